@@ -0,0 +1,105 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	benchmarks/Benchmark.h
+ *
+*/
+#ifndef ZYPP_BENCHMARKS_BENCHMARK_H
+#define ZYPP_BENCHMARKS_BENCHMARK_H
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+///////////////////////////////////////////////////////////////////
+/// \namespace zyppbench
+/// \brief Minimal benchmark harness for the libzypp benchmarks.
+///
+/// Each \c *_bench.cc registers benchmarks via \ref ZYPP_BENCHMARK and
+/// is linked against \c zypp_benchmark_main, which runs them:
+/// \code
+///   ZYPP_BENCHMARK( EditionCompare )
+///   {
+///     static std::vector<Edition> editions( makeEditions() );	// setup (in the warm up run)
+///     for ( ... )
+///       ...compare...
+///     state.items( editions.size() );
+///   }
+/// \endcode
+/// The body is one iteration. It is called once to warm up (untimed;
+/// static setup happens here), then repeatedly until \c --min-time is
+/// reached, and all this \c --repetitions times. The median time per
+/// iteration is reported.
+///
+/// Options:
+/// \code
+///   --list               list the benchmarks
+///   --filter REGEX       run matching benchmarks only
+///   --repetitions N      (default 5)
+///   --min-time SEC       minimal time per repetition (default 0.5)
+///   --json FILE          write the results as JSON ('-' for stdout)
+/// \endcode
+///////////////////////////////////////////////////////////////////
+namespace zyppbench
+{
+  ///////////////////////////////////////////////////////////////////
+  /// \class State
+  /// \brief Passed to the benchmark body.
+  ///////////////////////////////////////////////////////////////////
+  class State
+  {
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+    /** Exclude the following code from timing (e.g. cleanup). */
+    void pause()
+    { _paused = Clock::now(); }
+
+    /** Continue timing after \ref pause. */
+    void resume()
+    { _pausedTime += Clock::now() - _paused; }
+
+    /** Number of items processed per iteration (reports items/s). */
+    void items( unsigned long long count_r )
+    { _items = count_r; }
+
+    /** Number of bytes processed per iteration (reports bytes/s). */
+    void bytes( unsigned long long count_r )
+    { _bytes = count_r; }
+
+  public:
+    Clock::time_point  _paused;
+    Clock::duration    _pausedTime = Clock::duration::zero();
+    unsigned long long _items = 0;
+    unsigned long long _bytes = 0;
+  };
+
+  /** A benchmark body. */
+  typedef std::function<void( State & )> Function;
+
+  /** Register a benchmark (see \ref ZYPP_BENCHMARK). */
+  struct Registrar
+  {
+    Registrar( const std::string & name_r, Function fnc_r );
+  };
+
+  /** Prevent the compiler from optimizing away an otherwise unused result. */
+  template <class Tp>
+  inline void doNotOptimize( const Tp & value_r )
+  { asm volatile( "" : : "g"(&value_r) : "memory" ); }
+
+} // namespace zyppbench
+///////////////////////////////////////////////////////////////////
+
+/** Define and register a benchmark \a NAME; the body is a function of \c zyppbench::State & \c state. */
+#define ZYPP_BENCHMARK(NAME) \
+  static void NAME##_benchmark( zyppbench::State & state ); \
+  static zyppbench::Registrar NAME##_registrar( #NAME, NAME##_benchmark ); \
+  static void NAME##_benchmark( zyppbench::State & state )
+
+#endif // ZYPP_BENCHMARKS_BENCHMARK_H
@@ -0,0 +1,242 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	benchmarks/BenchmarkMain.cc
+ *
+*/
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "zypp/base/Exception.h"
+#include "zypp/base/Json.h"
+#include "zypp/base/LogControl.h"
+#include "zypp/base/Regex.h"
+#include "zypp/base/String.h"
+#include "zypp/Date.h"
+
+#include "Benchmark.h"
+
+using std::endl;
+using namespace zypp;
+
+namespace zyppbench
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace
+  {
+    struct Entry
+    {
+      std::string _name;
+      Function    _fnc;
+    };
+
+    std::vector<Entry> & registry()
+    {
+      static std::vector<Entry> _registry;
+      return _registry;
+    }
+
+    /** JSON number (json::Value has no floating point). */
+    struct Number
+    {
+      Number( double val_r ) : _val( val_r ) {}
+      std::string asJSON() const
+      { return std::isfinite( _val ) ? str::form( "%.6g", _val ) : "null"; }
+      double _val;
+    };
+
+    struct Options
+    {
+      bool        _list = false;
+      std::string _filter;
+      unsigned    _repetitions = 5;
+      double      _minTime = 0.5;
+      std::string _json;
+    };
+
+    struct Result
+    {
+      std::string         _name;
+      unsigned long long  _iterations = 0;
+      std::vector<double> _ns;	//!< per iteration, each repetition
+      unsigned long long  _items = 0;
+      unsigned long long  _bytes = 0;
+
+      double median() const
+      {
+	std::vector<double> v( _ns );
+	std::sort( v.begin(), v.end() );
+	return v.size() % 2 ? v[v.size()/2] : ( v[v.size()/2-1] + v[v.size()/2] ) / 2;
+      }
+      double mean() const
+      {
+	double sum = 0;
+	for ( double ns : _ns ) sum += ns;
+	return sum / _ns.size();
+      }
+      double stddev() const
+      {
+	double m = mean();
+	double sum = 0;
+	for ( double ns : _ns ) sum += ( ns - m ) * ( ns - m );
+	return _ns.size() > 1 ? std::sqrt( sum / ( _ns.size() - 1 ) ) : 0.0;
+      }
+
+      std::string asJSON() const
+      {
+	json::Object ret {
+	  { "name",		_name },
+	  { "iterations",	_iterations },
+	  { "repetitions",	unsigned(_ns.size()) },
+	  { "median_ns",	Number( median() ) },
+	  { "mean_ns",		Number( mean() ) },
+	  { "stddev_ns",	Number( stddev() ) },
+	  { "min_ns",		Number( *std::min_element( _ns.begin(), _ns.end() ) ) },
+	  { "max_ns",		Number( *std::max_element( _ns.begin(), _ns.end() ) ) },
+	};
+	if ( _items )
+	  ret.add( "items_per_second", Number( _items * 1e9 / median() ) );
+	if ( _bytes )
+	  ret.add( "bytes_per_second", Number( _bytes * 1e9 / median() ) );
+	return ret.asJSON();
+      }
+    };
+
+    /** Run \a count_r iterations, return the timed ns. */
+    double runIterations( const Entry & entry_r, unsigned long long count_r, State & state_r )
+    {
+      state_r._pausedTime = State::Clock::duration::zero();
+      State::Clock::time_point start( State::Clock::now() );
+      for ( unsigned long long i = 0; i < count_r; ++i )
+	entry_r._fnc( state_r );
+      State::Clock::duration elapsed( State::Clock::now() - start - state_r._pausedTime );
+      return std::chrono::duration<double,std::nano>( elapsed ).count();
+    }
+
+    Result run( const Entry & entry_r, const Options & opt_r )
+    {
+      Result ret;
+      ret._name = entry_r._name;
+      State state;
+
+      // warm up (untimed setup) and calibrate
+      runIterations( entry_r, 1, state );
+      double once = std::max( runIterations( entry_r, 1, state ), 1.0 );
+      ret._iterations = std::max( 1ULL, (unsigned long long)( opt_r._minTime * 1e9 / once ) );
+
+      for ( unsigned r = 0; r < opt_r._repetitions; ++r )
+	ret._ns.push_back( runIterations( entry_r, ret._iterations, state ) / ret._iterations );
+      ret._items = state._items;
+      ret._bytes = state._bytes;
+      return ret;
+    }
+
+    int usage( const char * argv0_r, int exit_r )
+    {
+      std::cerr << "Usage: " << argv0_r << " [--list] [--filter REGEX] [--repetitions N] [--min-time SEC] [--json FILE|-]" << endl;
+      return exit_r;
+    }
+  } // namespace
+  ///////////////////////////////////////////////////////////////////
+
+  Registrar::Registrar( const std::string & name_r, Function fnc_r )
+  { registry().push_back( Entry{ name_r, fnc_r } ); }
+
+} // namespace zyppbench
+
+int main( int argc, char * argv[] )
+{
+  using namespace zyppbench;
+  Options opt;
+  for ( int i = 1; i < argc; ++i )
+  {
+    std::string arg( argv[i] );
+    if ( arg == "--list" )
+      opt._list = true;
+    else if ( i+1 >= argc )
+      return usage( argv[0], 1 );
+    else if ( arg == "--filter" )
+      opt._filter = argv[++i];
+    else if ( arg == "--repetitions" )
+      opt._repetitions = std::max( 1U, str::strtonum<unsigned>( argv[++i] ) );
+    else if ( arg == "--min-time" )
+      opt._minTime = std::strtod( argv[++i], nullptr );
+    else if ( arg == "--json" )
+      opt._json = argv[++i];
+    else
+      return usage( argv[0], 1 );
+  }
+
+  base::LogControl::instance().logNothing();	// don't measure the logger
+  str::regex filter( opt._filter.empty() ? "." : opt._filter );
+
+  json::Array results;
+  int ret = 0;
+  for ( const Entry & entry : registry() )
+  {
+    if ( ! str::regex_match( entry._name, filter ) )
+      continue;
+    if ( opt._list )
+    {
+      std::cout << entry._name << endl;
+      continue;
+    }
+
+    try
+    {
+      Result result( run( entry, opt ) );
+      std::cerr << str::form( "%-40s %14.0f ns  (+-%4.1f%%, %llu iterations)",
+			      result._name.c_str(), result.median(),
+			      100 * result.stddev() / result.median(), result._iterations );
+      if ( result._items )
+	std::cerr << str::form( "  %.4g items/s", result._items * 1e9 / result.median() );
+      if ( result._bytes )
+	std::cerr << str::form( "  %.4g MiB/s", result._bytes * 1e9 / result.median() / ( 1024 * 1024 ) );
+      std::cerr << endl;
+      results.add( result );
+    }
+    catch ( const Exception & excpt )
+    {
+      std::cerr << entry._name << ": " << excpt.asUserHistory() << endl;
+      ret = 2;
+    }
+  }
+
+  if ( ! opt._json.empty() && ! opt._list )
+  {
+    char host[256] = "";
+    ::gethostname( host, sizeof(host)-1 );
+    json::Object context {
+      { "executable",	Pathname::basename( argv[0] ) },
+      { "libzypp",	VERSION },
+      { "date",		Date::now().printISO() },
+      { "host",		host },
+      { "repetitions",	opt._repetitions },
+      { "min_time_s",	Number( opt._minTime ) },
+    };
+    json::Object document { { "context", context }, { "benchmarks", results } };
+
+    if ( opt._json == "-" )
+      std::cout << document << endl;
+    else
+    {
+      std::ofstream out( opt._json.c_str() );
+      out << document << endl;
+      if ( ! out )
+      {
+	std::cerr << "Can't write " << opt._json << endl;
+	ret = 1;
+      }
+    }
+  }
+  return ret;
+}
@@ -0,0 +1,50 @@
+#include <iostream>
+#include <vector>
+
+#include "zypp/Digest.h"
+
+#include "Benchmark.h"
+
+using namespace zypp;
+
+namespace
+{
+  /** 4 MiB of reproducible pseudo random data. */
+  const std::vector<char> & data()
+  {
+    static std::vector<char> _data;
+    if ( _data.empty() )
+    {
+      _data.resize( 4 * 1024 * 1024 );
+      unsigned x = 42;
+      for ( char & c : _data )
+      {
+	x = x * 1103515245 + 12345;
+	c = char( x >> 16 );
+      }
+    }
+    return _data;
+  }
+
+  void digest( const std::string & name_r, zyppbench::State & state )
+  {
+    Digest digest;
+    digest.create( name_r );
+    digest.update( &data()[0], data().size() );
+    std::string sum( digest.digest() );
+    zyppbench::doNotOptimize( sum );
+    state.bytes( data().size() );
+  }
+}
+
+ZYPP_BENCHMARK( DigestMd5 )
+{ digest( Digest::md5(), state ); }
+
+ZYPP_BENCHMARK( DigestSha1 )
+{ digest( Digest::sha1(), state ); }
+
+ZYPP_BENCHMARK( DigestSha256 )
+{ digest( Digest::sha256(), state ); }
+
+ZYPP_BENCHMARK( DigestSha512 )
+{ digest( Digest::sha512(), state ); }
@@ -0,0 +1,65 @@
+#include <fstream>
+
+#include "zypp/MediaSetAccess.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "WebServer.h"
+
+#include "Benchmark.h"
+
+using namespace zypp;
+
+namespace
+{
+  static const unsigned fileSize = 16 * 1024 * 1024;
+
+  /** Local web server serving a reproducible file "/data.bin". */
+  WebServer & webServer()
+  {
+    static filesystem::TmpDir _root;
+    static WebServer _web( _root.path(), 10003 );
+    static bool _started = false;
+    if ( ! _started )
+    {
+      std::ofstream str( ( _root.path() / "data.bin" ).c_str() );
+      unsigned x = 42;
+      for ( unsigned i = 0; i < fileSize; ++i )
+      {
+	x = x * 1103515245 + 12345;
+	str.put( char( x >> 16 ) );
+      }
+      str.close();
+      _web.start();
+      _started = true;
+    }
+    return _web;
+  }
+
+  void download( const Url & url_r, zyppbench::State & state )
+  {
+    MediaSetAccess access( url_r, "/" );
+    Pathname local( access.provideFile( "/data.bin" ) );
+    if ( PathInfo( local ).size() != fileSize )
+      ZYPP_THROW( Exception( "Download: unexpected file size" ) );
+    state.bytes( fileSize );
+    state.pause();
+    access.release();
+    state.resume();
+  }
+}
+
+/** MediaMultiCurl (the default http handler). */
+ZYPP_BENCHMARK( DownloadMultiCurl )
+{
+  Url url( webServer().url() );
+  url.setQueryParam( "mediahandler", "multicurl" );
+  download( url, state );
+}
+
+/** MediaCurl for comparison. */
+ZYPP_BENCHMARK( DownloadCurl )
+{
+  Url url( webServer().url() );
+  url.setQueryParam( "mediahandler", "curl" );
+  download( url, state );
+}
@@ -0,0 +1,63 @@
+#include <vector>
+
+#include "zypp/Edition.h"
+#include "zypp/base/String.h"
+
+#include "Benchmark.h"
+
+using namespace zypp;
+
+namespace
+{
+  /** Reproducible set of editions (no randomness). */
+  const std::vector<Edition> & editions()
+  {
+    static std::vector<Edition> _editions;
+    if ( _editions.empty() )
+    {
+      for ( unsigned i = 0; i < 1000; ++i )
+      {
+	_editions.push_back( Edition( str::form( "%u.%u.%u%s", i % 7, i % 13, i % 29, ( i % 3 ? "" : "~rc1" ) ),
+				      str::form( "%u.%u", i % 17, i % 5 ),
+				      i % 11 ? 0 : 1 ) );
+      }
+    }
+    return _editions;
+  }
+}
+
+ZYPP_BENCHMARK( EditionCompare )
+{
+  const std::vector<Edition> & eds( editions() );
+  int sum = 0;
+  for ( unsigned i = 1; i < eds.size(); ++i )
+    sum += eds[i-1].compare( eds[i] );
+  zyppbench::doNotOptimize( sum );
+  state.items( eds.size() - 1 );
+}
+
+ZYPP_BENCHMARK( EditionMatch )
+{
+  const std::vector<Edition> & eds( editions() );
+  int sum = 0;
+  for ( unsigned i = 1; i < eds.size(); ++i )
+    sum += eds[i-1].match( eds[i] );
+  zyppbench::doNotOptimize( sum );
+  state.items( eds.size() - 1 );
+}
+
+ZYPP_BENCHMARK( EditionParse )
+{
+  static std::vector<std::string> strs;
+  if ( strs.empty() )
+  {
+    for ( const Edition & ed : editions() )
+      strs.push_back( ed.asString() );
+  }
+  for ( const std::string & s : strs )
+  {
+    Edition ed( s );
+    zyppbench::doNotOptimize( ed );
+  }
+  state.items( strs.size() );
+}
@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "zypp/base/String.h"
+#include "zypp/RepoInfo.h"
+#include "zypp/parser/RepoindexFileReader.h"
+#include "zypp/media/MetaLinkParser.h"
+
+#include "Benchmark.h"
+
+using namespace zypp;
+
+// Throughput of the streaming parsers on large synthetic input.
+namespace
+{
+  std::string repoindex( unsigned repos_r )
+  {
+    str::Str ret;
+    ret << "<repoindex arch=\"x86_64\" distver=\"12\" ttl=\"3600\">\n";
+    for ( unsigned i = 0; i < repos_r; ++i )
+    {
+      ret << "<repo alias=\"repo-" << i << "\" name=\"%{alias} Repository\""
+          << " url=\"http://download.example.com/%{distver}/" << i << "\""
+          << " distro_target=\"sle-%{distver}-%{arch}\" priority=\"" << (i%99+1) << "\""
+          << " enabled=\"" << (i%2 ? "true" : "false") << "\" autorefresh=\"true\"/>\n";
+    }
+    ret << "</repoindex>\n";
+    return ret;
+  }
+
+  std::string metalink( unsigned pieces_r, unsigned urls_r )
+  {
+    static const unsigned blksize = 256*1024;
+    str::Str ret;
+    ret << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<metalink xmlns=\"urn:ietf:params:xml:ns:metalink\">\n"
+        << "<file name=\"image.iso\">\n"
+        << "<size>" << (unsigned long long)pieces_r * blksize << "</size>\n"
+        << "<hash type=\"sha-1\">c7827b5a8e62d3971524ba0c438e9574e892103a</hash>\n"
+        << "<pieces length=\"" << blksize << "\" type=\"sha-1\">\n";
+    for ( unsigned i = 0; i < pieces_r; ++i )
+      ret << "<hash>" << str::form( "%08x", i ) << "5a8e62d3971524ba0c438e9574e89210</hash>\n";
+    ret << "</pieces>\n";
+    for ( unsigned i = 0; i < urls_r; ++i )
+      ret << "<url location=\"de\" priority=\"" << i+1 << "\">http://mirror" << i << ".example.com/image.iso</url>\n";
+    ret << "</file>\n</metalink>\n";
+    return ret;
+  }
+}
+
+ZYPP_BENCHMARK( RepoindexFileReader )
+{
+  static const std::string input( repoindex( 20000 ) );
+  std::istringstream str( input );
+  unsigned count = 0;
+  parser::RepoindexFileReader reader( str, [&count]( const RepoInfo & )->bool {
+    ++count;
+    return true;
+  });
+  zyppbench::doNotOptimize( count );
+  state.items( count );
+  state.bytes( input.size() );
+}
+
+ZYPP_BENCHMARK( MetaLinkParser )
+{
+  // an 8GiB image, fed in chunks as when downloading
+  static const std::string input( metalink( 32768, 100 ) );
+  static const size_t chunk = 16*1024;
+  media::MetaLinkParser mlp;
+  for ( size_t off = 0; off < input.size(); off += chunk )
+    mlp.parseBytes( input.data() + off, std::min( chunk, input.size() - off ) );
+  mlp.parseEnd();
+  media::MediaBlockList bl( mlp.getBlockList() );
+  zyppbench::doNotOptimize( bl );
+  state.items( bl.numBlocks() );
+  state.bytes( input.size() );
+}
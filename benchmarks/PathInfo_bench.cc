@@ -0,0 +1,48 @@
+#include <fstream>
+#define INCLUDE_TESTSETUP_WITHOUT_BOOST
+#include "TestSetup.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+
+#include "Benchmark.h"
+
+namespace
+{
+  /** A few thousand RPMs in a tmpfs directory (if available). */
+  struct Rpms
+  {
+    static const unsigned files = 3000;
+
+    Rpms()
+    : _tmp( PathInfo( "/dev/shm" ).isDir() && PathInfo( "/dev/shm" ).userMayRWX() ? Pathname( "/dev/shm" ) : filesystem::TmpPath::defaultLocation(),
+            "zypp-copy-bench" )
+    {
+      filesystem::assert_dir( src() );
+      std::string content( 64*1024, 'x' );
+      for ( unsigned i = 0; i < files; ++i )
+        std::ofstream( (src() / str::numstring( i ) + ".rpm").c_str() ) << i << content;
+    }
+
+    Pathname src() const
+    { return _tmp.path() / "rpms"; }
+
+    Pathname dest() const
+    { return _tmp.path() / "dest"; }
+
+  private:
+    filesystem::TmpDir _tmp;
+  };
+}
+
+ZYPP_BENCHMARK( CopyDir )
+{
+  static Rpms rpms;
+  state.pause();
+  filesystem::recursive_rmdir( rpms.dest() );
+  filesystem::assert_dir( rpms.dest() );
+  state.resume();
+  if ( filesystem::copy_dir( rpms.src(), rpms.dest() ) != 0 )
+    ZYPP_THROW( Exception( "copy_dir failed" ) );
+  state.items( Rpms::files );
+  state.bytes( Rpms::files * 64ULL*1024 );
+}
@@ -0,0 +1,205 @@
+#include <cstdlib>
+#define INCLUDE_TESTSETUP_WITHOUT_BOOST
+#include "TestSetup.h"
+#include "zypp/PoolQuery.h"
+#include "zypp/base/StrMatcher.h"
+
+#include "Benchmark.h"
+
+namespace
+{
+  /** The pool with the repos from tests/data (set up in the warm up run). */
+  TestSetup & test()
+  {
+    static TestSetup _test( Arch_x86_64 );
+    if ( _test.satpool().reposEmpty() )
+    {
+      _test.loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1", "openSUSE-11.1" );
+      _test.loadRepo( TESTS_SRC_DIR "/data/11.0-update", "11.0-update" );
+    }
+    return _test;
+  }
+
+  /** The solv file built for \a alias_r. */
+  Pathname solvFile( const std::string & alias_r )
+  {
+    Pathname ret( test().root() / "solv" / alias_r / "solv" );
+    if ( ! PathInfo( ret ).isFile() )
+      ZYPP_THROW( Exception( "No solv file " + ret.asString() ) );
+    return ret;
+  }
+
+  void query( PoolQuery & query_r, zyppbench::State & state )
+  {
+    test().pool();	// prepared
+    unsigned hits = 0;
+    for_( it, query_r.begin(), query_r.end() )
+      ++hits;
+    zyppbench::doNotOptimize( hits );
+    state.items( test().satpool().solvablesSize() );
+  }
+
+  /** 1000 search strings: every other one a package name from the pool.
+   * Names with regex special chars (e.g. 'libstdc++') are omitted.
+   */
+  const std::vector<std::string> & manyNames()
+  {
+    static std::vector<std::string> _names;
+    if ( _names.empty() )
+    {
+      std::set<std::string> names;
+      for ( const sat::Solvable & solv : test().satpool().solvables() )
+      {
+        if ( solv.name().find_first_of( "^$+*?()[]{}|\\" ) == std::string::npos )
+          names.insert( solv.name() );
+      }
+      std::set<std::string>::size_type step = std::max( names.size() / 500, std::set<std::string>::size_type(1) );
+      std::set<std::string>::size_type idx = 0;
+      for ( const std::string & name : names )
+      {
+        if ( idx++ % step == 0 && _names.size() < 1000 )
+        {
+          _names.push_back( name );
+          _names.push_back( str::form( "nosuchpackage-%u", unsigned(idx) ) );
+        }
+      }
+      while ( _names.size() < 1000 )
+        _names.push_back( str::form( "nosuchpackage-x%u", unsigned(_names.size()) ) );
+    }
+    return _names;
+  }
+
+  /** Match all solvable names. */
+  void matchNames( const StrMatcher & matcher_r, zyppbench::State & state )
+  {
+    matcher_r.compile();
+    unsigned hits = 0;
+    for ( const sat::Solvable & solv : test().satpool().solvables() )
+    {
+      if ( matcher_r( solv.ident() ) )
+        ++hits;
+    }
+    zyppbench::doNotOptimize( hits );
+    state.items( test().satpool().solvablesSize() );
+  }
+}
+
+ZYPP_BENCHMARK( PoolLoadSolv )
+{
+  static Pathname file( solvFile( "openSUSE-11.1" ) );
+  Repository repo( test().satpool().addRepoSolv( file, "bench" ) );
+  state.items( repo.solvablesSize() );
+  state.pause();
+  repo.eraseFromPool();
+  state.resume();
+}
+
+// The same read via stdio instead of the shared mapping:
+ZYPP_BENCHMARK( PoolLoadSolvStdio )
+{
+  static Pathname file( solvFile( "openSUSE-11.1" ) );
+  ::setenv( "ZYPP_SOLV_NO_MMAP", "1", 1 );
+  Repository repo( test().satpool().addRepoSolv( file, "bench" ) );
+  ::unsetenv( "ZYPP_SOLV_NO_MMAP" );
+  state.items( repo.solvablesSize() );
+  state.pause();
+  repo.eraseFromPool();
+  state.resume();
+}
+
+ZYPP_BENCHMARK( PoolPrepare )
+{
+  state.pause();
+  // a locale change invalidates the whatprovides index
+  static const Locale locale( "de" );
+  if ( ! test().satpool().addRequestedLocale( locale ) )
+    test().satpool().eraseRequestedLocale( locale );
+  state.resume();
+  test().satpool().prepare();
+  state.items( test().satpool().solvablesSize() );
+}
+
+ZYPP_BENCHMARK( PoolQuerySubstring )
+{
+  PoolQuery q;
+  q.addAttribute( sat::SolvAttr::name, "lib" );
+  q.setMatchSubstring();
+  query( q, state );
+}
+
+ZYPP_BENCHMARK( PoolQueryGlob )
+{
+  PoolQuery q;
+  q.addAttribute( sat::SolvAttr::name, "kde*" );
+  q.addKind( ResKind::package );
+  q.setMatchGlob();
+  query( q, state );
+}
+
+ZYPP_BENCHMARK( PoolQueryRegex )
+{
+  PoolQuery q;
+  q.addAttribute( sat::SolvAttr::name, "^(perl|python)-.*[0-9]$" );
+  q.setMatchRegex();
+  query( q, state );
+}
+
+ZYPP_BENCHMARK( PoolQuerySummaryDescription )
+{
+  PoolQuery q;
+  q.addAttribute( sat::SolvAttr::summary, "network" );
+  q.addAttribute( sat::SolvAttr::description, "network" );
+  q.setMatchSubstring();
+  q.setCaseSensitive( false );
+  query( q, state );
+}
+
+ZYPP_BENCHMARK( PoolQueryManyNames )
+{
+  PoolQuery q;
+  for ( const char * name : { "zypper", "libzypp", "kernel-default", "glibc", "bash", "coreutils",
+			      "rpm", "yast2", "perl", "python", "openssl", "vim", "emacs", "gcc" } )
+    q.addAttribute( sat::SolvAttr::name, name );
+  q.setMatchExact();
+  query( q, state );
+}
+
+ZYPP_BENCHMARK( PoolQuery1kNames )
+{
+  PoolQuery q;
+  for ( const std::string & name : manyNames() )
+    q.addAttribute( sat::SolvAttr::name, name );
+  q.setMatchExact();
+  query( q, state );
+}
+
+ZYPP_BENCHMARK( PoolQuery1kSubstrings )
+{
+  PoolQuery q;
+  for ( const std::string & name : manyNames() )
+    q.addAttribute( sat::SolvAttr::name, name );
+  q.setMatchSubstring();
+  query( q, state );
+}
+
+ZYPP_BENCHMARK( PoolQuery1kGlobs )
+{
+  PoolQuery q;
+  for ( const std::string & name : manyNames() )
+    q.addAttribute( sat::SolvAttr::name, name.substr( 0, name.size() / 2 ) + "*" );
+  q.setMatchGlob();
+  query( q, state );
+}
+
+// The same 1k substrings joined into a regex (as PoolQuery did) and as multi-pattern StrMatcher:
+ZYPP_BENCHMARK( StrMatcher1kSubstringsRegex )
+{
+  static const StrMatcher matcher( "(" + str::join( manyNames(), "|" ) + ")", Match::REGEX );
+  matchNames( matcher, state );
+}
+
+ZYPP_BENCHMARK( StrMatcher1kSubstringsMulti )
+{
+  static const StrMatcher matcher( manyNames(), Match::SUBSTRING );
+  matchNames( matcher, state );
+}
@@ -0,0 +1,85 @@
+#include <fstream>
+
+#include "zypp/base/String.h"
+#include "zypp/parser/RepoFileReader.h"
+#include "zypp/PathInfo.h"
+#include "zypp/RepoManager.h"
+#include "zypp/TmpPath.h"
+
+#include "Benchmark.h"
+
+using namespace zypp;
+
+namespace
+{
+  static const unsigned repoCount = 1000;
+
+  /** Write repo \a idx_r in .repo format (reproducible content). */
+  void writeRepo( std::ostream & str_r, unsigned idx_r )
+  {
+    str_r << "[repo-" << idx_r << "]" << std::endl
+	  << "name=Benchmark repository " << idx_r << std::endl
+	  << "enabled=" << ( idx_r % 5 ? 1 : 0 ) << std::endl
+	  << "autorefresh=" << ( idx_r % 2 ) << std::endl
+	  << "baseurl=http://download.example.com/distribution/" << idx_r << "/repo/oss/" << std::endl
+	  << "         http://mirror.example.com/distribution/" << idx_r << "/repo/oss/" << std::endl
+	  << "path=/" << std::endl
+	  << "type=rpm-md" << std::endl
+	  << "priority=" << 90 + idx_r % 20 << std::endl
+	  << "keeppackages=0" << std::endl
+	  << "gpgcheck=1" << std::endl
+	  << "gpgkey=http://download.example.com/distribution/" << idx_r << "/repodata/repomd.xml.key" << std::endl
+	  << std::endl;
+  }
+
+  /** A repos.d with \ref repoCount .repo files. */
+  const filesystem::TmpDir & reposdRoot()
+  {
+    static filesystem::TmpDir _root;
+    static bool _done = false;
+    if ( ! _done )
+    {
+      filesystem::assert_dir( _root.path() / "repos.d" );
+      for ( unsigned i = 0; i < repoCount; ++i )
+      {
+	std::ofstream str( ( _root.path() / "repos.d" / str::form( "repo-%u.repo", i ) ).c_str() );
+	writeRepo( str, i );
+      }
+      _done = true;
+    }
+    return _root;
+  }
+
+  /** A single .repo file containing \ref repoCount repos. */
+  const filesystem::TmpFile & bigRepoFile()
+  {
+    static filesystem::TmpFile _file;
+    static bool _done = false;
+    if ( ! _done )
+    {
+      std::ofstream str( _file.path().c_str() );
+      for ( unsigned i = 0; i < repoCount; ++i )
+	writeRepo( str, i );
+      _done = true;
+    }
+    return _file;
+  }
+}
+
+ZYPP_BENCHMARK( RepoFileReader )
+{
+  unsigned count = 0;
+  parser::RepoFileReader( bigRepoFile().path(),
+			  [&count]( const RepoInfo & )->bool { ++count; return true; } );
+  if ( count != repoCount )
+    ZYPP_THROW( Exception( "RepoFileReader: unexpected number of repos" ) );
+  state.items( count );
+}
+
+ZYPP_BENCHMARK( RepoManagerReposD )
+{
+  RepoManager manager( RepoManagerOptions::makeTestSetup( reposdRoot().path() ) );
+  if ( manager.repoSize() != repoCount )
+    ZYPP_THROW( Exception( "RepoManager: unexpected number of repos" ) );
+  state.items( repoCount );
+}
@@ -0,0 +1,40 @@
+#define INCLUDE_TESTSETUP_WITHOUT_BOOST
+#include "TestSetup.h"
+
+#include "Benchmark.h"
+
+namespace
+{
+  /** 11.0-update as installed system, openSUSE-11.1 available (set up in the warm up run). */
+  TestSetup & test()
+  {
+    static TestSetup _test( Arch_x86_64 );
+    if ( _test.satpool().reposEmpty() )
+    {
+      _test.loadTargetRepo( TESTS_SRC_DIR "/data/11.0-update" );
+      _test.loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1", "openSUSE-11.1" );
+    }
+    return _test;
+  }
+}
+
+ZYPP_BENCHMARK( ResolverUpdate )
+{
+  Resolver & resolver( test().resolver() );
+  resolver.doUpdate();
+  state.items( test().satpool().solvablesSize() );
+  state.pause();
+  resolver.undo();
+  state.resume();
+}
+
+ZYPP_BENCHMARK( ResolverVerifySystem )
+{
+  Resolver & resolver( test().resolver() );
+  resolver.verifySystem();
+  state.items( test().satpool().solvablesSize() );
+  state.pause();
+  resolver.setSystemVerification( false );
+  resolver.undo();
+  state.resume();
+}
@@ -0,0 +1,27 @@
+#define INCLUDE_TESTSETUP_WITHOUT_BOOST
+#include "TestSetup.h"
+
+#include "Benchmark.h"
+
+namespace
+{
+  /** The TCdup testcase (set up in the warm up run). */
+  TestSetup & test()
+  {
+    static TestSetup _test;
+    if ( _test.satpool().reposEmpty() )
+      _test.loadTestcaseRepos( TESTS_SRC_DIR "/data/TCdup" );
+    return _test;
+  }
+}
+
+ZYPP_BENCHMARK( ResolverUpgradeTCdup )
+{
+  Resolver & resolver( test().resolver() );
+  if ( ! resolver.doUpgrade() )
+    ZYPP_THROW( Exception( "Upgrade TCdup failed" ) );
+  state.items( test().satpool().solvablesSize() );
+  state.pause();
+  resolver.undo();
+  state.resume();
+}
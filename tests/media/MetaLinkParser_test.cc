@@ -1,4 +1,6 @@
 #include <iostream>
+#include <fstream>
+#include <iterator>
 #include <vector>
 #include <boost/test/auto_unit_test.hpp>
 
@@ -39,3 +41,25 @@ BOOST_AUTO_TEST_CASE(parse_metalink)
   BOOST_CHECK(bl3.numBlocks() == 459);
   BOOST_CHECK(bl4.numBlocks() == 459);
 }
+
+BOOST_AUTO_TEST_CASE(parse_metalink_chunked)
+{
+  // fed in chunks, as when downloading
+  Pathname meta4file = TESTS_SRC_DIR "/media/data/openSUSE-11.3-NET-i586.iso.meta4";
+  std::ifstream in( meta4file.c_str() );
+  std::string input( (std::istreambuf_iterator<char>( in )), std::istreambuf_iterator<char>() );
+  BOOST_REQUIRE( ! input.empty() );
+
+  MetaLinkParser whole;
+  whole.parse( meta4file );
+
+  MetaLinkParser chunked;
+  static const size_t chunk = 1000;
+  for ( size_t off = 0; off < input.size(); off += chunk )
+    chunked.parseBytes( input.data() + off, std::min( chunk, input.size() - off ) );
+  chunked.parseEnd();
+
+  BOOST_CHECK_EQUAL( chunked.getBlockList().asString(), whole.getBlockList().asString() );
+  BOOST_CHECK_EQUAL( chunked.getBlockList().numBlocks(), 459 );
+  BOOST_CHECK( chunked.getUrls() == whole.getUrls() );
+}
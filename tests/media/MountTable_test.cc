@@ -0,0 +1,64 @@
+#include <iostream>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/media/Mount.h"
+#include "zypp/PathInfo.h"
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::media;
+
+BOOST_AUTO_TEST_CASE(mounttable_entries)
+{
+  MountTable table( MountTable::current() );
+  MountEntries entries( Mount::getEntries() );
+  BOOST_REQUIRE_EQUAL( table.entries().size(), entries.size() );
+  for ( unsigned i = 0; i < entries.size(); ++i )
+  {
+    BOOST_CHECK_EQUAL( table.entries()[i].dir, entries[i].dir );
+    BOOST_CHECK_EQUAL( table.entries()[i].src, entries[i].src );
+  }
+  if ( entries.empty() )
+  {
+    BOOST_WARN( "No mount table available" );
+    return;
+  }
+
+  // lookup by mount point
+  for ( const MountEntry & entry : entries )
+  {
+    BOOST_CHECK( table.isMountPoint( entry.dir ) );
+    MountEntries at( table.entriesAt( entry.dir ) );
+    BOOST_CHECK( ! at.empty() );
+    for ( const MountEntry & a : at )
+      BOOST_CHECK_EQUAL( Pathname( a.dir ), Pathname( entry.dir ) );
+
+    Pathname parent( Pathname( entry.dir ).dirname() );
+    if ( parent != Pathname( entry.dir ) )
+      BOOST_CHECK( table.hasMountsBelow( parent ) );
+  }
+  BOOST_CHECK( ! table.isMountPoint( "/no/such/mount/point" ) );
+  BOOST_CHECK( table.entriesAt( "/no/such/mount/point" ).empty() );
+  BOOST_CHECK( ! table.hasMountsBelow( "/no/such/mount/point" ) );
+}
+
+BOOST_AUTO_TEST_CASE(mounttable_cache)
+{
+  if ( ! PathInfo( "/proc/self/mountinfo" ).isFile() )
+  {
+    BOOST_WARN( "No /proc/self/mountinfo to watch" );
+    return;
+  }
+  MountTable table( MountTable::current() );
+  // unchanged table is not reread
+  BOOST_CHECK_EQUAL( &MountTable::current().entries(), &table.entries() );
+
+  // reread after invalidate, but unchanged content keeps the generation
+  MountTable::invalidate();
+  MountTable reread( MountTable::current() );
+  BOOST_CHECK( &reread.entries() != &table.entries() );
+  BOOST_CHECK_EQUAL( reread.generation(), table.generation() );
+  // the old snapshot stays valid
+  BOOST_CHECK_EQUAL( reread.entries().size(), table.entries().size() );
+}
@@ -1,7 +1,11 @@
 #include <sstream>
+#include <fstream>
 #include <string>
+#include <list>
 #include <zypp/parser/RepoFileReader.h>
 #include <zypp/base/NonCopyable.h>
+#include <zypp/PathInfo.h>
+#include <zypp/TmpPath.h>
 
 #include "TestSetup.h"
 
@@ -78,3 +82,74 @@ BOOST_AUTO_TEST_CASE(read_repo_file)
   }
 
 }
+
+namespace
+{
+  std::string readRepoFiles( const std::list<Pathname> & files_r, const Pathname & cache_r = Pathname() )
+  {
+    RepoCollector collector;
+    parser::RepoFileReader parser( files_r, bind( &RepoCollector::collect, &collector, _1 ), cache_r );
+    stringstream str;
+    for ( const RepoInfo & repo : collector.repos )
+      repo.dumpAsIniOn( str << repo.filepath() << endl ) << endl;
+    return str.str();
+  }
+
+  void writeFile( const Pathname & file_r, const std::string & content_r )
+  {
+    std::ofstream out( file_r.c_str() );
+    out << content_r;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(read_repo_files_cached)
+{
+  filesystem::TmpDir tmp;
+  std::list<Pathname> files;
+  for ( unsigned i = 0; i < 20; ++i )
+  {
+    files.push_back( tmp.path() / str::form( "repo%02u.repo", i ) );
+    writeFile( files.back(), str::form( "[repo%u]\nname=Repo %u\n", i, i ) + ( i % 2 ? suse_repo : fedora_repo ) );
+  }
+  std::string expected;
+  for ( const Pathname & file : files )
+  {
+    std::list<Pathname> one { file };
+    expected += readRepoFiles( one );
+  }
+  BOOST_CHECK_EQUAL( readRepoFiles( files ), expected );
+
+  Pathname cache( tmp.path() / "cache" );
+  BOOST_CHECK_EQUAL( readRepoFiles( files, cache ), expected );	// create the cache
+  BOOST_CHECK( PathInfo( cache ).isFile() );
+  BOOST_CHECK_EQUAL( PathInfo( cache ).perm() & 0777, 0644 );
+  BOOST_CHECK_EQUAL( readRepoFiles( files, cache ), expected );	// use the cache
+
+  // a changed file is noticed
+  writeFile( files.front(), "[changed]\nname=Changed\nbaseurl=http://changed.example.com\n" );
+  std::string changed( readRepoFiles( files ) );
+  BOOST_CHECK( changed != expected );
+  BOOST_CHECK_EQUAL( readRepoFiles( files, cache ), changed );
+  BOOST_CHECK_EQUAL( readRepoFiles( files, cache ), changed );
+
+  // fewer files
+  files.pop_back();
+  changed = readRepoFiles( files );
+  BOOST_CHECK_EQUAL( readRepoFiles( files, cache ), changed );
+
+  // a broken cache is ignored
+  writeFile( cache, "garbage" );
+  BOOST_CHECK_EQUAL( readRepoFiles( files, cache ), changed );
+  std::string content;	// a valid header but truncated data
+  {
+    std::ifstream in( cache.c_str() );
+    content.assign( std::istreambuf_iterator<char>( in ), std::istreambuf_iterator<char>() );
+  }
+  writeFile( cache, content.substr( 0, content.size() / 2 ) );
+  BOOST_CHECK_EQUAL( readRepoFiles( files, cache ), changed );
+
+  // the cache is not readable by others if a file isn't
+  filesystem::chmod( files.front(), 0600 );
+  readRepoFiles( files, cache );
+  BOOST_CHECK_EQUAL( PathInfo( cache ).perm() & 0777, 0600 );
+}
@@ -1,5 +1,6 @@
 #include <sstream>
 #include <string>
+#include <algorithm>
 #include <zypp/Pathname.h>
 #include <zypp/parser/RepoindexFileReader.h>
 #include <zypp/base/NonCopyable.h>
@@ -67,3 +68,32 @@ BOOST_AUTO_TEST_CASE(read_index_file)
 
   }
 }
+
+BOOST_AUTO_TEST_CASE(read_index_many)
+{
+  static const unsigned repos = 100;
+  str::Str input;
+  input << "<repoindex arch=\"x86_64\" distver=\"12\" ttl=\"3600\">\n";
+  for ( unsigned i = 0; i < repos; ++i )
+  {
+    input << "<repo alias=\"repo-" << i << "\" name=\"%{alias} Repository\""
+          << " url=\"http://download.example.com/%{distver}/" << i << "\""
+          << " distro_target=\"sle-%{distver}-%{arch}\" priority=\"" << (i%99+1) << "\""
+          << " enabled=\"" << (i%2 ? "true" : "false") << "\" autorefresh=\"true\"/>\n";
+  }
+  input << "</repoindex>\n";
+
+  stringstream str( input.str() );
+  RepoCollector collector;
+  parser::RepoindexFileReader parser( str, bind( &RepoCollector::collect, &collector, _1 ) );
+  BOOST_CHECK_EQUAL( parser.ttl(), 3600 );
+  BOOST_REQUIRE_EQUAL( collector.repos.size(), repos );
+  BOOST_CHECK_EQUAL( std::count_if( collector.repos.begin(), collector.repos.end(), []( const RepoInfo & repo_r ) { return repo_r.enabled(); } ), repos/2 );
+
+  const RepoInfo & last( collector.repos.back() );
+  BOOST_CHECK_EQUAL( last.alias(), "repo-99" );
+  BOOST_CHECK_EQUAL( last.name(), "repo-99 Repository" );
+  BOOST_CHECK_EQUAL( last.priority(), 1 );
+  BOOST_CHECK_EQUAL( last.targetDistribution(), "sle-12-x86_64" );
+  BOOST_CHECK_EQUAL( last.url().asString(), "http://download.example.com/12/99" );
+}
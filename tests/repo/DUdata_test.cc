@@ -111,3 +111,37 @@ BOOST_AUTO_TEST_CASE(dudata)
   ins.status().setTransact( false, ResStatus::USER );
   up3.status().setTransact( false, ResStatus::USER );
 }
+
+BOOST_AUTO_TEST_CASE(dudata_incremental)
+{
+  Pathname repodir( TEST_DIR );
+  TestSetup test( Arch_x86_64 );
+  test.loadTargetRepo( repodir/"system" );
+  test.loadRepo( repodir/"repo", "repo" );
+
+  ResPool pool( ResPool::instance() );
+  std::vector<PoolItem> items( { piFind( "dutest", "1.0", true ),
+                                 piFind( "dutest", "1.0" ),
+                                 piFind( "dutest", "2.0" ),
+                                 piFind( "dutest", "3.0" ) } );
+
+  DiskUsageCounter duc( { DiskUsageCounter::MountPoint( "/grow", DiskUsageCounter::MountPoint::Hint_growonly ),
+                          DiskUsageCounter::MountPoint( "/norm" ) } );
+
+  // walk all combinations in gray code order (one toggle per step);
+  // the incremental result must match a full computation.
+  for ( unsigned step = 1; step <= 2 * (1U << items.size()); ++step )
+  {
+    unsigned bit = __builtin_ctz( step ) % items.size();
+    ResStatus & status( items[bit].status() );
+    status.setTransact( ! status.transacts(), ResStatus::USER );
+
+    DiskUsageCounter full( duc.getMountPoints() );
+    BOOST_CHECK_EQUAL( getSize( duc, pool ), getSize( full, pool ) );
+  }
+  // mount points changed
+  duc.setMountPoints( { DiskUsageCounter::MountPoint( "/norm" ), DiskUsageCounter::MountPoint( "/other" ) } );
+  items[1].status().setTransact( true, ResStatus::USER );
+  BOOST_CHECK_EQUAL( getSize( duc, pool ), getSize( DiskUsageCounter( duc.getMountPoints() ), pool ) );
+  items[1].status().setTransact( false, ResStatus::USER );
+}
@@ -0,0 +1,112 @@
+#include <boost/test/auto_unit_test.hpp>
+#include <iostream>
+#include <fstream>
+#include <utime.h>
+
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/repo/PackageStore.h"
+
+using std::cout;
+using std::endl;
+using namespace zypp;
+using namespace boost::unit_test;
+
+namespace
+{
+  CheckSum mkfile( const Pathname & file_r, const std::string & content_r )
+  {
+    filesystem::assert_dir( file_r.dirname() );
+    std::ofstream( file_r.c_str() ) << content_r;
+    return CheckSum::sha256( filesystem::checksum( file_r, "sha256" ) );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(package_store_disabled)
+{
+  repo::PackageStore store( (Pathname()) );
+  BOOST_CHECK( ! store.enabled() );
+  BOOST_CHECK( store.location( CheckSum::sha256( "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef" ) ).empty() );
+  BOOST_CHECK( ! store.add( CheckSum(), "/some/file" ) );
+}
+
+BOOST_AUTO_TEST_CASE(package_store_add_provide)
+{
+  filesystem::TmpDir tmp;
+  repo::PackageStore store( tmp.path() / "store" );
+  BOOST_CHECK( store.enabled() );
+
+  CheckSum sum( mkfile( tmp.path() / "repo1" / "a.rpm", "package a" ) );
+  const std::string & hex( sum.checksum() );
+  BOOST_CHECK_EQUAL( store.location( sum ), tmp.path() / "store" / "sha256" / hex.substr( 0, 2 ) / hex );
+  BOOST_CHECK( ! store.contains( sum ) );
+  BOOST_CHECK( ! store.provide( sum, tmp.path() / "repo2" / "a.rpm" ) );
+
+  BOOST_CHECK( store.add( sum, tmp.path() / "repo1" / "a.rpm" ) );
+  BOOST_CHECK( store.contains( sum ) );
+  BOOST_CHECK( store.add( sum, tmp.path() / "repo1" / "a.rpm" ) );	// already there
+
+  BOOST_CHECK( store.provide( sum, tmp.path() / "repo2" / "a.rpm" ) );
+  BOOST_CHECK( filesystem::is_checksum( tmp.path() / "repo2" / "a.rpm", sum ) );
+  // hardlinked on the same filesystem
+  BOOST_CHECK_EQUAL( PathInfo( tmp.path() / "repo2" / "a.rpm" ).ino(), PathInfo( store.location( sum ) ).ino() );
+}
+
+BOOST_AUTO_TEST_CASE(package_store_broken_file)
+{
+  filesystem::TmpDir tmp;
+  repo::PackageStore store( tmp.path() / "store" );
+
+  CheckSum sum( mkfile( tmp.path() / "a.rpm", "package a" ) );
+  BOOST_CHECK( store.add( sum, tmp.path() / "a.rpm" ) );
+  BOOST_CHECK( ! store.lookup( sum ).empty() );	// verified...
+  BOOST_CHECK( ! store.lookup( sum ).empty() );
+  // ...but modifying the hardlink breaks the stored file
+  std::ofstream( (tmp.path() / "a.rpm").c_str() ) << "modified";
+  BOOST_CHECK( store.lookup( sum ).empty() );
+  BOOST_CHECK( ! store.contains( sum ) );	// broken file was removed
+}
+
+BOOST_AUTO_TEST_CASE(package_store_rejected_hit)
+{
+  filesystem::TmpDir tmp;
+  repo::PackageStore store( tmp.path() / "store" );
+
+  CheckSum sum( mkfile( tmp.path() / "repo1" / "a.rpm", "package a" ) );
+  BOOST_CHECK( store.add( sum, tmp.path() / "repo1" / "a.rpm" ) );
+  BOOST_CHECK( store.provide( sum, tmp.path() / "repo2" / "a.rpm" ) );
+
+  // PackageProvider evicts a hit failing the signature check, so
+  // MediaSetAccess::provideFile does not return it again but downloads.
+  BOOST_CHECK( store.remove( sum ) );
+  BOOST_CHECK( ! store.contains( sum ) );
+  BOOST_CHECK( store.lookup( sum ).empty() );
+  BOOST_CHECK( ! store.provide( sum, tmp.path() / "repo3" / "a.rpm" ) );
+  BOOST_CHECK( ! store.remove( sum ) );
+  // the hit handed out before is not affected
+  BOOST_CHECK( filesystem::is_checksum( tmp.path() / "repo2" / "a.rpm", sum ) );
+
+  // the downloaded file is stored again
+  BOOST_CHECK( store.add( sum, tmp.path() / "repo2" / "a.rpm" ) );
+  BOOST_CHECK_EQUAL( store.lookup( sum ), store.location( sum ) );
+}
+
+BOOST_AUTO_TEST_CASE(package_store_cleanup)
+{
+  filesystem::TmpDir tmp;
+  repo::PackageStore store( tmp.path() / "store", ByteCount( 15 ) );
+
+  CheckSum olds( mkfile( tmp.path() / "old.rpm", "old package" ) );
+  CheckSum news( mkfile( tmp.path() / "new.rpm", "new package" ) );
+  BOOST_CHECK( store.add( olds, tmp.path() / "old.rpm" ) );
+  BOOST_CHECK( store.add( news, tmp.path() / "new.rpm" ) );
+
+  // make 'old' the least recently used one
+  struct ::utimbuf times;
+  times.actime = times.modtime = 1000;
+  ::utime( store.location( olds ).c_str(), &times );
+
+  store.cleanup();
+  BOOST_CHECK( ! store.contains( olds ) );
+  BOOST_CHECK( store.contains( news ) );
+}
@@ -0,0 +1,127 @@
+#include "TestSetup.h"
+#include <functional>
+#include <sstream>
+#include <zypp/sat/PoolSnapshot.h>
+#include <zypp/sat/LookupAttr.h>
+#include <zypp/sat/WhatProvides.h>
+#include <zypp/thread/RunTasks.h>
+#include <zypp/PoolQuery.h>
+
+static TestSetup test( Arch_x86_64 );
+
+namespace
+{
+  /** Query solvables [begin_r,end_r) and return a digest of the results.
+   * Must not log, as it runs in many threads.
+   */
+  std::string query( const std::vector<sat::Solvable> & solvables_r, unsigned begin_r, unsigned end_r )
+  {
+    std::ostringstream str;
+    for ( unsigned i = begin_r; i < end_r && i < solvables_r.size(); ++i )
+    {
+      const sat::Solvable & solv( solvables_r[i] );
+      str << solv.asString() << "|" << solv.summary() << "|" << solv.description().size()
+          << "|" << solv.lookupCheckSumAttribute( sat::SolvAttr::checksum )
+          << "|" << solv.lookupLocation().filename()
+          << "|" << solv.downloadSize() << endl;
+
+      str << "  " << sat::WhatProvides( Capability( solv.ident().c_str() ) ).size();
+      for ( const Capability & cap : solv.provides() )
+        str << " " << cap << ":" << sat::WhatProvides( cap ).size();
+      for ( const Capability & cap : solv.requires() )
+        str << " " << cap << ":" << sat::WhatProvides( cap ).size();
+      str << endl;
+
+      ResPool pool( ResPool::instance() );
+      str << "  " << std::distance( pool.byIdentBegin( solv ), pool.byIdentEnd( solv ) )
+          << " " << PoolItem( solv ).status() << endl;
+
+      sat::LookupAttr attrs( sat::SolvAttr::allAttr, solv );
+      for_( it, attrs.begin(), attrs.end() )
+        str << "  " << it.inSolvAttr() << "=" << it.asString() << endl;
+    }
+
+    PoolQuery q;
+    q.addAttribute( sat::SolvAttr::name, solvables_r[begin_r % solvables_r.size()].name().substr( 0, 3 ) );
+    q.addAttribute( sat::SolvAttr::summary, "lib" );
+    q.setMatchSubstring();
+    str << "PoolQuery:";
+    for ( const sat::Solvable & solv : q )
+      str << " " << solv.id();
+    str << endl;
+    return str.str();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(init)
+{
+  test.loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1" );
+  test.loadRepo( TESTS_SRC_DIR "/data/11.0-update" );
+  BOOST_REQUIRE( ! test.satpool().solvablesEmpty() );
+}
+
+BOOST_AUTO_TEST_CASE(frozen)
+{
+  BOOST_CHECK( ! sat::PoolSnapshot::active() );
+  IdString known( "zypper" );
+  {
+    sat::PoolSnapshot snapshot;
+    BOOST_CHECK( sat::PoolSnapshot::active() );
+    {
+      sat::PoolSnapshot nested;
+      BOOST_CHECK( sat::PoolSnapshot::active() );
+    }
+    BOOST_CHECK( sat::PoolSnapshot::active() );
+
+    // read only: no new strings or relations
+    BOOST_CHECK_EQUAL( IdString( "zypper" ), known );
+    BOOST_CHECK_EQUAL( IdString( "no such string in the pool" ), IdString::Null );
+    BOOST_CHECK_EQUAL( Capability( "zypper > 99.99-no.such.edition" ), Capability::Null );
+    BOOST_CHECK_THROW( test.satpool().reposInsert( "newrepo" ), Exception );
+    BOOST_CHECK( ! test.satpool().reposFind( "newrepo" ) );
+  }
+  BOOST_CHECK( ! sat::PoolSnapshot::active() );
+  BOOST_CHECK( IdString( "no such string in the pool" ) != IdString::Null );
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_queries)
+{
+  std::vector<sat::Solvable> solvables;
+  for ( const sat::Solvable & solv : test.satpool().solvables() )
+    solvables.push_back( solv );
+  BOOST_REQUIRE( ! solvables.empty() );
+
+  // each task queries a chunk; each chunk is queried by many tasks
+  static const unsigned chunkSize = 64;
+  static const unsigned rounds    = 8;
+  unsigned chunks = ( solvables.size() + chunkSize - 1 ) / chunkSize;
+
+  sat::PoolSnapshot snapshot;
+
+  std::vector<std::string> expected( chunks );
+  for ( unsigned c = 0; c < chunks; ++c )
+    expected[c] = query( solvables, c * chunkSize, ( c + 1 ) * chunkSize );
+
+  std::vector<std::string> results( chunks * rounds );
+  std::vector<std::function<void()>> tasks;
+  for ( unsigned r = 0; r < rounds; ++r )
+  {
+    for ( unsigned c = 0; c < chunks; ++c )
+    {
+      unsigned idx = r * chunks + ( r % 2 ? chunks - 1 - c : c );	// vary the order
+      unsigned chunk = idx % chunks;
+      tasks.push_back( [&solvables, &results, idx, chunk]() {
+        results[idx] = query( solvables, chunk * chunkSize, ( chunk + 1 ) * chunkSize );
+      } );
+    }
+  }
+  thread::runTasks( tasks, std::max( 8U, thread::defaultThreadCount() ) );
+
+  unsigned mismatches = 0;
+  for ( unsigned i = 0; i < results.size(); ++i )
+  {
+    if ( results[i] != expected[i % chunks] )
+      ++mismatches;
+  }
+  BOOST_CHECK_EQUAL( mismatches, 0 );
+}
@@ -1,3 +1,4 @@
+#include <cstdlib>
 #include "TestSetup.h"
 #include <zypp/Repository.h>
 #include <zypp/sat/Pool.h>
@@ -84,6 +85,46 @@ BOOST_AUTO_TEST_CASE(repolist)
   //test.loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1" );
 }
 
+BOOST_AUTO_TEST_CASE(solvfile_mmap)
+{
+  BOOST_CHECK( ! sat::openSolvFile( "/no/such/solv" ) );
+
+  // Some solv file cached by the repolist test
+  Pathname solvCachePath( RepoManagerOptions::makeTestSetup( test.root() ).repoSolvCachePath );
+  std::list<std::string> dirs;
+  filesystem::readdir( dirs, solvCachePath, false );
+  Pathname solvfile;
+  for ( const std::string & dir : dirs )
+  {
+    if ( PathInfo( solvCachePath / dir / "solv" ).isFile() )
+    {
+      solvfile = solvCachePath / dir / "solv";
+      break;
+    }
+  }
+  BOOST_REQUIRE( ! solvfile.empty() );
+
+  // mapped and read via stdio load the same (timing in benchmarks/Pool_bench)
+  sat::Pool satpool( test.satpool() );
+  auto load = [&]()->std::pair<sat::Pool::size_type,IdString>
+  {
+    Repository repo( satpool.reposInsert( "solvfile_mmap" ) );
+    repo.addSolv( solvfile );
+    std::pair<sat::Pool::size_type,IdString> ret( repo.solvablesSize(), repo.solvablesBegin()->ident() );
+    repo.eraseFromPool();
+    return ret;
+  };
+
+  std::pair<sat::Pool::size_type,IdString> mapped( load() );
+  ::setenv( "ZYPP_SOLV_NO_MMAP", "1", 1 );
+  std::pair<sat::Pool::size_type,IdString> stdio( load() );
+  ::unsetenv( "ZYPP_SOLV_NO_MMAP" );
+
+  BOOST_CHECK( mapped.first );
+  BOOST_CHECK_EQUAL( mapped.first, stdio.first );
+  BOOST_CHECK_EQUAL( mapped.second, stdio.second );
+}
+
 #if 0
 BOOST_AUTO_TEST_CASE(LookupAttr_)
 {
@@ -1,6 +1,8 @@
 #include <iostream>
+#include <fstream>
 #include <list>
 #include <string>
+#include <fcntl.h>
 
 // Boost.Test
 #include <boost/test/auto_unit_test.hpp>
@@ -9,6 +11,9 @@
 #include "zypp/base/Exception.h"
 #include "zypp/ZYppFactory.h"
 #include "zypp/Digest.h"
+#include "zypp/CheckSumSink.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
 #include "zypp/ZYpp.h"
 
 
@@ -51,3 +56,46 @@ BOOST_AUTO_TEST_CASE(checksum_test)
   chksumtest( CheckSum::sha384Type(),	"38b060a751ac96384cd9327eb1b1e36a21fdb71114be07434c0cc7bf63f6e1da274edebfe76f65fbd51ad2f14898b95b" );
   chksumtest( CheckSum::sha512Type(),	"cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce47d0d13c5d85f2b0ff8318d2877eec2f63b931bd47417a81a538327af927da3e" );
 }
+
+BOOST_AUTO_TEST_CASE(checksumsink_test)
+{
+  std::string data;
+  for ( unsigned i = 0; i < 100000; ++i )
+    data += str::numstring( i );
+
+  CheckSumSink sink( { "sha1", "SHA256", "sha256", "sha512", "nosuchtype" } );
+  BOOST_CHECK_EQUAL( sink.types().size(), 3 );	// no dups, no unknown types
+  sink.update( data.c_str(), 1000 );
+  sink.update( data.c_str()+1000, data.size()-1000 );
+  BOOST_CHECK_EQUAL( sink.size(), data.size() );
+
+  std::vector<CheckSum> sums( sink.checksums() );
+  BOOST_REQUIRE_EQUAL( sums.size(), 3 );
+  BOOST_CHECK_EQUAL( sums[0], CheckSum( "sha1",   Digest::digest( "sha1", data ) ) );
+  BOOST_CHECK_EQUAL( sums[1], CheckSum( "sha256", Digest::digest( "sha256", data ) ) );
+  BOOST_CHECK_EQUAL( sums[2], CheckSum( "sha512", Digest::digest( "sha512", data ) ) );
+  BOOST_CHECK_EQUAL( sink.size(), 0 );
+
+  // remember for the file, catching up from the file
+  filesystem::TmpFile tmp;
+  std::ofstream( tmp.path().c_str() ) << data;
+  sink.update( data.c_str(), 4711 );
+  int fd = ::open( tmp.path().c_str(), O_RDONLY );
+  BOOST_CHECK( sink.update( fd ) );
+  ::close( fd );
+  BOOST_CHECK( sink.commit( tmp.path() ) );
+
+  BOOST_CHECK_EQUAL( CheckSumSink::lookup( tmp.path(), "sha256" ), sums[1] );
+  BOOST_CHECK( CheckSumSink::lookup( tmp.path(), "md5" ).empty() );
+  BOOST_CHECK_EQUAL( filesystem::checksum( tmp.path(), "sha512" ), sums[2].checksum() );
+  BOOST_CHECK_EQUAL( filesystem::md5sum( tmp.path() ), Digest::digest( "md5", data ) );
+
+  // modifying the file invalidates it
+  std::ofstream( tmp.path().c_str(), std::ios_base::app ) << "x";
+  BOOST_CHECK( CheckSumSink::lookup( tmp.path(), "sha256" ).empty() );
+  BOOST_CHECK_EQUAL( filesystem::checksum( tmp.path(), "sha256" ), Digest::digest( "sha256", data+"x" ) );
+
+  // size mismatch is not remembered
+  sink.update( data.c_str(), 10 );
+  BOOST_CHECK( ! sink.commit( tmp.path() ) );
+}
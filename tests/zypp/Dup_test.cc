@@ -1,3 +1,4 @@
+#include <fstream>
 #include "TestSetup.h"
 #include "zypp/ResPool.h"
 #include "zypp/ResPoolProxy.h"
@@ -61,3 +62,33 @@ BOOST_AUTO_TEST_CASE(orphaned)
   BOOST_CHECK_EQUAL( proxy.lookup( ResKind::package, "dropped_required" )->status(),	ui::S_KeepInstalled );
   BOOST_CHECK_EQUAL( proxy.lookup( ResKind::package, "dropped" )->status(),		ui::S_AutoDel );
 }
+
+BOOST_AUTO_TEST_CASE(solv_testcase)
+{
+  filesystem::TmpDir tmp;
+  BOOST_REQUIRE( getZYpp()->resolver()->createSolvTestcase( tmp.path().asString() ) );
+
+  std::ifstream in( (tmp.path()/"testcase.t").c_str() );
+  unsigned repos = 0;
+  bool system = false;
+  bool dupjob = false;
+  for( iostr::EachLine line( in ); line; line.next() )
+  {
+    std::vector<std::string> words;
+    str::split( *line, std::back_inserter(words) );
+    if ( words.size() == 5 && words[0] == "repo" )
+    {
+      BOOST_CHECK_EQUAL( words[3], "solv" );
+      BOOST_CHECK( PathInfo( tmp.path()/words[4] ).size() > 0 );
+      ++repos;
+    }
+    else if ( words.size() >= 3 && words[0] == "system" )
+      system = true;
+    else if ( words.size() >= 2 && words[0] == "job" && words[1] == "distupgrade" )
+      dupjob = true;
+  }
+  BOOST_CHECK_EQUAL( repos, test.pool().knownRepositoriesSize() );
+  BOOST_CHECK( system );
+  BOOST_CHECK( dupjob );
+  BOOST_CHECK( PathInfo( tmp.path()/"solver.result" ).isFile() );
+}
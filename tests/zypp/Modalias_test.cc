@@ -0,0 +1,78 @@
+#include <iostream>
+#include <cstdlib>
+#include <fnmatch.h>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/String.h"
+#include "zypp/target/modalias/Modalias.h"
+
+using namespace std;
+using namespace zypp;
+using target::Modalias;
+
+namespace
+{
+  bool bruteForce( const Modalias::ModaliasList & list_r, const std::string & pattern_r )
+  {
+    for ( const std::string & alias : list_r )
+    {
+      if ( ::fnmatch( pattern_r.c_str(), alias.c_str(), 0 ) == 0 )
+        return true;
+    }
+    return false;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(modalias_query)
+{
+  Modalias::ModaliasList list = {
+    "pci:v00008086d0000265Asv00008086sd00004556bc0Csc03i00",
+    "pci:v00008086d00002668sv00001028sd000001ADbc04sc03i00",
+    "pci:v000010ECd00008168sv00001028sd000001ADbc02sc00i00",
+    "pci:v000010ECd00008168sv00001028sd000001ADbc02sc00i00",	// duplicate
+    "usb:v046DpC52Bd1201dc00dsc00dp00ic03isc01ip01in00",
+    "usb:v1D6Bp0002d0316dc09dsc00dp00ic09isc00ip00in00",
+    "acpi:PNP0A08:PNP0A03:",
+    "dmi:bvnDellInc.:bvrA05:bd03/24/2011:svnDellInc.:pnLatitudeE6410:",
+  };
+  ::setenv( "ZYPP_MODALIAS_SYSFS", TESTS_SRC_DIR "/no/such/dir", 1 );	// don't scan /sys
+  Modalias & modalias( Modalias::instance() );
+  modalias.modaliasList( list );
+  BOOST_CHECK_EQUAL( modalias.modaliasList().size(), list.size() );
+
+  std::vector<std::string> patterns = {
+    "pci:v00008086d0000265Asv*sd*bc*sc*i*",
+    "pci:v00008086d0000265Bsv*sd*bc*sc*i*",
+    "pci:v000010ECd0000816[89]sv*sd*bc*sc*i*",
+    "pci:v000010ECd0000816[0-7]sv*sd*bc*sc*i*",
+    "pci:v*d*sv*sd*bc02sc00i*",
+    "pci:*",
+    "usb:v046DpC52B*",
+    "usb:v046DpC52?d*",
+    "usb:v1D6B*dc09*",
+    "usb:v1D6B*dc08*",
+    "*PNP0A03*",
+    "acpi:PNP0A08:*",
+    "dmi:*svnDellInc.:pnLatitudeE6410:*",
+    "dmi:*svnLenovo:*",
+    "pcmcia:*",
+    "p?i:v00008086*",
+    "",
+  };
+  for ( const std::string & pattern : patterns )
+  {
+    BOOST_CHECK_MESSAGE( modalias.query( pattern ) == bruteForce( list, pattern ), pattern );
+    // memoized and hexencoded as in rpm dependencies
+    IdString encoded( str::hexencode( pattern ) );
+    BOOST_CHECK_MESSAGE( modalias.queryEncoded( encoded ) == bruteForce( list, pattern ), pattern );
+    BOOST_CHECK_MESSAGE( modalias.queryEncoded( encoded ) == bruteForce( list, pattern ), pattern );
+  }
+
+  // new list invalidates the memoized results
+  IdString encoded( str::hexencode( "acpi:PNP0A08:*" ) );
+  BOOST_CHECK( modalias.queryEncoded( encoded ) );
+  modalias.modaliasList( Modalias::ModaliasList( { "usb:v046DpC52Bd1201dc00dsc00dp00ic03isc01ip01in00" } ) );
+  BOOST_CHECK( ! modalias.queryEncoded( encoded ) );
+  BOOST_CHECK( modalias.query( "usb:v046D*" ) );
+}
@@ -3,6 +3,8 @@
 #include <fstream>
 #include <list>
 #include <string>
+#include <fcntl.h>
+#include <sys/stat.h>
 
 #include <boost/test/auto_unit_test.hpp>
 
@@ -210,3 +212,81 @@ BOOST_AUTO_TEST_CASE(test_exchange)
   BOOST_CHECK( PathInfo(a).isFile() );
   BOOST_CHECK( PathInfo(b).isDir() );
 }
+
+BOOST_AUTO_TEST_CASE(test_copy)
+{
+  TmpDir tmp;
+  Pathname src( tmp.path() / "src" );
+  assert_dir( src / "sub" / "deep" );
+  {
+    ofstream( (src / "file").c_str() ) << "file content";
+    ofstream( (src / "sub" / "file").c_str() ) << "sub file content";
+  }
+  ::chmod( (src / "file").c_str(), 0640 );
+  struct ::timespec times[2] = { { 1000000000, 0 }, { 1000000000, 0 } };
+  ::utimensat( AT_FDCWD, (src / "file").c_str(), times, 0 );
+  symlink( "sub/file", src / "link" );
+  ::chmod( (src / "sub" / "deep").c_str(), 0555 );
+
+  // copy
+  BOOST_CHECK_EQUAL( copy( src / "file", tmp.path() / "copy" ), 0 );
+  BOOST_CHECK_EQUAL( checksum( tmp.path() / "copy", "sha1" ), checksum( src / "file", "sha1" ) );
+  BOOST_CHECK_EQUAL( PathInfo( tmp.path() / "copy" ).perm(), 0640 );
+  BOOST_CHECK_EQUAL( PathInfo( tmp.path() / "copy" ).mtime(), 1000000000 );
+  BOOST_CHECK_EQUAL( copy( src / "sub" / "file", tmp.path() / "copy" ), 0 );	// replaces dest
+  BOOST_CHECK_EQUAL( checksum( tmp.path() / "copy", "sha1" ), checksum( src / "sub" / "file", "sha1" ) );
+  BOOST_CHECK_EQUAL( copy( src / "sub", tmp.path() / "copy" ), EINVAL );
+
+  // copy_file2dir
+  BOOST_CHECK_EQUAL( copy_file2dir( src / "file", src / "sub" ), 0 );
+  BOOST_CHECK_EQUAL( checksum( src / "sub" / "file", "sha1" ), checksum( src / "file", "sha1" ) );
+
+  // copy_dir
+  assert_dir( tmp.path() / "dest" );
+  BOOST_CHECK_EQUAL( copy_dir( src, tmp.path() / "dest" ), 0 );
+  Pathname dest( tmp.path() / "dest" / "src" );
+  BOOST_CHECK_EQUAL( checksum( dest / "file", "sha1" ), checksum( src / "file", "sha1" ) );
+  BOOST_CHECK_EQUAL( PathInfo( dest / "file" ).mtime(), 1000000000 );
+  BOOST_CHECK( PathInfo( dest / "link", PathInfo::LSTAT ).isLink() );
+  BOOST_CHECK_EQUAL( readlink( dest / "link" ), Pathname( "sub/file" ) );
+  BOOST_CHECK_EQUAL( PathInfo( dest / "sub" / "deep" ).perm(), 0555 );
+  BOOST_CHECK_EQUAL( copy_dir( src, tmp.path() / "dest" ), EEXIST );
+  BOOST_CHECK_EQUAL( copy_dir( src, src ), EINVAL );		// not into the own subtree
+  BOOST_CHECK_EQUAL( copy_dir( src, src / "sub" ), EINVAL );
+  BOOST_CHECK( ! PathInfo( src / "src" ).isExist() );
+
+  // copy_dir_content
+  assert_dir( tmp.path() / "content" );
+  BOOST_CHECK_EQUAL( copy_dir_content( src, tmp.path() / "content" ), 0 );
+  BOOST_CHECK_EQUAL( checksum( tmp.path() / "content" / "sub" / "file", "sha1" ), checksum( src / "sub" / "file", "sha1" ) );
+  BOOST_CHECK_EQUAL( copy_dir_content( src, tmp.path() / "content" ), 0 );	// merges into existing
+  BOOST_CHECK_EQUAL( copy_dir_content( src, src / "sub" ), EINVAL );
+
+  ::chmod( (src / "sub" / "deep").c_str(), 0755 );
+  ::chmod( (dest / "sub" / "deep").c_str(), 0755 );
+  ::chmod( (tmp.path() / "content" / "sub" / "deep").c_str(), 0755 );
+}
+
+BOOST_AUTO_TEST_CASE(test_copy_dir_many)
+{
+  // enough files to be copied in parallel
+  TmpDir tmp;
+  Pathname src( tmp.path() / "rpms" );
+  assert_dir( src );
+
+  static const unsigned files = 200;
+  for ( unsigned i = 0; i < files; ++i )
+    ofstream( (src / str::numstring( i ) + ".rpm").c_str() ) << i << std::string( i, 'x' );
+
+  assert_dir( tmp.path() / "dest" );
+  BOOST_CHECK_EQUAL( copy_dir( src, tmp.path() / "dest" ), 0 );
+
+  std::list<std::string> copied;
+  readdir( copied, tmp.path() / "dest" / "rpms", false );
+  BOOST_CHECK_EQUAL( copied.size(), files );
+  for ( unsigned i : { 0U, 42U, files-1 } )
+  {
+    Pathname file( str::numstring( i ) + ".rpm" );
+    BOOST_CHECK_EQUAL( checksum( tmp.path() / "dest" / "rpms" / file, "sha1" ), checksum( src / file, "sha1" ) );
+  }
+}
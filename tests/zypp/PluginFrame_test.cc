@@ -2,7 +2,9 @@
 #include <signal.h>
 
 #include <iostream>
+#include <fstream>
 #include <sstream>
+#include <chrono>
 
 #include "TestSetup.h"
 #include "zypp/PluginExecutor.h"
@@ -169,6 +171,34 @@ BOOST_AUTO_TEST_CASE(PluginScriptReceive)
   BOOST_CHECK_THROW(  scr.receive(), PluginScriptDiedUnexpectedly );
 }
 
+BOOST_AUTO_TEST_CASE(PluginScriptSendReceive)
+{
+  PluginFrame f( "a" );
+  std::vector<PluginScript> scripts;
+  for ( unsigned i = 0; i < 3; ++i )
+  {
+    scripts.push_back( PluginScript( "/bin/cat" ) );
+    scripts.back().open();
+  }
+  scripts.push_back( PluginScript( "/bin/sleep", { "10" } ) );	// never replies
+  scripts.back().open();
+
+  std::vector<PluginScript::Reply> replies( PluginScript::sendReceive( scripts, f ) );
+  BOOST_REQUIRE_EQUAL( replies.size(), 4 );
+  for ( unsigned i = 0; i < 3; ++i )
+  {
+    BOOST_CHECK( ! replies[i].error );
+    BOOST_CHECK_EQUAL( replies[i].frame, f );	// cat echoes the frame
+  }
+  BOOST_CHECK_THROW( std::rethrow_exception( replies[3].error ), PluginScriptReceiveTimeout );
+
+  ::kill( scripts[3].getPid(), SIGKILL );
+  scripts.pop_back();
+  replies = PluginScript::sendReceive( scripts, f );
+  for ( const PluginScript::Reply & reply : replies )
+    BOOST_CHECK_EQUAL( reply.frame, f );
+}
+
 BOOST_AUTO_TEST_CASE(PluginExecutorTest)
 {
   PluginExecutor exec;
@@ -190,3 +220,63 @@ BOOST_AUTO_TEST_CASE(PluginExecutorTest)
   exec.send( PluginFrame( "ERROR" ) );
   BOOST_CHECK_EQUAL( exec.size(), 0 );	// deleted failing scripts
 }
+
+BOOST_AUTO_TEST_CASE(PluginExecutorConcurrent)
+{
+  PluginExecutor exec;
+  exec.setConcurrent( true );
+  BOOST_CHECK_EQUAL( exec.concurrent(), true );
+
+  exec.load( "/bin/cat" );
+  exec.load( "/bin/cat" );
+  exec.load( "/bin/cat" );
+  BOOST_CHECK_EQUAL( exec.size(), 3 );
+
+  exec.send( PluginFrame( "ACK" ) );
+  BOOST_CHECK_EQUAL( exec.size(), 3 );
+
+  exec.send( PluginFrame( "ERROR" ) );
+  BOOST_CHECK_EQUAL( exec.size(), 0 );	// deleted failing scripts
+}
+
+BOOST_AUTO_TEST_CASE(PluginExecutorConcurrentOverlap)
+{
+  // plugins logging the received commands, each taking a second to reply
+  static const unsigned plugins = 4;
+  filesystem::TmpDir tmp;
+  for ( unsigned i = 0; i < plugins; ++i )
+  {
+    Pathname script( tmp.path() / str::numstring( i ) );
+    std::ofstream( script.c_str() )
+      << "#!/bin/bash\n"
+      << "while IFS= read -r -d '' frame; do\n"
+      << "  echo \"${frame%%$'\\n'*}\" >>" << script << ".log\n"
+      << "  sleep 1\n"
+      << "  printf 'ACK\\n\\n\\0'\n"
+      << "done\n";
+    filesystem::chmod( script, 0755 );
+  }
+
+  PluginExecutor exec;
+  exec.setConcurrent( true );
+  exec.load( tmp.path() );
+  BOOST_REQUIRE_EQUAL( exec.size(), plugins );
+
+  std::chrono::steady_clock::time_point start( std::chrono::steady_clock::now() );
+  exec.send( PluginFrame( "COMMITBEGIN" ) );
+  std::chrono::steady_clock::duration took( std::chrono::steady_clock::now() - start );
+  BOOST_CHECK_EQUAL( exec.size(), plugins );
+  BOOST_CHECK( took < std::chrono::milliseconds( 1000 * plugins / 2 ) );	// sequential: plugins seconds
+
+  // each plugin got each frame exactly once
+  for ( unsigned i = 0; i < plugins; ++i )
+  {
+    std::ifstream log( ( tmp.path() / ( str::numstring( i ) + ".log" ) ).c_str() );
+    std::vector<std::string> commands;
+    for ( iostr::EachLine line( log ); line; line.next() )
+      commands.push_back( *line );
+    BOOST_REQUIRE_EQUAL( commands.size(), 2 );
+    BOOST_CHECK_EQUAL( commands[0], "PLUGINBEGIN" );
+    BOOST_CHECK_EQUAL( commands[1], "COMMITBEGIN" );
+  }
+}
@@ -56,6 +56,54 @@ void dumpQ( std::ostream & str, const PoolQuery & q, bool verbose = true )
 }
 
 
+/////////////////////////////////////////////////////////////////////////////
+// many strings are matched by a multi-pattern StrMatcher instead of a regex
+/////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE(pool_query_multipattern)
+{
+  std::vector<std::string> strings { "zypper", "libzypp", "yast2-packager", "kernel.default", "vim",
+                                     "glibc", "gcc", "perl", "nosuchpackage" };
+  std::vector<std::string> globs { "gcc4?", "python*", "*-devel", "lib*.so.?" };
+  for ( Match::Mode mode : { Match::STRING, Match::SUBSTRING, Match::GLOB } )
+  {
+    PoolQuery q;
+    // the union of the single string queries ('.' is any char in the joined regex)
+    std::set<sat::Solvable> expected;
+    for ( const std::string & str : strings )
+    {
+      q.addAttribute( sat::SolvAttr::name, str );
+      std::string glob( str );
+      std::replace( glob.begin(), glob.end(), '.', '?' );
+      PoolQuery single;
+      single.addAttribute( sat::SolvAttr::name, mode == Match::SUBSTRING ? "*" + glob + "*" : glob );
+      single.setMatchGlob();
+      expected.insert( single.begin(), single.end() );
+    }
+    switch ( mode )
+    {
+      case Match::STRING:	q.setMatchExact();	break;
+      case Match::SUBSTRING:	q.setMatchSubstring();	break;
+      default:
+        q.setMatchGlob();
+        for ( const std::string & glob : globs )
+        {
+          q.addAttribute( sat::SolvAttr::name, glob );
+          std::string rglob( glob );
+          std::replace( rglob.begin(), rglob.end(), '.', '?' );
+          PoolQuery single;
+          single.addAttribute( sat::SolvAttr::name, rglob );
+          single.setMatchGlob();
+          expected.insert( single.begin(), single.end() );
+        }
+        break;
+    }
+    BOOST_CHECK( ! expected.empty() );
+    BOOST_CHECK_EQUAL( q.size(), expected.size() );
+    BOOST_CHECK( std::set<sat::Solvable>( q.begin(), q.end() ) == expected );
+  }
+}
+
 #if 0
 BOOST_AUTO_TEST_CASE(pool_query_experiment)
 {
@@ -1,6 +1,8 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <algorithm>
 #include <list>
 #include <string>
 
@@ -13,6 +15,7 @@
 #include "zypp/ServiceInfo.h"
 
 #include "zypp/RepoManager.h"
+#include "zypp/repo/PrefetchHelper.h"
 
 #include "TestSetup.h"
 
@@ -106,6 +109,60 @@ BOOST_AUTO_TEST_CASE(pluginservices_test)
   }
 }
 
+namespace
+{
+  /** Refresh the plugin services in \a pluginsPath_r, return the resulting repos. */
+  std::string refreshPluginServices( const Pathname & pluginsPath_r, const char * jobs_r )
+  {
+    ::setenv( "ZYPP_SERVICE_REFRESH_JOBS", jobs_r, 1 );
+    TmpDir tmpCachePath;
+    RepoManagerOptions opts( RepoManagerOptions::makeTestSetup( tmpCachePath ) ) ;
+    opts.rootDir = "";	// not chrooted (see pluginservices_test)
+    opts.pluginsPath = pluginsPath_r;
+
+    RepoManager manager(opts);
+    manager.refreshServices();
+    ::unsetenv( "ZYPP_SERVICE_REFRESH_JOBS" );
+
+    std::ostringstream str;
+    for ( const RepoInfo & repo : manager.repos() )
+      str << repo.alias() << " " << repo.service() << " " << repo.name() << " " << repo.enabled() << " " << repo.url() << endl;
+    return str.str();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(pluginservices_parallel)
+{
+  // services are fetched concurrently, but applied in order
+  TmpDir plugins;
+  Pathname servicesdir( plugins.path() / "services" );
+  filesystem::mkdir( servicesdir );
+  static const unsigned services = 6;
+  for ( unsigned i = 0; i < services; ++i )
+  {
+    Pathname script( servicesdir / str::form( "service%u", i ) );
+    std::ofstream out( script.c_str() );
+    out << "#!/bin/bash" << endl;
+    if ( i == 3 )
+      out << "echo 'failing service' >&2; exit 1" << endl;
+    else
+      out << "sleep 0.$((" << services << "-" << i << "))" << endl	// finish in reverse order
+          << "echo '[repo]'" << endl
+          << "echo 'name=Repository " << i << "'" << endl
+          << "echo 'baseurl=http://somehost.com/repo" << i << "'" << endl
+          << "echo 'enabled=" << i % 2 << "'" << endl;
+    out.close();
+    filesystem::chmod( script, 0755 );
+  }
+
+  BOOST_WARN_MESSAGE( ! repo::prefetchHelper().empty(), "No zypp-prefetch helper: services are fetched serially" );
+  std::string serial( refreshPluginServices( plugins.path(), "1" ) );
+  std::string parallel( refreshPluginServices( plugins.path(), "4" ) );
+  BOOST_CHECK_EQUAL( parallel, serial );
+  BOOST_CHECK_EQUAL( std::count( serial.begin(), serial.end(), '\n' ), services - 1 );
+  BOOST_CHECK( serial.find( "service3:" ) == std::string::npos );
+}
+
 // regression test for services bug
 // if you modify a service that you just
 // added and saved, the service was not associated with its
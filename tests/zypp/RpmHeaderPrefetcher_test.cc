@@ -0,0 +1,156 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/String.h"
+#include "zypp/target/RpmHeaderPrefetcher.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+
+using boost::unit_test::test_case;
+using namespace std;
+using namespace zypp;
+using namespace zypp::filesystem;
+using zypp::target::RpmHeaderPrefetcher;
+
+namespace
+{
+  void be32( std::string & str_r, unsigned val_r )
+  {
+    str_r += char( val_r >> 24 );
+    str_r += char( val_r >> 16 );
+    str_r += char( val_r >> 8 );
+    str_r += char( val_r );
+  }
+
+  void rpmHeader( std::string & str_r, unsigned il_r, unsigned dl_r, char fill_r )
+  {
+    be32( str_r, 0x8eade801 );
+    be32( str_r, 0 );
+    be32( str_r, il_r );
+    be32( str_r, dl_r );
+    str_r += std::string( 16 * il_r + dl_r, fill_r );
+  }
+
+  /** Write a fake rpm file (lead, signature, header and payload) of about \a n_r KiB. */
+  void writeRpm( const Pathname & file_r, unsigned n_r )
+  {
+    std::string data;
+    be32( data, 0xedabeedb );
+    data += std::string( 92, 'L' );
+    rpmHeader( data, 1, 13, 'S' );
+    data += std::string( 3, '\0' );			// pad signature to 8
+    rpmHeader( data, 2, 1024 * n_r, char( 'a' + n_r % 26 ) );
+    data += std::string( 4096, 'P' );			// payload
+    std::ofstream( file_r.c_str() ) << data;
+  }
+
+  /** Set up \a n_r fake rpms (and a broken one) and return them. */
+  std::vector<Pathname> setupRpms( const Pathname & dir_r, unsigned n_r )
+  {
+    std::vector<Pathname> ret;
+    for ( unsigned i = 0; i < n_r; ++i )
+    {
+      Pathname file( dir_r / str::form( "pkg-%u.rpm", i ) );
+      if ( i == n_r / 2 )
+        std::ofstream( file.c_str() ) << "not an rpm";
+      else
+        writeRpm( file, i % 7 );
+      ret.push_back( file );
+    }
+    return ret;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(read_blob)
+{
+  TmpDir dir;
+  writeRpm( dir / "pkg.rpm", 3 );
+  RpmHeaderPrefetcher::Blob blob( RpmHeaderPrefetcher::readBlob( dir / "pkg.rpm" ) );
+  BOOST_REQUIRE( blob );
+  BOOST_CHECK_EQUAL( blob->size(), PathInfo( dir / "pkg.rpm" ).size() - 4096 );	// w/o payload
+  BOOST_CHECK_EQUAL( blob->find( 'P' ), std::string::npos );
+
+  BOOST_CHECK( ! RpmHeaderPrefetcher::readBlob( dir / "missing.rpm" ) );
+  std::ofstream( (dir / "short.rpm").c_str() ) << std::string( 200, '\0' );
+  BOOST_CHECK( ! RpmHeaderPrefetcher::readBlob( dir / "short.rpm" ) );
+}
+
+BOOST_AUTO_TEST_CASE(prefetch_like_serial)
+{
+  TmpDir dir;
+  std::vector<Pathname> files( setupRpms( dir, 50 ) );
+
+  RpmHeaderPrefetcher prefetcher( 8 );
+  for ( unsigned i = 0; i < files.size(); ++i )
+    prefetcher.add( i, files[i] );
+  BOOST_CHECK_EQUAL( prefetcher.prefetched(), 0 );	// nothing read before it's needed
+
+  for ( unsigned i = 0; i < files.size(); ++i )
+  {
+    RpmHeaderPrefetcher::Blob serial( RpmHeaderPrefetcher::readBlob( files[i] ) );
+    RpmHeaderPrefetcher::Blob blob( prefetcher.take( i ) );
+    BOOST_CHECK( prefetcher.prefetched() <= prefetcher.windowSize() );
+    BOOST_REQUIRE_EQUAL( bool(blob), bool(serial) );
+    if ( serial )
+      BOOST_CHECK( *blob == *serial );
+    BOOST_CHECK( ! prefetcher.take( i ) );	// dropped after use
+  }
+  BOOST_CHECK_EQUAL( prefetcher.prefetched(), 0 );
+  BOOST_CHECK( ! prefetcher.take( 1000 ) );
+}
+
+BOOST_AUTO_TEST_CASE(prefetch_skip_ahead)
+{
+  TmpDir dir;
+  std::vector<Pathname> files( setupRpms( dir, 30 ) );
+
+  RpmHeaderPrefetcher prefetcher( 4 );
+  for ( unsigned i = 0; i < files.size(); ++i )
+    prefetcher.add( i, files[i] );
+
+  BOOST_CHECK( prefetcher.take( 0 ) );
+  RpmHeaderPrefetcher::Blob blob( prefetcher.take( 20 ) );	// window restarts at 20
+  BOOST_REQUIRE( blob );
+  BOOST_CHECK( *blob == *RpmHeaderPrefetcher::readBlob( files[20] ) );
+  BOOST_CHECK( prefetcher.prefetched() <= prefetcher.windowSize() );
+  BOOST_CHECK( ! prefetcher.take( 2 ) );	// skipped
+  BOOST_CHECK( prefetcher.take( 21 ) );
+}
+
+BOOST_AUTO_TEST_CASE(prefetch_cached)
+{
+  TmpDir dir;
+  std::vector<Pathname> files( setupRpms( dir, 10 ) );
+  const std::string key( "sha256:RpmHeaderPrefetcher_test-" );
+
+  {
+    RpmHeaderPrefetcher prefetcher;
+    for ( unsigned i = 0; i < files.size(); ++i )
+      prefetcher.add( i, files[i], key+str::numstring(i) );
+    for ( unsigned i = 0; i < files.size(); ++i )
+      prefetcher.take( i );
+  }
+
+  // a retry finds the blobs in the cache, even if the files are gone
+  std::vector<RpmHeaderPrefetcher::Blob> serial;
+  for ( const Pathname & file : files )
+  {
+    serial.push_back( RpmHeaderPrefetcher::readBlob( file ) );
+    unlink( file );
+  }
+
+  RpmHeaderPrefetcher prefetcher;
+  for ( unsigned i = 0; i < files.size(); ++i )
+    prefetcher.add( i, files[i], key+str::numstring(i) );
+  for ( unsigned i = 0; i < files.size(); ++i )
+  {
+    RpmHeaderPrefetcher::Blob blob( prefetcher.take( i ) );
+    BOOST_REQUIRE_EQUAL( bool(blob), bool(serial[i]) );
+    if ( serial[i] )
+      BOOST_CHECK( *blob == *serial[i] );
+  }
+}
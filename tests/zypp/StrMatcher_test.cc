@@ -149,6 +149,60 @@ BOOST_AUTO_TEST_CASE(StrMatcher_REGEX)
   BOOST_CHECK( m( "qwaaq" ) );
 }
 
+BOOST_AUTO_TEST_CASE(StrMatcher_multipattern)
+{
+  std::vector<std::string> strings { "fau", "lt", "de" };
+  StrMatcher m( strings, Match::SUBSTRING );
+  BOOST_CHECK( m.isMultiPattern() );
+  BOOST_CHECK( m );	// eval in boolean context
+  BOOST_CHECK_EQUAL( m.searchstring(), "fau\nlt\nde" );
+  BOOST_CHECK( !m( "" ) );
+  BOOST_CHECK( !m( "a" ) );
+  BOOST_CHECK( m( "default" ) );
+  BOOST_CHECK( m( "salt" ) );
+  BOOST_CHECK( !m( "FAULT" ) );
+  BOOST_CHECK( m != StrMatcher( m.searchstring(), Match::SUBSTRING ) );
+
+  m.setFlags( Match::SUBSTRING | Match::NOCASE );
+  BOOST_CHECK( m( "FAULT" ) );
+
+  m.setFlags( Match::STRING );
+  BOOST_CHECK( m( "lt" ) );
+  BOOST_CHECK( !m( "salt" ) );
+
+  m.setFlags( Match::STRINGSTART );
+  BOOST_CHECK( m( "ltd" ) );
+  BOOST_CHECK( m( "delta" ) );
+  BOOST_CHECK( !m( "salt" ) );
+
+  m.setFlags( Match::STRINGEND );
+  BOOST_CHECK( m( "salt" ) );
+  BOOST_CHECK( m( "code" ) );
+  BOOST_CHECK( !m( "delta" ) );
+
+  m.setFlags( Match::REGEX );
+  BOOST_CHECK_THROW( m.compile(), MatchUnknownModeException );
+
+  // globs: plain, anchored and those needing fnmatch
+  strings = { "zypp", "lib*", "*-devel", "*yast*", "p?th*3.[0-9]*", "??" };
+  m = StrMatcher( strings, Match::GLOB );
+  BOOST_CHECK( m( "zypp" ) );
+  BOOST_CHECK( !m( "zypper" ) );
+  BOOST_CHECK( m( "libzypp" ) );
+  BOOST_CHECK( m( "libzypp-devel" ) );
+  BOOST_CHECK( m( "autoyast2" ) );
+  BOOST_CHECK( m( "python3.6" ) );
+  BOOST_CHECK( !m( "python3.x" ) );
+  BOOST_CHECK( m( "vi" ) );
+  BOOST_CHECK( !m( "vim" ) );
+
+  // a new searchstring ends the multi-pattern mode
+  m.setSearchstring( "vim" );
+  BOOST_CHECK( !m.isMultiPattern() );
+  BOOST_CHECK( m( "vim" ) );
+  BOOST_CHECK( !m( "zypp" ) );
+}
+
 #if 0
 BOOST_AUTO_TEST_CASE(StrMatcher_)
 {
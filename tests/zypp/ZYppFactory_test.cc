@@ -0,0 +1,127 @@
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cerrno>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/LogControl.h"
+#include "zypp/ZYppFactory.h"
+#include "zypp/TmpPath.h"
+
+using namespace std;
+using namespace zypp;
+
+namespace
+{
+  enum Result { GotLock = 0, Locked = 1, Failed = 2 };
+
+  /** A child process trying to get the ZYpp lock.
+   * It reports the \ref Result and holds the lock until \ref release.
+   */
+  struct LockingChild
+  {
+    LockingChild( bool readOnly_r )
+    {
+      int report[2];
+      int release[2];
+      BOOST_REQUIRE( ::pipe( report ) == 0 && ::pipe( release ) == 0 );
+
+      _pid = ::fork();
+      BOOST_REQUIRE( _pid >= 0 );
+      if ( _pid == 0 )
+      {
+        ::close( report[0] );
+        ::close( release[1] );
+        char result = Failed;
+        try
+        {
+          ZYpp::Ptr zypp( readOnly_r ? ZYppFactory::instance().getZYppReadOnly() : ZYppFactory::instance().getZYpp() );
+          result = GotLock;
+          if ( ::write( report[1], &result, 1 ) != 1 )
+            ::_exit( Failed );
+          ssize_t got;
+          while ( ( got = ::read( release[0], &result, 1 ) ) == -1 && errno == EINTR )
+            ;	// wait for release (EOF)
+          zypp.reset();
+          ::_exit( got == 0 ? GotLock : Failed );
+        }
+        catch ( const ZYppFactoryException & )
+        { result = Locked; }
+        catch ( ... )
+        {}
+        if ( ::write( report[1], &result, 1 ) != 1 )
+          ::_exit( Failed );
+        ::_exit( result );
+      }
+
+      ::close( report[1] );
+      ::close( release[0] );
+      char result = Failed;
+      BOOST_REQUIRE( ::read( report[0], &result, 1 ) == 1 );
+      ::close( report[0] );
+      _result = Result( result );
+      _release = release[1];
+    }
+
+    ~LockingChild()
+    { release(); }
+
+    /** Let the child release the lock and wait for it to exit. */
+    void release()
+    {
+      if ( _pid <= 0 )
+        return;
+      ::close( _release );
+      while ( ::waitpid( _pid, nullptr, 0 ) == -1 && errno == EINTR )
+        ;
+      _pid = -1;
+    }
+
+    pid_t  _pid;
+    int    _release;
+    Result _result;
+  };
+}
+
+BOOST_AUTO_TEST_CASE(shared_lock)
+{
+  if ( geteuid() != 0 )
+  {
+    BOOST_WARN( "ZYpp lock test requires root permissions!" );
+    return;
+  }
+  base::LogControl::instance().logNothing();	// no concurrent logging into the same file
+  filesystem::TmpDir root;
+  ::setenv( "ZYPP_LOCKFILE_ROOT", root.path().c_str(), 1 );
+  ::unsetenv( "ZYPP_LOCK_TIMEOUT" );
+
+  static const unsigned readers = 16;
+  {
+    // many readers at once...
+    std::vector<std::unique_ptr<LockingChild>> children;
+    for ( unsigned i = 0; i < readers; ++i )
+    {
+      children.emplace_back( new LockingChild( /*readOnly*/true ) );
+      BOOST_CHECK_EQUAL( children.back()->_result, GotLock );
+    }
+    // ...but no writer
+    BOOST_CHECK_EQUAL( LockingChild( /*readOnly*/false )._result, Locked );
+  }
+  {
+    // a writer excludes readers and other writers
+    LockingChild writer( /*readOnly*/false );
+    BOOST_CHECK_EQUAL( writer._result, GotLock );
+    BOOST_CHECK_EQUAL( LockingChild( /*readOnly*/true )._result, Locked );
+    BOOST_CHECK_EQUAL( LockingChild( /*readOnly*/false )._result, Locked );
+  }
+  // all released
+  BOOST_CHECK_EQUAL( LockingChild( /*readOnly*/true )._result, GotLock );
+  BOOST_CHECK_EQUAL( LockingChild( /*readOnly*/false )._result, GotLock );
+
+  ::unsetenv( "ZYPP_LOCKFILE_ROOT" );
+}
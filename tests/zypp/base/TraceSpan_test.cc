@@ -0,0 +1,78 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Measure.h"
+#include "zypp/base/IOStream.h"
+#include "zypp/TmpPath.h"
+
+using namespace zypp;
+using debug::TraceSpan;
+
+namespace
+{
+  std::vector<std::string> readLines( const Pathname & file_r )
+  {
+    std::vector<std::string> ret;
+    std::ifstream str( file_r.c_str() );
+    for ( iostr::EachLine line( str ); line; line.next() )
+      ret.push_back( *line );
+    return ret;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(tracespan_disabled)
+{
+  TraceSpan::traceTo( "" );
+  BOOST_CHECK( ! TraceSpan::enabled() );
+  TraceSpan span( "test", "disabled" );
+  span.tag( "key", "value" );	// no-op
+}
+
+BOOST_AUTO_TEST_CASE(tracespan_chrome_trace)
+{
+  filesystem::TmpFile file;
+  ::unlink( file.path().c_str() );	// created on demand
+  TraceSpan::traceTo( file.path().asString() );
+  BOOST_CHECK( TraceSpan::enabled() );
+  {
+    TraceSpan outer( "test", "outer" );
+    outer.tag( "count", 42 ).tag( "file", Pathname( "/tmp/x \"y\"" ) );
+    {
+      TraceSpan inner( "test", std::string( "inner" ) );
+    }
+  }
+  {
+    debug::Measure m( "measured" );
+  }
+  TraceSpan::traceTo( "" );
+
+  std::vector<std::string> lines( readLines( file.path() ) );
+  BOOST_REQUIRE_EQUAL( lines.size(), 4 );
+  BOOST_CHECK_EQUAL( lines[0], "[" );
+  // inner completes first
+  BOOST_CHECK( lines[1].find( "\"name\":\"inner\",\"cat\":\"test\",\"ph\":\"X\"" ) != std::string::npos );
+  BOOST_CHECK( lines[1].find( "\"args\"" ) == std::string::npos );
+  BOOST_CHECK( lines[2].find( "\"name\":\"outer\"" ) != std::string::npos );
+  BOOST_CHECK( lines[2].find( "\"args\":{\"count\":\"42\",\"file\":\"/tmp/x \\\"y\\\"\"}" ) != std::string::npos );
+  BOOST_CHECK( lines[3].find( "\"name\":\"measured\",\"cat\":\"measure\"" ) != std::string::npos );
+  for ( unsigned i = 1; i < lines.size(); ++i )
+  {
+    BOOST_CHECK( lines[i].find( "\"pid\":" ) != std::string::npos );
+    BOOST_CHECK( lines[i].find( "\"tid\":" ) != std::string::npos );
+    BOOST_CHECK( lines[i].find( "\"ts\":" ) != std::string::npos );
+    BOOST_CHECK( lines[i].find( "\"dur\":" ) != std::string::npos );
+    BOOST_CHECK_EQUAL( lines[i].substr( lines[i].size() - 2 ), "}," );
+  }
+
+  // appending to an existing trace does not repeat the '['
+  TraceSpan::traceTo( file.path().asString() );
+  {
+    TraceSpan again( "test", "again" );
+  }
+  TraceSpan::traceTo( "" );
+  lines = readLines( file.path() );
+  BOOST_REQUIRE_EQUAL( lines.size(), 5 );
+  BOOST_CHECK( lines[4].find( "\"name\":\"again\"" ) != std::string::npos );
+}
@@ -0,0 +1,269 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	tools/zypp-prefetch/zypp-prefetch.cc
+ *
+ * Helper started by libzypp to fetch data ahead in a separate process
+ * (see \ref zypp::repo::prefetchHelper). Not meant to be called manually.
+ *
+ * \code
+ *   zypp-prefetch service ROOT REPOMANAGERROOT SERVICEFILE RESULT
+ * \endcode
+ * Fetch the repo list of the (single) service in SERVICEFILE like
+ * \ref zypp::repo::ServiceRepos does. RESULT gets a line "# ttl N"
+ * followed by the repos as .repo file.
+ *
+ * \code
+ *   zypp-prefetch packages JOBDIR RECORD
+ * \endcode
+ * Download the packages listed in \c JOBDIR/packages from the repos in
+ * \c JOBDIR/repos.repo (see \ref zypp::target::CommitPackagePrefetcher).
+ * Each package is downloaded into the staging dir \c .prefetch.PID below
+ * its repos packages path. After the download passed the checksum check,
+ * a line "ID STAGEDFILE" is appended to RECORD. Signatures are checked
+ * by the caller. The job file lines are:
+ * \code
+ *   repomanagerroot PATH
+ *   packagespath ALIAS PATH
+ *   package ID ALIAS MEDIANR DOWNLOADSIZE CHECKSUMTYPE CHECKSUM FILENAME
+ * \endcode
+ * (CHECKSUMTYPE and CHECKSUM are \c - if there is no checksum). SIGTERM
+ * stops the download. The helper also stops and removes its staging dirs
+ * if the caller is gone.
+ *
+ * The helper is not interactive and does not log. It exits with 0 on
+ * success; on error the caller does the job itself.
+*/
+extern "C"
+{
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <signal.h>
+#include <unistd.h>
+}
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "zypp/base/LogControl.h"
+#include "zypp/base/IOStream.h"
+#include "zypp/base/String.h"
+#include "zypp/parser/RepoFileReader.h"
+#include "zypp/parser/ServiceFileReader.h"
+#include "zypp/repo/RepoProvideFile.h"
+#include "zypp/repo/ServiceRepos.h"
+#include "zypp/ZYppCallbacks.h"
+#include "zypp/ZConfig.h"
+#include "zypp/OnMediaLocation.h"
+#include "zypp/PathInfo.h"
+#include "zypp/RepoInfo.h"
+#include "zypp/ServiceInfo.h"
+
+using std::endl;
+using namespace zypp;
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  int usage( const char * appname_r )
+  {
+    std::cerr << "Usage: " << appname_r << " service ROOT REPOMANAGERROOT SERVICEFILE RESULT" << endl;
+    std::cerr << "       " << appname_r << " packages JOBDIR RECORD" << endl;
+    return 2;
+  }
+
+  /** Don't ask the user (e.g. for credentials); the caller does the job again on error. */
+  void nonInteractive()
+  {
+    callback::DistributeReport<media::MediaChangeReport>::instance().noReceiver();
+    callback::DistributeReport<media::DownloadProgressReport>::instance().noReceiver();
+    callback::DistributeReport<media::AuthenticationReport>::instance().noReceiver();
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  // service
+  ///////////////////////////////////////////////////////////////////
+
+  int prefetchService( const Pathname & root_r, const Pathname & serviceFile_r, const Pathname & result_r )
+  {
+    std::vector<ServiceInfo> services;
+    parser::ServiceFileReader( serviceFile_r, [&]( const ServiceInfo & service_r ) {
+      services.push_back( service_r );
+      return true;
+    } );
+    if ( services.size() != 1 )
+      return 1;
+    const ServiceInfo & service( services.front() );
+
+    RepoInfoList repos;
+    repo::ServiceRepos( root_r, service, [&]( const RepoInfo & repo_r ) {
+      repos.push_back( repo_r );
+      return true;
+    } );
+
+    std::ofstream out( result_r.c_str() );
+    out << "# ttl " << service.ttl() << endl;	// as probed by ServiceRepos
+    for ( const RepoInfo & repo : repos )
+      repo.dumpAsIniOn( out ) << endl;
+    out.close();
+    return out ? 0 : 1;
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  // packages
+  ///////////////////////////////////////////////////////////////////
+
+  /** Set by SIGTERM (the caller cancels the prefetch). */
+  volatile sig_atomic_t g_cancelled = 0;
+
+  void cancelHandler( int )
+  { g_cancelled = 1; }
+
+  /** The caller; we get reparented if it is gone. */
+  pid_t g_parent = 0;
+
+  bool parentGone()
+  { return ::getppid() != g_parent; }
+
+  bool stopped()
+  { return g_cancelled || parentGone(); }
+
+  /** Aborts a running download once the prefetch is stopped. */
+  struct CancelDownloadReceiver : public callback::ReceiveReport<media::DownloadProgressReport>
+  {
+    virtual bool progress( int /*value*/, const Url & /*file*/, double /*dbps_avg*/, double /*dbps_current*/ )
+    { return ! stopped(); }
+  };
+
+  /** A package to download. */
+  struct PackageJob
+  {
+    std::string     id;		///< the callers id, echoed in the record
+    std::string     alias;	///< of the repo
+    OnMediaLocation location;
+  };
+
+  int prefetchPackages( const Pathname & jobDir_r, const Pathname & record_r )
+  {
+    struct sigaction sa;
+    ::memset( &sa, 0, sizeof(sa) );
+    sa.sa_handler = cancelHandler;
+    ::sigemptyset( &sa.sa_mask );
+    ::sigaction( SIGTERM, &sa, nullptr );
+    ::setpriority( PRIO_PROCESS, 0, 19 );
+
+    CancelDownloadReceiver cancelReceiver;
+    cancelReceiver.connect();
+
+    std::map<std::string,RepoInfo> repos;
+    parser::RepoFileReader( jobDir_r / "repos.repo", [&]( const RepoInfo & repo_r ) {
+      repos[repo_r.alias()] = repo_r;
+      return true;
+    } );
+
+    std::vector<PackageJob> packages;
+    {
+      std::ifstream job( (jobDir_r / "packages").c_str() );
+      for ( iostr::EachLine line( job ); line; line.next() )
+      {
+	std::string rest( *line );
+	std::string tag( str::stripFirstWord( rest ) );
+	if ( tag == "repomanagerroot" )
+	{
+	  ZConfig::instance().setRepoManagerRoot( rest );
+	}
+	else if ( tag == "packagespath" )
+	{
+	  std::string alias( str::stripFirstWord( rest ) );
+	  auto it( repos.find( alias ) );
+	  if ( it != repos.end() )
+	    it->second.setPackagesPath( rest );
+	}
+	else if ( tag == "package" )
+	{
+	  PackageJob package;
+	  package.id = str::stripFirstWord( rest );
+	  package.alias = str::stripFirstWord( rest );
+	  unsigned medianr = str::strtonum<unsigned>( str::stripFirstWord( rest ) );
+	  ByteCount downloadSize( str::strtonum<ByteCount::SizeType>( str::stripFirstWord( rest ) ) );
+	  std::string checksumType( str::stripFirstWord( rest ) );
+	  std::string checksum( str::stripFirstWord( rest ) );
+	  package.location = OnMediaLocation( rest, medianr );
+	  package.location.setDownloadSize( downloadSize );
+	  if ( checksumType != "-" )
+	    package.location.setChecksum( CheckSum( checksumType, checksum ) );
+	  packages.push_back( package );
+	}
+      }
+    }
+
+    std::ofstream record( record_r.c_str(), std::ios_base::app );
+    std::set<Pathname> stagingDirs;
+    {
+      repo::RepoMediaAccess access;	// released before exit, so attach points are removed
+      for ( const PackageJob & package : packages )
+      {
+	if ( stopped() )
+	  break;
+
+	auto it( repos.find( package.alias ) );
+	if ( it == repos.end() || it->second.packagesPath().empty() )
+	  continue;
+
+	RepoInfo staging( it->second );
+	staging.setPackagesPath( staging.packagesPath() / str::form( ".prefetch.%d", int(::getpid()) ) );
+	stagingDirs.insert( staging.packagesPath() );
+	if ( filesystem::assert_dir( staging.packagesPath() ) != 0 || ! PathInfo( staging.packagesPath() ).userMayW() )
+	  continue;	// (provideFile would fall back to the ZYpp tmp space)
+
+	try
+	{
+	  ManagedFile file( access.provideFile( staging, package.location ) );	// checksum checked
+	  file.resetDispose();
+	  record << package.id << " " << file.value() << endl;
+	}
+	catch ( const Exception & )
+	{}	// the caller downloads it again
+      }
+    }
+
+    if ( parentGone() )
+    {
+      for ( const Pathname & dir : stagingDirs )
+	filesystem::recursive_rmdir( dir );
+    }
+    return 0;
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+int main( int argc, char * argv[] )
+{
+  g_parent = ::getppid();
+  base::LogControl::instance().logNothing();	// don't mix into the callers log
+  nonInteractive();
+
+  try
+  {
+    if ( argc == 6 && argv[1] == std::string( "service" ) )
+    {
+      ZConfig::instance().setRepoManagerRoot( argv[3] );
+      return prefetchService( argv[2], argv[4], argv[5] );
+    }
+    if ( argc == 4 && argv[1] == std::string( "packages" ) )
+    {
+      return prefetchPackages( argv[2], argv[3] );
+    }
+  }
+  catch ( ... )
+  { return 1; }
+  return usage( argv[0] );
+}
@@ -19,6 +19,7 @@
 #include "zypp/base/Hash.h"
 #include "zypp/Arch.h"
 #include "zypp/Bit.h"
+#include "zypp/sat/detail/PoolImpl.h"
 
 using std::endl;
 
@@ -254,13 +255,19 @@ namespace zypp
       }
 
       /** Return the entry related to \a archStr_r.
-       * Creates an entry for nonbuiltin archs.
+       * Creates an entry for nonbuiltin archs (serialized while the pool is frozen).
       */
       const Arch::CompatEntry & assertDef( const std::string & archStr_r )
-      { return *_compatSet.insert( Arch::CompatEntry( archStr_r ) ).first; }
+      {
+        auto lock( sat::detail::PoolMember::myPool().frozenLock() );
+        return *_compatSet.insert( Arch::CompatEntry( archStr_r ) ).first;
+      }
       /** \overload */
       const Arch::CompatEntry & assertDef( IdString archStr_r )
-      { return *_compatSet.insert( Arch::CompatEntry( archStr_r ) ).first; }
+      {
+        auto lock( sat::detail::PoolMember::myPool().frozenLock() );
+        return *_compatSet.insert( Arch::CompatEntry( archStr_r ) ).first;
+      }
 
       const_iterator begin() const
       { return _compatSet.begin(); }
@@ -144,24 +144,30 @@ namespace zypp
       // First build the name, non-packages prefixed by kind
       sat::Solvable::SplitIdent split( kind_r, name_r );
       sat::detail::IdType nid( split.ident().id() );
+      // A frozen pool is read concurrently, so new strings and relations are
+      // not created. An unknown edition became noedition, which must not turn
+      // the relation into a plain (broader) name.
+      const bool create = ! sat::detail::PoolMember::myPool().frozen();
+      if ( ! create && ( ! nid || ( op_r != Rel::ANY && ed_r == Edition::noedition ) ) )
+        return STRID_NULL;
 
       if ( split.kind() == ResKind::srcpackage )
       {
         // map 'kind srcpackage' to 'arch src', the pseudo architecture
         // libsolv uses.
-        nid = ::pool_rel2id( pool_r, nid, IdString(ARCH_SRC).id(), REL_ARCH, /*create*/true );
+        nid = ::pool_rel2id( pool_r, nid, IdString(ARCH_SRC).id(), REL_ARCH, create );
       }
 
       // Extend name by architecture, if provided and not a srcpackage
       if ( ! arch_r.empty() && kind_r != ResKind::srcpackage )
       {
-        nid = ::pool_rel2id( pool_r, nid, arch_r.id(), REL_ARCH, /*create*/true );
+        nid = ::pool_rel2id( pool_r, nid, arch_r.id(), REL_ARCH, create );
       }
 
       // Extend 'op edition', if provided
       if ( op_r != Rel::ANY && ed_r != Edition::noedition )
       {
-        nid = ::pool_rel2id( pool_r, nid, ed_r.id(), op_r.bits(), /*create*/true );
+        nid = ::pool_rel2id( pool_r, nid, ed_r.id(), op_r.bits(), create );
       }
 
       return nid;
@@ -304,12 +310,23 @@ namespace zypp
   ///////////////////////////////////////////////////////////////////
 
   Capability::Capability( ResolverNamespace namespace_r, IdString value_r )
-  : _id( ::pool_rel2id( myPool().getPool(), asIdString(namespace_r).id(), (value_r.empty() ? STRID_NULL : value_r.id() ), REL_NAMESPACE, /*create*/true ) )
+  : _id( ::pool_rel2id( myPool().getPool(), asIdString(namespace_r).id(), (value_r.empty() ? STRID_NULL : value_r.id() ), REL_NAMESPACE, /*create*/! myPool().frozen() ) )
   {}
 
 
   const char * Capability::c_str() const
-  { return( _id ? ::pool_dep2str( myPool().getPool(), _id ) : "" ); }
+  {
+    if ( ! _id )
+      return "";
+    if ( ! myPool().frozen() )
+      return ::pool_dep2str( myPool().getPool(), _id );
+
+    // pool_dep2str uses the pools temporary string space.
+    static thread_local std::string ret;
+    auto lock( myPool().frozenLock() );
+    ret = ::pool_dep2str( myPool().getPool(), _id );
+    return ret.c_str();
+  }
 
   CapMatch Capability::_doMatch( sat::detail::IdType lhs,  sat::detail::IdType rhs )
   {
@@ -0,0 +1,255 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/CheckSumSink.cc
+ *
+*/
+extern "C"
+{
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+}
+#include <cerrno>
+#include <algorithm>
+#include <iostream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+
+#include "zypp/CheckSumSink.h"
+#include "zypp/Digest.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+
+  ///////////////////////////////////////////////////////////////////
+  namespace
+  {
+    /** Read buffer size for local hashing. */
+    const size_t bufferSize = 256 * 1024;
+
+    /** Page aligned read buffer (avoids the stacks 4k buffer of \ref Digest::digest). */
+    struct AlignedBuffer : private base::NonCopyable
+    {
+      AlignedBuffer( size_t size_r )
+      : data( nullptr ), size( size_r )
+      {
+	void * p = nullptr;
+	if ( ::posix_memalign( &p, 4096, size_r ) == 0 )
+	  data = static_cast<char *>( p );
+      }
+      ~AlignedBuffer()
+      { ::free( data ); }
+
+      char * data;
+      size_t size;
+    };
+
+    ///////////////////////////////////////////////////////////////////
+    /// \brief Remembered checksums of files.
+    ///
+    /// A files identity is its device, inode, size and mtime (ns). So a
+    /// hardlink to the file finds the entry, and any modification
+    /// invalidates it. The cache is small, it's meant for files which are
+    /// checked right after they were downloaded.
+    ///////////////////////////////////////////////////////////////////
+    struct FileCache
+    {
+      typedef std::tuple<dev_t, ino_t, off_t, time_t, long> FileId;
+      typedef std::map<std::string,std::string>             Sums;	// type -> checksum
+
+      static const size_t maxEntries = 64;
+
+      static bool fileId( const Pathname & file_r, FileId & id_r )
+      {
+	struct stat st;
+	if ( ::stat( file_r.c_str(), &st ) != 0 || ! S_ISREG( st.st_mode ) )
+	  return false;
+	id_r = FileId( st.st_dev, st.st_ino, st.st_size, st.st_mtim.tv_sec, st.st_mtim.tv_nsec );
+	return true;
+      }
+
+      void remember( const FileId & id_r, Sums sums_r )
+      {
+	std::lock_guard<std::mutex> lock( _mutex );
+	auto it( _sums.find( id_r ) );
+	if ( it == _sums.end() )
+	{
+	  if ( _sums.size() >= maxEntries )
+	  {
+	    _sums.erase( _order.front() );
+	    _order.pop_front();
+	  }
+	  _order.push_back( id_r );
+	  _sums[id_r].swap( sums_r );
+	}
+	else
+	  it->second.swap( sums_r );
+      }
+
+      std::string lookup( const FileId & id_r, const std::string & type_r )
+      {
+	std::lock_guard<std::mutex> lock( _mutex );
+	auto it( _sums.find( id_r ) );
+	if ( it == _sums.end() )
+	  return std::string();
+	auto sum( it->second.find( type_r ) );
+	return sum == it->second.end() ? std::string() : sum->second;
+      }
+
+      void clear()
+      {
+	std::lock_guard<std::mutex> lock( _mutex );
+	_sums.clear();
+	_order.clear();
+      }
+
+      static FileCache & instance()
+      {
+	static FileCache _instance;
+	return _instance;
+      }
+
+    private:
+      std::mutex           _mutex;
+      std::map<FileId,Sums> _sums;
+      std::list<FileId>    _order;
+    };
+  } // namespace
+  ///////////////////////////////////////////////////////////////////
+
+  CheckSumSink::CheckSumSink()
+  : _size( 0 )
+  {}
+
+  CheckSumSink::CheckSumSink( const std::vector<std::string> & types_r )
+  : _size( 0 )
+  {
+    for ( const std::string & type : types_r )
+    {
+      std::string ltype( str::toLower( type ) );
+      if ( ltype.empty() || std::find( _types.begin(), _types.end(), ltype ) != _types.end() )
+	continue;
+
+      shared_ptr<Digest> digest( new Digest );
+      if ( ! digest->create( ltype ) )
+      {
+	WAR << "Unknown checksum type '" << type << "' ignored." << endl;
+	continue;
+      }
+      _types.push_back( ltype );
+      _digests.push_back( digest );
+    }
+  }
+
+  CheckSumSink::~CheckSumSink()
+  {}
+
+  bool CheckSumSink::empty() const
+  { return _types.empty(); }
+
+  std::vector<std::string> CheckSumSink::types() const
+  { return _types; }
+
+  void CheckSumSink::update( const char * bytes_r, size_t len_r )
+  {
+    if ( ! len_r )
+      return;
+    for ( const shared_ptr<Digest> & digest : _digests )
+      digest->update( bytes_r, len_r );
+    _size += len_r;
+  }
+
+  bool CheckSumSink::update( int fd_r )
+  {
+    AlignedBuffer buf( bufferSize );
+    if ( ! buf.data )
+      return false;
+
+    ::posix_fadvise( fd_r, _size, 0, POSIX_FADV_SEQUENTIAL );
+    while ( true )
+    {
+      ssize_t cnt = ::pread( fd_r, buf.data, buf.size, _size );
+      if ( cnt == 0 )
+	return true;
+      if ( cnt < 0 )
+      {
+	if ( errno == EINTR )
+	  continue;
+	return false;
+      }
+      update( buf.data, cnt );
+    }
+  }
+
+  void CheckSumSink::reset()
+  {
+    for ( const shared_ptr<Digest> & digest : _digests )
+      digest->reset();
+    _size = 0;
+  }
+
+  std::vector<CheckSum> CheckSumSink::checksums()
+  {
+    std::vector<CheckSum> ret;
+    ret.reserve( _types.size() );
+    for ( unsigned i = 0; i < _types.size(); ++i )
+      ret.push_back( CheckSum( _types[i], _digests[i]->digest() ) );
+    reset();
+    return ret;
+  }
+
+  bool CheckSumSink::commit( const Pathname & file_r )
+  {
+    FileCache::FileId id;
+    if ( empty() || ! FileCache::fileId( file_r, id ) || std::get<2>( id ) != _size )
+    {
+      if ( ! empty() )
+	DBG << "Not remembering checksums of " << file_r << " (" << _size << " bytes hashed)" << endl;
+      reset();
+      return false;
+    }
+
+    FileCache::Sums sums;
+    for ( const CheckSum & sum : checksums() )
+      sums[sum.type()] = sum.checksum();
+    FileCache::instance().remember( id, std::move(sums) );
+    return true;
+  }
+
+  CheckSum CheckSumSink::lookup( const Pathname & file_r, const std::string & type_r )
+  {
+    FileCache::FileId id;
+    if ( ! FileCache::fileId( file_r, id ) )
+      return CheckSum();
+
+    std::string ltype( str::toLower( type_r ) );
+    std::string sum( FileCache::instance().lookup( id, ltype ) );
+    return sum.empty() ? CheckSum() : CheckSum( ltype, sum );
+  }
+
+  void CheckSumSink::clearCache()
+  { FileCache::instance().clear(); }
+
+  std::ostream & operator<<( std::ostream & str, const CheckSumSink & obj )
+  {
+    return str << "CheckSumSink(" << obj.types() << ", " << obj.size() << ")";
+  }
+
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,124 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/CheckSumSink.h
+ *
+*/
+#ifndef ZYPP_CHECKSUMSINK_H
+#define ZYPP_CHECKSUMSINK_H
+
+#include <sys/types.h>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/base/PtrTypes.h"
+#include "zypp/Pathname.h"
+#include "zypp/CheckSum.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+
+  class Digest;
+
+  ///////////////////////////////////////////////////////////////////
+  /// \class CheckSumSink
+  /// \brief Compute several checksums of a data stream in a single pass.
+  ///
+  /// Data are fed in sequentially, either as they stream in (e.g. from
+  /// a download's write callback) or read from a file descriptor,
+  /// starting at \ref size.
+  ///
+  /// Once the data are written to a file, \ref commit remembers the
+  /// checksums for this file. \ref filesystem::checksum (and so the
+  /// \ref ChecksumFileChecker) will return them, as long as the file (or
+  /// a hardlink to it) is not modified, instead of reading the file again.
+  ///
+  /// \code
+  ///   CheckSumSink sink( { "sha256" } );
+  ///   while ( ... )
+  ///   {
+  ///     ::write( fd, buf, len );
+  ///     sink.update( buf, len );
+  ///   }
+  ///   sink.commit( file );
+  /// \endcode
+  ///////////////////////////////////////////////////////////////////
+  class CheckSumSink : private base::NonCopyable
+  {
+  public:
+    /** Default ctor: no checksums to compute. */
+    CheckSumSink();
+
+    /** Ctor computing the checksums of the given \a types_r (e.g. \c sha256).
+     * Unknown types and duplicates are ignored.
+     */
+    explicit CheckSumSink( const std::vector<std::string> & types_r );
+
+    ~CheckSumSink();
+
+  public:
+    /** Whether no checksums are computed. */
+    bool empty() const;
+
+    /** The checksum types computed. */
+    std::vector<std::string> types() const;
+
+    /** Number of bytes consumed so far. */
+    off_t size() const
+    { return _size; }
+
+    /** Feed the next \a len_r bytes. */
+    void update( const char * bytes_r, size_t len_r );
+
+    /** Feed the content of \a fd_r from offset \ref size up to EOF.
+     * The file offset of \a fd_r is not changed.
+     * \return Whether EOF was reached without read error.
+     */
+    bool update( int fd_r );
+
+    /** Start from scratch. */
+    void reset();
+
+    /** Finalize and return the checksums (in order of \ref types).
+     * The sink is \ref reset afterwards.
+     */
+    std::vector<CheckSum> checksums();
+
+    /** Finalize and remember the checksums for \a file_r.
+     * Nothing is remembered unless the files size matches \ref size.
+     * The sink is \ref reset afterwards.
+     * \return Whether the checksums were remembered.
+     */
+    bool commit( const Pathname & file_r );
+
+  public:
+    /** Return a checksum of \a type_r remembered for \a file_r by \ref commit.
+     * An empty \ref CheckSum is returned if no checksum is known or the file
+     * was modified afterwards.
+     */
+    static CheckSum lookup( const Pathname & file_r, const std::string & type_r );
+
+    /** Forget about all remembered checksums. */
+    static void clearCache();
+
+  private:
+    std::vector<std::string>         _types;
+    std::vector<shared_ptr<Digest> > _digests;
+    off_t                            _size;
+  };
+
+  /** \relates CheckSumSink Stream output */
+  std::ostream & operator<<( std::ostream & str, const CheckSumSink & obj );
+
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_CHECKSUMSINK_H
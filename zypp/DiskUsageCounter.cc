@@ -21,6 +21,7 @@ extern "C"
 #include "zypp/base/LogTools.h"
 #include "zypp/base/DtorReset.h"
 #include "zypp/base/String.h"
+#include "zypp/base/SerialNumber.h"
 
 #include "zypp/DiskUsageCounter.h"
 #include "zypp/ExternalProgram.h"
@@ -37,22 +38,24 @@ namespace zypp
   namespace
   { /////////////////////////////////////////////////////////////////
 
-    DiskUsageCounter::MountPointSet calcDiskUsage( DiskUsageCounter::MountPointSet result, const Bitmap & installedmap_r )
+    /** Raw libsolv disk usage changes (KiB and files) per mount point. */
+    struct DuSum
     {
-      if ( result.empty() )
-      {
-        // partitioning is not set
-        return result;
-      }
+      long long kbytes = 0;
+      long long files = 0;
+    };
+    typedef std::vector<DuSum> DuSums;
 
+    DuSums calcDuSums( const DiskUsageCounter::MountPointSet & mps_r, const Bitmap & installedmap_r )
+    {
       sat::Pool satpool( sat::Pool::instance() );
 
       // init libsolv result vector with mountpoints
       static const ::DUChanges _initdu = { 0, 0, 0, 0 };
-      std::vector< ::DUChanges> duchanges( result.size(), _initdu );
+      std::vector< ::DUChanges> duchanges( mps_r.size(), _initdu );
       {
         unsigned idx = 0;
-        for_( it, result.begin(), result.end() )
+        for_( it, mps_r.begin(), mps_r.end() )
         {
           duchanges[idx].path = it->dir.c_str();
 	  if ( it->growonly )
@@ -66,43 +69,161 @@ namespace zypp
                              &duchanges[0],
                              duchanges.size() );
 
-      // and process the result
+      DuSums ret( duchanges.size() );
+      for ( unsigned idx = 0; idx < duchanges.size(); ++idx )
       {
-        unsigned idx = 0;
-        for_( it, result.begin(), result.end() )
-        {
-	  // Limit estimated waste (half block per file) as it does not apply to
-	  // btrfs, which reports up to 64K blocksize (bsc#974275,bsc#965322)
-	  static const ByteCount blockAdjust( 2, ByteCount::K ); // (files * blocksize) / 2 / 1K; result value in K!
-
-          it->pkg_size = it->used_size          // current usage
-                       + duchanges[idx].kbytes  // package data size
-                       + ( duchanges[idx].files * ( it->fstype == "btrfs" ? 4096 : it->block_size ) / blockAdjust ); // half block per file
-          ++idx;
-        }
+	ret[idx].kbytes = duchanges[idx].kbytes;
+	ret[idx].files  = duchanges[idx].files;
       }
+      return ret;
+    }
 
+    DiskUsageCounter::MountPointSet applyDuSums( DiskUsageCounter::MountPointSet result, const DuSums & sums_r )
+    {
+      unsigned idx = 0;
+      for_( it, result.begin(), result.end() )
+      {
+	// Limit estimated waste (half block per file) as it does not apply to
+	// btrfs, which reports up to 64K blocksize (bsc#974275,bsc#965322)
+	static const ByteCount blockAdjust( 2, ByteCount::K ); // (files * blocksize) / 2 / 1K; result value in K!
+
+	it->pkg_size = it->used_size          // current usage
+		     + sums_r[idx].kbytes     // package data size
+		     + ( sums_r[idx].files * ( it->fstype == "btrfs" ? 4096 : it->block_size ) / blockAdjust ); // half block per file
+	++idx;
+      }
       return result;
     }
 
+    DiskUsageCounter::MountPointSet calcDiskUsage( DiskUsageCounter::MountPointSet result, const Bitmap & installedmap_r )
+    {
+      if ( result.empty() )
+      {
+        // partitioning is not set
+        return result;
+      }
+      return applyDuSums( result, calcDuSums( result, installedmap_r ) );
+    }
+
+    /** Whether \a solv_r provides disk usage data. */
+    inline bool hasDuData( sat::Solvable solv_r )
+    { return ::repo_lookup_type( solv_r.get()->repo, solv_r.id(), sat::SolvAttr::diskusage.id() ); }
+
     /////////////////////////////////////////////////////////////////
   } // namespace
   ///////////////////////////////////////////////////////////////////
 
-  DiskUsageCounter::MountPointSet DiskUsageCounter::disk_usage( const ResPool & pool_r ) const
+  ///////////////////////////////////////////////////////////////////
+  /// \class DiskUsageCounter::Cache
+  /// \brief Remembers the last \ref disk_usage(const ResPool&) computation.
+  ///
+  /// libsolv sums up the disk usage data of all solvables to install and
+  /// of all installed solvables to delete. Apart from one exception, the
+  /// contributions are independent of each other. So when only some transact
+  /// states changed, it's sufficient to evaluate the solvables which changed
+  /// and update the remembered sums.
+  ///
+  /// The exception: A solvable to install that has no disk usage data
+  /// is assumed to be as large as the installed package it replaces, so
+  /// this installed package is not accounted. While such a solvable is
+  /// involved, we compute everything from scratch.
+  ///////////////////////////////////////////////////////////////////
+  class DiskUsageCounter::Cache
   {
-    Bitmap bitmap( Bitmap::poolSize );
+  public:
+    MountPointSet diskUsage( const MountPointSet & mps_r, const ResPool & pool_r )
+    {
+      Bitmap installedmap( Bitmap::poolSize );
+      bool full = _watcher.remember( pool_r.serial() ) || _installedmap.size() != installedmap.size();
+
+      // Changed solvables by [installed]:
+      Bitmap added[2] = { Bitmap( Bitmap::poolSize ), Bitmap( Bitmap::poolSize ) };
+      Bitmap removed[2] = { Bitmap( Bitmap::poolSize ), Bitmap( Bitmap::poolSize ) };
+      bool changed = false;
+      bool hadNoDu = _noDuCount;
+      if ( full )
+	_noDuCount = 0;
+
+      // build installedmap (installed != transact)
+      // stays installed or gets installed
+      for_( it, pool_r.begin(), pool_r.end() )
+      {
+	sat::Solvable solv( sat::asSolvable()(*it) );
+	bool inmap = ( it->status().isInstalled() != it->status().transacts() );
+	if ( inmap )
+	  installedmap.set( solv.id() );
+
+	if ( full )
+	{
+	  if ( inmap && ! solv.isSystem() && ! hasDuData( solv ) )
+	    ++_noDuCount;
+	}
+	else if ( inmap != _installedmap.test( solv.id() ) )
+	{
+	  bool installed = solv.isSystem();
+	  ( inmap ? added : removed )[installed].set( solv.id() );
+	  if ( ! installed && ! hasDuData( solv ) )
+	    inmap ? ++_noDuCount : --_noDuCount;
+	  changed = true;
+	}
+      }
 
-    // build installedmap (installed != transact)
-    // stays installed or gets installed
-    for_( it, pool_r.begin(), pool_r.end() )
+      if ( full || hadNoDu || _noDuCount )
+      {
+	DBG << "Full disk usage computation" << endl;
+	_sums = calcDuSums( mps_r, installedmap );
+      }
+      else if ( changed )
+      {
+	// temp. unset @system Repo, so each contributes its own disk usage data
+	DtorReset tmp( sat::Pool::instance().get()->installed );
+	sat::Pool::instance().get()->installed = nullptr;
+
+	for ( unsigned installed = 0; installed < 2; ++installed )
+	{
+	  // growonly partitions don't account deleting installed solvables
+	  if ( ! added[installed].empty() )
+	    addDuSums( mps_r, calcDuSums( mps_r, added[installed] ), 1, installed );
+	  if ( ! removed[installed].empty() )
+	    addDuSums( mps_r, calcDuSums( mps_r, removed[installed] ), -1, installed );
+	}
+      }
+      _installedmap = installedmap;
+      return applyDuSums( mps_r, _sums );
+    }
+
+  private:
+    void addDuSums( const MountPointSet & mps_r, const DuSums & delta_r, int sign_r, bool skipGrowonly_r )
     {
-      if ( it->status().isInstalled() != it->status().transacts() )
+      unsigned idx = 0;
+      for_( it, mps_r.begin(), mps_r.end() )
       {
-        bitmap.set( sat::asSolvable()(*it).id() );
+	if ( ! ( skipGrowonly_r && it->growonly ) )
+	{
+	  _sums[idx].kbytes += sign_r * delta_r[idx].kbytes;
+	  _sums[idx].files  += sign_r * delta_r[idx].files;
+	}
+	++idx;
       }
     }
-    return calcDiskUsage( _mps, bitmap );
+
+  private:
+    SerialNumberWatcher _watcher;
+    Bitmap _installedmap;	///< the last computation
+    DuSums _sums;		///< the last computation
+    unsigned _noDuCount = 0;	///< solvables to install without disk usage data in \ref _installedmap
+  };
+
+  DiskUsageCounter::MountPointSet DiskUsageCounter::disk_usage( const ResPool & pool_r ) const
+  {
+    if ( _mps.empty() )
+    {
+      // partitioning is not set
+      return _mps;
+    }
+    if ( ! _cache )
+      _cache.reset( new Cache );
+    return _cache->diskUsage( _mps, pool_r );
   }
 
   DiskUsageCounter::MountPointSet DiskUsageCounter::disk_usage( sat::Solvable solv_r ) const
@@ -162,7 +162,7 @@ namespace zypp
 
     /** Set a MountPointSet to compute */
     void setMountPoints( const MountPointSet & mps_r )
-    { _mps = mps_r; }
+    { _mps = mps_r; _cache.reset(); }
 
     /** Get the current MountPointSet */
     const MountPointSet & getMountPoints() const
@@ -179,7 +179,12 @@ namespace zypp
     static MountPointSet justRootPartition();
 
 
-    /** Compute disk usage if the current transaction woud be commited. */
+    /** Compute disk usage if the current transaction woud be commited.
+     * Repeated calls are incremental: Only the disk usage data of solvables
+     * whose transact state changed since the last call are evaluated. Setting
+     * new mount points or changing the pools content (adding or removing
+     * repos) triggers a full computation.
+     */
     MountPointSet disk_usage( const ResPool & pool ) const;
 
     /** Compute disk usage of a single Solvable */
@@ -206,6 +211,8 @@ namespace zypp
 
   private:
     MountPointSet _mps;
+    class Cache;
+    mutable shared_ptr<Cache> _cache;	///< incremental \ref disk_usage(const ResPool&)
   };
   ///////////////////////////////////////////////////////////////////
 
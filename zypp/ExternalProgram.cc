@@ -479,20 +479,24 @@ namespace zypp {
 	  } while ( true );
 	}
 
-	// Wait for child to exit
-	int ret;
-	int status = 0;
-	do
+	// Wait for child to exit (unless running() already reaped it;
+	// waitpid(-1) would wait for any other child)
+	if ( pid > 0 )
 	{
-	  ret = waitpid(pid, &status, 0);
-	}
-	while (ret == -1 && errno == EINTR);
+	  int ret;
+	  int status = 0;
+	  do
+	  {
+	    ret = waitpid(pid, &status, 0);
+	  }
+	  while (ret == -1 && errno == EINTR);
 
-	if (ret != -1)
-	{
-	 _exitStatus = checkStatus( status );
+	  if (ret != -1)
+	  {
+	   _exitStatus = checkStatus( status );
+	  }
+	  pid = -1;
 	}
-	pid = -1;
       }
 
       return _exitStatus;
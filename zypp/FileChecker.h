@@ -66,6 +66,9 @@ namespace zypp
 
   /**
    * \short Checks for a valid checksum and interacts with the user.
+   *
+   * Uses \ref filesystem::checksum, so a checksum computed while the
+   * file was downloaded is used instead of reading the file again.
    */
    class ChecksumFileChecker
    {
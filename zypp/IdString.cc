@@ -28,12 +28,13 @@ namespace zypp
 
   /////////////////////////////////////////////////////////////////
 
+  // A frozen pool is read concurrently, so new strings are not created.
   IdString::IdString( const char * str_r )
-  : _id( ::pool_str2id( myPool().getPool(), str_r, /*create*/true ) )
+  : _id( ::pool_str2id( myPool().getPool(), str_r, /*create*/! myPool().frozen() ) )
   {}
 
   IdString::IdString( const char * str_r, unsigned len_r )
-  : _id( ::pool_strn2id( myPool().getPool(), str_r, len_r, /*create*/true ) )
+  : _id( ::pool_strn2id( myPool().getPool(), str_r, len_r, /*create*/! myPool().frozen() ) )
   {}
 
   IdString::IdString( const std::string & str_r )
@@ -17,6 +17,7 @@
 #include "zypp/MediaSetAccess.h"
 #include "zypp/PathInfo.h"
 #include "zypp/TmpPath.h"
+#include "zypp/repo/PackageStore.h"
 //#include "zypp/source/MediaSetAccessReportReceivers.h"
 
 using namespace std;
@@ -157,6 +158,17 @@ IMPL_PTR_TYPE(MediaSetAccess);
 
   Pathname MediaSetAccess::provideFile( const OnMediaLocation & resource, ProvideFileOptions options, const Pathname &deltafile )
   {
+    if ( ! resource.checksum().empty() )
+    {
+      // The shared package store might already have it
+      Pathname stored( repo::PackageStore().lookup( resource.checksum() ) );
+      if ( ! stored.empty() )
+      {
+        MIL << "Provide " << resource.filename() << " from package store: " << stored << endl;
+        return stored;
+      }
+    }
+
     ProvideFileOperation op;
     provide( boost::ref(op), resource, options, deltafile );
     return op.result;
@@ -239,16 +251,23 @@ IMPL_PTR_TYPE(MediaSetAccess);
         if ( ! media_mgr.isAttached(media) )
           media_mgr.attach(media);
 	media_mgr.setDeltafile(media, deltafile);
+	// let the download compute the checksum, so it needs not to be read again
+	if ( ! resource.checksum().empty() )
+	  media_mgr.setChecksumTypes(media, { resource.checksum().type() });
 	deltafileset = true;
         op(media, file);
 	media_mgr.setDeltafile(media, Pathname());
+	media_mgr.setChecksumTypes(media, vector<string>());
         break;
       }
       catch ( media::MediaException & excp )
       {
         ZYPP_CAUGHT(excp);
 	if (deltafileset)
+	{
 	  media_mgr.setDeltafile(media, Pathname());
+	  media_mgr.setChecksumTypes(media, vector<string>());
+	}
         media::MediaChangeReport::Action user = media::MediaChangeReport::ABORT;
         unsigned int devindex = 0;
         vector<string> devices;
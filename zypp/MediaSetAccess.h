@@ -146,6 +146,10 @@ namespace zypp
        *
        * \note OnMediaLocation::optional() hint has no effect on the transfer.
        *
+       * \note If the resource has a checksum and a file with this checksum is
+       * available in the \ref repo::PackageStore, the stored file is returned
+       * without accessing the media. It must not be modified.
+       *
        * \see zypp::media::MediaManager::provideFile()
        */
       Pathname provideFile( const OnMediaLocation & resource, ProvideFileOptions options = PROVIDE_DEFAULT, const Pathname &deltafile = Pathname() );
@@ -13,10 +13,17 @@
 #include <utime.h>     // for ::utime
 #include <sys/statvfs.h>
 #include <sys/sysmacros.h> // for ::minor, ::major macros
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>   // for SYS_copy_file_range
+#include <fcntl.h>
+#include <linux/fs.h>      // for FICLONE
 
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <vector>
+#include <functional>
 
 #include "zypp/base/LogTools.h"
 #include "zypp/base/String.h"
@@ -27,8 +34,9 @@
 #include "zypp/AutoDispose.h"
 #include "zypp/ExternalProgram.h"
 #include "zypp/PathInfo.h"
-#include "zypp/Digest.h"
+#include "zypp/CheckSumSink.h"
 #include "zypp/TmpPath.h"
+#include "zypp/thread/RunTasks.h"
 
 using std::endl;
 using std::string;
@@ -447,6 +455,298 @@ namespace zypp
       return logResult( recursive_rmdir_1( path, false/* don't remove path itself */ ) );
     }
 
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	in-process copy
+    //
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** Permissions we preserve (setuid/setgid would need the owner preserved as well). */
+      inline mode_t copyMode( const struct stat & st_r )
+      { return st_r.st_mode & 01777; }
+
+      /** Copy the remaining data of \a src_r to \a dst_r, using the fastest
+       * method the kernel and filesystems support: clone (FICLONE),
+       * copy_file_range, sendfile and finally read/write.
+       * \a size_r is the files size according to stat; pseudo files (/proc)
+       * claiming to be empty are not supported by the kernel assisted methods.
+       * \return 0 or errno. Does not log (may run in worker threads).
+       */
+      int copyFileData( int src_r, int dst_r, off_t size_r )
+      {
+#ifdef FICLONE
+        if ( ::ioctl( dst_r, FICLONE, src_r ) == 0 )
+          return 0;
+#endif
+        static const size_t chunk = 1024*1024*1024;
+        bool started = false;	// once data were copied a method must not fail
+
+#ifdef SYS_copy_file_range
+        for ( ;; )
+        {
+          ssize_t n = ::syscall( SYS_copy_file_range, src_r, nullptr, dst_r, nullptr, chunk, 0 );
+          if ( n > 0 )
+          { started = true; continue; }
+          if ( n == 0 && ( started || size_r == 0 ) )
+            return 0;
+          if ( n == 0 )
+            break;	// pseudo file
+          if ( errno == EINTR )
+            continue;
+          if ( started || ! ( errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP || errno == EBADF ) )
+            return errno;
+          break;	// not supported here
+        }
+#endif
+        for ( ;; )
+        {
+          ssize_t n = ::sendfile( dst_r, src_r, nullptr, chunk );
+          if ( n > 0 )
+          { started = true; continue; }
+          if ( n == 0 && ( started || size_r == 0 ) )
+            return 0;
+          if ( n == 0 )
+            break;	// pseudo file
+          if ( errno == EINTR )
+            continue;
+          if ( started || ! ( errno == ENOSYS || errno == EINVAL ) )
+            return errno;
+          break;	// not supported here
+        }
+
+        std::vector<char> buf( 256*1024 );
+        for ( ;; )
+        {
+          ssize_t n = ::read( src_r, &buf[0], buf.size() );
+          if ( n == 0 )
+            return 0;
+          if ( n < 0 )
+          {
+            if ( errno == EINTR )
+              continue;
+            return errno;
+          }
+          for ( ssize_t w = 0; w < n; )
+          {
+            ssize_t r = ::write( dst_r, &buf[w], n - w );
+            if ( r < 0 )
+            {
+              if ( errno == EINTR )
+                continue;
+              return errno;
+            }
+            w += r;
+          }
+        }
+      }
+
+      /** Copy the regular file \a src_r to \a dst_r (replacing an existing \a dst_r),
+       * preserving permissions and timestamps.
+       * \return 0 or errno. Does not log (may run in worker threads).
+       */
+      int copyRegularFile( const Pathname & src_r, const Pathname & dst_r )
+      {
+        int src = ::open( src_r.c_str(), O_RDONLY|O_CLOEXEC );
+        if ( src == -1 )
+          return errno;
+
+        struct stat st;
+        if ( ::fstat( src, &st ) == -1 )
+        {
+          int err = errno;
+          ::close( src );
+          return err;
+        }
+
+        if ( ::unlink( dst_r.c_str() ) == -1 && errno != ENOENT )
+        {
+          int err = errno;
+          ::close( src );
+          return err;
+        }
+        int dst = ::open( dst_r.c_str(), O_WRONLY|O_CREAT|O_EXCL|O_CLOEXEC, 0600 );
+        if ( dst == -1 )
+        {
+          int err = errno;
+          ::close( src );
+          return err;
+        }
+
+        int err = copyFileData( src, dst, st.st_size );
+        if ( ! err )
+        {
+          struct timespec times[2] = { st.st_atim, st.st_mtim };
+          if ( ::fchmod( dst, copyMode( st ) ) == -1 || ::futimens( dst, times ) == -1 )
+            err = errno;
+        }
+        ::close( src );
+        if ( ::close( dst ) == -1 && ! err )
+          err = errno;
+        if ( err )
+          ::unlink( dst_r.c_str() );
+        return err;
+      }
+
+      /** Whether the existing directory \a dir_r is \a ancestor_r or below it.
+       * Compares device and inode, so symlinks or \c .. in the paths don't matter.
+       */
+      bool isBelow( const Pathname & dir_r, const Pathname & ancestor_r )
+      {
+        struct stat ancestor;
+        if ( ::stat( ancestor_r.c_str(), &ancestor ) == -1 )
+          return false;
+        std::string path( dir_r.asString() );
+        struct stat st;
+        struct stat prev;
+        prev.st_dev = 0;
+        prev.st_ino = 0;
+        while ( ::stat( path.c_str(), &st ) == 0 )
+        {
+          if ( st.st_dev == ancestor.st_dev && st.st_ino == ancestor.st_ino )
+            return true;
+          if ( st.st_dev == prev.st_dev && st.st_ino == prev.st_ino )
+            break;	// reached "/"
+          prev = st;
+          path += "/..";
+        }
+        return false;
+      }
+
+      /** Copy a directory tree, \c cp \c -a like.
+       * The tree is walked in the calling thread creating directories,
+       * symlinks and special files. Regular files are copied in parallel
+       * afterwards. Finally the directories permissions and timestamps
+       * are set.
+       */
+      class TreeCopier
+      {
+      public:
+        /** Copy the content of \a src_r into the existing directory \a dst_r. */
+        int copyContent( const Pathname & src_r, const Pathname & dst_r )
+        {
+          int res = walk( src_r, dst_r );
+          if ( res == 0 )
+            res = copyFiles();
+          // deepest first, as setting the timestamps of a
+          // directory must follow all changes inside it
+          for ( auto it = _dirs.rbegin(); it != _dirs.rend(); ++it )
+          {
+            struct timespec times[2] = { it->second.st_atim, it->second.st_mtim };
+            if ( ( ::chmod( it->first.c_str(), copyMode( it->second ) ) == -1
+                   || ::utimensat( AT_FDCWD, it->first.c_str(), times, 0 ) == -1 ) && res == 0 )
+              res = errno;
+          }
+          return res;
+        }
+
+        /** Copy the directory \a src_r as \a dst_r (which must not exist). */
+        int copyDir( const Pathname & src_r, const Pathname & dst_r )
+        {
+          struct stat st;
+          if ( ::stat( src_r.c_str(), &st ) == -1 )
+            return errno;
+          if ( ::mkdir( dst_r.c_str(), 0700 ) == -1 )
+            return errno;
+          _dirs.push_back( std::make_pair( dst_r, st ) );
+          return copyContent( src_r, dst_r );
+        }
+
+      private:
+        int walk( const Pathname & src_r, const Pathname & dst_r )
+        {
+          AutoDispose<DIR *> dir( ::opendir( src_r.c_str() ), ::closedir );
+          if ( ! dir )
+          {
+            dir.resetDispose();
+            return errno;
+          }
+          for ( struct dirent * entry = ::readdir( dir ); entry; entry = ::readdir( dir ) )
+          {
+            if ( entry->d_name[0] == '.'
+                 && ( entry->d_name[1] == '\0' || ( entry->d_name[1] == '.' && entry->d_name[2] == '\0' ) ) )
+              continue;
+
+            Pathname src( src_r / entry->d_name );
+            Pathname dst( dst_r / entry->d_name );
+            struct stat st;
+            if ( ::lstat( src.c_str(), &st ) == -1 )
+              return errno;
+
+            int res = 0;
+            if ( S_ISDIR( st.st_mode ) )
+              res = walkDir( src, dst, st );
+            else if ( S_ISREG( st.st_mode ) )
+              _files.push_back( std::make_pair( src, dst ) );
+            else
+              res = copySpecial( src, dst, st );
+            if ( res )
+              return res;
+          }
+          return 0;
+        }
+
+        int walkDir( const Pathname & src_r, const Pathname & dst_r, const struct stat & st_r )
+        {
+          if ( ::mkdir( dst_r.c_str(), 0700 ) == -1 )
+          {
+            struct stat dst;
+            if ( errno != EEXIST || ::lstat( dst_r.c_str(), &dst ) == -1 || ! S_ISDIR( dst.st_mode ) )
+              return EEXIST;
+            if ( ::chmod( dst_r.c_str(), dst.st_mode | 0700 ) == -1 )	// merging into an existing one
+              return errno;
+          }
+          _dirs.push_back( std::make_pair( dst_r, st_r ) );
+          return walk( src_r, dst_r );
+        }
+
+        int copySpecial( const Pathname & src_r, const Pathname & dst_r, const struct stat & st_r )
+        {
+          if ( ::unlink( dst_r.c_str() ) == -1 && errno != ENOENT )
+            return errno;
+          if ( S_ISLNK( st_r.st_mode ) )
+          {
+            Pathname target;
+            int res = readlink( src_r, target );
+            if ( res )
+              return res;
+            if ( ::symlink( target.c_str(), dst_r.c_str() ) == -1 )
+              return errno;
+            struct timespec times[2] = { st_r.st_atim, st_r.st_mtim };
+            ::utimensat( AT_FDCWD, dst_r.c_str(), times, AT_SYMLINK_NOFOLLOW );	// not supported everywhere
+            return 0;
+          }
+          if ( ::mknod( dst_r.c_str(), st_r.st_mode, st_r.st_rdev ) == -1 )
+            return errno;
+          return 0;
+        }
+
+        int copyFiles()
+        {
+          std::vector<int> results( _files.size(), 0 );
+          std::vector<std::function<void()>> tasks;
+          tasks.reserve( _files.size() );
+          for ( size_t i = 0; i < _files.size(); ++i )
+            tasks.push_back( [this,i,&results]() { results[i] = copyRegularFile( _files[i].first, _files[i].second ); } );
+          thread::runTasks( tasks );
+
+          for ( size_t i = 0; i < results.size(); ++i )
+          {
+            if ( results[i] )
+            {
+              WAR << "copy " << _files[i].first << " failed: " << str::strerror( results[i] ) << endl;
+              return results[i];
+            }
+          }
+          return 0;
+        }
+
+      private:
+        std::vector<std::pair<Pathname,Pathname>> _files;	///< regular files to copy
+        std::vector<std::pair<Pathname,struct stat>> _dirs;	///< created dirs and their source attributes
+      };
+    } // namespace
+
     ///////////////////////////////////////////////////////////////////
     //
     //	METHOD NAME : copy_dir
@@ -471,21 +771,11 @@ namespace zypp
         return logResult( EEXIST );
       }
 
-
-      const char *const argv[] = {
-        "/bin/cp",
-        "-dR",
-        "--",
-        srcpath.asString().c_str(),
-        destpath.asString().c_str(),
-        NULL
-      };
-      ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
+      if ( isBelow( destpath, srcpath ) ) {
+        return logResult( EINVAL );	// would copy into itself
       }
-      int ret = prog.close();
-      return logResult( ret, "returned" );
+
+      return logResult( TreeCopier().copyDir( srcpath, tp.path() ) );
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -511,22 +801,11 @@ namespace zypp
         return logResult( EEXIST );
       }
 
-      std::string src( srcpath.asString());
-      src += "/.";
-      const char *const argv[] = {
-        "/bin/cp",
-        "-dR",
-        "--",
-        src.c_str(),
-        destpath.asString().c_str(),
-        NULL
-      };
-      ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
+      if ( isBelow( destpath, srcpath ) ) {
+        return logResult( EINVAL );	// would copy into itself
       }
-      int ret = prog.close();
-      return logResult( ret, "returned" );
+
+      return logResult( TreeCopier().copyContent( srcpath, destpath ) );
     }
 
     ///////////////////////////////////////////////////////////////////////
@@ -784,20 +1063,7 @@ namespace zypp
         return logResult( EISDIR );
       }
 
-      const char *const argv[] = {
-        "/bin/cp",
-        "--remove-destination",
-        "--",
-        file.asString().c_str(),
-        dest.asString().c_str(),
-        NULL
-      };
-      ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
-      }
-      int ret = prog.close();
-      return logResult( ret, "returned" );
+      return logResult( copyRegularFile( file, dest ) );
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -828,6 +1094,48 @@ namespace zypp
       return logResult( 0 );
     }
 
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	METHOD NAME : reflink
+    //	METHOD TYPE : int
+    //
+    int reflink( const Pathname & oldpath, const Pathname & newpath )
+    {
+      MIL << "reflink " << newpath << " -> " << oldpath;
+#ifdef FICLONE
+      int src = ::open( oldpath.c_str(), O_RDONLY|O_CLOEXEC );
+      if ( src == -1 )
+        return logResult( errno );
+
+      struct stat st;
+      if ( ::fstat( src, &st ) == -1 )
+      {
+        int err = errno;
+        ::close( src );
+        return logResult( err );
+      }
+
+      int dst = ::open( newpath.c_str(), O_WRONLY|O_CREAT|O_EXCL|O_CLOEXEC, st.st_mode & 07777 );
+      if ( dst == -1 )
+      {
+        int err = errno;
+        ::close( src );
+        return logResult( err );
+      }
+
+      int err = 0;
+      if ( ::ioctl( dst, FICLONE, src ) == -1 )
+        err = errno;
+      ::close( src );
+      ::close( dst );
+      if ( err )
+        ::unlink( newpath.c_str() );
+      return logResult( err );
+#else
+      return logResult( EOPNOTSUPP );
+#endif
+    }
+
     ///////////////////////////////////////////////////////////////////
     //
     //	METHOD NAME : hardlink
@@ -859,6 +1167,11 @@ namespace zypp
         switch ( errno )
         {
 	  case EPERM: // /proc/sys/fs/protected_hardlink in proc(5)
+	    MIL << " => reflink or copy" << endl;
+	    if ( reflink( oldpath, newpath ) == 0 )
+	      return 0;
+            return copy( oldpath, newpath );
+            break;
           case EXDEV: // oldpath  and  newpath are not on the same mounted file system
 	    MIL << " => copy" << endl;
             return copy( oldpath, newpath );
@@ -954,19 +1267,7 @@ namespace zypp
         return logResult( ENOTDIR );
       }
 
-      const char *const argv[] = {
-        "/bin/cp",
-        "--",
-        file.asString().c_str(),
-        dest.asString().c_str(),
-        NULL
-      };
-      ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
-      }
-      int ret = prog.close();
-      return logResult( ret, "returned" );
+      return logResult( copyRegularFile( file, dest / file.basename() ) );
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -976,14 +1277,7 @@ namespace zypp
     //
     std::string md5sum( const Pathname & file )
     {
-      if ( ! PathInfo( file ).isFile() ) {
-        return string();
-      }
-      std::ifstream istr( file.asString().c_str() );
-      if ( ! istr ) {
-        return string();
-      }
-      return Digest::digest( "MD5", istr );
+      return checksum(file, "MD5");
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -1006,11 +1300,26 @@ namespace zypp
       if ( ! PathInfo( file ).isFile() ) {
         return string();
       }
-      std::ifstream istr( file.asString().c_str() );
-      if ( ! istr ) {
+      // computed while the file was downloaded?
+      CheckSum known( CheckSumSink::lookup( file, algorithm ) );
+      if ( ! known.empty() ) {
+        return known.checksum();
+      }
+
+      CheckSumSink sink( { algorithm } );
+      if ( sink.empty() ) {
+        return string();
+      }
+      int fd = ::open( file.c_str(), O_RDONLY|O_CLOEXEC );
+      if ( fd == -1 ) {
+        return string();
+      }
+      bool ok = sink.update( fd );
+      ::close( fd );
+      if ( ! ok ) {
         return string();
       }
-      return Digest::digest( algorithm, istr );
+      return sink.checksums().front().checksum();
     }
 
     bool is_checksum( const Pathname & file, const CheckSum &checksum )
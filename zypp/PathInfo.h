@@ -438,8 +438,13 @@ namespace zypp
      * Like 'cp -a srcpath destpath'. Copy directory tree. srcpath/destpath must be
      * directories. 'basename srcpath' must not exist in destpath.
      *
+     * The copy is done in-process, regular files are copied in parallel
+     * (see \ref copy). Permissions (but setuid/setgid) and timestamps are
+     * preserved, symlinks are copied as symlinks.
+     *
      * @return 0 on success, ENOTDIR if srcpath/destpath is not a directory, EEXIST if
-     * 'basename srcpath' exists in destpath, otherwise the commands return value.
+     * 'basename srcpath' exists in destpath, EINVAL if destpath is inside srcpath,
+     * otherwise errno.
      **/
     int copy_dir( const Pathname & srcpath, const Pathname & destpath );
 
@@ -447,9 +452,12 @@ namespace zypp
      * Like 'cp -a srcpath/. destpath'. Copy the content of srcpath recursively
      * into destpath. Both \p srcpath and \p destpath has to exists.
      *
+     * Existing files in \p destpath are replaced, existing directories
+     * merged. Like \ref copy_dir otherwise.
+     *
      * @return 0 on success, ENOTDIR if srcpath/destpath is not a directory,
-     * EEXIST if srcpath and destpath are equal, otherwise the commands
-     * return value.
+     * EEXIST if srcpath and destpath are equal, EINVAL if destpath is inside
+     * srcpath, otherwise errno.
      */
     int copy_dir_content( const Pathname & srcpath, const Pathname & destpath);
 
@@ -636,10 +644,14 @@ namespace zypp
     int exchange( const Pathname & lpath, const Pathname & rpath );
 
     /**
-     * Like 'cp file dest'. Copy file to destination file.
+     * Like 'cp -p --remove-destination file dest'. Copy file to destination file.
+     *
+     * The data are copied in-process using the fastest method available:
+     * clone (\c FICLONE), \c copy_file_range, \c sendfile or read/write.
+     * Permissions (but setuid/setgid) and timestamps are preserved.
      *
      * @return 0 on success, EINVAL if file is not a file, EISDIR if
-     * destiantion is a directory, otherwise the commands return value.
+     * destiantion is a directory, otherwise errno.
      **/
     int copy( const Pathname & file, const Pathname & dest );
 
@@ -659,9 +671,21 @@ namespace zypp
      **/
     int hardlink( const Pathname & oldpath, const Pathname & newpath );
 
+    /**
+     * Create \a newpath as a reflink (\c FICLONE, copy on write clone)
+     * of \a oldpath. This requires both files on the same filesystem, and
+     * a filesystem supporting it (btrfs, xfs). If newpath exists it will
+     * not be overwritten.
+     *
+     * @return 0 on success, errno on failure.
+     */
+    int reflink( const Pathname & oldpath, const Pathname & newpath );
+
     /**
      * Create \a newpath as hardlink or copy of \a oldpath.
      *
+     * If hardlinks are not permitted, a reflink is tried before copying.
+     *
      * @return 0 on success, errno on failure.
      */
     int hardlinkCopy( const Pathname & oldpath, const Pathname & newpath );
@@ -696,10 +720,10 @@ namespace zypp
     Pathname expandlink( const Pathname & path_r );
 
     /**
-     * Like 'cp file dest'. Copy file to dest dir.
+     * Like 'cp -p file dest'. Copy file to dest dir (see \ref copy).
      *
      * @return 0 on success, EINVAL if file is not a file, ENOTDIR if dest
-     * is no directory, otherwise the commands return value.
+     * is no directory, otherwise errno.
      **/
     int copy_file2dir( const Pathname & file, const Pathname & dest );
     //@}
@@ -727,6 +751,9 @@ namespace zypp
     /**
      * Compute a files checksum
      *
+     * If the checksum was already computed while the file was downloaded
+     * (see \ref CheckSumSink), the file is not read again.
+     *
      * @return the files checksum on success, otherwise an empty string..
      **/
     std::string checksum( const Pathname & file, const std::string &algorithm );
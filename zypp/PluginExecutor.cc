@@ -11,6 +11,7 @@
 #include <iostream>
 #include "zypp/base/LogTools.h"
 #include "zypp/base/NonCopyable.h"
+#include "zypp/base/String.h"
 
 #include "zypp/ZConfig.h"
 #include "zypp/PathInfo.h"
@@ -24,6 +25,11 @@ using std::endl;
 ///////////////////////////////////////////////////////////////////
 namespace zypp
 {
+  namespace
+  {
+    const bool PLUGIN_CONCURRENT = str::strToBool( getenv( "ZYPP_PLUGIN_CONCURRENT" ), false );
+  }
+
   ///////////////////////////////////////////////////////////////////
   /// \class PluginExecutor::Impl
   /// \brief PluginExecutor implementation.
@@ -32,6 +38,7 @@ namespace zypp
   {
   public:
     Impl()
+    : _concurrent( PLUGIN_CONCURRENT )
     {}
 
     ~Impl()
@@ -47,10 +54,17 @@ namespace zypp
     size_t size() const
     { return _scripts.size(); }
 
+    bool concurrent() const
+    { return _concurrent; }
+
+    void setConcurrent( bool yesno_r )
+    { _concurrent = yesno_r; }
+
     void load( const Pathname & path_r )
     {
       PathInfo pi( path_r );
       DBG << "+++++++++++++++ load " << pi << endl;
+      std::list<PluginScript> loaded;
       if ( pi.isDir() )
       {
 	std::list<Pathname> entries;
@@ -63,13 +77,17 @@ namespace zypp
 	{
 	  PathInfo pii( *it );
 	  if ( pii.isFile() && pii.userMayRX() )
-	    doLoad( pii );
+	  {
+	    doLoad( pii, loaded );
+	    if ( ! _concurrent )
+	      doBegin( loaded );
+	  }
 	}
       }
       else if ( pi.isFile() )
       {
 	if ( pi.userMayRX() )
-	  doLoad( pi );
+	  doLoad( pi, loaded );
 	else
 	  WAR << "Plugin file is not executable: " << pi << endl;
       }
@@ -77,20 +95,14 @@ namespace zypp
       {
 	WAR << "Plugin path is neither dir nor file: " << pi << endl;
       }
+      doBegin( loaded );
       DBG << "--------------- load " << pi << endl;
     }
 
     void send( const PluginFrame & frame_r )
     {
       DBG << "+++++++++++++++ send " << frame_r << endl;
-      for ( auto it = _scripts.begin(); it != _scripts.end(); )
-      {
-	doSend( *it, frame_r );
-	if ( it->isOpen() )
-	  ++it;
-	else
-	  it = _scripts.erase( it );
-      }
+      doSend( _scripts, frame_r );
       DBG << "--------------- send " << frame_r << endl;
     }
 
@@ -98,21 +110,14 @@ namespace zypp
     { return _scripts; }
 
   private:
-    /** Launch a plugin sending PLUGINSTART message. */
-    void doLoad( const PathInfo & pi_r )
+    /** Launch a plugin. */
+    void doLoad( const PathInfo & pi_r, std::list<PluginScript> & loaded_r )
     {
       MIL << "Load plugin: " << pi_r << endl;
       try {
 	PluginScript plugin( pi_r.path() );
 	plugin.open();
-
-	PluginFrame frame( "PLUGINBEGIN" );
-	if ( ZConfig::instance().hasUserData() )
-	  frame.setHeader( "userdata", ZConfig::instance().userData() );
-
-	doSend( plugin, frame );	// closes on error
-	if ( plugin.isOpen() )
-	  _scripts.push_back( plugin );
+	loaded_r.push_back( plugin );
       }
       catch( const zypp::Exception & e )
       {
@@ -120,6 +125,71 @@ namespace zypp
       }
     }
 
+    /** Send PLUGINBEGIN to the launched plugins and add them to the execution list. */
+    void doBegin( std::list<PluginScript> & loaded_r )
+    {
+      if ( loaded_r.empty() )
+	return;
+
+      PluginFrame frame( "PLUGINBEGIN" );
+      if ( ZConfig::instance().hasUserData() )
+	frame.setHeader( "userdata", ZConfig::instance().userData() );
+
+      doSend( loaded_r, frame );	// closes on error
+      _scripts.splice( _scripts.end(), loaded_r );
+    }
+
+    /** Send frame to scripts, removing failed ones. */
+    void doSend( std::list<PluginScript> & scripts_r, const PluginFrame & frame_r )
+    {
+      if ( _concurrent && scripts_r.size() > 1 )
+      {
+	std::vector<PluginScript::Reply> replies;
+	try {
+	  replies = PluginScript::sendReceive( std::vector<PluginScript>( scripts_r.begin(), scripts_r.end() ), frame_r );
+	}
+	catch( const zypp::Exception & e )
+	{
+	  // Thrown before anything was sent. Once sending started, errors
+	  // are per script, so no script gets the frame twice.
+	  ZYPP_CAUGHT(e);
+	  WAR << "Concurrent send failed, sending one by one: " << e << endl;
+	}
+	if ( replies.size() == scripts_r.size() )
+	{
+	  // Process the replies in order, just like a sequential send would do.
+	  auto reply = replies.begin();
+	  for ( auto it = scripts_r.begin(); it != scripts_r.end(); ++reply )
+	  {
+	    if ( reply->error )
+	    {
+	      try { std::rethrow_exception( reply->error ); }
+	      catch( const zypp::Exception & e )
+	      {
+		ZYPP_CAUGHT(e);
+		WAR << e.asUserHistory() << endl;
+	      }
+	    }
+	    checkResponse( *it, frame_r, reply->frame );
+	    if ( it->isOpen() )
+	      ++it;
+	    else
+	      it = scripts_r.erase( it );
+	  }
+	  return;
+	}
+      }
+
+      for ( auto it = scripts_r.begin(); it != scripts_r.end(); )
+      {
+	doSend( *it, frame_r );
+	if ( it->isOpen() )
+	  ++it;
+	else
+	  it = scripts_r.erase( it );
+      }
+    }
+
     PluginFrame doSend( PluginScript & script_r, const PluginFrame & frame_r )
     {
       PluginFrame ret;
@@ -134,18 +204,25 @@ namespace zypp
 	WAR << e.asUserHistory() << endl;
       }
 
+      checkResponse( script_r, frame_r, ret );
+      return ret;
+    }
+
+    /** Close the script unless it sent a valid response. */
+    void checkResponse( PluginScript & script_r, const PluginFrame & frame_r, const PluginFrame & ret_r )
+    {
       // Allow using "/bin/cat" as reflector-script for testing
-      if ( ! ( ret.isAckCommand() || ret.isEnomethodCommand() || ( script_r.script() == "/bin/cat" && frame_r.command() != "ERROR" ) ) )
+      if ( ! ( ret_r.isAckCommand() || ret_r.isEnomethodCommand() || ( script_r.script() == "/bin/cat" && frame_r.command() != "ERROR" ) ) )
       {
-	WAR << "Bad plugin response from " << script_r << ": " << ret << endl;
+	WAR << "Bad plugin response from " << script_r << ": " << ret_r << endl;
 	WAR << "(Expected " << PluginFrame::ackCommand() << " or " << PluginFrame::enomethodCommand() << ")" << endl;
 	script_r.close();
       }
-
-      return ret;
     }
+
   private:
     std::list<PluginScript> _scripts;
+    bool _concurrent;
   };
 
   ///////////////////////////////////////////////////////////////////
@@ -173,6 +250,12 @@ namespace zypp
   void PluginExecutor::send( const PluginFrame & frame_r )
   { _pimpl->send( frame_r ); }
 
+  bool PluginExecutor::concurrent() const
+  { return _pimpl->concurrent(); }
+
+  void PluginExecutor::setConcurrent( bool yesno_r )
+  { _pimpl->setConcurrent( yesno_r ); }
+
   std::ostream & operator<<( std::ostream & str, const PluginExecutor & obj )
   { return str << obj._pimpl->scripts(); }
 
@@ -35,6 +35,13 @@ namespace zypp
   /// executors last reference goes out of scope. Failing PluginScripts are
   /// closed immediately.
   ///
+  /// By default a frame is sent to one script after the other, waiting for
+  /// each scripts reply. In \ref concurrent mode the frame is sent to all
+  /// scripts at once and the replies are collected as they arrive (see
+  /// \ref PluginScript::sendReceive). The replies are still processed in
+  /// the order the scripts were loaded. The default mode may be changed via
+  /// the environment variable \c ZYPP_PLUGIN_CONCURRENT.
+  ///
   /// \see PluginScript
   /// \ingroup g_RAII
   ///////////////////////////////////////////////////////////////////
@@ -75,6 +82,12 @@ namespace zypp
        */
       void send( const PluginFrame & frame_r );
 
+      /** Whether frames are sent to all plugins concurrently. */
+      bool concurrent() const;
+
+      /** Set whether frames are sent to all plugins concurrently. */
+      void setConcurrent( bool yesno_r );
+
     public:
       class Impl;		///< Implementation class.
     private:
@@ -10,16 +10,20 @@
  *
 */
 #include <sys/types.h>
+#include <sys/epoll.h>
 #include <signal.h>
 
 #include <iostream>
 #include <sstream>
+#include <chrono>
 
 #include "zypp/base/LogTools.h"
 #include "zypp/base/DefaultIntegral.h"
 #include "zypp/base/String.h"
+#include "zypp/base/Measure.h"
 #include "zypp/base/Signal.h"
 #include "zypp/base/IOStream.h"
+#include "zypp/AutoDispose.h"
 
 #include "zypp/PluginScript.h"
 #include "zypp/ExternalProgram.h"
@@ -157,6 +161,25 @@ namespace zypp
 
       PluginFrame receive() const;
 
+    public:
+      /** \name Non-blocking frame I/O (\ref send, \ref receive and \ref PluginScript::sendReceive) */
+      //@{
+	/** The frame data to send (debug logs the frame). */
+	std::string frameData( const PluginFrame & frame_r ) const;
+	/** Fd to write to the script. */
+	int outputFd() const;
+	/** Fd to read from the script. */
+	int inputFd() const;
+	/** Write as much of the buffer as possible; \c true if all was written. */
+	bool writeSome( const char *& buffer_r, ssize_t & buffsize_r ) const;
+	/** Append available frame data; \c true if the frame is complete. */
+	bool readSome( std::string & data_r ) const;
+	/** Parse received frame data. */
+	PluginFrame parseFrame( const std::string & data_r ) const;
+	/** Log the scripts stderr. */
+	void dumpStderr() const;
+      //@}
+
     private:
       Pathname _script;
       Arguments _args;
@@ -254,7 +277,7 @@ namespace zypp
     return _lastReturn;
   }
 
-  void PluginScript::Impl::send( const PluginFrame & frame_r ) const
+  std::string PluginScript::Impl::frameData( const PluginFrame & frame_r ) const
   {
     if ( !_cmd )
       ZYPP_THROW( PluginScriptNotConnected( "Not connected", str::Str() << *this ) );
@@ -276,8 +299,14 @@ namespace zypp
       std::istringstream datas( data );
       iostr::copyIndent( datas, L_DBG("PLUGIN") ) << endl;
     }
+    return data;
+  }
+
+  int PluginScript::Impl::outputFd() const
+  {
+    if ( !_cmd )
+      ZYPP_THROW( PluginScriptNotConnected( "Not connected", str::Str() << *this ) );
 
-    // try writing the pipe....
     FILE * filep = _cmd->outputFile();
     if ( ! filep )
       ZYPP_THROW( PluginScriptException( "Bad file pointer." ) );
@@ -285,6 +314,112 @@ namespace zypp
     int fd = ::fileno( filep );
     if ( fd == -1 )
       ZYPP_THROW( PluginScriptException( "Bad file descriptor" ) );
+    return fd;
+  }
+
+  int PluginScript::Impl::inputFd() const
+  {
+    if ( !_cmd )
+      ZYPP_THROW( PluginScriptNotConnected( "Not connected", str::Str() << *this ) );
+
+    FILE * filep = _cmd->inputFile();
+    if ( ! filep )
+      ZYPP_THROW( PluginScriptException( "Bad file pointer." ) );
+
+    int fd = ::fileno( filep );
+    if ( fd == -1 )
+      ZYPP_THROW( PluginScriptException( "Bad file descriptor" ) );
+    return fd;
+  }
+
+  bool PluginScript::Impl::writeSome( const char *& buffer_r, ssize_t & buffsize_r ) const
+  {
+    int fd = outputFd();
+    do {
+      ssize_t ret = ::write( fd, buffer_r, buffsize_r );
+      if ( ret == buffsize_r )
+      {
+	//DBG << "::write(" << buffsize_r << ") -> " << ret << endl;
+	::fflush( _cmd->outputFile() );
+	buffsize_r = 0;
+	return true;		// -> done
+      }
+      else if ( ret > 0 )
+      {
+	//WAR << "::write(" << buffsize_r << ") -> " << ret << " INCOMPLETE..." << endl;
+	::fflush( _cmd->outputFile() );
+	buffsize_r -= ret;
+	buffer_r += ret;	// -> continue
+      }
+      else // ( ret == -1 )
+      {
+	if ( errno == EAGAIN || errno == EWOULDBLOCK )
+	  return false;		// -> wait for fd to become ready
+	if ( errno != EINTR )
+	{
+	  ERR << "write(): " << Errno() << endl;
+	  if ( errno == EPIPE )
+	    ZYPP_THROW( PluginScriptDiedUnexpectedly( "Send: script died unexpectedly", str::Str() << Errno() ) );
+	  else
+	    ZYPP_THROW( PluginScriptException( "Send: send error", str::Str() << Errno() ) );
+	}
+      }
+    } while( true );
+  }
+
+  bool PluginScript::Impl::readSome( std::string & data_r ) const
+  {
+    inputFd();	// check connection
+    FILE * filep = _cmd->inputFile();
+    ::clearerr( filep );
+    do {
+      int ch = fgetc( filep );
+      if ( ch != EOF )
+      {
+	data_r.push_back( ch );
+	if ( ch == '\0' )
+	  return true;		// -> done
+      }
+      else if ( ::feof( filep ) )
+      {
+	WAR << "Unexpected EOF" << endl;
+	ZYPP_THROW( PluginScriptDiedUnexpectedly( "Receive: script died unexpectedly", str::Str() << Errno() ) );
+      }
+      else if ( errno != EINTR )
+      {
+	if ( errno == EWOULDBLOCK )
+	  return false;		// -> wait for fd to become ready
+	ERR << "read(): " << Errno() << endl;
+	ZYPP_THROW( PluginScriptException( "Receive: receive error", str::Str() << Errno() ) );
+      }
+      else
+	::clearerr( filep );
+    } while ( true );
+  }
+
+  PluginFrame PluginScript::Impl::parseFrame( const std::string & data_r ) const
+  {
+    // DBG << " <-read " << data_r.size() << endl;
+    std::istringstream datas( data_r );
+    PluginFrame ret( datas );
+    DBG << *this << " <-" << ret << endl;
+    return ret;
+  }
+
+  void PluginScript::Impl::dumpStderr() const
+  {
+    if ( _cmd )
+      PluginDumpStderr _dump( *_cmd );
+  }
+
+  void PluginScript::Impl::send( const PluginFrame & frame_r ) const
+  {
+    debug::TraceSpan span( "plugin", "send" );
+    span.tag( "script", _script ).tag( "command", frame_r.command() );
+    std::string data( frameData( frame_r ) );
+
+    // try writing the pipe....
+    int fd = outputFd();
 
     //DBG << " ->[" << fd << " " << (::feof(filep)?'e':'_') << (::ferror(filep)?'F':'_') << "]" << endl;
     {
@@ -292,7 +427,9 @@ namespace zypp
       SignalSaver sigsav( SIGPIPE, SIG_IGN );
       const char * buffer = data.c_str();
       ssize_t buffsize = data.size();
-      do {
+      while ( ! writeSome( buffer, buffsize ) )
+      {
+	// wait a while for fd to become ready for writing...
 	fd_set wfds;
 	FD_ZERO( &wfds );
 	FD_SET( fd, &wfds );
@@ -302,41 +439,12 @@ namespace zypp
 	tv.tv_usec = 0;
 
 	int retval = select( fd+1, NULL, &wfds, NULL, &tv );
-	if ( retval > 0 )	// FD_ISSET( fd, &wfds ) will be true.
-	{
-	  //DBG << "Ready to write..." << endl;
-	  ssize_t ret = ::write( fd, buffer, buffsize );
-	  if ( ret == buffsize )
-	  {
-	    //DBG << "::write(" << buffsize << ") -> " << ret << endl;
-	    ::fflush( filep );
-	    break; 		// -> done
-	  }
-	  else if ( ret > 0 )
-	  {
-	    //WAR << "::write(" << buffsize << ") -> " << ret << " INCOMPLETE..." << endl;
-	    ::fflush( filep );
-	    buffsize -= ret;
-	    buffer += ret;	// -> continue
-	  }
-	  else // ( retval == -1 )
-	  {
-	    if ( errno != EINTR )
-	    {
-	      ERR << "write(): " << Errno() << endl;
-	      if ( errno == EPIPE )
-		ZYPP_THROW( PluginScriptDiedUnexpectedly( "Send: script died unexpectedly", str::Str() << Errno() ) );
-	      else
-		ZYPP_THROW( PluginScriptException( "Send: send error", str::Str() << Errno() ) );
-	    }
-	  }
-	}
-	else if ( retval == 0 )
+	if ( retval == 0 )
 	{
 	  WAR << "Not ready to write within timeout." << endl;
 	  ZYPP_THROW( PluginScriptSendTimeout( "Not ready to write within timeout." ) );
 	}
-	else // ( retval == -1 )
+	else if ( retval == -1 )
 	{
 	  if ( errno != EINTR )
 	  {
@@ -344,86 +452,250 @@ namespace zypp
 	    ZYPP_THROW( PluginScriptException( "Error waiting on file descriptor", str::Str() << Errno() ) );
 	  }
 	}
-      } while( true );
+	// else: FD_ISSET( fd, &wfds ) will be true.
+      }
     }
   }
 
   PluginFrame PluginScript::Impl::receive() const
   {
-    if ( !_cmd )
-      ZYPP_THROW( PluginScriptNotConnected( "Not connected", str::Str() << *this ) );
-
+    debug::TraceSpan span( "plugin", "receive" );
+    span.tag( "script", _script );
     // try reading the pipe....
-    FILE * filep = _cmd->inputFile();
-    if ( ! filep )
-      ZYPP_THROW( PluginScriptException( "Bad file pointer." ) );
+    int fd = inputFd();
 
-    int fd = ::fileno( filep );
-    if ( fd == -1 )
-      ZYPP_THROW( PluginScriptException( "Bad file descriptor" ) );
-
-    ::clearerr( filep );
     std::string data;
     {
       PluginDebugBuffer _debug( data ); // dump receive buffer if PLUGIN_DEBUG
       PluginDumpStderr _dump( *_cmd ); // dump scripts stderr before leaving
-      do {
-	int ch = fgetc( filep );
-	if ( ch != EOF )
+      while ( ! readSome( data ) )
+      {
+	// wait a while for fd to become ready for reading...
+	fd_set rfds;
+	FD_ZERO( &rfds );
+	FD_SET( fd, &rfds );
+
+	struct timeval tv;
+	tv.tv_sec = _receiveTimeout;
+	tv.tv_usec = 0;
+
+	int retval = select( fd+1, &rfds, NULL, NULL, &tv );
+	if ( retval == 0 )
+	{
+	  WAR << "Not ready to read within timeout." << endl;
+	  ZYPP_THROW( PluginScriptReceiveTimeout( "Not ready to read within timeout." ) );
+	}
+	else if ( retval == -1 )
+	{
+	  if ( errno != EINTR )
+	  {
+	    ERR << "select(): " << Errno() << endl;
+	    ZYPP_THROW( PluginScriptException( "Error waiting on file descriptor", str::Str() << Errno() ) );
+	  }
+	}
+	// else: FD_ISSET( fd, &rfds ) will be true.
+      }
+    }
+    return parseFrame( data );
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  namespace
+  {
+    typedef std::chrono::steady_clock Clock;
+
+    ///////////////////////////////////////////////////////////////////
+    /// \brief One scripts frame exchange within \ref PluginScript::sendReceive.
+    ///////////////////////////////////////////////////////////////////
+    struct Channel
+    {
+      enum State { Sending, Receiving, Done };
+
+      Channel()
+      : impl( nullptr ), state( Done ), buffer( nullptr ), buffsize( 0 ), fd( -1 )
+      {}
+
+      const PluginScript::Impl * impl;
+      State         state;
+      std::string   out;		///< frame data to send
+      const char *  buffer;		///< unsent part of out
+      ssize_t       buffsize;
+      std::string   in;			///< reply data received
+      int           fd;			///< fd registered in the epoll set
+      Clock::time_point deadline;	///< timeout, reset on any progress
+    };
+  } // namespace
+  ///////////////////////////////////////////////////////////////////
+
+  std::vector<PluginScript::Reply> PluginScript::sendReceive( const std::vector<PluginScript> & scripts_r, const PluginFrame & frame_r )
+  {
+    std::vector<Reply> ret( scripts_r.size() );
+    std::vector<Channel> channels( scripts_r.size() );
+
+    int epfd = ::epoll_create1( EPOLL_CLOEXEC );
+    if ( epfd == -1 )
+      ZYPP_THROW( PluginScriptException( "Error creating epoll set", str::Str() << Errno() ) );
+    AutoDispose<int> epfdGuard( epfd, ::close );
+    SignalSaver sigsav( SIGPIPE, SIG_IGN );
+
+    size_t pending = 0;
+
+    auto watch = [&]( unsigned idx_r, int fd_r, uint32_t events_r )
+    {
+      struct epoll_event ev;
+      ev.events = events_r;
+      ev.data.u32 = idx_r;
+      if ( ::epoll_ctl( epfd, EPOLL_CTL_ADD, fd_r, &ev ) == -1 )
+	ZYPP_THROW( PluginScriptException( "Error waiting on file descriptor", str::Str() << Errno() ) );
+      channels[idx_r].fd = fd_r;
+    };
+
+    auto unwatch = [&]( unsigned idx_r )
+    {
+      Channel & ch( channels[idx_r] );
+      if ( ch.fd != -1 )
+      {
+	::epoll_ctl( epfd, EPOLL_CTL_DEL, ch.fd, nullptr );
+	ch.fd = -1;
+      }
+    };
+
+    auto finish = [&]( unsigned idx_r )
+    {
+      Channel & ch( channels[idx_r] );
+      unwatch( idx_r );
+      if ( ch.state != Channel::Done )
+      {
+	ch.state = Channel::Done;
+	--pending;
+      }
+      PluginDebugBuffer _debug( ch.in ); // dump receive buffer if PLUGIN_DEBUG
+      ch.impl->dumpStderr();
+    };
+
+    // Proceed as far as possible without blocking.
+    auto proceed = [&]( unsigned idx_r )
+    {
+      Channel & ch( channels[idx_r] );
+      try
+      {
+	if ( ch.state == Channel::Sending )
 	{
-	  data.push_back( ch );
-	  if ( ch == '\0' )
-	    break;
+	  if ( ! ch.impl->writeSome( ch.buffer, ch.buffsize ) )
+	  {
+	    ch.deadline = Clock::now() + std::chrono::seconds( ch.impl->_sendTimeout );
+	    return;
+	  }
+	  unwatch( idx_r );
+	  ch.state = Channel::Receiving;
+	  ch.deadline = Clock::now() + std::chrono::seconds( ch.impl->_receiveTimeout );
+	  watch( idx_r, ch.impl->inputFd(), EPOLLIN );
 	}
-	else if ( ::feof( filep ) )
+	// data may already be buffered in the input FILE
+	if ( ch.impl->readSome( ch.in ) )
 	{
-	  WAR << "Unexpected EOF" << endl;
-	  ZYPP_THROW( PluginScriptDiedUnexpectedly( "Receive: script died unexpectedly", str::Str() << Errno() ) );
+	  ret[idx_r].frame = ch.impl->parseFrame( ch.in );
+	  finish( idx_r );
 	}
-	else if ( errno != EINTR )
+	else
+	  ch.deadline = Clock::now() + std::chrono::seconds( ch.impl->_receiveTimeout );
+      }
+      catch ( const Exception & )
+      {
+	ret[idx_r].error = std::current_exception();
+	finish( idx_r );
+      }
+    };
+
+    for ( unsigned idx = 0; idx < scripts_r.size(); ++idx )
+    {
+      Channel & ch( channels[idx] );
+      ch.impl = scripts_r[idx]._pimpl.get();
+      try
+      {
+	ch.impl->frameData( frame_r ).swap( ch.out );
+	ch.buffer = ch.out.c_str();
+	ch.buffsize = ch.out.size();
+	ch.state = Channel::Sending;
+	ch.deadline = Clock::now() + std::chrono::seconds( ch.impl->_sendTimeout );
+	++pending;
+	watch( idx, ch.impl->outputFd(), EPOLLOUT );
+      }
+      catch ( const Exception & )
+      {
+	ret[idx].error = std::current_exception();
+	finish( idx );
+      }
+    }
+
+    std::vector<struct epoll_event> events( scripts_r.size() ? scripts_r.size() : 1 );
+    while ( pending )
+    {
+      Clock::time_point next( Clock::time_point::max() );
+      for ( const Channel & ch : channels )
+      {
+	if ( ch.state != Channel::Done && ch.deadline < next )
+	  next = ch.deadline;
+      }
+      Clock::duration wait( next - Clock::now() );
+      int waitms = wait.count() > 0 ? std::chrono::duration_cast<std::chrono::milliseconds>( wait ).count() + 1 : 0;
+
+      int cnt = ::epoll_wait( epfd, &events[0], events.size(), waitms );
+      if ( cnt == -1 )
+      {
+	if ( errno == EINTR )
+	  continue;
+	// Frames may be partially exchanged: fail the pending scripts, but don't
+	// throw, as the caller must not send the frame again to the others.
+	ERR << "epoll_wait(): " << Errno() << endl;
+	for ( unsigned idx = 0; idx < channels.size(); ++idx )
+	{
+	  if ( channels[idx].state == Channel::Done )
+	    continue;
+	  try
+	  { ZYPP_THROW( PluginScriptException( "Error waiting on file descriptor", str::Str() << Errno() ) ); }
+	  catch ( const Exception & )
+	  {
+	    ret[idx].error = std::current_exception();
+	    finish( idx );
+	  }
+	}
+	break;
+      }
+
+      for ( int i = 0; i < cnt; ++i )
+      {
+	if ( channels[events[i].data.u32].state != Channel::Done )
+	  proceed( events[i].data.u32 );
+      }
+
+      // per script timeouts
+      Clock::time_point now( Clock::now() );
+      for ( unsigned idx = 0; idx < channels.size(); ++idx )
+      {
+	Channel & ch( channels[idx] );
+	if ( ch.state == Channel::Done || ch.deadline > now )
+	  continue;
+	try
 	{
-	  if ( errno == EWOULDBLOCK )
+	  if ( ch.state == Channel::Sending )
 	  {
-	    // wait a while for fd to become ready for reading...
-	    fd_set rfds;
-	    FD_ZERO( &rfds );
-	    FD_SET( fd, &rfds );
-
-	    struct timeval tv;
-	    tv.tv_sec = _receiveTimeout;
-	    tv.tv_usec = 0;
-
-	    int retval = select( fd+1, &rfds, NULL, NULL, &tv );
-	    if ( retval > 0 )	// FD_ISSET( fd, &rfds ) will be true.
-	    {
-	      ::clearerr( filep );
-	    }
-	    else if ( retval == 0 )
-	    {
-	      WAR << "Not ready to read within timeout." << endl;
-	      ZYPP_THROW( PluginScriptReceiveTimeout( "Not ready to read within timeout." ) );
-	    }
-	    else // ( retval == -1 )
-	    {
-	      if ( errno != EINTR )
-	      {
-		ERR << "select(): " << Errno() << endl;
-		ZYPP_THROW( PluginScriptException( "Error waiting on file descriptor", str::Str() << Errno() ) );
-	      }
-	    }
+	    WAR << *ch.impl << ": Not ready to write within timeout." << endl;
+	    ZYPP_THROW( PluginScriptSendTimeout( "Not ready to write within timeout." ) );
 	  }
 	  else
 	  {
-	    ERR << "read(): " << Errno() << endl;
-	    ZYPP_THROW( PluginScriptException( "Receive: receive error", str::Str() << Errno() ) );
+	    WAR << *ch.impl << ": Not ready to read within timeout." << endl;
+	    ZYPP_THROW( PluginScriptReceiveTimeout( "Not ready to read within timeout." ) );
 	  }
 	}
-      } while ( true );
+	catch ( const Exception & )
+	{
+	  ret[idx].error = std::current_exception();
+	  finish( idx );
+	}
+      }
     }
-    // DBG << " <-read " << data.size() << endl;
-    std::istringstream datas( data );
-    PluginFrame ret( datas );
-    DBG << *this << " <-" << ret << endl;
     return ret;
   }
 
@@ -15,6 +15,7 @@
 #include <iosfwd>
 #include <string>
 #include <vector>
+#include <exception>
 
 #include "zypp/base/PtrTypes.h"
 #include "zypp/Pathname.h"
@@ -180,6 +181,32 @@ namespace zypp
        */
       PluginFrame receive() const;
 
+    public:
+      /** Result of \ref sendReceive for a single script. */
+      struct Reply
+      {
+	PluginFrame        frame;	///< The scripts reply (if no error).
+	std::exception_ptr error;	///< Exception thrown while sending or receiving.
+      };
+
+      /** Send a \ref PluginFrame to several scripts at once and receive their replies.
+       *
+       * The frame is written to all scripts concurrently and the replies are
+       * collected through a single \c epoll set. So the call takes as long as
+       * the slowest script, not the sum of all. The scripts must not share
+       * their connection (i.e. be copies of each other).
+       *
+       * Each scripts own \ref sendTimeout and \ref receiveTimeout apply the
+       * same way they do in \ref send and \ref receive.
+       *
+       * \return The replies in order of \a scripts_r. If \ref send or
+       * \ref receive would have thrown for a script, its \ref Reply::error
+       * holds the exception. Failing scripts are not closed.
+       * \throw PluginScriptException if the \c epoll set can't be created
+       * (before anything was sent, so the frame may be sent again).
+       */
+      static std::vector<Reply> sendReceive( const std::vector<PluginScript> & scripts_r, const PluginFrame & frame_r );
+
     public:
       /** Implementation. */
       class Impl;
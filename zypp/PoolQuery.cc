@@ -11,6 +11,7 @@
 */
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 
 #include "zypp/base/Gettext.h"
 #include "zypp/base/LogTools.h"
@@ -523,6 +524,14 @@ namespace zypp
     /** Pass flags from \ref compile, as they may have been changed. */
     string createRegex( const StrContainer & container, const Match & flags ) const;
 
+    /** The \ref StrMatcher for \a container.
+     * Multiple strings are joined by \ref createRegex and \a flags are
+     * switched to \ref Match::REGEX. If there are many, and the regex would
+     * just match any of some plain strings or globs, a multi-pattern
+     * \ref StrMatcher is returned instead.
+     */
+    StrMatcher createMatcher( const StrContainer & container, Match & flags ) const;
+
   private:
     friend Impl * rwcowClone<Impl>( const Impl * rhs );
     /** clone for RWCOW_pointer */
@@ -562,10 +571,6 @@ namespace zypp
     if ( cflags.mode() == Match::OTHER ) // this will never succeed...
       ZYPP_THROW( MatchUnknownModeException( cflags ) );
 
-    /** Compiled search strings. */
-    string rcstrings;
-
-
     // 'different'         - will have to iterate through all and match by ourselves (slow)
     // 'same'              - will pass the compiled string to dataiterator_init
     // 'one-attr'          - will pass it to dataiterator_init
@@ -589,11 +594,8 @@ namespace zypp
       StrContainer joined;
       invokeOnEach(_strings.begin(), _strings.end(), EmptyFilter(), MyInserter(joined));
       invokeOnEach(_attrs.begin()->second.begin(), _attrs.begin()->second.end(), EmptyFilter(), MyInserter(joined));
-      rcstrings = createRegex(joined, cflags);
-      if (joined.size() > 1) // switch to regex for multiple strings
-        cflags.setModeRegex();
       _attrMatchList.push_back( AttrMatchData( _attrs.begin()->first,
-                                StrMatcher( rcstrings, cflags ) ) );
+                                createMatcher( joined, cflags ) ) );
     }
 
     // // MULTIPLE ATTRIBUTES
@@ -641,18 +643,14 @@ attremptycheckend:
         if (attrvals_empty)
         {
           invokeOnEach(_strings.begin(), _strings.end(), EmptyFilter(), MyInserter(joined));
-          rcstrings = createRegex(joined, cflags);
         }
         else
         {
           invokeOnEach(_strings.begin(), _strings.end(), EmptyFilter(), MyInserter(joined));
           invokeOnEach(_attrs.begin()->second.begin(), _attrs.begin()->second.end(), EmptyFilter(), MyInserter(joined));
-          rcstrings = createRegex(joined, cflags);
         }
-        if (joined.size() > 1) // switch to regex for multiple strings
-          cflags.setModeRegex();
         // May use the same StrMatcher for all
-        StrMatcher matcher( rcstrings, cflags );
+        StrMatcher matcher( createMatcher( joined, cflags ) );
         for_( ai, _attrs.begin(), _attrs.end() )
         {
           _attrMatchList.push_back( AttrMatchData( ai->first, matcher ) );
@@ -670,11 +668,8 @@ attremptycheckend:
           StrContainer joined;
           invokeOnEach(_strings.begin(), _strings.end(), EmptyFilter(), MyInserter(joined));
           invokeOnEach(ai->second.begin(), ai->second.end(), EmptyFilter(), MyInserter(joined));
-          string s = createRegex(joined, cflags);
-          if (joined.size() > 1) // switch to regex for multiple strings
-            cflags.setModeRegex();
           _attrMatchList.push_back( AttrMatchData( ai->first,
-                                    StrMatcher( s, cflags ) ) );
+                                    createMatcher( joined, cflags ) ) );
         }
       }
     }
@@ -695,13 +690,10 @@ attremptycheckend:
             joined.insert( mstr );
 
           cflags = _flags;
-          rcstrings = createRegex( joined, cflags );
-          if ( joined.size() > 1 ) // switch to regex for multiple strings
-            cflags.setModeRegex();
 
 	  // copy and exchange the StrMatcher
 	  AttrMatchData nattr( *it );
-	  nattr.strMatcher = StrMatcher( rcstrings, cflags ),
+	  nattr.strMatcher = createMatcher( joined, cflags );
           _attrMatchList.push_back( std::move(nattr) );
         }
         else
@@ -716,11 +708,8 @@ attremptycheckend:
     if ( _attrMatchList.empty() )
     {
       cflags = _flags;
-      rcstrings = createRegex( _strings, cflags );
-      if ( _strings.size() > 1 ) // switch to regex for multiple strings
-        cflags.setModeRegex();
       _attrMatchList.push_back( AttrMatchData( sat::SolvAttr::allAttr,
-                                StrMatcher( rcstrings, cflags ) ) );
+                                createMatcher( _strings, cflags ) ) );
     }
 
     // Finally check here, whether all involved regex compile.
@@ -829,6 +818,63 @@ attremptycheckend:
 #undef WB
   }
 
+  /** Number of strings from which on a multi-pattern \ref StrMatcher is
+   * used rather than a regex (if possible).
+   */
+  static const PoolQuery::StrContainer::size_type multiPatternMin = 8;
+
+  /**
+   * Globs matching the same as the regex \ref PoolQuery::Impl::createRegex
+   * builds from \a container in \c STRING, \c SUBSTRING or \c GLOB mode.
+   * If the strings contain any other regex syntax than '.' (a glob's '?'),
+   * an empty vector is returned. Also for \c NOCASE with non-ASCII strings,
+   * as the multi-pattern \ref StrMatcher folds ASCII only, while \c REG_ICASE
+   * follows the locale.
+   */
+  static std::vector<string> regex2globs( const PoolQuery::StrContainer & container, const Match & flags )
+  {
+    std::vector<string> ret;
+    if ( ! ( flags.isModeString() || flags.isModeSubstring() || flags.isModeGlob() ) )
+      return ret;
+
+    const char * regexchars = flags.isModeGlob() ? "^$+()[]{}|\\\n" : "^$+()[]{}|\\\n*?";
+    bool nocase = flags.test( Match::NOCASE );
+    for_( it, container.begin(), container.end() )
+    {
+      if ( it->empty() || it->find_first_of( regexchars ) != string::npos )
+        return std::vector<string>();
+      if ( nocase && std::find_if( it->begin(), it->end(), []( char ch ) { return (unsigned char)ch >= 0x80; } ) != it->end() )
+        return std::vector<string>();
+
+      string glob( *it );
+      std::replace( glob.begin(), glob.end(), '.', '?' );
+      if ( flags.isModeSubstring() )
+        glob = "*" + glob + "*";
+      ret.push_back( std::move(glob) );
+    }
+    return ret;
+  }
+
+  StrMatcher PoolQuery::Impl::createMatcher( const StrContainer & container, Match & flags ) const
+  {
+    if ( container.size() >= multiPatternMin && ! _match_word && ! _require_all )
+    {
+      std::vector<string> globs( regex2globs( container, flags ) );
+      if ( ! globs.empty() )
+      {
+        Match gflags( flags );
+        gflags.setModeGlob();
+        flags.setModeRegex();	// as for the regex
+        return StrMatcher( globs, gflags );
+      }
+    }
+
+    string rcstrings( createRegex( container, flags ) );
+    if ( container.size() > 1 ) // switch to regex for multiple strings
+      flags.setModeRegex();
+    return StrMatcher( rcstrings, flags );
+  }
+
   string PoolQuery::Impl::asString() const
   {
     ostringstream o;
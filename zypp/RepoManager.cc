@@ -10,6 +10,7 @@
  *
 */
 
+#include <unistd.h>
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
@@ -22,6 +23,7 @@
 
 #include "zypp/base/InputStream.h"
 #include "zypp/base/LogTools.h"
+#include "zypp/base/Measure.h"
 #include "zypp/base/Gettext.h"
 #include "zypp/base/DefaultIntegral.h"
 #include "zypp/base/Function.h"
@@ -34,6 +36,7 @@
 #include "zypp/RepoManager.h"
 
 #include "zypp/media/MediaManager.h"
+#include "zypp/media/MirrorScoreboard.h"
 #include "zypp/media/CredentialManager.h"
 #include "zypp/MediaSetAccess.h"
 #include "zypp/ExternalProgram.h"
@@ -45,6 +48,8 @@
 #include "zypp/repo/yum/Downloader.h"
 #include "zypp/repo/susetags/Downloader.h"
 #include "zypp/repo/PluginServices.h"
+#include "zypp/repo/PackageStore.h"
+#include "zypp/repo/PrefetchHelper.h"
 
 #include "zypp/Target.h" // for Target::targetDistribution() for repo index services
 #include "zypp/ZYppFactory.h" // to get the Target from ZYpp instance
@@ -73,6 +78,13 @@ namespace zypp
       const char * env = getenv("ZYPP_PLUGIN_APPDATA_FORCE_COLLECT");
       return( env && str::strToBool( env, true ) );
     }
+
+    /** Max. number of services \ref RepoManager::refreshServices fetches concurrently (default 8, 1 disables). */
+    inline unsigned ZYPP_SERVICE_REFRESH_JOBS()
+    {
+      const char * env = getenv("ZYPP_SERVICE_REFRESH_JOBS");
+      return( env ? str::strtonum<unsigned>( env ) : 8 );
+    }
   } // namespace env
   ///////////////////////////////////////////////////////////////////
 
@@ -294,6 +306,142 @@ namespace zypp
 
     ////////////////////////////////////////////////////////////////////////////
 
+    /** A services repo list fetched ahead by \ref RepoManager::Impl::refreshServices. */
+    struct ServicePrefetch
+    {
+      RepoInfoList   repos;		///< as collected by \ref RepoCollector
+      Date::Duration ttl = 0;		///< the ttl probed by \ref ServiceRepos
+    };
+    typedef std::map<std::string,ServicePrefetch> ServicePrefetchMap;
+
+    /** Whether \ref RepoManager::Impl::refreshService would skip \a service_r as its TTL is not yet expired. */
+    bool serviceTtlValid( const ServiceInfo & service_r, const RepoManager::RefreshServiceOptions & options_r )
+    {
+      if ( ! service_r.ttl()
+	|| options_r.testFlag( RepoManager::RefreshService_forceRefresh )
+	|| options_r.testFlag( RepoManager::RefreshService_restoreStatus ) )
+	return false;
+      Date lrf( service_r.lrf() );
+      Date now( Date::now() );
+      return( lrf && lrf <= now && (lrf+=service_r.ttl()) > now );
+    }
+
+    /** Time (sec) granted to a \ref startServicePrefetch helper before it is killed. */
+    const unsigned servicePrefetchTimeout = 600;
+
+    /** Start the \ref repo::prefetchHelper running \ref ServiceRepos for \a service_r and writing the result to \a result_r.
+     * The helper exits with 0 on success. Returns an empty pointer if it could not be started.
+     */
+    shared_ptr<ExternalProgram> startServicePrefetch( const Pathname & helper_r, const Pathname & root_r, const ServiceInfo & service_r, const Pathname & result_r )
+    {
+      Pathname serviceFile( result_r.extend( ".service" ) );
+      {
+	std::ofstream out( serviceFile.c_str() );
+	service_r.dumpAsIniOn( out );
+	out.close();
+	if ( ! out )
+	  return shared_ptr<ExternalProgram>();
+      }
+
+      ExternalProgram::Arguments cmd;
+      cmd.push_back( helper_r.asString() );
+      cmd.push_back( "service" );
+      cmd.push_back( root_r.empty() ? "/" : root_r.asString() );
+      cmd.push_back( ZConfig::instance().repoManagerRoot().asString() );
+      cmd.push_back( serviceFile.asString() );
+      cmd.push_back( result_r.asString() );
+      shared_ptr<ExternalProgram> ret( new ExternalProgram( cmd, ExternalProgram::Discard_Stderr ) );
+      if ( ret->getpid() <= 0 )
+	ret.reset();
+      return ret;
+    }
+
+    /** Read the result written by \ref startServicePrefetch. */
+    ServicePrefetch readServicePrefetch( const Pathname & result_r, const std::string & targetDistro_r )
+    {
+      ServicePrefetch ret;
+      {
+	std::ifstream in( result_r.c_str() );
+	std::string line( str::getline( in ) );
+	if ( ! str::hasPrefix( line, "# ttl " ) )
+	  ZYPP_THROW( Exception( "Bad prefetch result " + result_r.asString() ) );
+	ret.ttl = str::strtonum<Date::Duration>( line.substr( 6 ) );
+      }
+      RepoCollector collector( targetDistro_r );
+      parser::RepoFileReader parser( result_r, bind( &RepoCollector::collect, &collector, _1 ) );
+      ret.repos = std::move( collector.repos );
+      for ( RepoInfo & repo : ret.repos )
+	repo.setFilepath( Pathname() );
+      return ret;
+    }
+
+    /** Fetch the repo lists of \a services_r, running up to \a jobs_r helper processes concurrently.
+     * Services which failed are not in the returned map, so \ref RepoManager::Impl::refreshService
+     * fetches them again itself (and reports the error). A helper exceeding the
+     * \ref servicePrefetchTimeout is killed and counts as failed.
+     */
+    ServicePrefetchMap prefetchServices( const Pathname & root_r, const std::vector<ServiceInfo> & services_r, const std::string & targetDistro_r, unsigned jobs_r )
+    {
+      ServicePrefetchMap ret;
+      if ( jobs_r <= 1 || services_r.size() <= 1 )
+	return ret;	// nothing to win
+
+      Pathname helper( repo::prefetchHelper() );
+      if ( helper.empty() )
+	return ret;
+
+      MIL << "Prefetch " << services_r.size() << " services, up to " << jobs_r << " concurrently" << endl;
+      filesystem::TmpDir tmpdir;
+      std::vector<shared_ptr<ExternalProgram>> progs( services_r.size() );
+
+      // Collect the results in service order:
+      auto collect = [&]( unsigned idx_r ) {
+	const ServiceInfo & service( services_r[idx_r] );
+	shared_ptr<ExternalProgram> prog;
+	prog.swap( progs[idx_r] );
+	int status = -1;
+	if ( prog )
+	{
+	  Date deadline( Date::now() + servicePrefetchTimeout );
+	  while ( prog->running() )
+	  {
+	    if ( Date::now() > deadline )
+	    {
+	      WAR << "Prefetch timed out for service '" << service.alias() << "'" << endl;
+	      prog->kill();
+	      break;
+	    }
+	    ::usleep( 50 * 1000 );
+	  }
+	  status = prog->close();
+	}
+	if ( status == 0 )
+	{
+	  try
+	  {
+	    ret[service.alias()] = readServicePrefetch( tmpdir.path() / str::numstring( idx_r ), targetDistro_r );
+	    DBG << "Prefetched service '" << service.alias() << "': " << ret[service.alias()].repos.size() << " repos" << endl;
+	    return;
+	  }
+	  catch ( const Exception & excpt )
+	  { ZYPP_CAUGHT( excpt ); }
+	}
+	WAR << "Prefetch failed for service '" << service.alias() << "' (" << status << ")" << endl;
+      };
+
+      for ( unsigned idx = 0; idx < services_r.size(); ++idx )
+      {
+	if ( idx >= jobs_r )
+	  collect( idx - jobs_r );
+	progs[idx] = startServicePrefetch( helper, root_r, services_r[idx], tmpdir.path() / str::numstring( idx ) );
+      }
+      for ( unsigned idx = ( services_r.size() > jobs_r ? services_r.size() - jobs_r : 0 ); idx < services_r.size(); ++idx )
+	collect( idx );
+      return ret;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+
     /**
      * \short List of RepoInfo's from a directory
      *
@@ -301,8 +449,9 @@ namespace zypp
      * RepoInfo's contained in that file.
      *
      * \param dir pathname of the directory to read.
+     * \param cache optional cache file (see \ref parser::RepoFileReader)
      */
-    std::list<RepoInfo> repositories_in_dir( const Pathname &dir )
+    std::list<RepoInfo> repositories_in_dir( const Pathname &dir, const Pathname & cache = Pathname() )
     {
       MIL << "directory " << dir << endl;
       std::list<RepoInfo> repos;
@@ -320,6 +469,7 @@ namespace zypp
 	  ZYPP_THROW(Exception(str::form(_("Failed to read directory '%s'"), dir.c_str())));
 	}
 
+	std::list<Pathname> repofiles;
 	str::regex allowedRepoExt("^\\.repo(_[0-9]+)?$");
 	for ( std::list<Pathname>::const_iterator it = entries.begin(); it != entries.end(); ++it )
 	{
@@ -331,11 +481,14 @@ namespace zypp
 	    }
 	    else
 	    {
-	      const std::list<RepoInfo> & tmp( repositories_in_file( *it ) );
-	      repos.insert( repos.end(), tmp.begin(), tmp.end() );
+	      repofiles.push_back( *it );
 	    }
 	  }
 	}
+
+	RepoCollector collector;
+	parser::RepoFileReader parser( repofiles, bind( &RepoCollector::collect, &collector, _1 ), cache );
+	repos = std::move(collector.repos);
       }
       return repos;
     }
@@ -525,10 +678,20 @@ namespace zypp
     {
       init_knownServices();
       init_knownRepositories();
+      if ( ZConfig::instance().download_mirrorScoreboard() )
+	media::MediaManager::mirrorScoreboard().load( mirrorScoreboardFile() );
     }
 
     ~Impl()
     {
+      if ( ZConfig::instance().download_mirrorScoreboard()
+	&& ! media::MediaManager::mirrorScoreboard().empty()
+	&& geteuid() == 0 )
+      {
+	if ( ! media::MediaManager::mirrorScoreboard().save( mirrorScoreboardFile() ) )
+	  WAR << "Unable to save the mirror scoreboard to " << mirrorScoreboardFile() << endl;
+      }
+
       // trigger appdata refresh if some repos change
       if ( ( _reposDirty || env::ZYPP_PLUGIN_APPDATA_FORCE_COLLECT() )
 	&& geteuid() == 0 && ( _options.rootDir.empty() || _options.rootDir == "/" ) )
@@ -586,6 +749,10 @@ namespace zypp
       return it == repos().end() ? RepoInfo::noRepo : *it;
     }
 
+  public:
+    Pathname mirrorScoreboardFile() const
+    { return _options.repoCachePath / "mirror-scoreboard"; }
+
   public:
     Pathname metadataPath( const RepoInfo & info ) const
     { return rawcache_path_for_repoinfo( _options, info ); }
@@ -657,7 +824,7 @@ namespace zypp
 
     void refreshServices( const RefreshServiceOptions & options_r );
 
-    void refreshService( const std::string & alias, const RefreshServiceOptions & options_r );
+    void refreshService( const std::string & alias, const RefreshServiceOptions & options_r, const ServicePrefetch * prefetch_r = nullptr );
     void refreshService( const ServiceInfo & service, const RefreshServiceOptions & options_r )
     {  refreshService( service.alias(), options_r ); }
 
@@ -668,6 +835,16 @@ namespace zypp
   private:
     void saveService( ServiceInfo & service ) const;
 
+    /** Target distro identifier for services (\ref RepoManagerOptions or the target). */
+    std::string servicesTargetDistro() const
+    {
+      std::string ret( _options.servicesTargetDistro );
+      if ( ret.empty() )
+	ret = Target::targetDistribution( Pathname() );
+      DBG << "ServicesTargetDistro: " << ret << endl;
+      return ret;
+    }
+
     Pathname generateNonExistingName( const Pathname & dir, const std::string & basefilename ) const;
 
     std::string generateFilename( const RepoInfo & info ) const
@@ -832,7 +1009,7 @@ namespace zypp
     {
       std::list<std::string> repoEscAliases;
       std::list<RepoInfo> orphanedRepos;
-      for ( RepoInfo & repoInfo : repositories_in_dir(_options.knownReposPath) )
+      for ( RepoInfo & repoInfo : repositories_in_dir( _options.knownReposPath, _options.repoCachePath / "repos.d.cache" ) )
       {
         // set the metadata path for the repo
         repoInfo.setMetadataPath( rawcache_path_for_repoinfo(_options, repoInfo) );
@@ -1085,6 +1262,7 @@ namespace zypp
 
   void RepoManager::Impl::refreshMetadata( const RepoInfo & info, RawMetadataRefreshPolicy policy, const ProgressData::ReceiverFnc & progress )
   {
+    ZYppFactory::instance().assertWritable( "Refresh metadata" );
     assert_alias(info);
     assert_urls(info);
 
@@ -1223,6 +1401,7 @@ namespace zypp
 
   void RepoManager::Impl::cleanMetadata( const RepoInfo & info, const ProgressData::ReceiverFnc & progressfnc )
   {
+    ZYppFactory::instance().assertWritable( "Clean metadata" );
     ProgressData progress(100);
     progress.sendTo(progressfnc);
 
@@ -1237,12 +1416,14 @@ namespace zypp
     progress.sendTo(progressfnc);
 
     filesystem::recursive_rmdir(packagescache_path_for_repoinfo(_options, info));
+    repo::PackageStore().cleanup();
     progress.toMax();
   }
 
 
   void RepoManager::Impl::buildCache( const RepoInfo & info, CacheBuildPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
   {
+    ZYppFactory::instance().assertWritable( "Build cache" );
     assert_alias(info);
     Pathname mediarootpath = rawcache_path_for_repoinfo( _options, info );
     Pathname productdatapath = rawproductdata_path_for_repoinfo( _options, info );
@@ -1341,12 +1522,15 @@ namespace zypp
         // Take care we unlink the solvfile on exception
         ManagedFile guard( solvfile, filesystem::unlink );
         scoped_ptr<MediaMounter> forPlainDirs;
+        // Other processes may have the solvfile mmapped (sat::openSolvFile):
+        // never rewrite it in place, but write a new one and rename it.
+        filesystem::TmpFile tmpsolv( filesystem::TmpFile::makeSibling( solvfile ) );
 
         ExternalProgram::Arguments cmd;
         cmd.push_back( PathInfo( "/usr/bin/repo2solv" ).isFile() ? "repo2solv" : "repo2solv.sh" );
         // repo2solv expects -o as 1st arg!
         cmd.push_back( "-o" );
-        cmd.push_back( solvfile.asString() );
+        cmd.push_back( tmpsolv.path().asString() );
 	cmd.push_back( "-X" );	// autogenerate pattern from pattern-package
 
         if ( repokind == RepoType::RPMPLAINDIR )
@@ -1360,6 +1544,8 @@ namespace zypp
         else
           cmd.push_back( productdatapath.asString() );
 
+        debug::TraceSpan span( "repo", "repo2solv" );
+        span.tag( "repo", info.alias() );
         ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
         std::string errdetail;
 
@@ -1380,8 +1566,15 @@ namespace zypp
           ZYPP_THROW(ex);
         }
 
+        ret = filesystem::rename( tmpsolv.path(), solvfile );
+        if ( ret != 0 )
+          ZYPP_THROW(RepoException(str::form( _("Failed to cache repo (%d)."), ret )));
+        // if this fails, don't bother throwing exceptions
+        filesystem::chmod( solvfile, 0644 );
+
         // We keep it.
         guard.resetDispose();
+	sat::splitSolvFile( solvfile );		// heavy attributes are loaded on demand
 	sat::updateSolvFileIndex( solvfile );	// content digest for zypper bash completion
       }
       break;
@@ -1561,6 +1754,7 @@ namespace zypp
 
   void RepoManager::Impl::cleanCache( const RepoInfo & info, const ProgressData::ReceiverFnc & progressrcv )
   {
+    ZYppFactory::instance().assertWritable( "Clean cache" );
     ProgressData progress(100);
     progress.sendTo(progressrcv);
     progress.toMin();
@@ -2018,20 +2212,32 @@ namespace zypp
     // copy the set of services since refreshService
     // can eventually invalidate the iterator
     ServiceSet services( serviceBegin(), serviceEnd() );
+
+    // Fetch the repo lists concurrently. Applying them to the system
+    // remains serial and in service order.
+    std::vector<ServiceInfo> toPrefetch;
+    for ( const ServiceInfo & service : services )
+    {
+      if ( service.enabled() && service.type() != ServiceType::NONE && ! serviceTtlValid( service, options_r ) )
+	toPrefetch.push_back( service );
+    }
+    ServicePrefetchMap prefetched( prefetchServices( _options.rootDir, toPrefetch, servicesTargetDistro(), env::ZYPP_SERVICE_REFRESH_JOBS() ) );
+
     for_( it, services.begin(), services.end() )
     {
       if ( !it->enabled() )
         continue;
 
       try {
-	refreshService(*it, options_r);
+	ServicePrefetchMap::const_iterator pit( prefetched.find( it->alias() ) );
+	refreshService( it->alias(), options_r, ( pit == prefetched.end() ? nullptr : &pit->second ) );
       }
       catch ( const repo::ServicePluginInformalException & e )
       { ;/* ignore ServicePluginInformalException */ }
     }
   }
 
-  void RepoManager::Impl::refreshService( const std::string & alias, const RefreshServiceOptions & options_r )
+  void RepoManager::Impl::refreshService( const std::string & alias, const RefreshServiceOptions & options_r, const ServicePrefetch * prefetch_r )
   {
     ServiceInfo service( getService( alias ) );
     assert_alias( service );
@@ -2076,30 +2282,32 @@ namespace zypp
       }
     }
 
-    // get target distro identifier
-    std::string servicesTargetDistro = _options.servicesTargetDistro;
-    if ( servicesTargetDistro.empty() )
-    {
-      servicesTargetDistro = Target::targetDistribution( Pathname() );
-    }
-    DBG << "ServicesTargetDistro: " << servicesTargetDistro << endl;
-
     // parse it
     Date::Duration origTtl = service.ttl();	// FIXME Ugly hack: const service.ttl modified when parsing
-    RepoCollector collector(servicesTargetDistro);
+    RepoCollector collector;
     // FIXME Ugly hack: ServiceRepos may throw ServicePluginInformalException
     // which is actually a notification. Using an exception for this
     // instead of signal/callback is bad. Needs to be fixed here, in refreshServices()
     // and in zypper.
     std::pair<DefaultIntegral<bool,false>, repo::ServicePluginInformalException> uglyHack;
     try {
-      // FIXME bsc#1080693: Shortcoming of (plugin)services (and repos as well) is that they
-      // are not aware of the RepoManagers rootDir. The service url, as created in known_services,
-      // contains the full path to the script. The script however has to be executed chrooted.
-      // Repos would need to know the RepoMangers rootDir to use the correct vars.d to replace
-      // repos variables. Until RepoInfoBase is aware if the rootDir, we need to explicitly pass it
-      // to ServiceRepos.
-      ServiceRepos( _options.rootDir, service, bind( &RepoCollector::collect, &collector, _1 ) );
+      if ( prefetch_r && service.type() != ServiceType::NONE )
+      {
+	DBG << "Use prefetched repos of service '" << service.alias() << "'" << endl;
+	collector.repos = prefetch_r->repos;
+	service.setProbedTtl( prefetch_r->ttl );
+      }
+      else
+      {
+	collector.targetDistro = servicesTargetDistro();
+	// FIXME bsc#1080693: Shortcoming of (plugin)services (and repos as well) is that they
+	// are not aware of the RepoManagers rootDir. The service url, as created in known_services,
+	// contains the full path to the script. The script however has to be executed chrooted.
+	// Repos would need to know the RepoMangers rootDir to use the correct vars.d to replace
+	// repos variables. Until RepoInfoBase is aware if the rootDir, we need to explicitly pass it
+	// to ServiceRepos.
+	ServiceRepos( _options.rootDir, service, bind( &RepoCollector::collect, &collector, _1 ) );
+      }
     }
     catch ( const repo::ServicePluginInformalException & e )
     {
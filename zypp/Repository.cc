@@ -321,14 +321,13 @@ namespace zypp
     {
       NO_REPOSITORY_THROW( Exception( "Can't add solvables to norepo." ) );
 
-      AutoDispose<FILE*> file( ::fopen( file_r.c_str(), "re" ), ::fclose );
+      AutoDispose<FILE*> file( sat::openSolvFile( file_r ) );
       if ( file == NULL )
       {
-        file.resetDispose();
         ZYPP_THROW( Exception( "Can't open solv-file: "+file_r.asString() ) );
       }
 
-      if ( myPool()._addSolv( _repo, file ) != 0 )
+      if ( myPool()._addSolv( _repo, file, file_r ) != 0 )
       {
         ZYPP_THROW( Exception( "Error reading solv-file: "+file_r.asString() ) );
       }
@@ -281,6 +281,9 @@ namespace zypp
          * \throws Exception if this is \ref noRepository
          * \throws Exception if loading the solv-file fails.
          * \see \ref Pool::addRepoSolv and \ref Repository::EraseFromPool
+         *
+         * Attributes moved into a separate file by \ref sat::splitSolvFile
+         * are loaded on demand (from the solv-files directory).
          */
         void addSolv( const Pathname & file_r );
 
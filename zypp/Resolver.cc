@@ -15,6 +15,7 @@
 
 #include "zypp/Resolver.h"
 #include "zypp/ZConfig.h"
+#include "zypp/ZYppFactory.h"
 #include "zypp/TriBool.h"
 #include "zypp/solver/detail/Resolver.h"
 #include "zypp/solver/detail/Testcase.h"
@@ -31,6 +32,24 @@ namespace zypp
 
   IMPL_PTR_TYPE(Resolver);
 
+  ///////////////////////////////////////////////////////////////////
+  namespace
+  {
+    /** Start (or cancel) the package prefetch for a new solution (zypp.conf:download.prefetch_packages). */
+    inline bool prefetchSolution( bool solved_r )
+    {
+      if ( ZConfig::instance().download_prefetchPackages() )
+      {
+        if ( solved_r )
+          getZYpp()->prefetchPackages();
+        else
+          getZYpp()->cancelPackagePrefetch();
+      }
+      return solved_r;
+    }
+  } // namespace
+  ///////////////////////////////////////////////////////////////////
+
   ///////////////////////////////////////////////////////////////////
   //
   //	METHOD NAME : Resolver::Resolver
@@ -57,10 +76,10 @@ namespace zypp
   { return _pimpl->verifySystem(); }
 
   bool Resolver::resolvePool ()
-  { return _pimpl->resolvePool(); }
+  { return prefetchSolution( _pimpl->resolvePool() ); }
 
   bool Resolver::resolveQueue( solver::detail::SolverQueueItemList & queue )
-  { return _pimpl->resolveQueue(queue); }
+  { return prefetchSolution( _pimpl->resolveQueue(queue) ); }
 
   void Resolver::undo()
   { _pimpl->undo(); }
@@ -75,7 +94,7 @@ namespace zypp
   { return _pimpl->getTransaction(); }
 
   bool Resolver::doUpgrade()
-  { return _pimpl->doUpgrade(); }
+  { return prefetchSolution( _pimpl->doUpgrade() ); }
 
   void Resolver::doUpdate()
   { _pimpl->doUpdate(); }
@@ -152,6 +171,12 @@ namespace zypp
     return testcase.createTestcase(*_pimpl, true, runSolver);
   }
 
+  bool Resolver::createSolvTestcase( const std::string & dumpPath, bool async )
+  {
+    solver::detail::Testcase testcase (dumpPath);
+    return testcase.createSolvTestcase(*_pimpl, async);
+  }
+
   solver::detail::ItemCapKindList Resolver::isInstalledBy( const PoolItem & item )
   { return _pimpl->isInstalledBy (item); }
 
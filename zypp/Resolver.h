@@ -374,6 +374,21 @@ namespace zypp
      */
     bool createSolverTestcase( const std::string & dumpPath = "/var/log/YaST2/solverTestcase", bool runSolver = true );
 
+    /**
+     * Generates a libsolv testcase of the last solver run
+     *
+     * Much faster than \ref createSolverTestcase: the pool is written as
+     * binary solv files (unchanged repo caches are hardlinked) and the job
+     * as libsolv \c testcase.t file, to be replayed using \c testsolv.
+     * The files are written in background if \a async is \c true. Set
+     * \c ZYPP_SOLVTESTCASE=1 to have a testcase written after each failed
+     * solver run.
+     *
+     * \param dumpPath destination directory of the created directory
+     * \return true if it was successful
+     */
+    bool createSolvTestcase( const std::string & dumpPath = "/var/log/YaST2/solvTestcase", bool async = false );
+
     /**
      * Gives information about WHO has pused an installation of an given item.
      *
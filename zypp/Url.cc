@@ -14,9 +14,11 @@
 #include "zypp/Pathname.h"
 #include "zypp/base/Gettext.h"
 #include "zypp/base/String.h"
-#include "zypp/base/Regex.h"
 #include <stdexcept>
 #include <iostream>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
 
 
 //////////////////////////////////////////////////////////////////////
@@ -30,12 +32,11 @@ namespace zypp
   // -----------------------------------------------------------------
   /*
    * url       = [scheme:] [//authority] /path [?query] [#fragment]
+   *
+   * Split as by the regex (see splitUrl):
+   *
+   *   ^([^:/?#]+:|)(//[^/?#]*|)([^?#]*)([?][^#]*|)(#.*|)
    */
-  #define RX_SPLIT_URL                       "^([^:/?#]+:|)" \
-                                             "(//[^/?#]*|)"  \
-                                             "([^?#]*)"        \
-                                             "([?][^#]*|)"   \
-                                             "(#.*|)"
 
 
   ////////////////////////////////////////////////////////////////////
@@ -272,6 +273,105 @@ namespace zypp
       return _v;
     }
 
+
+    // ---------------------------------------------------------------
+    /*
+     * Split an encoded url into its raw components (the scheme
+     * without ':', the authority without '//', ...). Like matching
+     * RX_SPLIT_URL, scanning stops at a NUL char. Never fails.
+     */
+    void splitUrl(const std::string &encodedUrl,
+                  std::string &scheme, std::string &authority,
+                  std::string &path, std::string &query,
+                  std::string &fragment)
+    {
+      const char *beg = encodedUrl.c_str();
+      const char *end = beg + ::strlen(beg);
+      const char *p   = beg;
+
+      // ([^:/?#]+:|)
+      while( p != end && *p != ':' && *p != '/' && *p != '?' && *p != '#')
+        ++p;
+      if( p != end && *p == ':' && p != beg)
+      {
+        scheme.assign(beg, p);
+        beg = ++p;
+      }
+      else
+        p = beg;
+
+      // (//[^/?#]*|)
+      if( end - p >= 2 && p[0] == '/' && p[1] == '/')
+      {
+        for( p += 2; p != end && *p != '/' && *p != '?' && *p != '#'; ++p )
+        {}
+        authority.assign(beg + 2, p);
+        beg = p;
+      }
+
+      // ([^?#]*)
+      while( p != end && *p != '?' && *p != '#')
+        ++p;
+      path.assign(beg, p);
+
+      // ([?][^#]*|) - a lone '?' is kept
+      if( p != end && *p == '?')
+      {
+        beg = p++;
+        while( p != end && *p != '#')
+          ++p;
+        query.assign(p - beg > 1 ? beg + 1 : beg, p);
+      }
+
+      // (#.*|) - a lone '#' is kept
+      if( p != end)
+        fragment.assign(end - p > 1 ? p + 1 : p, end);
+    }
+
+
+    // ---------------------------------------------------------------
+    /*
+     * Recently parsed urls. Repositories, mirrors and services
+     * parse the same base urls over and over again. As UrlRef
+     * is copy on write, the parsed object can be shared.
+     */
+    class ParsedUrlCache
+    {
+    public:
+      static const size_t maxEntries = 256;
+
+      UrlRef lookup(const std::string &encodedUrl)
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it( _urls.find(encodedUrl));
+        return it == _urls.end() ? UrlRef() : it->second;
+      }
+
+      void remember(const std::string &encodedUrl, const UrlRef &url)
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if( _urls.size() >= maxEntries)
+          _urls.clear();
+        _urls[encodedUrl] = url;
+      }
+
+      void clear()
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _urls.clear();
+      }
+
+    private:
+      std::mutex                             _mutex;
+      std::unordered_map<std::string,UrlRef> _urls;
+    };
+
+    ParsedUrlCache & g_parsedUrlCache()
+    {
+      static ParsedUrlCache _v;
+      return _v;
+    }
+
     //////////////////////////////////////////////////////////////////
   } // anonymous namespace
   ////////////////////////////////////////////////////////////////////
@@ -360,6 +460,8 @@ namespace zypp
   Url::registerScheme(const std::string &scheme,
                       UrlRef            urlImpl)
   {
+    // cached urls may use the former implementation
+    g_parsedUrlCache().clear();
     return g_urlSchemeRepository().addUrlByScheme(scheme, urlImpl);
   }
 
@@ -369,41 +471,22 @@ namespace zypp
   UrlRef
   Url::parseUrl(const std::string &encodedUrl)
   {
-    UrlRef      url;
-    str::smatch out;
-    bool        ret = false;
+    UrlRef url( g_parsedUrlCache().lookup(encodedUrl));
+    if( url)
+      return url;
 
-    try
-    {
-      str::regex  rex(RX_SPLIT_URL);
-      ret = str::regex_match(encodedUrl, out, rex);
-    }
-    catch( ... )
-    {}
+    std::string scheme, authority, path, query, fragment;
+    splitUrl(encodedUrl, scheme, authority, path, query, fragment);
 
-    if(ret && out.size() == 6)
+    url = g_urlSchemeRepository().getUrlByScheme(scheme);
+    if( !url)
     {
-      std::string scheme = out[1];
-      if (scheme.size() > 1)
-        scheme = scheme.substr(0, scheme.size()-1);
-      std::string authority = out[2];
-      if (authority.size() >= 2)
-        authority = authority.substr(2);
-      std::string query = out[4];
-      if (query.size() > 1)
-        query = query.substr(1);
-      std::string fragment = out[5];
-      if (fragment.size() > 1)
-        fragment = fragment.substr(1);
-
-      url = g_urlSchemeRepository().getUrlByScheme(scheme);
-      if( !url)
-      {
-        url.reset( new UrlBase());
-      }
-      url->init(scheme, authority, out[3],
-                query, fragment);
+      url.reset( new UrlBase());
     }
+    url->init(scheme, authority, path,
+              query, fragment);
+
+    g_parsedUrlCache().remember(encodedUrl, url);
     return url;
   }
 
@@ -322,6 +322,9 @@ namespace zypp
         , download_max_download_speed	( 0 )
         , download_max_silent_tries	( 5 )
         , download_transfer_timeout	( 180 )
+        , download_packageStoreSize	( 0 )
+        , download_mirrorScoreboard	( false )
+        , download_prefetchPackages	( false )
         , commit_downloadMode		( DownloadDefault )
 	, gpgCheck			( true )
 	, repoGpgCheck			( indeterminate )
@@ -470,6 +473,22 @@ namespace zypp
 		  if ( download_transfer_timeout < 0 )		download_transfer_timeout = 0;
 		  else if ( download_transfer_timeout > 3600 )	download_transfer_timeout = 3600;
                 }
+                else if ( entry == "download.package_store" )
+                {
+                  download_packageStorePath = Pathname(value);
+                }
+                else if ( entry == "download.package_store_size" )
+                {
+                  str::strtonum(value, download_packageStoreSize);
+                }
+                else if ( entry == "download.mirror_scoreboard" )
+                {
+                  download_mirrorScoreboard = str::strToBool( value, download_mirrorScoreboard );
+                }
+                else if ( entry == "download.prefetch_packages" )
+                {
+                  download_prefetchPackages = str::strToBool( value, download_prefetchPackages );
+                }
                 else if ( entry == "commit.downloadMode" )
                 {
                   commit_downloadMode.set( deserializeDownloadMode( value ) );
@@ -655,6 +674,11 @@ namespace zypp
     int download_max_silent_tries;
     int download_transfer_timeout;
 
+    Pathname download_packageStorePath;
+    unsigned download_packageStoreSize;	// MiB
+    bool download_mirrorScoreboard;
+    bool download_prefetchPackages;
+
     Option<DownloadMode> commit_downloadMode;
 
     DefaultOption<bool>		gpgCheck;
@@ -1019,6 +1043,18 @@ namespace zypp
   void ZConfig::set_download_mediaMountdir( Pathname newval_r )	{ _pimpl->download_mediaMountdir.set( std::move(newval_r) ); }
   void ZConfig::set_default_download_mediaMountdir()		{ _pimpl->download_mediaMountdir.restoreToDefault(); }
 
+  Pathname ZConfig::download_packageStorePath() const
+  { return _pimpl->download_packageStorePath; }
+
+  ByteCount ZConfig::download_packageStoreSize() const
+  { return ByteCount( _pimpl->download_packageStoreSize, ByteCount::MiB ); }
+
+  bool ZConfig::download_mirrorScoreboard() const
+  { return _pimpl->download_mirrorScoreboard; }
+
+  bool ZConfig::download_prefetchPackages() const
+  { return _pimpl->download_prefetchPackages; }
+
   DownloadMode ZConfig::commit_downloadMode() const
   { return _pimpl->commit_downloadMode; }
 
@@ -23,6 +23,7 @@
 #include "zypp/Arch.h"
 #include "zypp/Locale.h"
 #include "zypp/Pathname.h"
+#include "zypp/ByteCount.h"
 #include "zypp/IdString.h"
 #include "zypp/TriBool.h"
 
@@ -285,6 +286,31 @@ namespace zypp
       /** Reset to zypp.cong default. */
       void set_default_download_mediaMountdir();
 
+      /** Path of the content addressed package store shared by all repos and roots.
+       * Config option <tt>download.package_store</tt> (unset: store is disabled)
+       * \see \ref repo::PackageStore
+       */
+      Pathname download_packageStorePath() const;
+
+      /** Size limit of the package store (least recently used files are removed first).
+       * Config option <tt>download.package_store_size</tt> in MiB (0: no limit)
+       */
+      ByteCount download_packageStoreSize() const;
+
+      /** Whether to keep the per host download statistics used to rank
+       * mirrors (\ref media::MirrorScoreboard) across processes.
+       * They are saved in the repo cache directory.
+       * Config option <tt>download.mirror_scoreboard (false)</tt>
+       */
+      bool download_mirrorScoreboard() const;
+
+      /** Whether to download the packages to install in the background as
+       * soon as the resolver found a solution, while the application waits
+       * for the user to confirm the commit (\ref target::CommitPackagePrefetcher).
+       * Config option <tt>download.prefetch_packages (false)</tt>
+       */
+      bool download_prefetchPackages() const;
+
       /**
        * Commit download policy to use as default.
        */
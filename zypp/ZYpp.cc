@@ -77,6 +77,12 @@ namespace zypp
   ZYppCommitResult ZYpp::commit( const ZYppCommitPolicy & policy_r )
   { return _pimpl->commit( policy_r ); }
 
+  void ZYpp::prefetchPackages()
+  { _pimpl->prefetchPackages(); }
+
+  void ZYpp::cancelPackagePrefetch()
+  { _pimpl->cancelPackagePrefetch(); }
+
   void ZYpp::installSrcPackage( const SrcPackage_constPtr & srcPackage_r )
   { _pimpl->installSrcPackage( srcPackage_r ); }
 
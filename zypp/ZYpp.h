@@ -115,6 +115,18 @@ namespace zypp
     */
     ZYppCommitResult commit( const ZYppCommitPolicy & policy_r );
 
+    /** Download the packages to install in the resolvers current solution
+     * into the package cache in the background, while waiting for the user
+     * to confirm the \ref commit. A prefetch of a different solution is
+     * cancelled. Done automatically after solving if
+     * \ref ZConfig::download_prefetchPackages is set.
+     * \see \ref target::CommitPackagePrefetcher
+     */
+    void prefetchPackages();
+
+    /** Stop downloading packages in the background. */
+    void cancelPackagePrefetch();
+
     /** Install a source package on the Target.
      * \throws Exception
      */
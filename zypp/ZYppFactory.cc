@@ -35,6 +35,7 @@ extern "C"
 using boost::interprocess::file_lock;
 using boost::interprocess::scoped_lock;
 using boost::interprocess::sharable_lock;
+using boost::interprocess::try_to_lock;
 
 using std::endl;
 
@@ -89,6 +90,12 @@ namespace zypp
   /// \class ZYppGlobalLock
   /// \brief Our broken global lock
   ///
+  /// A writer writes its pid into \c /var/run/zypp.pid (the lock
+  /// older versions know about). Additionally writers hold an exclusive,
+  /// readers a shared \c flock on \c /var/run/zypp.rwlock as long as
+  /// the lock exists. So readers run in parallel, but not while a writer
+  /// runs, and vice versa. Readers also respect the pid of an old writer
+  /// not using the reader/writer lock.
   ///////////////////////////////////////////////////////////////////
   class ZYppGlobalLock
   {
@@ -96,6 +103,8 @@ namespace zypp
     ZYppGlobalLock()
     : _zyppLockFilePath( env::ZYPP_LOCKFILE_ROOT() / "/var/run/zypp.pid" )
     , _zyppLockFile( NULL )
+    , _zyppRWLockFilePath( env::ZYPP_LOCKFILE_ROOT() / "/var/run/zypp.rwlock" )
+    , _zyppRWLockFileOpen( false )
     , _lockerPid( 0 )
     , _cleanLock( false )
     {
@@ -134,6 +143,12 @@ namespace zypp
     file_lock	_zyppLockFileLock;
     FILE *	_zyppLockFile;
 
+    Pathname	_zyppRWLockFilePath;
+    file_lock	_zyppRWLockFileLock;
+    bool	_zyppRWLockFileOpen;
+    sharable_lock<file_lock> _sharedLock;	// reader
+    scoped_lock<file_lock>   _exclusiveLock;	// writer
+
     pid_t	_lockerPid;
     std::string _lockerName;
     bool	_cleanLock;
@@ -224,6 +239,55 @@ namespace zypp
       return (pid_t)readpid;
     }
 
+    /** Try to get the reader/writer lock (kept until \ref unlockRW).
+     * \return \c false if a writer (or for \a shared_r \c false, a reader) holds it.
+     */
+    bool lockRW( bool shared_r )
+    {
+      if ( shared_r ? _sharedLock.owns() : _exclusiveLock.owns() )
+	return true;
+      unlockRW();
+
+      if ( ! _zyppRWLockFileOpen )
+      {
+	// file_lock requires an existing file
+	FILE * file = fopen( _zyppRWLockFilePath.c_str(), "a" );
+	if ( file == NULL )
+	  ZYPP_THROW( Exception( "Cant open " + _zyppRWLockFilePath.asString() ) );
+	fclose( file );
+	_zyppRWLockFileLock = file_lock( _zyppRWLockFilePath.c_str() );
+	_zyppRWLockFileOpen = true;
+      }
+
+      if ( shared_r )
+      {
+	_sharedLock = sharable_lock<file_lock>( _zyppRWLockFileLock, try_to_lock );
+	return _sharedLock.owns();
+      }
+      _exclusiveLock = scoped_lock<file_lock>( _zyppRWLockFileLock, try_to_lock );
+      return _exclusiveLock.owns();
+    }
+
+    void unlockRW()
+    {
+      if ( _sharedLock.owns() )
+	_sharedLock.unlock();
+      if ( _exclusiveLock.owns() )
+	_exclusiveLock.unlock();
+    }
+
+    /** Remember a running foreign writers pid (and name) or \c 0.
+     * Expects the lockfile to be open and locked.
+     */
+    pid_t readForeignLocker()
+    {
+      _lockerName.clear();
+      _lockerPid = readLockFile();
+      if ( _lockerPid == getpid() || ( _lockerPid && ! isProcessRunning( _lockerPid ) ) )
+	_lockerPid = 0;
+      return _lockerPid;
+    }
+
     void writeLockFile()
     {
       clearerr( _zyppLockFile );
@@ -250,6 +314,16 @@ namespace zypp
       {
 	scoped_lock<file_lock> flock( _zyppLockFileLock );	// aquire write lock
 
+	if ( ! lockRW( /*shared*/false ) )
+	{
+	  // readers, or a writer (which has not yet written its pid)
+	  if ( ! readForeignLocker() )
+	    WAR << "Processes holding a shared ZYpp lock are running. Sorry." << std::endl;
+	  else
+	    WAR << _lockerPid << " is running and has a ZYpp lock. Sorry." << std::endl;
+	  return true;
+	}
+
 	_lockerPid = readLockFile();
 	if ( _lockerPid == 0 )
 	{
@@ -267,7 +341,9 @@ namespace zypp
 	  // a foreign pid in lock
 	  if ( isProcessRunning( _lockerPid ) )
 	  {
+	    // an old writer not using the reader/writer lock
 	    WAR << _lockerPid << " is running and has a ZYpp lock. Sorry." << std::endl;
+	    unlockRW();
 	    return true;
 	  }
 	  else
@@ -282,6 +358,33 @@ namespace zypp
       return true;
     }
 
+    /** Try to aquire a shared (read) lock.
+     * \return \c true if zypp is locked by a writer.
+     */
+    bool zyppSharedLocked()
+    {
+      if ( geteuid() != 0 )
+	return false;	// no lock as non-root
+
+      // Exception safe access to the lockfile.
+      ScopedGuard closeOnReturn( accessLockFile() );
+      {
+	scoped_lock<file_lock> flock( _zyppLockFileLock );	// writers must not change it meanwhile
+
+	bool locked = ! lockRW( /*shared*/true );
+	if ( readForeignLocker() )
+	  locked = true;	// an old writer not using the reader/writer lock
+	if ( locked )
+	{
+	  WAR << ( _lockerPid ? str::numstring( _lockerPid ) : std::string( "A writer" ) ) << " is running and has a ZYpp lock. Sorry." << std::endl;
+	  unlockRW();
+	  return true;
+	}
+	MIL << "Got a shared ZYpp lock (" << getpid() << ")" << std::endl;
+	return false;
+      }
+    }
+
   };
 
   ///////////////////////////////////////////////////////////////////
@@ -289,6 +392,7 @@ namespace zypp
   {
     static weak_ptr<ZYpp>		_theZYppInstance;
     static scoped_ptr<ZYppGlobalLock>	_theGlobalLock;		// on/off in sync with _theZYppInstance
+    static bool				_theZYppReadOnly = false;	// _theZYppInstance was created by getZYppReadOnly
 
     ZYppGlobalLock & globalLock()
     {
@@ -351,10 +455,19 @@ namespace zypp
   ///////////////////////////////////////////////////////////////////
   //
   ZYpp::Ptr ZYppFactory::getZYpp() const
+  { return getZYpp( false ); }
+
+  ZYpp::Ptr ZYppFactory::getZYppReadOnly() const
+  { return getZYpp( true ); }
+
+  ZYpp::Ptr ZYppFactory::getZYpp( bool readOnly_r ) const
   {
     ZYpp::Ptr _instance = _theZYppInstance.lock();
     if ( ! _instance )
     {
+      auto locked = [readOnly_r]()->bool
+      { return readOnly_r ? globalLock().zyppSharedLocked() : globalLock().zyppLocked(); };
+
       if ( geteuid() != 0 )
       {
 	MIL << "Running as user. Skip creating " << globalLock().zyppLockFilePath() << std::endl;
@@ -363,7 +476,7 @@ namespace zypp
       {
 	MIL << "ZYPP_READONLY active." << endl;
       }
-      else if ( globalLock().zyppLocked() )
+      else if ( locked() )
       {
 	bool failed = true;
 	const long LOCK_TIMEOUT = str::strtonum<long>( getenv( "ZYPP_LOCK_TIMEOUT" ) );
@@ -374,12 +487,14 @@ namespace zypp
 	  Pathname procdir( "/proc"/str::numstring(globalLock().lockerPid()) );
 	  for ( long i = 0; i < LOCK_TIMEOUT; i += delay )
 	  {
-	    if ( PathInfo( procdir ).isDir() )	// wait for /proc/pid to disapear
+	    if ( globalLock().lockerPid() && PathInfo( procdir ).isDir() )	// wait for /proc/pid to disapear
 	      sleep( delay );
 	    else
 	    {
+	      if ( ! globalLock().lockerPid() )
+		sleep( delay );	// no pid to watch (e.g. readers): poll
 	      MIL << "Retry after " << i << " sec." << endl;
-	      failed = globalLock().zyppLocked();
+	      failed = locked();
 	      if ( failed )
 	      {
 		// another proc locked faster. maybe it ends fast as well....
@@ -396,11 +511,16 @@ namespace zypp
 	}
 	if ( failed )
 	{
-	  std::string t = str::form(_("System management is locked by the application with pid %d (%s).\n"
-				      "Close this application before trying again."),
-				      globalLock().lockerPid(),
-				      globalLock().lockerName().c_str()
-				    );
+	  std::string t;
+	  if ( globalLock().lockerPid() )
+	    t = str::form(_("System management is locked by the application with pid %d (%s).\n"
+			    "Close this application before trying again."),
+			    globalLock().lockerPid(),
+			    globalLock().lockerName().c_str()
+			  );
+	  else
+	    t = _("System management is locked by other applications.\n"
+		  "Close them before trying again.");
 	  ZYPP_THROW(ZYppFactoryException(t, globalLock().lockerPid(), globalLock().lockerName() ));
 	}
       }
@@ -410,6 +530,9 @@ namespace zypp
 	_theImplInstance.reset( new ZYpp::Impl );
       _instance.reset( new ZYpp( _theImplInstance ) );
       _theZYppInstance = _instance;
+      _theZYppReadOnly = readOnly_r;
+      if ( readOnly_r )
+	MIL << "ZYpp is read-only." << endl;
     }
 
     return _instance;
@@ -420,6 +543,15 @@ namespace zypp
   bool ZYppFactory::haveZYpp() const
   { return !_theZYppInstance.expired(); }
 
+  bool ZYppFactory::readOnly() const
+  { return haveZYpp() && _theZYppReadOnly; }
+
+  void ZYppFactory::assertWritable( const std::string & what_r ) const
+  {
+    if ( readOnly() )
+      ZYPP_THROW( Exception( what_r + ": not allowed, ZYpp holds just a shared (read-only) lock." ) );
+  }
+
   /******************************************************************
   **
   **	FUNCTION NAME : operator<<
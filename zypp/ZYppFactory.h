@@ -56,12 +56,34 @@ namespace zypp
     */
     ZYpp::Ptr getZYpp() const;
 
+    /** Like \ref getZYpp, but if the instance needs to be created, just a
+     * shared (read) lock is acquired. Many processes can hold a shared lock
+     * at the same time, but not while one holds the exclusive lock acquired
+     * by \ref getZYpp.
+     *
+     * Use it if you don't commit and don't write the repo caches
+     * (refresh, build or clean them). Otherwise these throw (see \ref readOnly).
+     * An existing instance is returned whatever lock it holds.
+     * \throw EXCEPTION In case we can't acquire a lock.
+     */
+    ZYpp::Ptr getZYppReadOnly() const;
+
     /** Whether the ZYpp instance is already created.*/
     bool haveZYpp() const;
 
+    /** Whether the ZYpp instance exists and was created by \ref getZYppReadOnly. */
+    bool readOnly() const;
+
+    /** Throw if the ZYpp instance is \ref readOnly; \a what_r is the
+     * attempted action to report.
+     */
+    void assertWritable( const std::string & what_r ) const;
+
   private:
     /** Default ctor. */
     ZYppFactory();
+
+    ZYpp::Ptr getZYpp( bool readOnly_r ) const;
   };
   ///////////////////////////////////////////////////////////////////
 
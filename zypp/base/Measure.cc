@@ -12,13 +12,19 @@
 extern "C"
 {
 #include <sys/times.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <time.h>
 #include <unistd.h>
 }
+#include <cstdlib>
 #include <iostream>
+#include <mutex>
 
 #include "zypp/base/Logger.h"
 #include "zypp/base/Measure.h"
 #include "zypp/base/String.h"
+#include "zypp/base/Json.h"
 
 using std::endl;
 
@@ -142,6 +148,7 @@ namespace zypp
       : _ident  ( ident_r )
       , _level  ( _glevel )
       , _seq    ( 0 )
+      , _span   ( "measure", ident_r )
       {
 	_glevel += "..";
         log() << _level << "START MEASURE(" << _ident << ")" << endl;
@@ -198,6 +205,7 @@ namespace zypp
       mutable unsigned _seq;
       mutable Tm       _elapsed;
       mutable Tm       _stop;
+      TraceSpan        _span;
     };
 
     std::string Measure::Impl::_glevel;
@@ -236,6 +244,154 @@ namespace zypp
     void Measure::stop()
     { _pimpl.reset(); }
 
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	CLASS NAME : TraceSpan
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    namespace
+    {
+      inline const char * envTraceFile()
+      {
+	const char * file = ::getenv( "ZYPP_TRACE" );
+	return file && *file ? file : nullptr;
+      }
+
+      /** The trace file name (initially $ZYPP_TRACE). */
+      std::string & traceFile()
+      {
+	static std::string _file( envTraceFile() ? envTraceFile() : "" );
+	return _file;
+      }
+
+      /** The trace file fd, -1 on error, -2 if not yet opened. */
+      int & traceFdRef()
+      {
+	static int _fd = -2;
+	return _fd;
+      }
+
+      std::mutex & traceMutex()
+      {
+	static std::mutex _mutex;
+	return _mutex;
+      }
+
+      /** The trace file opened on demand, -1 on error. */
+      int traceFd()
+      {
+	std::lock_guard<std::mutex> guard( traceMutex() );
+	int & fd( traceFdRef() );
+	if ( fd == -2 )
+	{
+	  if ( traceFile().empty() )
+	    return fd = -1;
+	  // Only the process creating the file writes the header.
+	  fd = ::open( traceFile().c_str(), O_WRONLY|O_CREAT|O_EXCL|O_APPEND|O_CLOEXEC, 0644 );
+	  if ( fd != -1 )
+	  {
+	    if ( ::write( fd, "[\n", 2 ) != 2 )	// trailing ']' is optional in the JSON array format
+	    {
+	      ERR << "Can't write trace file " << traceFile() << ": " << ::strerror( errno ) << endl;
+	      ::close( fd );
+	      return fd = -1;
+	    }
+	  }
+	  else if ( errno == EEXIST )
+	    fd = ::open( traceFile().c_str(), O_WRONLY|O_APPEND|O_CLOEXEC );
+	  if ( fd == -1 )
+	  {
+	    ERR << "Can't open trace file " << traceFile() << ": " << ::strerror( errno ) << endl;
+	    return fd;
+	  }
+	  MIL << "Writing trace spans to " << traceFile() << endl;
+	}
+	return fd;
+      }
+
+      /** Monotonic time in microseconds. */
+      inline long long nowUs()
+      {
+	struct timespec ts;
+	::clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+      }
+    } // namespace
+
+    std::atomic<bool> TraceSpan::_enabled( envTraceFile() != nullptr );
+
+    void TraceSpan::traceTo( const std::string & file_r )
+    {
+      std::lock_guard<std::mutex> guard( traceMutex() );
+      int & fd( traceFdRef() );
+      if ( fd >= 0 )
+	::close( fd );
+      fd = -2;
+      traceFile() = file_r;
+      _enabled = ! file_r.empty();
+    }
+
+    /** TraceSpan implementation. */
+    class TraceSpan::Impl
+    {
+    public:
+      Impl( const char * category_r, const char * name_r )
+      : _category( category_r )
+      , _name( name_r )
+      , _start( nowUs() )
+      {}
+
+      std::string asJSON( long long end_r ) const
+      {
+	str::Str ret;
+	ret << "{\"name\":" << json::toJSON( _name )
+	    << ",\"cat\":" << json::toJSON( _category )
+	    << ",\"ph\":\"X\""
+	    << ",\"pid\":" << ::getpid()
+	    << ",\"tid\":" << ::syscall( SYS_gettid )
+	    << ",\"ts\":" << _start
+	    << ",\"dur\":" << ( end_r - _start );
+	if ( ! _args.empty() )
+	  ret << ",\"args\":{" << _args << "}";
+	ret << "},\n";
+	return ret;
+      }
+
+      std::string _category;
+      std::string _name;
+      std::string _args;	//!< JSON key/value pairs
+      long long   _start;
+    };
+
+    void TraceSpan::start( const char * category_r, const char * name_r )
+    { _pimpl = new Impl( category_r, name_r ); }
+
+    void TraceSpan::addTag( const char * key_r, const std::string & val_r )
+    {
+      if ( ! _pimpl->_args.empty() )
+	_pimpl->_args += ',';
+      _pimpl->_args += json::toJSON( key_r );
+      _pimpl->_args += ':';
+      _pimpl->_args += json::toJSON( val_r );
+    }
+
+    void TraceSpan::finish()
+    {
+      // A single write() per event, so concurrent threads and processes don't mix lines.
+      std::string event( _pimpl->asJSON( nowUs() ) );
+      delete _pimpl;
+      _pimpl = nullptr;
+      int fd = traceFd();
+      if ( fd == -1 )
+	_enabled = false;
+      else if ( ::write( fd, event.c_str(), event.size() ) != ssize_t(event.size()) )
+      {
+	if ( _enabled.exchange( false ) )	// report it once
+	  ERR << "Can't write trace file " << traceFile() << ": " << ::strerror( errno ) << endl;
+      }
+    }
+
     /////////////////////////////////////////////////////////////////
   } // namespace debug
   ///////////////////////////////////////////////////////////////////
@@ -14,8 +14,11 @@
 
 #include <iosfwd>
 #include <string>
+#include <atomic>
 
+#include "zypp/base/NonCopyable.h"
 #include "zypp/base/PtrTypes.h"
+#include "zypp/base/String.h"
 
 ///////////////////////////////////////////////////////////////////
 namespace zypp
@@ -114,6 +117,73 @@ namespace zypp
     };
     ///////////////////////////////////////////////////////////////////
 
+    ///////////////////////////////////////////////////////////////////
+    /// \class TraceSpan
+    /// \brief Trace the time spent in a scope.
+    ///
+    /// If \c $ZYPP_TRACE names a file, each span is appended to it as
+    /// a Chrome trace event (JSON array format, viewable in \c chrome://tracing
+    /// or Perfetto) when it goes out of scope. An event carries the process and
+    /// thread id, start time and duration in microseconds, and the key/value
+    /// tags added to the span. Nesting is given by the times per thread.
+    /// Several processes may append to the same file.
+    ///
+    /// If tracing is disabled, a span costs a test of a static flag; the
+    /// tag values are not even converted to string.
+    ///
+    /// \code
+    ///   {
+    ///     debug::TraceSpan span( "rpm", "install" );
+    ///     span.tag( "package", filename );
+    ///     ...
+    ///   }
+    ///
+    ///   // {"name":"install","cat":"rpm","ph":"X","pid":1234,"tid":1234,"ts":...,"dur":...,"args":{"package":"..."}},
+    /// \endcode
+    /// \note A \ref Measure also creates a span (category "measure").
+    ///////////////////////////////////////////////////////////////////
+    class TraceSpan : private base::NonCopyable
+    {
+    public:
+      /** Start the span \a name_r of category \a category_r (if tracing is enabled). */
+      TraceSpan( const char * category_r, const char * name_r )
+      { if ( enabled() ) start( category_r, name_r ); }
+      /** \overload */
+      TraceSpan( const char * category_r, const std::string & name_r )
+      { if ( enabled() ) start( category_r, name_r.c_str() ); }
+
+      /** Dtor writes the span (if started). */
+      ~TraceSpan()
+      { if ( _pimpl ) finish(); }
+
+    public:
+      /** Add a key/value tag (\ref str::asString of \a val_r). */
+      template <class Tp>
+      TraceSpan & tag( const char * key_r, const Tp & val_r )
+      { if ( _pimpl ) addTag( key_r, str::asString( val_r ) ); return *this; }
+
+      /** Whether tracing is enabled (\c $ZYPP_TRACE). */
+      static bool enabled()
+      { return _enabled.load( std::memory_order_relaxed ); }
+
+      /** Trace to \a file_r instead of \c $ZYPP_TRACE (an empty path disables tracing).
+       * Call it while no spans are active.
+       */
+      static void traceTo( const std::string & file_r );
+
+    private:
+      void start( const char * category_r, const char * name_r );
+      void addTag( const char * key_r, const std::string & val_r );
+      void finish();
+
+      static std::atomic<bool> _enabled;	//!< cleared by any thread failing to write
+
+    public:
+      class Impl;
+    private:
+      Impl * _pimpl = nullptr;	//!< owned, deleted in finish; keeps the dtor inline
+    };
+
     /////////////////////////////////////////////////////////////////
   } // namespace debug
   ///////////////////////////////////////////////////////////////////
@@ -14,6 +14,9 @@ extern "C"
 #include <solv/repo.h>
 }
 
+#include <fnmatch.h>
+#include <cstring>
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -158,6 +161,261 @@ namespace zypp
                               : str::form(_("Invalid regular expression '%s'"), regex_r.c_str() ) )
   {}
 
+  ///////////////////////////////////////////////////////////////////
+  namespace
+  {
+    /** The longest run of literal chars in \a glob_r (\c ::fnmatch syntax).
+     * Anything following a bracket expression is ignored, as we don't
+     * parse them.
+     */
+    std::string longestLiteral( const std::string & glob_r )
+    {
+      std::string ret;
+      std::string run;
+      for ( std::string::size_type i = 0; i < glob_r.size(); ++i )
+      {
+	char ch = glob_r[i];
+	if ( ch == '*' || ch == '?' || ch == '[' )
+	{
+	  if ( run.size() > ret.size() )
+	    ret.swap( run );
+	  run.clear();
+	  if ( ch == '[' )
+	    return ret;
+	  continue;
+	}
+	if ( ch == '\\' && i+1 < glob_r.size() )
+	  ch = glob_r[++i];
+	run += ch;
+      }
+      if ( run.size() > ret.size() )
+	ret.swap( run );
+      return ret;
+    }
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class MultiMatcher
+    /// \brief Match a string against a set of search strings.
+    ///
+    /// The literal part of each search string is added to an Aho-Corasick
+    /// automaton, so a single pass over the string finds all candidates.
+    /// A candidate matches if it was found at the right position (STRING,
+    /// STRINGSTART, STRINGEND) or, for a glob, if \c ::fnmatch accepts the
+    /// whole string. The literal part of a glob is its longest run of
+    /// literal chars; globs without any are always passed to \c ::fnmatch.
+    ///
+    /// NOCASE folds ASCII chars only, like \c ::strcasecmp in the C locale.
+    ///////////////////////////////////////////////////////////////////
+    class MultiMatcher
+    {
+      /** Where a search string must be found to match. */
+      enum Anchor { EXACT, START, END, ANYWHERE, FNMATCH };
+
+      struct Pattern
+      {
+	Anchor      _anchor;
+	std::string _literal;	//!< (folded) literal part
+	std::string _glob;	//!< FNMATCH: the glob
+      };
+
+      struct Node
+      {
+	std::vector<std::pair<unsigned char,unsigned>> _next;	//!< children sorted by char
+	unsigned              _fail = 0;	//!< longest proper suffix also in the trie
+	unsigned              _dict = 0;	//!< next node on the fail chain having patterns
+	std::vector<unsigned> _patterns;	//!< patterns whose literal part ends here
+      };
+
+    public:
+      /** Ctor
+       * \throws MatchUnknownModeException if the mode is not supported.
+       */
+      MultiMatcher( const std::vector<std::string> & searchstrings_r, const Match & flags_r, const std::string & msg_r )
+      : _nocase( flags_r.test( Match::NOCASE ) )
+      , _nodes( 1 )
+      {
+	Anchor anchor = ANYWHERE;
+	switch ( flags_r.mode() )
+	{
+	  case Match::STRING:		anchor = EXACT;		break;
+	  case Match::STRINGSTART:	anchor = START;		break;
+	  case Match::STRINGEND:	anchor = END;		break;
+	  case Match::SUBSTRING:	anchor = ANYWHERE;	break;
+	  case Match::GLOB:		anchor = FNMATCH;	break;
+	  case Match::NOTHING:		return;	// matches nothing
+	  default:
+	    ZYPP_THROW( MatchUnknownModeException( flags_r, msg_r ) );
+	    break;
+	}
+
+	for ( const std::string & search : searchstrings_r )
+	{
+	  Pattern pattern { anchor, search, std::string() };
+	  if ( anchor == FNMATCH )
+	  {
+	    pattern._literal = longestLiteral( search );
+	    pattern._anchor = globAnchor( search, pattern._literal );
+	    if ( pattern._anchor == FNMATCH )
+	      pattern._glob = search;
+	  }
+	  if ( _nocase )
+	    pattern._literal = str::toLower( pattern._literal );
+
+	  if ( pattern._literal.empty() )
+	    _unanchored.push_back( std::move(pattern) );
+	  else
+	    addPattern( std::move(pattern) );
+	}
+	buildFailLinks();
+      }
+
+      /** Whether \a string_r matches any of the search strings. */
+      bool operator()( const char * string_r ) const
+      {
+	std::string folded;
+	if ( _nocase )
+	  folded = str::toLower( string_r );
+	const char * str = _nocase ? folded.c_str() : string_r;
+	size_t len = _nocase ? folded.size() : ::strlen( string_r );
+
+	unsigned node = 0;
+	for ( size_t end = 1; end <= len; ++end )
+	{
+	  node = step( node, str[end-1] );
+	  for ( unsigned hit = _nodes[node]._patterns.empty() ? _nodes[node]._dict : node; hit; hit = _nodes[hit]._dict )
+	  {
+	    for ( unsigned idx : _nodes[hit]._patterns )
+	    {
+	      if ( found( _patterns[idx], end, len, string_r ) )
+		return true;
+	    }
+	  }
+	}
+
+	for ( const Pattern & pattern : _unanchored )
+	{
+	  if ( pattern._anchor == FNMATCH ? fnmatch( pattern, string_r ) : ( pattern._anchor != EXACT || len == 0 ) )
+	    return true;
+	}
+	return false;
+      }
+
+    private:
+      /** A glob which is just its \a literal_r with leading and/or trailing '*'
+       * needs no \c ::fnmatch.
+       */
+      static Anchor globAnchor( const std::string & glob_r, const std::string & literal_r )
+      {
+	std::string::size_type begin = glob_r.find_first_not_of( '*' );
+	if ( begin == std::string::npos )
+	  return FNMATCH;
+	std::string::size_type end = glob_r.find_last_not_of( '*' ) + 1;
+	if ( glob_r.compare( begin, end - begin, literal_r ) != 0 )
+	  return FNMATCH;	// wildcards or escapes inside
+	if ( begin == 0 )
+	  return end == glob_r.size() ? EXACT : START;
+	return end == glob_r.size() ? END : ANYWHERE;
+      }
+
+      /** Whether \a pattern_r matches, its literal part ending at \a end_r. */
+      bool found( const Pattern & pattern_r, size_t end_r, size_t len_r, const char * string_r ) const
+      {
+	switch ( pattern_r._anchor )
+	{
+	  case EXACT:		return end_r == len_r && pattern_r._literal.size() == len_r;
+	  case START:		return end_r == pattern_r._literal.size();
+	  case END:		return end_r == len_r;
+	  case ANYWHERE:	return true;
+	  case FNMATCH:		return fnmatch( pattern_r, string_r );
+	}
+	return false;
+      }
+
+      bool fnmatch( const Pattern & pattern_r, const char * string_r ) const
+      { return ::fnmatch( pattern_r._glob.c_str(), string_r, _nocase ? FNM_CASEFOLD : 0 ) == 0; }
+
+      /** Child of \a node_r on \a ch_r or \c 0. */
+      unsigned child( unsigned node_r, unsigned char ch_r ) const
+      {
+	if ( ! node_r && ! _root.empty() )
+	  return _root[ch_r];
+	const auto & next( _nodes[node_r]._next );
+	auto it( std::lower_bound( next.begin(), next.end(), std::make_pair( ch_r, 0U ) ) );
+	return( it != next.end() && it->first == ch_r ? it->second : 0 );
+      }
+
+      /** Automaton transition. */
+      unsigned step( unsigned node_r, unsigned char ch_r ) const
+      {
+	while ( true )
+	{
+	  if ( unsigned next = child( node_r, ch_r ) )
+	    return next;
+	  if ( ! node_r )
+	    return 0;
+	  node_r = _nodes[node_r]._fail;
+	}
+      }
+
+      void addPattern( Pattern && pattern_r )
+      {
+	unsigned node = 0;
+	for ( unsigned char ch : pattern_r._literal )
+	{
+	  unsigned next = child( node, ch );
+	  if ( ! next )
+	  {
+	    next = _nodes.size();
+	    _nodes.emplace_back();
+	    auto & edges( _nodes[node]._next );
+	    edges.insert( std::lower_bound( edges.begin(), edges.end(), std::make_pair( ch, 0U ) ), std::make_pair( ch, next ) );
+	  }
+	  node = next;
+	}
+	_nodes[node]._patterns.push_back( _patterns.size() );
+	_patterns.push_back( std::move(pattern_r) );
+      }
+
+      /** Breadth first, so the fail node of a parent is always done. */
+      void buildFailLinks()
+      {
+	std::vector<unsigned> queue;
+	for ( const auto & edge : _nodes[0]._next )
+	  queue.push_back( edge.second );	// depth 1 fails to root
+
+	for ( size_t i = 0; i < queue.size(); ++i )
+	{
+	  const Node & parent( _nodes[queue[i]] );
+	  for ( const auto & edge : parent._next )
+	  {
+	    unsigned fail = parent._fail;
+	    while ( fail && ! child( fail, edge.first ) )
+	      fail = _nodes[fail]._fail;
+	    fail = child( fail, edge.first );
+
+	    Node & node( _nodes[edge.second] );
+	    node._fail = fail;
+	    node._dict = _nodes[fail]._patterns.empty() ? _nodes[fail]._dict : fail;
+	    queue.push_back( edge.second );
+	  }
+	}
+
+	// The root is the busiest node: direct lookup.
+	_root.assign( 256, 0 );
+	for ( const auto & edge : _nodes[0]._next )
+	  _root[edge.first] = edge.second;
+      }
+
+    private:
+      bool                  _nocase;
+      std::vector<Node>     _nodes;	//!< trie, [0] is the root
+      std::vector<unsigned> _root;	//!< root transitions by char
+      std::vector<Pattern>  _patterns;
+      std::vector<Pattern>  _unanchored;	//!< without literal part
+    };
+  } // namespace
+  ///////////////////////////////////////////////////////////////////
+
   ///////////////////////////////////////////////////////////////////
   /// \class StrMatcher::Impl
   /// \brief StrMatcher implementation.
@@ -175,13 +433,25 @@ namespace zypp
     , _flags( flags_r )
     {}
 
+    Impl( std::vector<std::string> searchstrings_r, const Match & flags_r )
+    : _search( str::join( searchstrings_r, "\n" ) )
+    , _flags( flags_r )
+    , _searchstrings( std::move(searchstrings_r) )
+    , _multiPattern( true )
+    {}
+
     ~Impl()
     { invalidate(); }
 
     /** Compile the pattern. */
     void compile() const
     {
-      if ( !_matcher )
+      if ( _multiPattern )
+      {
+	if ( !_multiMatcher )
+	  _multiMatcher.reset( new MultiMatcher( _searchstrings, _flags, _search ) );
+      }
+      else if ( !_matcher )
       {
 	if ( _flags.mode() == Match::OTHER )
 	  ZYPP_THROW( MatchUnknownModeException( _flags, _search ) );
@@ -198,7 +468,15 @@ namespace zypp
 
     /** Whether the pattern is already compiled. */
     bool isCompiled() const
-    { return _matcher != nullptr; }
+    { return _matcher != nullptr || _multiMatcher != nullptr; }
+
+    /** Whether this matches a set of search strings. */
+    bool isMultiPattern() const
+    { return _multiPattern; }
+
+    /** The search strings if \ref isMultiPattern. */
+    const std::vector<std::string> & searchstrings() const
+    { return _searchstrings; }
 
     /** Return whether string matches. */
     bool doMatch( const char * string_r ) const
@@ -207,6 +485,8 @@ namespace zypp
 
       if ( ! string_r )
 	return false; // NULL never matches
+      if ( _multiMatcher )
+	return (*_multiMatcher)( string_r );
       return ::datamatcher_match( _matcher.get(), string_r );
     }
 
@@ -216,7 +496,12 @@ namespace zypp
 
     /** Set a new searchstring. */
     void setSearchstring( std::string string_r )
-    { invalidate(); _search = std::move(string_r); }
+    {
+      invalidate();
+      _search = std::move(string_r);
+      _searchstrings.clear();
+      _multiPattern = false;
+    }
 
     /** The current search flags. */
     const Match & flags() const
@@ -233,23 +518,29 @@ namespace zypp
       if ( _matcher )
 	::datamatcher_free( _matcher.get() );
       _matcher.reset();
+      _multiMatcher.reset();
     }
 
   private:
     std::string _search;
     Match       _flags;
     mutable scoped_ptr< sat::detail::CDatamatcher> _matcher;
+    std::vector<std::string> _searchstrings;
+    bool _multiPattern = false;
+    mutable scoped_ptr<MultiMatcher> _multiMatcher;
 
   private:
     friend Impl * rwcowClone<Impl>( const Impl * rhs );
     /** clone for RWCOW_pointer */
     Impl * clone() const
-    { return new Impl( _search, _flags ); }
+    { return _multiPattern ? new Impl( _searchstrings, _flags ) : new Impl( _search, _flags ); }
   };
 
   /** \relates StrMatcher::Impl Stream output */
   inline std::ostream & operator<<( std::ostream & str, const StrMatcher::Impl & obj )
   {
+    if ( obj.isMultiPattern() )
+      return str << "[" << obj.searchstrings().size() << " searchstrings]{" << obj.flags() << "}";
     return str << "\"" << obj.searchstring() << "\"{" << obj.flags() << "}";
   }
 
@@ -289,12 +580,19 @@ namespace zypp
   : _pimpl( new Impl( std::move(search_r), Match(flags_r) ) )
   {}
 
+  StrMatcher::StrMatcher( const std::vector<std::string> & searchstrings_r, const Match & flags_r )
+  : _pimpl( new Impl( searchstrings_r, flags_r ) )
+  {}
+
   void StrMatcher::compile() const
   { return _pimpl->compile(); }
 
   bool StrMatcher::isCompiled() const
   { return _pimpl->isCompiled(); }
 
+  bool StrMatcher::isMultiPattern() const
+  { return _pimpl->isMultiPattern(); }
+
   bool StrMatcher::doMatch( const char * string_r ) const
   { return _pimpl->doMatch( string_r ); }
 
@@ -329,6 +627,7 @@ namespace zypp
   bool operator==( const StrMatcher & lhs, const StrMatcher & rhs )
   {
     return ( lhs.flags() == rhs.flags()
+          && lhs.isMultiPattern() == rhs.isMultiPattern()
           && lhs.searchstring() == rhs.searchstring() );
   }
 
@@ -337,6 +636,9 @@ namespace zypp
     if ( lhs.flags().get() != rhs.flags().get() )
       return ( lhs.flags().get() < rhs.flags().get() );
 
+    if ( lhs.isMultiPattern() != rhs.isMultiPattern() )
+      return rhs.isMultiPattern();
+
     return ( lhs.searchstring() < rhs.searchstring() );
   }
 
@@ -14,6 +14,7 @@
 
 #include <iosfwd>
 #include <string>
+#include <vector>
 
 #include "zypp/base/PtrTypes.h"
 #include "zypp/base/Exception.h"
@@ -292,6 +293,10 @@ namespace zypp
   ///  }
   /// \endcode
   ///
+  /// A \ref StrMatcher may also take a set of search strings and match
+  /// if any of them matches (see \ref isMultiPattern). This is much faster
+  /// than joining many strings into a single regex.
+  ///
   /// \Note Those flags are always set: <tt>REG_EXTENDED | REG_NOSUB | REG_NEWLINE</tt>
   ///////////////////////////////////////////////////////////////////
   class StrMatcher
@@ -332,6 +337,14 @@ namespace zypp
     /** \overload for rvalues */
     StrMatcher( std::string && search_r, int flags_r );
 
+    /** Ctor taking a set of search strings and \ref Match flags.
+     * Matches if any of the strings matches. Supported modes are \ref Match::STRING,
+     * \ref Match::STRINGSTART, \ref Match::STRINGEND, \ref Match::SUBSTRING and
+     * \ref Match::GLOB.
+     * \see \ref isMultiPattern
+     */
+    StrMatcher( const std::vector<std::string> & searchstrings_r, const Match & flags_r );
+
     /** Evaluate in a boolean context <tt>( ! searchstring().empty() )</tt>. */
     explicit operator bool() const
     { return !searchstring().empty(); }
@@ -381,6 +394,25 @@ namespace zypp
     /** Whether the \ref StrMatcher is already compiled. */
     bool isCompiled() const;
 
+    /** Whether this matches a set of search strings.
+     * The strings are matched by an Aho-Corasick automaton; globs are
+     * checked by \c ::fnmatch only if their longest literal part occurs
+     * in the string. So the time needed does not grow with the number of
+     * search strings. The \ref searchstring is then the search strings
+     * joined by newline. Setting a new \ref searchstring turns this back
+     * into an ordinary \ref StrMatcher.
+     *
+     * \note Unlike a regex, \ref Match::NOCASE folds ASCII chars only (like
+     * \c ::strcasecmp in the C locale), and a value spanning several lines is
+     * matched as a whole (a regex is compiled with \c REG_NEWLINE and anchors
+     * at each line). \ref PoolQuery keeps using the regex for \ref Match::NOCASE
+     * searches with non-ASCII strings.
+     *
+     * \note libsolv can't evaluate a multi-pattern \ref StrMatcher, so
+     * \ref sat::LookupAttr iterates all values and filters them itself.
+     */
+    bool isMultiPattern() const;
+
     /** Return whether string matches.
      * Compiles the \ref StrMatcher if this was not yet done.
      * \throws MatchException Any of the exceptions thrown by \ref StrMatcher::compile.
@@ -356,6 +356,16 @@ MediaAccess::setDeltafile( const Pathname & filename ) const
   _handler->setDeltafile( filename );
 }
 
+void
+MediaAccess::setChecksumTypes( const std::vector<std::string> & types ) const
+{
+  if ( !_handler ) {
+    ZYPP_THROW(MediaNotOpenException("setChecksumTypes"));
+  }
+
+  _handler->setChecksumTypes( types );
+}
+
 void
 MediaAccess::releaseFile( const Pathname & filename ) const
 {
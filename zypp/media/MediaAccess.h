@@ -16,6 +16,7 @@
 #include <map>
 #include <list>
 #include <string>
+#include <vector>
 
 #include "zypp/base/ReferenceCounted.h"
 #include "zypp/base/NonCopyable.h"
@@ -279,6 +280,11 @@ namespace zypp {
 	 */
 	void setDeltafile( const Pathname & filename ) const;
 
+	/**
+	 * set the checksum types to compute during the next download
+	 */
+	void setChecksumTypes( const std::vector<std::string> & types ) const;
+
     public:
 
 	/**
@@ -11,6 +11,9 @@
  */
 
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -18,10 +21,12 @@
 #include <vector>
 #include <iostream>
 #include <fstream>
+#include <functional>
 
 #include "zypp/media/MediaBlockList.h"
 #include "zypp/base/Logger.h"
 #include "zypp/base/String.h"
+#include "zypp/thread/RunTasks.h"
 
 using namespace std;
 using namespace zypp::base;
@@ -47,6 +52,13 @@ MediaBlockList::addBlock(off_t off, size_t size)
   return blocks.size() - 1;
 }
 
+void
+MediaBlockList::reserveBlocks(size_t nblks)
+{
+  blocks.reserve(nblks);
+  rsums.reserve(nblks);
+}
+
 void
 MediaBlockList::setFileChecksum(std::string ctype, int cl, unsigned char *c)
 {
@@ -270,6 +282,247 @@ fetchnext(FILE *fp, unsigned char *bp, size_t blksize, size_t pushback, unsigned
   return blksize - l;
 }
 
+// files smaller than two stripes are scanned sequentially
+#define REUSE_STRIPE_SIZE (8 * 1024 * 1024)
+
+// weak checksum of a whole window, a = sum(c[i]), b = sum((len - i) * c[i]).
+// unlike the rolling update the terms are independent, so the compiler
+// can vectorize the loop. used to (re)start the rolling sum.
+static inline void
+rsumWindow(const unsigned char *buf, size_t len, unsigned short &a_r, unsigned short &b_r)
+{
+  unsigned int a = 0, b = 0;
+  for (size_t i = 0; i < len; i++)
+    {
+      a += buf[i];
+      b += (unsigned int)(len - i) * buf[i];
+    }
+  a_r = a;
+  b_r = b;
+}
+
+// read len bytes at off, zero fill what is beyond EOF
+static bool
+preadFull(int fd, unsigned char *buf, size_t len, off_t off)
+{
+  while (len)
+    {
+      ssize_t r = pread(fd, buf, len, off);
+      if (r < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  return false;
+	}
+      if (r == 0)
+	{
+	  memset(buf, 0, len);
+	  break;
+	}
+      buf += r;
+      len -= r;
+      off += r;
+    }
+  return true;
+}
+
+unsigned int
+MediaBlockList::rsumValue(unsigned short a, unsigned short b) const
+{
+  if (rsumlen == 1)
+    return ((unsigned int)b & 255);
+  else if (rsumlen == 2)
+    return ((unsigned int)b & 65535);
+  else if (rsumlen == 3)
+    return ((unsigned int)a & 255) << 16 | ((unsigned int)b & 65535);
+  return ((unsigned int)a & 65535) << 16 | ((unsigned int)b & 65535);
+}
+
+std::vector<unsigned int>
+MediaBlockList::rsumHashTable(size_t blksize, unsigned int &hm) const
+{
+  size_t nblks = blocks.size();
+  hm = rsums.size() * 2;
+  while (hm & (hm - 1))
+    hm &= hm - 1;
+  hm = hm * 2 - 1;
+  if (hm < 16383)
+    hm = 16383;
+  vector<unsigned int> ht(hm + 1, 0);
+  for (unsigned int i = 0; i < rsums.size(); i++)
+    {
+      if (blocks[i].size != blksize && (i != nblks - 1 || rsumpad != blksize))
+	continue;
+      unsigned int r = rsums[i];
+      unsigned int h = r & hm;
+      unsigned int hh = 7;
+      while (ht[h])
+	h = (h + hh++) & hm;
+      ht[h] = i + 1;
+    }
+  return ht;
+}
+
+// multi-threaded variant of reuseBlocks for large files. the file is split
+// into stripes, each stripe is read together with an overlap of two blocks,
+// so that every window starting inside the stripe can be checked. the
+// workers only collect (block, file offset) pairs, the matching data is
+// written to wfp afterwards in stripe order. returns false if the
+// file should be scanned sequentially.
+bool
+MediaBlockList::reuseBlocksParallel(FILE *wfp, int fd, vector<bool> &found) const
+{
+  size_t nblks = blocks.size();
+  unsigned threads = zypp::thread::defaultThreadCount();
+  struct stat st;
+  if (threads < 2 || !nblks || fstat(fd, &st) || !S_ISREG(st.st_mode) || st.st_size < 2 * REUSE_STRIPE_SIZE)
+    return false;
+  off_t fsize = st.st_size;
+
+  // prime the digest library and check we know the checksum type,
+  // before the workers start using it
+  Digest dig;
+  if (!createDigest(dig))
+    return false;
+
+  typedef vector<pair<size_t, off_t> > Matches;
+  vector<function<void()> > tasks;
+  vector<Matches> matches;
+
+  if (rsumlen && !rsums.empty())
+    {
+      size_t blksize = blocks[0].size;
+      if (nblks == 1 && rsumpad && rsumpad > blksize)
+	blksize = rsumpad;
+      if (!blksize || blksize > REUSE_STRIPE_SIZE / 4)
+	return false;
+      unsigned int hm;
+      vector<unsigned int> ht = rsumHashTable(blksize, hm);
+      int sql = nblks > 1 && chksumlen < 16 ? 2 : 1;
+      size_t overlap = 2 * blksize;
+      off_t stripesize = REUSE_STRIPE_SIZE;
+      size_t nstripes = (fsize + stripesize - 1) / stripesize;
+      matches.resize(nstripes);
+
+      for (size_t stripe = 0; stripe < nstripes; stripe++)
+	tasks.push_back([this, &ht, &matches, hm, sql, overlap, stripesize, blksize, fsize, fd, nblks, stripe]()
+	  {
+	    Matches &m = matches[stripe];
+	    off_t begin = stripe * stripesize;
+	    size_t len = fsize - begin > stripesize ? stripesize : fsize - begin;
+	    vector<unsigned char> data(len + overlap);
+	    if (!preadFull(fd, &data[0], data.size(), begin))
+	      return;
+	    vector<bool> lfound(nblks);
+	    unsigned short a = 0, b = 0;
+	    bool init = true;
+	    for (size_t p = 0; p < len; p++)
+	      {
+		if (sql == 2 && begin + off_t(p + blksize) > fsize)
+		  break;
+		if (init)
+		  {
+		    rsumWindow(&data[p], blksize, a, b);
+		    init = false;
+		  }
+		else
+		  {
+		    unsigned short oc = data[p - 1];
+		    a += data[p - 1 + blksize] - oc;
+		    b += a - oc * blksize;
+		  }
+		unsigned int r = rsumValue(a, b);
+		unsigned int h = r & hm;
+		unsigned int hh = 7;
+		for (; ht[h]; h = (h + hh++) & hm)
+		  {
+		    size_t blkno = ht[h] - 1;
+		    if (rsums[blkno] != r || lfound[blkno])
+		      continue;
+		    if (sql == 2)
+		      {
+			if (blkno + 1 >= nblks)
+			  continue;
+			if (!checkRsum(blkno + 1, &data[p + blksize], blksize))
+			  continue;
+		      }
+		    if (!checkChecksum(blkno, &data[p], blksize))
+		      continue;
+		    if (sql == 2 && !checkChecksum(blkno + 1, &data[p + blksize], blksize))
+		      continue;
+		    m.push_back(make_pair(blkno, begin + p));
+		    lfound[blkno] = true;
+		    p += blksize;
+		    if (sql == 2)
+		      {
+			blkno++;
+			m.push_back(make_pair(blkno, begin + p));
+			lfound[blkno] = true;
+			p += blksize;
+		      }
+		    // the following blocks are likely to match, too
+		    while (p < len && blkno + 1 < nblks && !lfound[blkno + 1]
+			   && checkRsum(blkno + 1, &data[p], blksize)
+			   && checkChecksum(blkno + 1, &data[p], blksize))
+		      {
+			blkno++;
+			m.push_back(make_pair(blkno, begin + p));
+			lfound[blkno] = true;
+			p += blksize;
+		      }
+		    init = true;
+		    p--;	// for loop increments
+		    break;
+		  }
+	      }
+	  });
+    }
+  else if (chksumlen >= 16)
+    {
+      // no rolling checksum, just check the blocks at their offsets
+      size_t chunk = 256;
+      size_t nchunks = (nblks + chunk - 1) / chunk;
+      matches.resize(nchunks);
+      for (size_t c = 0; c < nchunks; c++)
+	tasks.push_back([this, &matches, fd, fsize, nblks, chunk, c]()
+	  {
+	    Matches &m = matches[c];
+	    vector<unsigned char> buf;
+	    size_t end = (c + 1) * chunk < nblks ? (c + 1) * chunk : nblks;
+	    for (size_t blkno = c * chunk; blkno < end; blkno++)
+	      {
+		size_t blksize = blocks[blkno].size;
+		if (blocks[blkno].off + off_t(blksize) > fsize)
+		  break;
+		buf.resize(blksize);
+		if (!blksize || !preadFull(fd, &buf[0], blksize, blocks[blkno].off))
+		  continue;
+		if (checkChecksum(blkno, &buf[0], blksize))
+		  m.push_back(make_pair(blkno, blocks[blkno].off));
+	      }
+	  });
+    }
+  else
+    return false;
+
+  zypp::thread::runTasks(tasks, threads);
+
+  // write back the found blocks, first match wins
+  vector<unsigned char> buf;
+  for (size_t i = 0; i < matches.size(); i++)
+    for (Matches::const_iterator it = matches[i].begin(); it != matches[i].end(); ++it)
+      {
+	size_t blkno = it->first;
+	if (found[blkno])
+	  continue;
+	size_t size = blocks[blkno].size;
+	buf.resize(size);
+	if (size && preadFull(fd, &buf[0], size, it->second))
+	  writeBlock(blkno, wfp, &buf[0], size, 0, found);
+      }
+  return true;
+}
+
 
 void
 MediaBlockList::reuseBlocks(FILE *wfp, string filename)
@@ -281,31 +534,18 @@ MediaBlockList::reuseBlocks(FILE *wfp, string filename)
   size_t nblks = blocks.size();
   vector<bool> found;
   found.resize(nblks + 1);
-  if (rsumlen && !rsums.empty())
+  if (reuseBlocksParallel(wfp, fileno(fp), found))
+    {
+      // large file, already scanned by the worker threads
+    }
+  else if (rsumlen && !rsums.empty())
     {
       size_t blksize = blocks[0].size;
       if (nblks == 1 && rsumpad && rsumpad > blksize)
 	blksize = rsumpad;
       // create hash of checksums
-      unsigned int hm = rsums.size() * 2;
-      while (hm & (hm - 1))
-	hm &= hm - 1;
-      hm = hm * 2 - 1;
-      if (hm < 16383)
-	hm = 16383;
-      unsigned int *ht = new unsigned int[hm + 1];
-      memset(ht, 0, (hm + 1) * sizeof(unsigned int));
-      for (unsigned int i = 0; i < rsums.size(); i++)
-	{
-	  if (blocks[i].size != blksize && (i != nblks - 1 || rsumpad != blksize))
-	    continue;
-	  unsigned int r = rsums[i];
-	  unsigned int h = r & hm;
-	  unsigned int hh = 7;
-	  while (ht[h])
-	    h = (h + hh++) & hm;
-	  ht[h] = i + 1;
-	}
+      unsigned int hm;
+      vector<unsigned int> ht = rsumHashTable(blksize, hm);
 
       unsigned char *buf = new unsigned char[blksize];
       unsigned char *buf2 = new unsigned char[blksize];
@@ -358,15 +598,7 @@ MediaBlockList::reuseBlocks(FILE *wfp, string filename)
 		    continue;
 		  init = 0;
 		}
-	      unsigned int r;
-	      if (rsumlen == 1)
-		r = ((unsigned int)b & 255);
-	      else if (rsumlen == 2)
-		r = ((unsigned int)b & 65535);
-	      else if (rsumlen == 3)
-		r = ((unsigned int)a & 255) << 16 | ((unsigned int)b & 65535);
-	      else
-		r = ((unsigned int)a & 65535) << 16 | ((unsigned int)b & 65535);
+	      unsigned int r = rsumValue(a, b);
 	      unsigned int h = r & hm;
 	      unsigned int hh = 7;
 	      for (; ht[h]; h = (h + hh++) & hm)
@@ -422,7 +654,6 @@ MediaBlockList::reuseBlocks(FILE *wfp, string filename)
 	}
       delete[] buf2;
       delete[] buf;
-      delete[] ht;
     }
   else if (chksumlen >= 16)
     {
@@ -456,7 +687,9 @@ MediaBlockList::reuseBlocks(FILE *wfp, string filename)
 	    writeBlock(blkno, wfp, buf, blksize, 0, found);
 	  off += blksize;
 	}
+      delete[] buf;
     }
+  fclose(fp);
   if (!found[nblks])
     return;
   // now throw out all of the blocks we found
@@ -50,6 +50,12 @@ public:
    **/
   size_t addBlock(off_t off, size_t size);
 
+  /**
+   * reserve space for nblks blocks (and their checksums) if the number
+   * of blocks to be added is known in advance.
+   **/
+  void reserveBlocks(size_t nblks);
+
   /**
    * return the offset/size of a block with number blkno
    **/
@@ -110,7 +116,9 @@ public:
 
   /**
    * scan a file for blocks from our blocklist. if we find a suitable block,
-   * it is removed from the list
+   * it is removed from the list.
+   * large files are split into overlapping stripes which are scanned
+   * and verified by a pool of worker threads.
    **/
   void reuseBlocks(FILE *wfp, std::string filename);
 
@@ -122,6 +130,9 @@ public:
 private:
   void writeBlock(size_t blkno, FILE *fp, const unsigned char *buf, size_t bufl, size_t start, std::vector<bool> &found) const;
   bool checkChecksumRotated(size_t blkno, const unsigned char *buf, size_t bufl, size_t start) const;
+  unsigned int rsumValue(unsigned short a, unsigned short b) const;
+  std::vector<unsigned int> rsumHashTable(size_t blksize, unsigned int &hm) const;
+  bool reuseBlocksParallel(FILE *wfp, int fd, std::vector<bool> &found) const;
 
   off_t filesize;
   std::string fsumtype;
@@ -25,6 +25,8 @@
 #include "zypp/media/MediaUserAuth.h"
 #include "zypp/media/CredentialManager.h"
 #include "zypp/media/CurlConfig.h"
+#include "zypp/media/MediaManager.h"
+#include "zypp/media/MirrorScoreboard.h"
 #include "zypp/thread/Once.h"
 #include "zypp/Target.h"
 #include "zypp/ZYppFactory.h"
@@ -181,6 +183,23 @@ namespace zypp {
   namespace media {
 
   namespace {
+    /** CURLOPT_WRITEDATA passing the file and a \ref CheckSumSink to \ref writeCallback. */
+    struct WriteData
+    {
+      FILE *	     file;
+      CheckSumSink * sink;
+    };
+
+    /** Write the data and feed them into the sink. */
+    size_t writeCallback( char * ptr, size_t size, size_t nmemb, void * userdata )
+    {
+      WriteData * data( reinterpret_cast<WriteData *>( userdata ) );
+      size_t cnt = ::fwrite( ptr, size, nmemb, data->file );
+      if ( cnt )
+	data->sink->update( ptr, cnt * size );
+      return cnt * size;
+    }
+
     struct ProgressData
     {
       ProgressData( CURL *_curl, time_t _timeout = 0, const Url & _url = Url(),
@@ -1180,6 +1199,57 @@ void MediaCurl::evaluateCurlCode( const Pathname &filename,
 
 ///////////////////////////////////////////////////////////////////
 
+void MediaCurl::reportMirrorHealth( CURLcode code, bool timeout ) const
+{
+  MirrorScoreboard & scoreboard( MediaManager::mirrorScoreboard() );
+  switch ( code )
+  {
+    case CURLE_OK:
+    {
+      double bytes = 0;
+      double total = 0;
+      double connect = 0;
+      double namelookup = 0;
+      curl_easy_getinfo( _curl, CURLINFO_SIZE_DOWNLOAD, &bytes );
+      curl_easy_getinfo( _curl, CURLINFO_TOTAL_TIME, &total );
+      curl_easy_getinfo( _curl, CURLINFO_CONNECT_TIME, &connect );
+      curl_easy_getinfo( _curl, CURLINFO_NAMELOOKUP_TIME, &namelookup );
+      // connect is 0 if an existing connection was reused
+      scoreboard.reportSuccess( _url, ByteCount( (ByteCount::SizeType)bytes ), total, connect > namelookup ? connect - namelookup : 0 );
+    }
+    break;
+
+    case CURLE_HTTP_RETURNED_ERROR:
+    {
+      long httpReturnCode = 0;
+      if ( curl_easy_getinfo( _curl, CURLINFO_RESPONSE_CODE, &httpReturnCode ) == CURLE_OK && httpReturnCode >= 500 )
+        scoreboard.reportFailure( _url );
+    }
+    break;
+
+    case CURLE_ABORTED_BY_CALLBACK:
+      if ( timeout )
+        scoreboard.reportFailure( _url );
+      break;
+
+    case CURLE_COULDNT_RESOLVE_HOST:
+    case CURLE_COULDNT_CONNECT:
+    case CURLE_OPERATION_TIMEDOUT:
+    case CURLE_PARTIAL_FILE:
+    case CURLE_GOT_NOTHING:
+    case CURLE_SEND_ERROR:
+    case CURLE_RECV_ERROR:
+    case CURLE_SSL_CONNECT_ERROR:
+      scoreboard.reportFailure( _url );
+      break;
+
+    default:
+      break;
+  }
+}
+
+///////////////////////////////////////////////////////////////////
+
 bool MediaCurl::doGetDoesFileExist( const Pathname & filename ) const
 {
   DBG << filename.asString() << endl;
@@ -1420,9 +1490,10 @@ void MediaCurl::doGetFileCopy( const Pathname & filename , const Pathname & targ
       curl_easy_setopt(_curl, CURLOPT_TIMECONDITION, CURL_TIMECOND_NONE);
       curl_easy_setopt(_curl, CURLOPT_TIMEVALUE, 0L);
     }
+    CheckSumSink sink( checksumTypes() );
     try
     {
-      doGetFileCopyFile(filename, dest, file, report, options);
+      doGetFileCopyFile(filename, dest, file, report, options, &sink);
     }
     catch (Exception &e)
     {
@@ -1471,6 +1542,7 @@ void MediaCurl::doGetFileCopy( const Pathname & filename , const Pathname & targ
         ERR << "Rename failed" << endl;
         ZYPP_THROW(MediaWriteException(dest));
       }
+      sink.commit( dest );
     }
     else
     {
@@ -1484,7 +1556,7 @@ void MediaCurl::doGetFileCopy( const Pathname & filename , const Pathname & targ
 
 ///////////////////////////////////////////////////////////////////
 
-void MediaCurl::doGetFileCopyFile( const Pathname & filename , const Pathname & dest, FILE *file, callback::SendReport<DownloadProgressReport> & report, RequestOptions options ) const
+void MediaCurl::doGetFileCopyFile( const Pathname & filename , const Pathname & dest, FILE *file, callback::SendReport<DownloadProgressReport> & report, RequestOptions options, CheckSumSink * sink ) const
 {
     DBG << filename.asString() << endl;
 
@@ -1518,7 +1590,18 @@ void MediaCurl::doGetFileCopyFile( const Pathname & filename , const Pathname &
       ZYPP_THROW(MediaCurlSetOptException(url, _curlError));
     }
 
-    ret = curl_easy_setopt( _curl, CURLOPT_WRITEDATA, file );
+    // Hash the data while they are written, if someone is interested
+    // in the checksum.
+    WriteData writeData = { file, sink };
+    bool hashing = sink && ! sink->empty();
+    if ( hashing )
+    {
+      ret = curl_easy_setopt( _curl, CURLOPT_WRITEFUNCTION, &writeCallback );
+      if ( ret == 0 )
+        ret = curl_easy_setopt( _curl, CURLOPT_WRITEDATA, &writeData );
+    }
+    else
+      ret = curl_easy_setopt( _curl, CURLOPT_WRITEDATA, file );
     if ( ret != 0 ) {
       ZYPP_THROW(MediaCurlSetOptException(url, _curlError));
     }
@@ -1557,6 +1640,13 @@ void MediaCurl::doGetFileCopyFile( const Pathname & filename , const Pathname &
     if ( curl_easy_setopt( _curl, CURLOPT_PROGRESSDATA, NULL ) != 0 ) {
       WAR << "Can't unset CURLOPT_PROGRESSDATA: " << _curlError << endl;;
     }
+    reportMirrorHealth( ret, progressData.reached );
+    if ( hashing )
+    {
+      // back to the default fwrite
+      curl_easy_setopt( _curl, CURLOPT_WRITEFUNCTION, (void *)0 );
+      curl_easy_setopt( _curl, CURLOPT_WRITEDATA, file );
+    }
 
     if ( ret != 0 )
     {
@@ -16,6 +16,7 @@
 #include "zypp/media/TransferSettings.h"
 #include "zypp/media/MediaHandler.h"
 #include "zypp/ZYppCallbacks.h"
+#include "zypp/CheckSumSink.h"
 
 #include <curl/curl.h>
 
@@ -149,7 +150,22 @@ class MediaCurl : public MediaHandler
      */
     void evaluateCurlCode( const zypp::Pathname &filename, CURLcode code, bool timeout ) const;
 
-    void doGetFileCopyFile( const Pathname & srcFilename, const Pathname & dest, FILE *file, callback::SendReport<DownloadProgressReport> & _report, RequestOptions options = OPTION_NONE ) const;
+    /**
+     * Report the outcome of the last transfer of \p _curl to the
+     * \ref MirrorScoreboard. Only failures the server is to blame for
+     * (connection errors, timeouts, server errors) are counted; missing
+     * files and user aborts are not.
+     * \p code Code curl returned
+     * \p timeout Whether we reached timeout (see \ref evaluateCurlCode)
+     */
+    void reportMirrorHealth( CURLcode code, bool timeout ) const;
+
+    /**
+     * Download \p srcFilename into \p file.
+     * If a \p sink is passed, the data are also fed into it while they
+     * are written (hash-while-write).
+     */
+    void doGetFileCopyFile( const Pathname & srcFilename, const Pathname & dest, FILE *file, callback::SendReport<DownloadProgressReport> & _report, RequestOptions options = OPTION_NONE, CheckSumSink * sink = 0 ) const;
 
   private:
     /**
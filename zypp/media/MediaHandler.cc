@@ -528,12 +528,11 @@ MediaHandler::checkAttached(bool matchMountFs) const
       else
         DBG << "Forced check of the mount table" << std::endl;
 
-      MountEntries entries( MediaManager::getMountEntries());
+      // at least the mount points must match
+      MountTable table( MountTable::current() );
+      MountEntries entries( table.entriesAt( ref.attachPoint->path ) );
       for_( e, entries.begin(), entries.end() )
       {
-	if ( ref.attachPoint->path != Pathname(e->dir) )
-	  continue;	// at least the mount points must match
-
         bool        is_device = false;
         PathInfo    dev_info;
         if( str::hasPrefix( Pathname(e->src).asString(), "/dev/" ) &&
@@ -630,13 +629,13 @@ MediaHandler::checkAttached(bool matchMountFs) const
       if( !_isAttached)
       {
         MIL << "Looking for " << ref << endl;
-	if( entries.empty() )
+	if( table.entries().empty() )
 	{
 	  ERR << "Unable to find any entry in the /etc/mtab file" << std::endl;
 	}
 	else
 	{
-          dumpRange( DBG << "MountEntries: ", entries.begin(), entries.end() ) << endl;
+          dumpRange( DBG << "MountEntries: ", table.entries().begin(), table.entries().end() ) << endl;
 	}
 	if( old_mtime > 0 )
 	{
@@ -1407,6 +1406,15 @@ Pathname MediaHandler::deltafile() const {
   return _deltafile;
 }
 
+void MediaHandler::setChecksumTypes( const std::vector<std::string> & types ) const
+{
+  _checksumTypes = types;
+}
+
+const std::vector<std::string> & MediaHandler::checksumTypes() const {
+  return _checksumTypes;
+}
+
   } // namespace media
 } // namespace zypp
 // vim: set ts=8 sts=2 sw=2 ai noet:
@@ -16,6 +16,7 @@
 #include <iosfwd>
 #include <string>
 #include <list>
+#include <vector>
 
 #include "zypp/Pathname.h"
 #include "zypp/PathInfo.h"
@@ -103,6 +104,9 @@ class MediaHandler {
 	/** file usable for delta downloads */
 	mutable Pathname _deltafile;
 
+	/** checksums to compute while downloading */
+	mutable std::vector<std::string> _checksumTypes;
+
     protected:
         /**
 	 * Url to handle
@@ -650,6 +654,17 @@ class MediaHandler {
 	 */
 	Pathname deltafile () const;
 
+        /*
+         * set the checksum types to compute while the next file is
+         * downloaded (see \ref CheckSumSink)
+         */
+	void setChecksumTypes( const std::vector<std::string> & types = std::vector<std::string>() ) const;
+
+	/*
+	 * return the checksum types set with setChecksumTypes()
+	 */
+	const std::vector<std::string> & checksumTypes() const;
+
     public:
 
 	/**
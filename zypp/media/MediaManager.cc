@@ -18,11 +18,13 @@
 #include "zypp/media/MediaManager.h"
 #include "zypp/media/MediaHandler.h"
 #include "zypp/media/Mount.h"
+#include "zypp/media/MirrorScoreboard.h"
 #include "zypp/thread/Mutex.h"
 #include "zypp/thread/MutexLock.h"
 
 #include "zypp/base/String.h"
 #include "zypp/base/Logger.h"
+#include "zypp/base/Measure.h"
 #include "zypp/Pathname.h"
 #include "zypp/PathInfo.h"
 
@@ -220,7 +222,7 @@ namespace zypp
       static inline MountEntries
       getMountEntries()
       {
-        return Mount::getEntries();
+        return MountTable::current().entries();
       }
 
     };
@@ -679,6 +681,8 @@ namespace zypp
 
       ref.checkDesired(accessId);
 
+      debug::TraceSpan span( "media", "provideFile" );
+      span.tag( "file", filename ).tag( "url", ref.handler->url() );
       ref.handler->provideFile(filename);
     }
 
@@ -696,6 +700,20 @@ namespace zypp
       ref.handler->setDeltafile(filename);
     }
 
+    // ---------------------------------------------------------------
+    void
+    MediaManager::setChecksumTypes(MediaAccessId   accessId,
+                                   const std::vector<std::string> &types ) const
+    {
+      MutexLock glock(g_Mutex);
+
+      ManagedMedia &ref( m_impl->findMM(accessId));
+
+      ref.checkDesired(accessId);
+
+      ref.handler->setChecksumTypes(types);
+    }
+
     // ---------------------------------------------------------------
     void
     MediaManager::provideDir(MediaAccessId   accessId,
@@ -889,32 +907,30 @@ namespace zypp
       //
       // check against system mount entries
       //
-      MountEntries  entries( m_impl->getMountEntries());
-      MountEntries::const_iterator e;
-      for( e = entries.begin(); e != entries.end(); ++e)
+      MountTable table( MountTable::current() );
+      if( table.isMountPoint( path ) )
       {
-        std::string mnt(Pathname(e->dir).asString());
-        std::string our(path.asString());
-
-        if( our == mnt)
-        {
-          // already used as mountpoint
-          return false;
-        }
-        else
-        if( mnt.size() > our.size()   &&
-            mnt.at(our.size()) == '/' &&
-           !mnt.compare(0, our.size(), our))
-        {
-          // mountpoint is bellow of path
-          // (would hide the content)
-          return false;
-        }
+        // already used as mountpoint
+        return false;
+      }
+      if( table.hasMountsBelow( path ) )
+      {
+        // mountpoint is bellow of path
+        // (would hide the content)
+        return false;
       }
 
       return true;
     }
 
+    // ---------------------------------------------------------------
+    MirrorScoreboard &
+    MediaManager::mirrorScoreboard()
+    {
+      static MirrorScoreboard _scoreboard;
+      return _scoreboard;
+    }
+
     // ---------------------------------------------------------------
     AttachedMedia
     MediaManager::getAttachedMedia(MediaAccessId &accessId) const
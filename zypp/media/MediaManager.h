@@ -21,6 +21,7 @@
 #include "zypp/Url.h"
 
 #include <list>
+#include <vector>
 
 
 //////////////////////////////////////////////////////////////////////
@@ -44,6 +45,7 @@ namespace zypp
     // forward declaration
     class MountEntry;
     class MediaManager_Impl;
+    class MirrorScoreboard;
 
     ///////////////////////////////////////////////////////////////////
     //
@@ -840,6 +842,16 @@ namespace zypp
       setDeltafile(MediaAccessId   accessId,
                   const Pathname &filename ) const;
 
+      /**
+       * Set the checksum types to compute while the next file is
+       * downloaded. Downloading handlers remember them for the
+       * downloaded file (see \ref CheckSumSink), so the file needs
+       * not to be read again to verify it.
+       */
+      void
+      setChecksumTypes(MediaAccessId   accessId,
+                       const std::vector<std::string> &types ) const;
+
     public:
       /**
        * Get the modification time of the /etc/mtab file.
@@ -868,6 +880,14 @@ namespace zypp
       isUseableAttachPoint(const Pathname &path,
                            bool            mtab=true) const;
 
+      /**
+       * The per host download statistics of this process,
+       * used to rank mirrors and alternate base urls.
+       * \see MirrorScoreboard
+       */
+      static MirrorScoreboard &
+      mirrorScoreboard();
+
     private:
       friend class MediaHandler;
 
@@ -11,6 +11,7 @@
 */
 
 #include <ctype.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <signal.h>
 #include <sys/wait.h>
@@ -25,7 +26,11 @@
 #include "zypp/ZConfig.h"
 #include "zypp/base/Logger.h"
 #include "zypp/media/MediaMultiCurl.h"
+#include "zypp/media/MediaManager.h"
+#include "zypp/media/MirrorScoreboard.h"
 #include "zypp/media/MetaLinkParser.h"
+#include "zypp/media/ZsyncParser.h"
+#include "zypp/TmpPath.h"
 
 using namespace std;
 using namespace zypp::base;
@@ -158,6 +163,7 @@ public:
   double _connect_timeout;
   double _maxspeed;
   int _maxworkers;
+  CheckSumSink *_sink;	// hash in sequence data while they arrive
 };
 
 #define BLKSIZE		131072
@@ -221,6 +227,14 @@ multifetchworker::writefunction(void *ptr, size_t size)
       _size -= len;
       return size;
     }
+  if (_request->_sink && _off < _request->_sink->size()
+      && !(_request->_blklist && _request->_blklist->haveChecksum(_blkno)))
+    {
+      // Overwriting already hashed data (competing or stolen block) which
+      // no block checksum verifies: the sink can't know which data is in
+      // the file, so the file must be hashed from disk.
+      _request->_sink->reset();
+    }
   if (fseeko(_request->_fp, _off, SEEK_SET))
     return size ? 0 : 1;
   cnt = fwrite(ptr, 1, len, _request->_fp);
@@ -229,6 +243,8 @@ multifetchworker::writefunction(void *ptr, size_t size)
       _request->_fetchedsize += cnt;
       if (_request->_blklist)
         _dig.update((const char *)ptr, cnt);
+      if (_request->_sink && _off == _request->_sink->size())
+        _request->_sink->update((const char *)ptr, cnt);
       _off += cnt;
       _size -= cnt;
       if (cnt == len)
@@ -811,6 +827,7 @@ multifetchrequest::multifetchrequest(const MediaMultiCurl *context, const Pathna
   _connect_timeout = 0;
   _maxspeed = 0;
   _maxworkers = 0;
+  _sink = 0;
   if (blklist)
     {
       for (size_t blkno = 0; blkno < blklist->numBlocks(); blkno++)
@@ -998,6 +1015,8 @@ multifetchrequest::run(std::vector<Url> &urllist)
 	    }
 	  XXX << "#" << worker->_workerno << ": BLK " << worker->_blkno << " done code " << cc << " speed " << worker->_avgspeed << endl;
 	  curl_multi_remove_handle(_multi, easy);
+	  if (cc != 0)
+	    worker->reportMirrorHealth(cc, false);
 	  if (cc == CURLE_HTTP_RETURNED_ERROR)
 	    {
 	      long statuscode = 0;
@@ -1030,11 +1049,15 @@ multifetchrequest::run(std::vector<Url> &urllist)
 	      if (!worker->checkChecksum())
 		{
 		  WAR << "#" << worker->_workerno << ": checksum error, disable worker" << endl;
+		  MediaManager::mirrorScoreboard().reportFailure(worker->_url);
+		  if (_sink && worker->_blkstart < _sink->size())
+		    _sink->reset();	// maybe hashed bad data, start over at the end
 		  worker->_state = WORKER_BROKEN;
 		  strncpy(worker->_curlError, "checksum error", CURL_ERROR_SIZE);
 		  _activeworkers--;
 		  continue;
 		}
+	      worker->reportMirrorHealth(cc, false);
 	      if (worker->_state == WORKER_FETCH)
 		{
 		  if (worker->_competing)
@@ -1046,6 +1069,8 @@ multifetchrequest::run(std::vector<Url> &urllist)
 		      if (!worker->recheckChecksum())
 			{
 			  XXX << "#" << worker->_workerno << ": recheck checksum error, refetch block" << endl;
+			  if (_sink && worker->_blkstart < _sink->size())
+			    _sink->reset();
 			  // re-fetch! No need to worry about the bad workers,
 			  // they will now be set to DISCARD. At the end of their block
 			  // they will notice that they wrote bad data and go into BROKEN.
@@ -1158,6 +1183,7 @@ MediaMultiCurl::MediaMultiCurl(const Url &url_r, const Pathname & attach_point_h
   MIL << "MediaMultiCurl::MediaMultiCurl(" << url_r << ", " << attach_point_hint_r << ")" << endl;
   _multi = 0;
   _customHeadersMetalink = 0;
+  _nozsync = false;
 }
 
 MediaMultiCurl::~MediaMultiCurl()
@@ -1282,6 +1308,27 @@ int MediaMultiCurl::progressCallback( void *clientp, double dltotal, double dlno
   return MediaCurl::progressCallback(clientp, dltotal, dlnow, ultotal, ulnow);
 }
 
+// move a completely downloaded temp file into place
+static void commitTempFile(FILE *file, const string & destNew, const Pathname & dest)
+{
+  if (::fchmod( ::fileno(file), filesystem::applyUmaskTo( 0644 )))
+    {
+      ERR << "Failed to chmod file " << destNew << endl;
+    }
+  if (::fclose(file))
+    {
+      filesystem::unlink(destNew);
+      ERR << "Fclose failed for file '" << destNew << "'" << endl;
+      ZYPP_THROW(MediaWriteException(destNew));
+    }
+  if ( rename( destNew, dest ) != 0 )
+    {
+      ERR << "Rename failed" << endl;
+      ZYPP_THROW(MediaWriteException(dest));
+    }
+  DBG << "done: " << PathInfo(dest) << endl;
+}
+
 void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname & target, callback::SendReport<DownloadProgressReport> & report, RequestOptions options ) const
 {
   Pathname dest = target.absolutename();
@@ -1320,6 +1367,38 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
   DBG << "dest: " << dest << endl;
   DBG << "temp: " << destNew << endl;
 
+  // compute the checksums while downloading
+  CheckSumSink sink( checksumTypes() );
+
+  // block level delta transfer against an old copy of the file, if the
+  // server offers a zsync file (metalinks are handled below)
+  Pathname df = deltafile();
+  if ( !df.empty() && !_nozsync && PathInfo(df).isFile() && _url.getScheme() != "ftp" )
+    {
+      if (!(options & OPTION_NO_REPORT_START))
+	report->start(getFileUrl(filename), dest);
+      options = options | OPTION_NO_REPORT_START;
+      curl_easy_setopt(_curl, CURLOPT_TIMECONDITION, CURL_TIMECOND_NONE);
+      curl_easy_setopt(_curl, CURLOPT_TIMEVALUE, 0L);
+      bool done = false;
+      try
+	{
+	  done = zsyncfetch(filename, dest, df, file, report, &sink);
+	}
+      catch (Exception &ex)
+	{
+	  ::fclose(file);
+	  filesystem::unlink(destNew);
+	  ZYPP_RETHROW(ex);
+	}
+      if (done)
+	{
+	  commitTempFile(file, destNew, dest);
+	  sink.commit(dest);
+	  return;
+	}
+    }
+
   // set IFMODSINCE time condition (no download if not modified)
   if( PathInfo(target).isExist() && !(options & OPTION_NO_IFMODSINCE) )
   {
@@ -1338,7 +1417,7 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
   curl_easy_setopt(_curl, CURLOPT_PRIVATE, file);
   try
     {
-      MediaCurl::doGetFileCopyFile(filename, dest, file, report, options);
+      MediaCurl::doGetFileCopyFile(filename, dest, file, report, options, &sink);
     }
   catch (Exception &ex)
     {
@@ -1395,6 +1474,7 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
       bool userabort = false;
       fclose(file);
       file = NULL;
+      sink.reset();	// that was the metalink file
       Pathname failedFile = ZConfig::instance().repoCachePath() / "MultiCurl.failed";
       try
 	{
@@ -1428,7 +1508,7 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
 	    }
 	  try
 	    {
-	      multifetch(filename, file, &urls, &report, &bl);
+	      multifetch(filename, file, &urls, &report, &bl, off_t(-1), &sink);
 	    }
 	  catch (MediaCurlException &ex)
 	    {
@@ -1455,26 +1535,72 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
 	  file = fopen(destNew.c_str(), "w+e");
 	  if (!file)
 	    ZYPP_THROW(MediaWriteException(destNew));
-	  MediaCurl::doGetFileCopyFile(filename, dest, file, report, options | OPTION_NO_REPORT_START);
+	  sink.reset();
+	  MediaCurl::doGetFileCopyFile(filename, dest, file, report, options | OPTION_NO_REPORT_START, &sink);
 	}
     }
 
-  if (::fchmod( ::fileno(file), filesystem::applyUmaskTo( 0644 )))
-    {
-      ERR << "Failed to chmod file " << destNew << endl;
-    }
-  if (::fclose(file))
+  commitTempFile(file, destNew, dest);
+  sink.commit(dest);
+}
+
+bool MediaMultiCurl::zsyncfetch(const Pathname & filename, const Pathname & dest, const Pathname & deltafile, FILE *fp, callback::SendReport<DownloadProgressReport> & report, CheckSumSink *sink) const
+{
+  Pathname zsyncname(filename.extend(".zsync"));
+  filesystem::TmpFile zsyncfile(filesystem::TmpFile::makeSibling(dest));
+  try
     {
-      filesystem::unlink(destNew);
-      ERR << "Fclose failed for file '" << destNew << "'" << endl;
-      ZYPP_THROW(MediaWriteException(destNew));
+      FILE *zfp = fopen(zsyncfile.path().c_str(), "we");
+      if (!zfp)
+	ZYPP_THROW(MediaWriteException(zsyncfile.path()));
+      try
+	{
+	  MediaCurl::doGetFileCopyFile(zsyncname, zsyncfile.path(), zfp, report, OPTION_NO_REPORT_START | OPTION_NO_IFMODSINCE);
+	}
+      catch (const MediaFileNotFoundException &)
+	{
+	  fclose(zfp);
+	  MIL << "No zsync file on the server, not trying again: " << zsyncname << endl;
+	  _nozsync = true;
+	  return false;
+	}
+      catch (...)
+	{
+	  fclose(zfp);
+	  throw;
+	}
+      if (fclose(zfp))
+	ZYPP_THROW(MediaWriteException(zsyncfile.path()));
+
+      ZsyncParser zsp;
+      zsp.parse(zsyncfile.path().asString());
+      MediaBlockList bl = zsp.getBlockList();
+      vector<Url> urls = zsp.getUrls();
+      XXX << bl << endl;
+      XXX << "reusing blocks from file " << deltafile << endl;
+      bl.reuseBlocks(fp, deltafile.asString());
+      XXX << bl << endl;
+      multifetch(filename, fp, &urls, &report, &bl, off_t(-1), sink);
+      struct stat st;
+      if (fflush(fp) || ::fstat(::fileno(fp), &st) || !bl.haveFilesize() || st.st_size != bl.getFilesize())
+	ZYPP_THROW(Exception("zsync: file size mismatch"));
     }
-  if ( rename( destNew, dest ) != 0 )
+  catch (Exception &ex)
     {
-      ERR << "Rename failed" << endl;
-      ZYPP_THROW(MediaWriteException(dest));
+      const MediaCurlException *cex = dynamic_cast<const MediaCurlException *>(&ex);
+      if (cex && cex->errstr() == "User abort")
+	ZYPP_RETHROW(ex);
+      ZYPP_CAUGHT(ex);
+      WAR << "zsync transfer of " << filename << " failed, falling back to normal download" << endl;
+      if (sink)
+	sink->reset();
+      fflush(fp);
+      if (::ftruncate(::fileno(fp), 0) || fseeko(fp, off_t(0), SEEK_SET))
+	ZYPP_THROW(MediaWriteException(dest));
+      return false;
     }
-  DBG << "done: " << PathInfo(dest) << endl;
+  MIL << "zsync transfer of " << filename << " done (old copy " << deltafile << ")" << endl;
+  return true;
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -1493,7 +1619,7 @@ namespace {
 }
 ///////////////////////////////////////////////////////////////////
 
-void MediaMultiCurl::multifetch(const Pathname & filename, FILE *fp, std::vector<Url> *urllist, callback::SendReport<DownloadProgressReport> *report, MediaBlockList *blklist, off_t filesize) const
+void MediaMultiCurl::multifetch(const Pathname & filename, FILE *fp, std::vector<Url> *urllist, callback::SendReport<DownloadProgressReport> *report, MediaBlockList *blklist, off_t filesize, CheckSumSink *sink) const
 {
   Url baseurl(getFileUrl(filename));
   if (blklist && filesize == off_t(-1) && blklist->haveFilesize())
@@ -1502,7 +1628,7 @@ void MediaMultiCurl::multifetch(const Pathname & filename, FILE *fp, std::vector
     blklist = 0;
   if (blklist && (filesize == 0 || !blklist->numBlocks()))
     {
-      checkFileDigest(baseurl, fp, blklist);
+      checkFileDigest(baseurl, fp, blklist, sink);
       return;
     }
   if (filesize == 0)
@@ -1514,6 +1640,7 @@ void MediaMultiCurl::multifetch(const Pathname & filename, FILE *fp, std::vector
 	ZYPP_THROW(MediaCurlInitException(baseurl));
     }
   multifetchrequest req(this, filename, baseurl, _multi, fp, report, blklist, filesize);
+  req._sink = sink;
   req._timeout = _settings.timeout();
   req._connect_timeout = _settings.connectTimeout();
   req._maxspeed = _settings.maxDownloadSpeed();
@@ -1540,22 +1667,38 @@ void MediaMultiCurl::multifetch(const Pathname & filename, FILE *fp, std::vector
     }
   if (!myurllist.size())
     myurllist.push_back(baseurl);
+  // try the mirrors which did well for the previous files first
+  MediaManager::mirrorScoreboard().rank(myurllist);
   req.run(myurllist);
-  checkFileDigest(baseurl, fp, blklist);
+  checkFileDigest(baseurl, fp, blklist, sink);
 }
 
-void MediaMultiCurl::checkFileDigest(Url &url, FILE *fp, MediaBlockList *blklist) const
+// also feeds the sink with the data it did not get while downloading
+void MediaMultiCurl::checkFileDigest(Url &url, FILE *fp, MediaBlockList *blklist, CheckSumSink *sink) const
 {
   if (!blklist || !blklist->haveFileChecksum())
-    return;
+    {
+      if (sink && (fflush(fp) || !sink->update(::fileno(fp))))
+	sink->reset();
+      return;
+    }
   if (fseeko(fp, off_t(0), SEEK_SET))
     ZYPP_THROW(MediaCurlException(url, "fseeko", "seek error"));
   Digest dig;
   blklist->createFileDigest(dig);
-  char buf[4096];
+  std::vector<char> buf(256 * 1024);
   size_t l;
-  while ((l = fread(buf, 1, sizeof(buf), fp)) > 0)
-    dig.update(buf, l);
+  off_t off = 0;
+  while ((l = fread(&buf[0], 1, buf.size(), fp)) > 0)
+    {
+      dig.update(&buf[0], l);
+      if (sink && off <= sink->size() && sink->size() < off + off_t(l))
+	{
+	  size_t skip = sink->size() - off;
+	  sink->update(&buf[skip], l - skip);
+	}
+      off += l;
+    }
   if (!blklist->verifyFileDigest(dig))
     ZYPP_THROW(MediaCurlException(url, "file verification failed", "checksum error"));
 }
@@ -47,7 +47,13 @@ public:
 
   virtual void doGetFileCopy( const Pathname & srcFilename, const Pathname & targetFilename, callback::SendReport<DownloadProgressReport> & _report, RequestOptions options = OPTION_NONE ) const;
 
-  void multifetch(const Pathname &filename, FILE *fp, std::vector<Url> *urllist, callback::SendReport<DownloadProgressReport> *report = 0, MediaBlockList *blklist = 0, off_t filesize = off_t(-1)) const;
+  /**
+   * Fetch \a filename from the mirrors in \a urllist into \a fp.
+   * If a \a sink is passed, it receives the complete file content:
+   * data written in sequence are hashed as they arrive, the rest is
+   * read back at the end.
+   */
+  void multifetch(const Pathname &filename, FILE *fp, std::vector<Url> *urllist, callback::SendReport<DownloadProgressReport> *report = 0, MediaBlockList *blklist = 0, off_t filesize = off_t(-1), CheckSumSink *sink = 0) const;
 
 protected:
 
@@ -58,7 +64,17 @@ protected:
   void toEasyPool(const std::string &host, CURL *easy) const;
 
   virtual void setupEasy();
-  void checkFileDigest(Url &url, FILE *fp, MediaBlockList *blklist) const;
+  void checkFileDigest(Url &url, FILE *fp, MediaBlockList *blklist, CheckSumSink *sink = 0) const;
+  /**
+   * Try a zsync based delta transfer of \a filename into \a fp, reusing
+   * the blocks of the old copy \a deltafile. The block list is taken from
+   * \c filename.zsync on the server.
+   * \return \c false if the server offers no zsync file or the transfer
+   * failed. \a fp is truncated then and the caller should fall back to a
+   * normal download.
+   * \throws MediaCurlException on user abort
+   */
+  bool zsyncfetch(const Pathname &filename, const Pathname &dest, const Pathname &deltafile, FILE *fp, callback::SendReport<DownloadProgressReport> &report, CheckSumSink *sink = 0) const;
   static int progressCallback( void *clientp, double dltotal, double dlnow, double ultotal, double ulnow );
 
 private:
@@ -67,6 +83,7 @@ private:
   mutable CURLM *_multi;	// reused for all fetches so we can make use of the dns cache
   mutable std::set<std::string> _dnsok;
   mutable std::map<std::string, CURL *> _easypool;
+  mutable bool _nozsync;	// server offers no .zsync files, don't ask again
 };
 
 ///////////////////////////////////////////////////////////////////
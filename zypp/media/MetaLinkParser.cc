@@ -265,6 +265,9 @@ startElement(void *userData, const xmlChar *name, const xmlChar **atts)
 	    pd->statedepth--;
 	    break;
 	  }
+	// usually the size is known by now, so the pieces need no reallocation
+	if (pd->size != off_t(-1))
+	  pd->piece.reserve(pd->piecel * ((pd->size + blksize - 1) / blksize));
 	break;
       }
     case STATE_HASH:
@@ -370,12 +373,12 @@ endElement(void *userData, const xmlChar *name)
     case STATE_M4PIECES:
       if (pd->piecel == 4)
 	{
-	  pd->zsync = pd->piece;
+	  pd->zsync.swap(pd->piece);
 	  pd->nzsync = pd->npiece;
 	}
       else
 	{
-	  pd->sha1 = pd->piece;
+	  pd->sha1.swap(pd->piece);
 	  pd->nsha1 = pd->npiece;
 	}
       pd->piecel = pd->npiece = 0;
@@ -436,13 +439,14 @@ MetaLinkParser::parse(const Pathname &filename)
 void
 MetaLinkParser::parse(const InputStream &is)
 {
-  char buf[4096];
+  // large chunks: less parser calls for multi-GB image metalinks
+  std::vector<char> buf(64 * 1024);
   if (!is.stream())
     ZYPP_THROW(Exception("MetaLinkParser: no such file"));
   while (is.stream().good())
     {
-      is.stream().read(buf, sizeof(buf));
-      parseBytes(buf, is.stream().gcount());
+      is.stream().read(&buf[0], buf.size());
+      parseBytes(&buf[0], is.stream().gcount());
     }
   parseEnd();
 }
@@ -477,6 +481,7 @@ std::vector<Url>
 MetaLinkParser::getUrls()
 {
   std::vector<Url> urls;
+  urls.reserve(pd->nurls);
   int i;
   for (i = 0; i < pd->nurls; ++i)
     urls.push_back(Url(pd->urls[i].url));
@@ -497,6 +502,7 @@ MetaLinkParser::getBlockList()
       size_t nb = (pd->size + pd->blksize - 1) / pd->blksize;
       off_t off = 0;
       size_t size = pd->blksize;
+      bl.reserveBlocks(nb);
       for (i = 0; i < nb; i++)
 	{
 	  if (i == nb - 1)
@@ -0,0 +1,271 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/media/MirrorScoreboard.cc
+ *
+*/
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/base/IOStream.h"
+#include "zypp/media/MirrorScoreboard.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////
+  namespace media
+  { /////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** Weight of a new sample in the moving averages. */
+      const double alpha = 0.3;
+
+      /** Transfers smaller than this do not tell the throughput. */
+      const ByteCount::SizeType minThroughputBytes = 64 * 1024;
+
+      /** Half-life of the error rate (seconds): errors are forgiven over time. */
+      const double errorHalfLife = 600;
+
+      /** Saved statistics older than this (seconds) are ignored. */
+      const time_t maxAge = 7 * 24 * 3600;
+
+      /** Transfer size used to compare hosts. */
+      const double refBytes = 1024 * 1024;
+
+      /** Time (seconds) a failed transfer is assumed to cost (e.g. waiting for a timeout). */
+      const double failurePenalty = 10;
+
+      inline void ewma( double & avg_r, double sample_r )
+      { avg_r = avg_r ? ( alpha * sample_r + ( 1 - alpha ) * avg_r ) : sample_r; }
+
+      inline double errorRate( const MirrorScoreboard::Score & score_r, time_t now_r )
+      {
+	if ( ! score_r.errorRate || now_r <= score_r.mtime )
+	  return score_r.errorRate;
+	return score_r.errorRate * std::pow( 0.5, ( now_r - score_r.mtime ) / errorHalfLife );
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class MirrorScoreboard::Impl
+    /// \brief MirrorScoreboard implementation.
+    ///////////////////////////////////////////////////////////////////
+    class MirrorScoreboard::Impl
+    {
+    public:
+      typedef std::map<std::string,Score> Scores;
+
+      mutable std::mutex _mutex;
+      Scores             _scores;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    MirrorScoreboard::MirrorScoreboard()
+    : _pimpl( new Impl )
+    {}
+
+    MirrorScoreboard::~MirrorScoreboard()
+    {}
+
+    std::string MirrorScoreboard::hostKey( const Url & url_r )
+    {
+      std::string ret( url_r.getScheme() );
+      ret += "://";
+      ret += url_r.getHost();
+      if ( ! url_r.getPort().empty() )
+      {
+	ret += ":";
+	ret += url_r.getPort();
+      }
+      return ret;
+    }
+
+    void MirrorScoreboard::reportSuccess( const Url & url_r, const ByteCount & bytes_r, double seconds_r, double rtt_r )
+    {
+      std::lock_guard<std::mutex> lock( _pimpl->_mutex );
+      Score & score( _pimpl->_scores[hostKey( url_r )] );
+      time_t now = ::time( nullptr );
+      score.errorRate = ( 1 - alpha ) * errorRate( score, now );
+      if ( bytes_r >= minThroughputBytes && seconds_r > 0 )
+	ewma( score.throughput, bytes_r / seconds_r );
+      if ( rtt_r > 0 )
+	ewma( score.rtt, rtt_r );
+      ++score.samples;
+      score.mtime = now;
+    }
+
+    void MirrorScoreboard::reportFailure( const Url & url_r )
+    {
+      std::lock_guard<std::mutex> lock( _pimpl->_mutex );
+      Score & score( _pimpl->_scores[hostKey( url_r )] );
+      time_t now = ::time( nullptr );
+      score.errorRate = alpha + ( 1 - alpha ) * errorRate( score, now );
+      ++score.samples;
+      score.mtime = now;
+    }
+
+    MirrorScoreboard::Score MirrorScoreboard::score( const Url & url_r ) const
+    {
+      std::lock_guard<std::mutex> lock( _pimpl->_mutex );
+      Impl::Scores::const_iterator it( _pimpl->_scores.find( hostKey( url_r ) ) );
+      return it == _pimpl->_scores.end() ? Score() : it->second;
+    }
+
+    void MirrorScoreboard::rank( std::vector<Url> & urls_r ) const
+    {
+      if ( urls_r.size() < 2 )
+	return;
+
+      std::vector<Score> scores;
+      scores.reserve( urls_r.size() );
+      for ( const Url & url : urls_r )
+	scores.push_back( score( url ) );
+
+      // Unknown values are assumed to be the average of the known ones.
+      double throughput = 0;
+      double rtt = 0;
+      unsigned nthroughput = 0;
+      unsigned nrtt = 0;
+      for ( const Score & score : scores )
+      {
+	if ( score.throughput ) { throughput += score.throughput; ++nthroughput; }
+	if ( score.rtt )        { rtt += score.rtt; ++nrtt; }
+      }
+      throughput = nthroughput ? throughput / nthroughput : refBytes;
+      rtt = nrtt ? rtt / nrtt : 0.1;
+
+      // Expected time to download refBytes, including the failed attempts.
+      time_t now = ::time( nullptr );
+      std::vector<std::pair<double,Url> > ranked;
+      ranked.reserve( urls_r.size() );
+      for ( unsigned i = 0; i < urls_r.size(); ++i )
+      {
+	const Score & score( scores[i] );
+	double error = errorRate( score, now );
+	double cost = ( score.rtt ? score.rtt : rtt ) + refBytes / ( score.throughput ? score.throughput : throughput );
+	cost = ( cost + failurePenalty * error ) / std::max( 0.05, 1 - error );
+	ranked.push_back( std::make_pair( cost, urls_r[i] ) );
+      }
+      std::stable_sort( ranked.begin(), ranked.end(),
+			[]( const std::pair<double,Url> & lhs, const std::pair<double,Url> & rhs )->bool
+			{ return lhs.first < rhs.first; } );
+
+      for ( unsigned i = 0; i < urls_r.size(); ++i )
+	urls_r[i] = ranked[i].second;
+    }
+
+    bool MirrorScoreboard::empty() const
+    {
+      std::lock_guard<std::mutex> lock( _pimpl->_mutex );
+      return _pimpl->_scores.empty();
+    }
+
+    size_t MirrorScoreboard::size() const
+    {
+      std::lock_guard<std::mutex> lock( _pimpl->_mutex );
+      return _pimpl->_scores.size();
+    }
+
+    void MirrorScoreboard::clear()
+    {
+      std::lock_guard<std::mutex> lock( _pimpl->_mutex );
+      _pimpl->_scores.clear();
+    }
+
+    // File format: one line per host (integers only, not to depend on the locale):
+    //   <hostkey> <throughput[bytes/s]> <rtt[us]> <errorRate[ppm]> <samples> <mtime>
+    bool MirrorScoreboard::load( const Pathname & file_r )
+    {
+      if ( ! PathInfo( file_r ).isFile() )
+	return false;
+
+      time_t now = ::time( nullptr );
+      Impl::Scores scores;
+      std::ifstream in( file_r.c_str() );
+      for ( iostr::EachLine line( in ); line; line.next() )
+      {
+	std::vector<std::string> words;
+	if ( str::split( *line, std::back_inserter( words ) ) != 6 )
+	  continue;
+
+	Score score;
+	score.throughput = str::strtonum<unsigned long long>( words[1] );
+	score.rtt        = str::strtonum<unsigned long long>( words[2] ) / 1e6;
+	score.errorRate  = str::strtonum<unsigned long long>( words[3] ) / 1e6;
+	score.samples    = str::strtonum<unsigned>( words[4] );
+	score.mtime      = str::strtonum<time_t>( words[5] );
+	if ( score.mtime + maxAge < now || score.errorRate > 1 )
+	  continue;
+	scores[words[0]] = score;
+      }
+
+      std::lock_guard<std::mutex> lock( _pimpl->_mutex );
+      for ( const auto & entry : scores )
+      {
+	Score & score( _pimpl->_scores[entry.first] );
+	if ( score.mtime < entry.second.mtime )
+	  score = entry.second;	// keep the more recent one
+      }
+      DBG << "Loaded " << scores.size() << " mirror scores from " << file_r << endl;
+      return true;
+    }
+
+    bool MirrorScoreboard::save( const Pathname & file_r ) const
+    {
+      if ( filesystem::assert_dir( file_r.dirname() ) != 0 )
+	return false;
+
+      filesystem::TmpFile tmp( filesystem::TmpFile::makeSibling( file_r ) );
+      if ( tmp.path().empty() )
+	return false;
+      {
+	std::ofstream out( tmp.path().c_str() );
+	std::lock_guard<std::mutex> lock( _pimpl->_mutex );
+	for ( const auto & entry : _pimpl->_scores )
+	{
+	  const Score & score( entry.second );
+	  out << entry.first
+	      << " " << (unsigned long long)score.throughput
+	      << " " << (unsigned long long)( score.rtt * 1e6 )
+	      << " " << (unsigned long long)( score.errorRate * 1e6 )
+	      << " " << score.samples << " " << score.mtime << endl;
+	}
+	if ( ! out )
+	  return false;
+      }
+      if ( filesystem::rename( tmp.path(), file_r ) != 0 )
+	return false;
+      DBG << "Saved " << size() << " mirror scores to " << file_r << endl;
+      return true;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const MirrorScoreboard & obj )
+    {
+      return str << "MirrorScoreboard(" << obj.size() << " hosts)";
+    }
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace media
+  ///////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,125 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/media/MirrorScoreboard.h
+ *
+*/
+#ifndef ZYPP_MEDIA_MIRRORSCOREBOARD_H
+#define ZYPP_MEDIA_MIRRORSCOREBOARD_H
+
+#include <ctime>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/base/PtrTypes.h"
+#include "zypp/ByteCount.h"
+#include "zypp/Pathname.h"
+#include "zypp/Url.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////
+  namespace media
+  { /////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class MirrorScoreboard
+    /// \brief Per host download statistics used to rank mirrors.
+    ///
+    /// The download handlers report each transfer. Per host (scheme,
+    /// host and port of the \ref Url) an exponentially weighted moving
+    /// average of the throughput, the round trip time and the error rate
+    /// is kept. \ref rank orders a list of mirrors so that fast and healthy
+    /// hosts are tried first. Hosts without data are assumed to be average.
+    /// Errors are forgiven over time, so a dead mirror is retried eventually.
+    ///
+    /// The scoreboard is kept in the \ref MediaManager and lives as long as
+    /// the process. It can be saved and loaded to keep the data across
+    /// processes (see zypp.conf:download.mirror_scoreboard).
+    ///////////////////////////////////////////////////////////////////
+    class MirrorScoreboard : private base::NonCopyable
+    {
+    public:
+      /** A hosts statistics. */
+      struct Score
+      {
+	Score()
+	: throughput( 0 ), rtt( 0 ), errorRate( 0 ), samples( 0 ), mtime( 0 )
+	{}
+
+	double   throughput;	//!< bytes/s (0: unknown)
+	double   rtt;		//!< seconds (0: unknown)
+	double   errorRate;	//!< [0,1]
+	unsigned samples;	//!< number of reports
+	time_t   mtime;		//!< time of the last report
+      };
+
+    public:
+      MirrorScoreboard();
+      ~MirrorScoreboard();
+
+    public:
+      /** Report a successful transfer of \a bytes_r in \a seconds_r.
+       * \a rtt_r is the time needed to establish the connection (0 if
+       * unknown, e.g. a reused connection). Small transfers do not
+       * change the throughput, as they are dominated by latency.
+       */
+      void reportSuccess( const Url & url_r, const ByteCount & bytes_r, double seconds_r, double rtt_r = 0 );
+
+      /** Report a failed transfer (connection error, timeout, server error, bad data). */
+      void reportFailure( const Url & url_r );
+
+      /** The statistics of \a url_r's host (default constructed if unknown). */
+      Score score( const Url & url_r ) const;
+
+      /** Stable sort \a urls_r, best hosts first. */
+      void rank( std::vector<Url> & urls_r ) const;
+
+      /** Whether there are no statistics. */
+      bool empty() const;
+
+      /** Number of hosts with statistics. */
+      size_t size() const;
+
+      /** Forget all statistics. */
+      void clear();
+
+    public:
+      /** Merge the statistics saved in \a file_r (outdated ones are ignored).
+       * \return Whether the file was read.
+       */
+      bool load( const Pathname & file_r );
+
+      /** Save the statistics to \a file_r.
+       * \return Whether the file was written.
+       */
+      bool save( const Pathname & file_r ) const;
+
+    public:
+      /** The key the statistics of \a url_r are stored at (\c scheme://host[:port]). */
+      static std::string hostKey( const Url & url_r );
+
+    public:
+      class Impl;
+    private:
+      RW_pointer<Impl> _pimpl;
+    };
+
+    /** \relates MirrorScoreboard Stream output */
+    std::ostream & operator<<( std::ostream & str, const MirrorScoreboard & obj );
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace media
+  ///////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_MEDIA_MIRRORSCOREBOARD_H
@@ -11,14 +11,21 @@
 */
 
 #include <mntent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
 
 #include <cstdio>
 #include <climits>
 #include <cerrno>
+#include <cstring>
 
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <set>
+#include <mutex>
+#include <unordered_map>
 
 #include "zypp/base/ExternalDataSource.h"
 #include "zypp/base/Logger.h"
@@ -140,6 +147,7 @@ void Mount::mount( const std::string & source,
     }
 
     int status = Status();
+    MountTable::invalidate();	// in case the change notification is late
 
     if ( status == 0 )
     {
@@ -211,6 +219,7 @@ void Mount::umount( const std::string & path )
     }
 
     int status = Status();
+    MountTable::invalidate();	// in case the change notification is late
 
     if ( status == 0 )
     {
@@ -367,5 +376,174 @@ Mount::getEntries(const std::string &mtab)
   return entries;
 }
 
+///////////////////////////////////////////////////////////////////
+//
+//	CLASS NAME : MountTable
+//
+///////////////////////////////////////////////////////////////////
+
+class MountTable::Impl
+{
+public:
+  Impl( MountEntries entries_r, unsigned generation_r )
+  : _entries( std::move(entries_r) )
+  , _generation( generation_r )
+  {
+    for ( unsigned i = 0; i < _entries.size(); ++i )
+    {
+      std::string dir( Pathname( _entries[i].dir ).asString() );
+      _byDir[dir].push_back( i );
+      _dirs.insert( dir );
+    }
+  }
+
+public:
+  MountEntries _entries;
+  std::unordered_map<std::string, std::vector<unsigned> > _byDir;
+  std::set<std::string> _dirs;	//!< sorted, for hasMountsBelow
+  unsigned _generation;
+};
+
+namespace
+{
+  /** The cached table and the change notification. */
+  class MountTableCache
+  {
+  public:
+    MountTableCache()
+    : _fd( ::open( "/proc/self/mountinfo", O_RDONLY|O_CLOEXEC ) )
+    , _mtabMtime( 0 )
+    , _generation( 0 )
+    , _stale( true )
+    {
+      if ( _fd == -1 )
+        WAR << "Can't watch /proc/self/mountinfo (" << ::strerror( errno ) << "); always rereading the mount table." << endl;
+    }
+
+    ~MountTableCache()
+    {
+      if ( _fd != -1 )
+        ::close( _fd );
+    }
+
+    shared_ptr<const MountTable::Impl> get()
+    {
+      std::lock_guard<std::mutex> guard( _mutex );
+      if ( changed() )
+      {
+        MountEntries entries( Mount::getEntries() );
+        if ( ! _table || ! sameEntries( entries, _table->_entries ) )
+          ++_generation;
+        _table.reset( new MountTable::Impl( std::move(entries), _generation ) );
+        _stale = false;
+      }
+      return _table;
+    }
+
+    void invalidate()
+    {
+      std::lock_guard<std::mutex> guard( _mutex );
+      _stale = true;
+    }
+
+  private:
+    /** Whether the table must be reread. The kernel reports a mount
+     * table change to each open mountinfo file once, as POLLPRI|POLLERR.
+     */
+    bool changed()
+    {
+      bool ret = _stale || _fd == -1;
+      if ( _fd != -1 )
+      {
+        struct pollfd pfd;
+        pfd.fd = _fd;
+        pfd.events = POLLPRI;
+        pfd.revents = 0;
+        if ( ::poll( &pfd, 1, 0 ) != 0 )	// an event or an error (EINTR)
+          ret = true;
+      }
+
+      // an /etc/mtab file (not a symlink into /proc) is written by mount(8)
+      PathInfo mtab( "/etc/mtab", PathInfo::LSTAT );
+      time_t mtime = mtab.isFile() ? mtab.mtime() : 0;
+      if ( mtime != _mtabMtime )
+      {
+        _mtabMtime = mtime;
+        ret = true;
+      }
+      return ret;
+    }
+
+    static bool sameEntries( const MountEntries & lhs, const MountEntries & rhs )
+    {
+      if ( lhs.size() != rhs.size() )
+        return false;
+      for ( unsigned i = 0; i < lhs.size(); ++i )
+      {
+        if ( lhs[i].src != rhs[i].src || lhs[i].dir != rhs[i].dir
+          || lhs[i].type != rhs[i].type || lhs[i].opts != rhs[i].opts )
+          return false;
+      }
+      return true;
+    }
+
+  private:
+    std::mutex _mutex;
+    int        _fd;
+    time_t     _mtabMtime;
+    unsigned   _generation;
+    bool       _stale;
+    shared_ptr<const MountTable::Impl> _table;
+  };
+
+  MountTableCache & mountTableCache()
+  {
+    static MountTableCache _cache;
+    return _cache;
+  }
+} // namespace
+
+MountTable::MountTable( const shared_ptr<const Impl> & pimpl_r )
+: _pimpl( pimpl_r )
+{}
+
+MountTable MountTable::current()
+{ return MountTable( mountTableCache().get() ); }
+
+void MountTable::invalidate()
+{ mountTableCache().invalidate(); }
+
+const MountEntries & MountTable::entries() const
+{ return _pimpl->_entries; }
+
+MountEntries MountTable::entriesAt( const Pathname & dir_r ) const
+{
+  MountEntries ret;
+  auto it( _pimpl->_byDir.find( dir_r.asString() ) );
+  if ( it != _pimpl->_byDir.end() )
+  {
+    for ( unsigned idx : it->second )
+      ret.push_back( _pimpl->_entries[idx] );
+  }
+  return ret;
+}
+
+bool MountTable::isMountPoint( const Pathname & dir_r ) const
+{ return _pimpl->_byDir.count( dir_r.asString() ); }
+
+bool MountTable::hasMountsBelow( const Pathname & dir_r ) const
+{
+  std::string prefix( dir_r.asString() );
+  if ( prefix.empty() || prefix[prefix.size()-1] != '/' )
+    prefix += '/';
+  auto it( _pimpl->_dirs.lower_bound( prefix ) );
+  if ( it != _pimpl->_dirs.end() && *it == prefix )
+    ++it;	// "/" itself
+  return it != _pimpl->_dirs.end() && it->compare( 0, prefix.size(), prefix ) == 0;
+}
+
+unsigned MountTable::generation() const
+{ return _pimpl->_generation; }
+
   } // namespace media
 } // namespace zypp
@@ -20,8 +20,10 @@
 #include <string>
 #include <iosfwd>
 
+#include "zypp/base/PtrTypes.h"
 #include "zypp/ExternalProgram.h"
 #include "zypp/KVMap.h"
+#include "zypp/Pathname.h"
 
 namespace zypp {
   namespace media {
@@ -175,6 +177,50 @@ namespace zypp {
 	int exit_code;
     };
 
+    /**
+     * @short Process wide cache of the system mount table.
+     *
+     * \ref current returns the cached \ref Mount::getEntries and rereads
+     * them only if something was mounted or unmounted meanwhile. Changes
+     * are noticed by polling \c /proc/self/mountinfo for \c POLLPRI (and
+     * the mtime of \c /etc/mtab, if it is a file). If \c mountinfo is not
+     * available, the table is reread on each call.
+     *
+     * A \ref MountTable is an immutable snapshot and cheap to copy. Mount
+     * points are indexed, so looking them up does not scan the entries.
+     */
+    class MountTable
+    {
+    public:
+	/** The current system mount table. */
+	static MountTable current();
+
+	/** Force rereading the table on the next \ref current. */
+	static void invalidate();
+
+    public:
+	/** All entries in mount table order. */
+	const MountEntries & entries() const;
+
+	/** Entries mounted on \a dir_r (in mount table order). */
+	MountEntries entriesAt( const Pathname & dir_r ) const;
+
+	/** Whether something is mounted on \a dir_r. */
+	bool isMountPoint( const Pathname & dir_r ) const;
+
+	/** Whether something is mounted below (not on) \a dir_r. */
+	bool hasMountsBelow( const Pathname & dir_r ) const;
+
+	/** Incremented whenever the table was reread and differs. */
+	unsigned generation() const;
+
+    public:
+	class Impl;
+    private:
+	explicit MountTable( const shared_ptr<const Impl> & pimpl_r );
+	shared_ptr<const Impl> _pimpl;
+    };
+
 
   } // namespace media
 } // namespace zypp
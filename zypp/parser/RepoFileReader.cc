@@ -9,7 +9,20 @@
 /** \file	zypp/repo/RepoFileReader.cc
  *
 */
+extern "C"
+{
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+}
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <functional>
 #include "zypp/base/LogTools.h"
 #include "zypp/base/String.h"
 #include "zypp/base/Regex.h"
@@ -18,6 +31,7 @@
 
 #include "zypp/parser/IniDict.h"
 #include "zypp/parser/RepoFileReader.h"
+#include "zypp/thread/RunTasks.h"
 
 using std::endl;
 
@@ -47,7 +61,7 @@ namespace zypp
 	  if ( key_r == "baseurl" )
 	  {
 	    _inMultiline = MultiLine::baseurl;
-	    _baseurls[section_r].push_back( Url(value_r) );
+	    _baseurls[section_r].push_back( value_r );
 	  }
 	  else if ( key_r == "gpgkey" )
 	  {
@@ -66,7 +80,7 @@ namespace zypp
 	  switch ( _inMultiline )
 	  {
 	    case MultiLine::baseurl:
-	      _baseurls[section_r].push_back( Url(line_r) );
+	      _baseurls[section_r].push_back( line_r );
 	      break;
 
 	    case MultiLine::gpgkey:
@@ -79,53 +93,82 @@ namespace zypp
 	  }
 	}
 
-	std::list<Url> & baseurls( const std::string & section_r )
+	std::vector<std::string> & baseurls( const std::string & section_r )
 	{ return _baseurls[section_r]; }
 
-	std::list<Url> & gpgkeys( const std::string & section_r )
+	std::vector<std::string> & gpgkeys( const std::string & section_r )
 	{ return _gpgkeys[section_r]; }
 
       private:
-	void legacyStoreUrl( std::list<Url> & store_r, const std::string & line_r )
+	void legacyStoreUrl( std::vector<std::string> & store_r, const std::string & line_r )
 	{
 	  // Legacy:
 	  // 	commit 4ef65a442038caf7a1e310bc719e329b34dbdb67
 	  // 	- split the gpgkey line and take the first one as url to avoid
 	  // 	  crash when creating an url from the line, as Fedora hat the
 	  // 	  *BRILLIANT* idea of using more than one url per line.
-	  std::vector<std::string> keys;
-	  str::split( line_r, std::back_inserter(keys) );
-	  for ( auto && str : keys )
-	    store_r.push_back( Url(std::move(str)) );
+	  str::split( line_r, std::back_inserter(store_r) );
 	}
 
 	enum class MultiLine { none, baseurl, gpgkey };
 	MultiLine _inMultiline = MultiLine::none;
 
-	std::map<std::string,std::list<Url>> _baseurls;
-	std::map<std::string,std::list<Url>> _gpgkeys;
+	std::map<std::string,std::vector<std::string>> _baseurls;
+	std::map<std::string,std::vector<std::string>> _gpgkeys;
+      };
+
+      ///////////////////////////////////////////////////////////////////
+      /// \class RepoSection
+      /// \brief The uninterpreted content of a .repo file section.
+      ///
+      /// What \ref RepoFileParser found, so it can be cached and turned
+      /// into \ref RepoInfo later.
+      ///////////////////////////////////////////////////////////////////
+      struct RepoSection
+      {
+	std::string alias;
+	std::vector<std::pair<std::string,std::string>> entries;
+	std::vector<std::string> baseurls;
+	std::vector<std::string> gpgkeys;
       };
+      typedef std::vector<RepoSection> RepoSections;
 
     } //namespace
     ///////////////////////////////////////////////////////////////////
 
-    /**
-   * \short List of RepoInfo's from a file.
-   * \param file pathname of the file to read.
-   */
-    static void repositories_in_stream( const InputStream &is,
-                                        const RepoFileReader::ProcessRepo &callback,
-                                        const ProgressData::ReceiverFnc &progress )
+    /** Parse a .repo file into \ref RepoSections. */
+    static RepoSections parseRepoSections( const InputStream & is )
     {
+      RepoSections ret;
       RepoFileParser dict(is);
       for_( its, dict.sectionsBegin(), dict.sectionsEnd() )
+      {
+	ret.push_back( RepoSection() );
+	RepoSection & section( ret.back() );
+	section.alias = *its;
+	section.entries.assign( dict.entriesBegin(*its), dict.entriesEnd(*its) );
+	section.baseurls.swap( dict.baseurls( *its ) );
+	section.gpgkeys.swap( dict.gpgkeys( *its ) );
+      }
+      return ret;
+    }
+
+    /**
+   * \short Turn parsed sections into RepoInfo's.
+   * \param filepath pathname of the file the sections were read from.
+   */
+    static void repositories_in_sections( const RepoSections & sections,
+					  const Pathname & filepath,
+					  const RepoFileReader::ProcessRepo &callback )
+    {
+      for ( const RepoSection & section : sections )
       {
         RepoInfo info;
-        info.setAlias(*its);
+        info.setAlias( section.alias );
 	std::string proxy;
 	std::string proxyport;
 
-        for_( it, dict.entriesBegin(*its), dict.entriesEnd(*its) )
+        for_( it, section.entries.begin(), section.entries.end() )
         {
           //MIL << (*it).first << endl;
           if (it->first == "name" )
@@ -172,11 +215,12 @@ namespace zypp
 	    }
 	  }
           else
-            ERR << "Unknown attribute in [" << *its << "]: " << it->first << "=" << it->second << " ignored" << endl;
+            ERR << "Unknown attribute in [" << section.alias << "]: " << it->first << "=" << it->second << " ignored" << endl;
         }
 
-	for ( auto & url : dict.baseurls( *its ) )
+	for ( const std::string & urlstr : section.baseurls )
 	{
+	  Url url( urlstr );
 	  if ( ! proxy.empty() && url.getQueryParam( "proxy" ).empty() )
 	  {
 	    url.setQueryParam( "proxy", proxy );
@@ -185,9 +229,12 @@ namespace zypp
 	  info.addBaseUrl( url );
 	}
 
-	info.setGpgKeyUrls( std::move(dict.gpgkeys( *its )) );
+	RepoInfo::url_set gpgkeys;
+	for ( const std::string & urlstr : section.gpgkeys )
+	  gpgkeys.push_back( Url(urlstr) );
+	info.setGpgKeyUrls( std::move(gpgkeys) );
 
-        info.setFilepath(is.path());
+        info.setFilepath(filepath);
         MIL << info << endl;
         // add it to the list.
         callback(info);
@@ -196,6 +243,378 @@ namespace zypp
       }
     }
 
+    /**
+   * \short List of RepoInfo's from a file.
+   * \param file pathname of the file to read.
+   */
+    static void repositories_in_stream( const InputStream &is,
+                                        const RepoFileReader::ProcessRepo &callback,
+                                        const ProgressData::ReceiverFnc &progress )
+    {
+      repositories_in_sections( parseRepoSections( is ), is.path(), callback );
+    }
+
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** What identifies an unchanged file. */
+      struct FileKey
+      {
+	unsigned long long dev = 0;
+	unsigned long long ino = 0;
+	unsigned long long size = 0;
+	unsigned long long mtime = 0;	// ns
+	unsigned long long ctime = 0;	// ns
+	bool readable = false;		// by others
+
+	FileKey()
+	{}
+
+	FileKey( const struct ::stat & st )
+	: dev( st.st_dev ), ino( st.st_ino ), size( st.st_size )
+	, mtime( st.st_mtim.tv_sec * 1000000000ULL + st.st_mtim.tv_nsec )
+	, ctime( st.st_ctim.tv_sec * 1000000000ULL + st.st_ctim.tv_nsec )
+	, readable( st.st_mode & S_IROTH )
+	{}
+
+	bool operator==( const FileKey & rhs ) const
+	{ return dev == rhs.dev && ino == rhs.ino && size == rhs.size && mtime == rhs.mtime && ctime == rhs.ctime; }
+      };
+
+      /** A .repo file to read. */
+      struct RepoFile
+      {
+	Pathname     path;
+	FileKey      key;
+	bool         valid = false;	///< \ref sections are up to date
+	bool         read = false;	///< \ref content was read
+	std::string  content;
+	RepoSections sections;
+      };
+
+      /** Read \a file_r into memory (no logging, so it can run in a thread). */
+      void readRepoFile( RepoFile & file_r )
+      {
+	int fd = ::open( file_r.path.c_str(), O_RDONLY|O_CLOEXEC );
+	if ( fd < 0 )
+	  return;
+	struct ::stat st;
+	if ( ::fstat( fd, &st ) == 0 && S_ISREG( st.st_mode ) )
+	{
+	  file_r.key = FileKey( st );
+	  file_r.content.resize( st.st_size );
+	  size_t got = 0;
+	  while ( got < file_r.content.size() )
+	  {
+	    ssize_t cnt = ::read( fd, &file_r.content[got], file_r.content.size() - got );
+	    if ( cnt < 0 && errno == EINTR )
+	      continue;
+	    if ( cnt <= 0 )
+	      break;
+	    got += cnt;
+	  }
+	  // Size changed while reading or a gzip compressed file: use InputStream
+	  static const char gzmagic[] = { '\x1f', '\x8b' };
+	  file_r.read = ( got == file_r.content.size() && file_r.content.compare( 0, 2, gzmagic, 2 ) != 0 );
+	}
+	::close( fd );
+      }
+
+      ///////////////////////////////////////////////////////////////////
+      /// \class RepoFileCache
+      /// \brief Binary cache of parsed .repo files.
+      ///
+      /// A header line followed by the files: path, \ref FileKey and the
+      /// \ref RepoSections. Numbers are stored as fixed size native
+      /// integers, strings as length and data. The cache is build and
+      /// read on the same host, so there is no need to care for endianess.
+      ///////////////////////////////////////////////////////////////////
+      class RepoFileCache
+      {
+      public:
+	/** Fill in the sections of all unchanged \a files_r. */
+	static void load( const Pathname & cache_r, std::vector<RepoFile> & files_r )
+	{
+	  std::string data;
+	  {
+	    std::ifstream in( cache_r.c_str() );
+	    if ( ! in )
+	      return;
+	    data.assign( std::istreambuf_iterator<char>( in ), std::istreambuf_iterator<char>() );
+	  }
+	  Reader reader( data );
+	  if ( ! reader.header() )
+	  {
+	    WAR << "Ignore cache with unknown format " << cache_r << endl;
+	    return;
+	  }
+
+	  std::map<std::string,RepoFile*> byPath;
+	  for ( RepoFile & file : files_r )
+	    byPath[file.path.asString()] = &file;
+
+	  unsigned hits = 0;
+	  unsigned long long nfiles = 0;
+	  if ( ! reader.get( nfiles ) )
+	    return;
+	  for ( ; nfiles; --nfiles )
+	  {
+	    std::string path;
+	    FileKey key;
+	    RepoSections sections;
+	    if ( ! ( reader.get( path ) && reader.get( key ) && reader.get( sections ) ) )
+	    {
+	      WAR << "Ignore broken cache " << cache_r << endl;
+	      for ( RepoFile & file : files_r )
+		file.valid = false;
+	      return;
+	    }
+	    auto it( byPath.find( path ) );
+	    if ( it != byPath.end() && it->second->key == key )
+	    {
+	      it->second->sections.swap( sections );
+	      it->second->valid = true;
+	      ++hits;
+	    }
+	  }
+	  MIL << "Cache " << cache_r << ": " << hits << " of " << files_r.size() << " files unchanged" << endl;
+	}
+
+	/** Store the sections of all \a files_r.
+	 * The cache is readable by others only if all files are.
+	 */
+	static void store( const Pathname & cache_r, const std::vector<RepoFile> & files_r )
+	{
+	  Writer writer;
+	  bool readable = true;
+	  writer.header();
+	  writer.put( files_r.size() );
+	  for ( const RepoFile & file : files_r )
+	  {
+	    writer.put( file.path.asString() );
+	    writer.put( file.key );
+	    writer.put( file.sections );
+	    if ( ! file.key.readable )
+	      readable = false;
+	  }
+
+	  // A unique sibling: concurrent processes may store the cache too.
+	  std::string tmp( cache_r.asString() + ".XXXXXX" );
+	  int fd = ::mkostemp( &tmp[0], O_CLOEXEC );
+	  if ( fd < 0 )
+	  {
+	    DBG << "Can't write cache " << cache_r << ": " << Errno() << endl;
+	    return;
+	  }
+	  ::fchmod( fd, readable ? 0644 : 0600 );	// mkostemp creates it 0600
+	  const std::string & data( writer.data() );
+	  bool ok = ( ::write( fd, data.c_str(), data.size() ) == ssize_t(data.size()) );
+	  ok = ( ::close( fd ) == 0 ) && ok;
+	  if ( ok && ::rename( tmp.c_str(), cache_r.c_str() ) == 0 )
+	    MIL << "Wrote cache " << cache_r << " (" << files_r.size() << " files)" << endl;
+	  else
+	  {
+	    WAR << "Can't write cache " << cache_r << ": " << Errno() << endl;
+	    ::unlink( tmp.c_str() );
+	  }
+	}
+
+      private:
+	static const std::string & magic()
+	{
+	  static const std::string _magic( "zypp-repofile-cache 1\n" );
+	  return _magic;
+	}
+
+	struct Writer
+	{
+	  void header()
+	  { _data += magic(); }
+
+	  void put( unsigned long long val_r )
+	  { _data.append( reinterpret_cast<const char *>( &val_r ), sizeof(val_r) ); }
+
+	  void put( const std::string & val_r )
+	  { put( val_r.size() ); _data += val_r; }
+
+	  void put( const FileKey & val_r )
+	  {
+	    put( val_r.dev ); put( val_r.ino ); put( val_r.size );
+	    put( val_r.mtime ); put( val_r.ctime ); put( val_r.readable );
+	  }
+
+	  void put( const std::vector<std::string> & val_r )
+	  {
+	    put( val_r.size() );
+	    for ( const std::string & str : val_r )
+	      put( str );
+	  }
+
+	  void put( const RepoSections & val_r )
+	  {
+	    put( val_r.size() );
+	    for ( const RepoSection & section : val_r )
+	    {
+	      put( section.alias );
+	      put( section.entries.size() );
+	      for ( const auto & entry : section.entries )
+	      { put( entry.first ); put( entry.second ); }
+	      put( section.baseurls );
+	      put( section.gpgkeys );
+	    }
+	  }
+
+	  const std::string & data() const
+	  { return _data; }
+
+	private:
+	  std::string _data;
+	};
+
+	struct Reader
+	{
+	  Reader( const std::string & data_r )
+	  : _data( data_r )
+	  {}
+
+	  bool header()
+	  {
+	    if ( _data.compare( 0, magic().size(), magic() ) != 0 )
+	      return false;
+	    _pos = magic().size();
+	    return true;
+	  }
+
+	  bool get( unsigned long long & val_r )
+	  {
+	    if ( _data.size() - _pos < sizeof(val_r) )
+	      return false;
+	    ::memcpy( &val_r, _data.c_str() + _pos, sizeof(val_r) );
+	    _pos += sizeof(val_r);
+	    return true;
+	  }
+
+	  bool get( std::string & val_r )
+	  {
+	    unsigned long long size;
+	    if ( ! get( size ) || _data.size() - _pos < size )
+	      return false;
+	    val_r.assign( _data, _pos, size );
+	    _pos += size;
+	    return true;
+	  }
+
+	  bool get( FileKey & val_r )
+	  {
+	    unsigned long long readable;
+	    if ( ! ( get( val_r.dev ) && get( val_r.ino ) && get( val_r.size )
+		  && get( val_r.mtime ) && get( val_r.ctime ) && get( readable ) ) )
+	      return false;
+	    val_r.readable = readable;
+	    return true;
+	  }
+
+	  bool get( std::vector<std::string> & val_r )
+	  {
+	    unsigned long long size;
+	    if ( ! getSize( size ) )
+	      return false;
+	    val_r.resize( size );
+	    for ( std::string & str : val_r )
+	      if ( ! get( str ) )
+		return false;
+	    return true;
+	  }
+
+	  bool get( RepoSections & val_r )
+	  {
+	    unsigned long long size;
+	    if ( ! getSize( size ) )
+	      return false;
+	    val_r.resize( size );
+	    for ( RepoSection & section : val_r )
+	    {
+	      if ( ! ( get( section.alias ) && getSize( size ) ) )
+		return false;
+	      section.entries.resize( size );
+	      for ( auto & entry : section.entries )
+		if ( ! ( get( entry.first ) && get( entry.second ) ) )
+		  return false;
+	      if ( ! ( get( section.baseurls ) && get( section.gpgkeys ) ) )
+		return false;
+	    }
+	    return true;
+	  }
+
+	private:
+	  /** A number of elements to follow (each takes at least 8 bytes). */
+	  bool getSize( unsigned long long & val_r )
+	  { return get( val_r ) && val_r <= ( _data.size() - _pos ) / sizeof(val_r); }
+
+	  const std::string & _data;
+	  std::string::size_type _pos = 0;
+	};
+      };
+
+      /** Read many .repo files, concurrently and using the cache. */
+      void repositories_in_files( const std::list<Pathname> & repo_files,
+				  const RepoFileReader::ProcessRepo &callback,
+				  const Pathname & cache_r )
+      {
+	std::vector<RepoFile> files( repo_files.size() );
+	{
+	  unsigned idx = 0;
+	  for ( const Pathname & path : repo_files )
+	  {
+	    RepoFile & file( files[idx++] );
+	    file.path = path;
+	    struct ::stat st;
+	    if ( ::stat( path.c_str(), &st ) == 0 )
+	      file.key = FileKey( st );
+	  }
+	}
+
+	if ( ! cache_r.empty() )
+	  RepoFileCache::load( cache_r, files );
+
+	// read the changed files concurrently...
+	std::vector<std::function<void()>> tasks;
+	for ( RepoFile & file : files )
+	{
+	  if ( ! file.valid )
+	    tasks.push_back( [&file]() { readRepoFile( file ); } );
+	}
+	if ( tasks.empty() )
+	  MIL << "All " << files.size() << " repo files unchanged" << endl;
+	else
+	{
+	  thread::runTasks( tasks, std::min( 8U, thread::defaultThreadCount() ) );
+
+	  // ...and parse them (the parser logs, so not concurrently)
+	  for ( RepoFile & file : files )
+	  {
+	    if ( file.valid )
+	      continue;
+	    if ( file.read )
+	    {
+	      std::istringstream str( file.content );
+	      file.sections = parseRepoSections( InputStream( str, file.path.asString() ) );
+	      file.content.clear();
+	    }
+	    else
+	      file.sections = parseRepoSections( InputStream( file.path ) );
+	    file.valid = true;
+	  }
+	  if ( ! cache_r.empty() )
+	    RepoFileCache::store( cache_r, files );
+	}
+
+	for ( const RepoFile & file : files )
+	  repositories_in_sections( file.sections, file.path, callback );
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
     ///////////////////////////////////////////////////////////////////
     //
     //	CLASS NAME : RepoFileReader
@@ -218,6 +637,14 @@ namespace zypp
       repositories_in_stream(is, _callback, progress);
     }
 
+    RepoFileReader::RepoFileReader( const std::list<Pathname> & repo_files,
+                                    const ProcessRepo & callback,
+                                    const Pathname & cache_r )
+      : _callback(callback)
+    {
+      repositories_in_files( repo_files, _callback, cache_r );
+    }
+
     RepoFileReader::~RepoFileReader()
     {}
 
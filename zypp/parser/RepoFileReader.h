@@ -13,6 +13,7 @@
 #define ZYPP_REPO_REPOFILEREADER_H
 
 #include <iosfwd>
+#include <list>
 
 #include "zypp/base/PtrTypes.h"
 #include "zypp/base/InputStream.h"
@@ -97,6 +98,26 @@ namespace zypp
                       const ProcessRepo & callback,
                       const ProgressData::ReceiverFnc &progress = ProgressData::ReceiverFnc() );
 
+     /**
+      * \short Constructor. Creates the reader and reads many .repo files (e.g. repos.d).
+      *
+      * Same as reading the files one after the other, but the files are read
+      * concurrently. If a \a cache_r file is given, the parsed files are stored
+      * there and reused as long as a file does not change (compared by inode,
+      * size, mtime and ctime). So an unchanged configuration is loaded with a
+      * single \c stat per file.
+      *
+      * \param repo_files The .repo files
+      * \param callback Callback that will be called for each repository.
+      * \param cache_r Optional cache file
+      *
+      * \throws AbortRequestException If the callback returns false
+      * \throws Exception If a error occurs at reading / parsing
+      */
+      RepoFileReader( const std::list<Pathname> & repo_files,
+                      const ProcessRepo & callback,
+                      const Pathname & cache_r = Pathname() );
+
       /**
        * Dtor
        */
@@ -10,6 +10,7 @@
  * Implementation of repoindex.xml file reader.
  */
 #include <iostream>
+#include <cstring>
 #include <unordered_map>
 
 #include "zypp/base/String.h"
@@ -59,6 +60,20 @@ namespace zypp
 	  std::string::size_type vbeg = val_r.find( "%{", 0 );
 	  if ( vbeg == std::string::npos )
 	    return val_r;
+	  return replaceVars( val_r, vbeg );
+	}
+
+	/** In place version, not copying values without variables. */
+	void replaceIn( std::string & val_r ) const
+	{
+	  std::string::size_type vbeg = val_r.find( "%{", 0 );
+	  if ( vbeg != std::string::npos )
+	    val_r = replaceVars( val_r, vbeg );
+	}
+
+      private:
+	std::string replaceVars( const std::string & val_r, std::string::size_type vbeg ) const
+	{
 
 	  str::Str ret;
 	  std::string::size_type cbeg = 0;
@@ -88,6 +103,7 @@ namespace zypp
 
 	  return ret;
 	}
+
       private:
 	std::unordered_map<std::string,std::string> _vars;
       };
@@ -116,22 +132,86 @@ namespace zypp
     DefaultIntegral<Date::Duration,0> _ttl;
 
   private:
-    bool getAttrValue( const std::string & key_r, Reader & reader_r, std::string & value_r )
+    /** The <repo> attributes we're interested in.
+     * The buffers are reused for all repos, so reading large
+     * indices does not allocate per attribute.
+     */
+    struct RepoAttrs
     {
-      const XmlString & s( reader_r->getAttribute( key_r ) );
-      if ( s.get() )
+      void clear()
       {
-	value_r = _replacer.replace( s.asString() );
-	return !value_r.empty();
+	alias.clear(); url.clear(); path.clear(); name.clear();
+	distroTarget.clear(); priority.clear(); enabled.clear(); autorefresh.clear();
       }
-      value_r.clear();
-      return false;
+
+      /** Buffer for attribute \a name_r or \c nullptr if not wanted. */
+      std::string * buffer( const char * name_r )
+      {
+	switch ( *name_r )
+	{
+	  case 'a':
+	    if ( ::strcmp( name_r, "alias" ) == 0 )		return &alias;
+	    if ( ::strcmp( name_r, "autorefresh" ) == 0 )	return &autorefresh;
+	    break;
+	  case 'd':
+	    if ( ::strcmp( name_r, "distro_target" ) == 0 )	return &distroTarget;
+	    break;
+	  case 'e':
+	    if ( ::strcmp( name_r, "enabled" ) == 0 )		return &enabled;
+	    break;
+	  case 'n':
+	    if ( ::strcmp( name_r, "name" ) == 0 )		return &name;
+	    break;
+	  case 'p':
+	    if ( ::strcmp( name_r, "path" ) == 0 )		return &path;
+	    if ( ::strcmp( name_r, "priority" ) == 0 )		return &priority;
+	    break;
+	  case 'u':
+	    if ( ::strcmp( name_r, "url" ) == 0 )		return &url;
+	    break;
+	}
+	return nullptr;
+      }
+
+      std::string alias;
+      std::string url;
+      std::string path;
+      std::string name;
+      std::string distroTarget;
+      std::string priority;
+      std::string enabled;
+      std::string autorefresh;
+    };
+
+    /** Read all attributes of the current <repo> node in one pass. */
+    void readRepoAttrs( Reader & reader_r )
+    {
+      _attrs.clear();
+      while ( reader_r.nextNodeAttribute() )
+      {
+	std::string * buffer = _attrs.buffer( reader_r->localName().c_str() );
+	if ( buffer )
+	{
+	  const XmlString & value( reader_r->value() );	// not copied by libxml
+	  if ( value.get() )
+	    buffer->assign( value.c_str() );
+	}
+      }
+      // mandatory, so we can allow it in var replacement without reset
+      _replacer.replaceIn( _attrs.alias );
+      if ( ! _attrs.alias.empty() )
+	_replacer.setVar( "alias", _attrs.alias );
+
+      for ( std::string * value : { &_attrs.url, &_attrs.path, &_attrs.name, &_attrs.distroTarget,
+				    &_attrs.priority, &_attrs.enabled, &_attrs.autorefresh } )
+	_replacer.replaceIn( *value );
     }
 
   private:
     /** Function for processing collected data. Passed-in through constructor. */
     ProcessResource _callback;
     VarReplacer _replacer;
+    RepoAttrs _attrs;
   };
   ///////////////////////////////////////////////////////////////////////
 
@@ -184,25 +264,19 @@ namespace zypp
         info.setAutorefresh( true );
 	info.setEnabled(false);
 
-	std::string attrValue;
+	readRepoAttrs( reader_r );
 
 	// required alias
-	// mandatory, so we can allow it in var replacement without reset
-	if ( getAttrValue( "alias", reader_r, attrValue ) )
-	{
-	  info.setAlias( attrValue );
-	  _replacer.setVar( "alias", attrValue );
-	}
+	if ( ! _attrs.alias.empty() )
+	  info.setAlias( _attrs.alias );
 	else
 	  throw ParseException(str::form(_("Required attribute '%s' is missing."), "alias"));
 
         // required url
 	// SLES HACK: or path, but beware of the hardcoded '/repo' prefix!
 	{
-	  std::string urlstr;
-	  std::string pathstr;
-	  getAttrValue( "url", reader_r, urlstr );
-	  getAttrValue( "path", reader_r, pathstr );
+	  const std::string & urlstr( _attrs.url );
+	  const std::string & pathstr( _attrs.path );
 	  if ( urlstr.empty() )
 	  {
 	    if ( pathstr.empty() )
@@ -224,25 +298,25 @@ namespace zypp
 	}
 
         // optional name
-        if ( getAttrValue( "name", reader_r, attrValue ) )
-          info.setName( attrValue );
+        if ( ! _attrs.name.empty() )
+          info.setName( _attrs.name );
 
         // optional targetDistro
-        if ( getAttrValue( "distro_target", reader_r, attrValue ) )
-          info.setTargetDistribution( attrValue );
+        if ( ! _attrs.distroTarget.empty() )
+          info.setTargetDistribution( _attrs.distroTarget );
 
         // optional priority
-        if ( getAttrValue( "priority", reader_r, attrValue ) )
-          info.setPriority( str::strtonum<unsigned>( attrValue ) );
+        if ( ! _attrs.priority.empty() )
+          info.setPriority( str::strtonum<unsigned>( _attrs.priority ) );
 
 
         // optional enabled
-        if ( getAttrValue( "enabled", reader_r, attrValue ) )
-          info.setEnabled( str::strToBool( attrValue, info.enabled() ) );
+        if ( ! _attrs.enabled.empty() )
+          info.setEnabled( str::strToBool( _attrs.enabled, info.enabled() ) );
 
         // optional autorefresh
-	if ( getAttrValue( "autorefresh", reader_r, attrValue ) )
-	  info.setAutorefresh( str::strToBool( attrValue, info.autorefresh() ) );
+	if ( ! _attrs.autorefresh.empty() )
+	  info.setAutorefresh( str::strToBool( _attrs.autorefresh, info.autorefresh() ) );
 
         DBG << info << endl;
 
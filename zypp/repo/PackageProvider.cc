@@ -10,16 +10,17 @@
  *
 */
 #include <iostream>
-#include <fstream>
 #include <sstream>
 #include "zypp/repo/PackageDelta.h"
 #include "zypp/base/Logger.h"
+#include "zypp/base/Measure.h"
 #include "zypp/base/Gettext.h"
 #include "zypp/base/UserRequestException.h"
 #include "zypp/base/NonCopyable.h"
 #include "zypp/repo/PackageProvider.h"
 #include "zypp/repo/Applydeltarpm.h"
 #include "zypp/repo/PackageDelta.h"
+#include "zypp/repo/PackageStore.h"
 
 #include "zypp/TmpPath.h"
 #include "zypp/ZConfig.h"
@@ -189,6 +190,33 @@ namespace zypp
 	return ret;
       }
 
+      /** Whether \ref packageSigCheck must not relax \c CHK_NOSIG for packages from \a info_r. */
+      bool pkgGpgCheckIsMandatory( const RepoInfo & info_r ) const
+      {
+#if ( 1 )
+	bool ret = info_r.pkgGpgCheckIsMandatory();
+	if ( str::startsWith( VERSION, "16.15." ) )
+	{
+	  // BSC#1038984: For a short period of time, libzypp-16.15.x
+	  // will silently accept unsigned packages IFF a repositories gpgcheck
+	  // configuration is explicitly turned OFF like this:
+	  //     gpgcheck      = 0
+	  //     repo_gpgcheck = 0
+	  //     pkg_gpgcheck  = 1
+	  // This will allow some already released products to adapt to the behavioral
+	  // changes introduced by fixing BSC#1038984, while systems with a default
+	  // configuration (gpgcheck = 1) already benefit from the fix.
+	  // With libzypp-16.16.x the above configuration will reject unsigned packages
+	  // as it should.
+	  if ( ret && !info_r.gpgCheck() && !info_r.repoGpgCheck() )
+	    ret = false;
+	}
+	return ret;
+#else
+	return info_r.pkgGpgCheckIsMandatory();
+#endif
+      }
+
       /** React on signature verification error user action
        * \note: IGNORE == accept insecure file (no SkipRequestException!)
        */
@@ -247,6 +275,8 @@ namespace zypp
     template <class TPackage>
     ManagedFile PackageProviderImpl<TPackage>::providePackage() const
     {
+      debug::TraceSpan span( "package", "provide" );
+      span.tag( "package", _package );
       ScopedGuard guardReport( newReport() );
 
       // check for cache hit:
@@ -270,7 +300,7 @@ namespace zypp
 	  if ( ! loc.checksum().empty() )	// no cache hit without checksum
 	  {
 	    PathInfo pi( topCache.repoPackagesCachePath / info.packagesPath().basename() / info.path() / loc.filename() );
-	    if ( pi.isExist() && loc.checksum() == CheckSum( loc.checksum().type(), std::ifstream( pi.c_str() ) ) )
+	    if ( pi.isExist() && filesystem::is_checksum( pi.path(), loc.checksum() ) )
 	    {
 	      report()->start( _package, pi.path().asFileUrl() );
 	      const Pathname & dest( info.packagesPath() / info.path() / loc.filename() );
@@ -289,6 +319,50 @@ namespace zypp
 	}
       }
 
+      // Check the shared package store
+      PackageStore store;
+      if ( store.enabled() )
+      {
+	const OnMediaLocation & loc( _package->location() );
+	const Pathname & dest( info.packagesPath() / info.path() / loc.filename() );
+	if ( store.provide( loc.checksum(), dest ) )
+	{
+	  ret = ManagedFile( dest );
+	  if ( ! info.keepPackages() )
+	    ret.setDispose( filesystem::unlink );
+
+	  // The store is shared across repos and roots, so the package may
+	  // have been stored unchecked or checked against another keyring.
+	  UserData userData( "pkgGpgCheck" );
+	  if ( info.pkgGpgCheck() )
+	  {
+	    ResObject::constPtr roptr( _package );
+	    userData.set( "ResObject", roptr );
+	    /*legacy:*/userData.set( "Package", roptr->asKind<Package>() );
+	    userData.set( "Localpath", ret.value() );
+	    RpmDb::CheckPackageResult res = packageSigCheck( ret, pkgGpgCheckIsMandatory( info ), userData );
+	    if ( res != RpmDb::CHK_OK )
+	    {
+	      // Evict it, as the download below would find it in the store again.
+	      WAR << "Dropping package store hit " << _package << ": " << res << endl;
+	      ret.setDispose( filesystem::unlink );
+	      ret.reset();
+	      store.remove( loc.checksum() );
+	    }
+	  }
+
+	  if ( ! ret->empty() )
+	  {
+	    report()->start( _package, store.location( loc.checksum() ).asFileUrl() );
+	    if ( info.pkgGpgCheck() )
+	      report()->pkgGpgCheck( userData );
+	    MIL << "provided Package from package store " << _package << " at " << ret << endl;
+	    report()->finish( _package, repo::DownloadResolvableReport::NO_ERROR, std::string() );
+	    return ret; // <-- package store hit
+	  }
+	}
+      }
+
       // FIXME we only support the first url for now.
       if ( info.baseUrlsEmpty() )
         ZYPP_THROW(Exception("No url in repository."));
@@ -315,28 +389,7 @@ namespace zypp
 	      userData.set( "ResObject", roptr );	// a type for '_package->asKind<ResObject>()'...
 	      /*legacy:*/userData.set( "Package", roptr->asKind<Package>() );
 	      userData.set( "Localpath", ret.value() );
-#if ( 1 )
-	      bool pkgGpgCheckIsMandatory = info.pkgGpgCheckIsMandatory();
-	      if ( str::startsWith( VERSION, "16.15." ) )
-	      {
-		// BSC#1038984: For a short period of time, libzypp-16.15.x
-		// will silently accept unsigned packages IFF a repositories gpgcheck
-		// configuration is explicitly turned OFF like this:
-		//     gpgcheck      = 0
-		//     repo_gpgcheck = 0
-		//     pkg_gpgcheck  = 1
-		// This will allow some already released products to adapt to the behavioral
-		// changes introduced by fixing BSC#1038984, while systems with a default
-		// configuration (gpgcheck = 1) already benefit from the fix.
-		// With libzypp-16.16.x the above configuration will reject unsigned packages
-		// as it should.
-		if ( pkgGpgCheckIsMandatory && !info.gpgCheck() && !info.repoGpgCheck() )
-		  pkgGpgCheckIsMandatory = false;
-	      }
-	      RpmDb::CheckPackageResult res = packageSigCheck( ret, pkgGpgCheckIsMandatory, userData );
-#else
-	      RpmDb::CheckPackageResult res = packageSigCheck( ret, info.pkgGpgCheckIsMandatory(), userData );
-#endif
+	      RpmDb::CheckPackageResult res = packageSigCheck( ret, pkgGpgCheckIsMandatory( info ), userData );
 	      // publish the checkresult, even if it is OK. Apps may want to report something...
 	      report()->pkgGpgCheck( userData );
 
@@ -442,6 +495,9 @@ namespace zypp
 	throw;
       }
 
+      if ( store.enabled() && ! ret->empty() )
+	store.add( _package->location().checksum(), ret );
+
       report()->finish( _package, repo::DownloadResolvableReport::NO_ERROR, std::string() );
       MIL << "provided Package " << _package << " at " << ret << endl;
       return ret;
@@ -0,0 +1,271 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/PackageStore.cc
+ *
+*/
+extern "C"
+{
+#include <sys/stat.h>
+}
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/repo/PackageStore.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/ZConfig.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** A stored file and its LRU data. */
+      struct StoreEntry
+      {
+	StoreEntry( Pathname path_r, const PathInfo & pi_r )
+	: path( std::move(path_r) ), mtime( pi_r.mtime() ), size( pi_r.size() )
+	{}
+
+	bool operator<( const StoreEntry & rhs ) const
+	{ return mtime < rhs.mtime; }
+
+	Pathname path;
+	time_t   mtime;
+	off_t    size;
+      };
+
+      /** Identifies the state of a stored file; any write changes the ctime. */
+      struct FileStamp
+      {
+	bool operator==( const FileStamp & rhs ) const
+	{ return ino == rhs.ino && size == rhs.size && ctime == rhs.ctime && ctimens == rhs.ctimens; }
+
+	ino_t  ino;
+	off_t  size;
+	time_t ctime;
+	long   ctimens;
+      };
+
+      bool fileStamp( const Pathname & file_r, FileStamp & stamp_r )
+      {
+	struct ::stat st;
+	if ( ::stat( file_r.c_str(), &st ) != 0 )
+	  return false;
+	stamp_r.ino = st.st_ino;
+	stamp_r.size = st.st_size;
+	stamp_r.ctime = st.st_ctim.tv_sec;
+	stamp_r.ctimens = st.st_ctim.tv_nsec;
+	return true;
+      }
+
+      /** Stored files verified by this process, so a hit is not hashed again. */
+      class VerifiedFiles
+      {
+      public:
+	bool contains( const Pathname & file_r )
+	{
+	  FileStamp stamp;
+	  if ( ! fileStamp( file_r, stamp ) )
+	    return false;
+	  std::lock_guard<std::mutex> guard( _mutex );
+	  auto it( _files.find( file_r.asString() ) );
+	  return it != _files.end() && it->second == stamp;
+	}
+
+	void insert( const Pathname & file_r )
+	{
+	  FileStamp stamp;
+	  if ( fileStamp( file_r, stamp ) )
+	  {
+	    std::lock_guard<std::mutex> guard( _mutex );
+	    _files[file_r.asString()] = stamp;
+	  }
+	}
+
+	void erase( const Pathname & file_r )
+	{
+	  std::lock_guard<std::mutex> guard( _mutex );
+	  _files.erase( file_r.asString() );
+	}
+
+      private:
+	std::mutex _mutex;
+	std::unordered_map<std::string,FileStamp> _files;
+      };
+
+      VerifiedFiles & verifiedFiles()
+      {
+	static VerifiedFiles _files;
+	return _files;
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    PackageStore::PackageStore()
+    : _root( ZConfig::instance().download_packageStorePath() )
+    , _sizeLimit( ZConfig::instance().download_packageStoreSize() )
+    {}
+
+    PackageStore::PackageStore( const Pathname & root_r, const ByteCount & sizeLimit_r )
+    : _root( root_r )
+    , _sizeLimit( sizeLimit_r )
+    {}
+
+    Pathname PackageStore::location( const CheckSum & checksum_r ) const
+    {
+      if ( ! enabled() || checksum_r.empty() )
+	return Pathname();
+      // checksum() is plain hex, type() something like 'sha256'
+      const std::string & sum( str::toLower( checksum_r.checksum() ) );
+      if ( sum.size() < 3 || sum.find( '/' ) != std::string::npos )
+	return Pathname();
+      return _root / str::toLower( checksum_r.type() ) / sum.substr( 0, 2 ) / sum;
+    }
+
+    bool PackageStore::contains( const CheckSum & checksum_r ) const
+    {
+      const Pathname & file( location( checksum_r ) );
+      return ! file.empty() && PathInfo( file ).isFile();
+    }
+
+    Pathname PackageStore::lookup( const CheckSum & checksum_r ) const
+    {
+      const Pathname & file( location( checksum_r ) );
+      if ( file.empty() || ! PathInfo( file ).isFile() )
+	return Pathname();
+
+      if ( ! verifiedFiles().contains( file ) && ! filesystem::is_checksum( file, checksum_r ) )
+      {
+	WAR << "Removing broken file from package store: " << file << endl;
+	remove( checksum_r );
+	return Pathname();
+      }
+      filesystem::touch( file );	// LRU stamp
+      verifiedFiles().insert( file );	// with the ctime changed by touch
+      return file;
+    }
+
+    bool PackageStore::remove( const CheckSum & checksum_r ) const
+    {
+      const Pathname & file( location( checksum_r ) );
+      if ( file.empty() )
+	return false;
+      verifiedFiles().erase( file );
+      return filesystem::unlink( file ) == 0;
+    }
+
+    bool PackageStore::provide( const CheckSum & checksum_r, const Pathname & dest_r ) const
+    {
+      const Pathname & file( lookup( checksum_r ) );
+      if ( file.empty() )
+	return false;
+
+      if ( filesystem::assert_dir( dest_r.dirname() ) != 0
+	|| filesystem::hardlinkCopy( file, dest_r ) != 0 )
+      {
+	ERR << "Unable to provide " << dest_r << " from package store" << endl;
+	return false;
+      }
+      MIL << "Provided " << dest_r << " from package store (" << checksum_r << ")" << endl;
+      return true;
+    }
+
+    bool PackageStore::add( const CheckSum & checksum_r, const Pathname & file_r ) const
+    {
+      const Pathname & file( location( checksum_r ) );
+      if ( file.empty() )
+	return false;
+      if ( PathInfo( file ).isFile() )
+	return true;	// no need to verify, lookup will do it
+
+      if ( filesystem::assert_dir( file.dirname() ) != 0 )
+	return false;
+
+      // Create it aside and rename, as other processes may share the store.
+      filesystem::TmpFile tmp( filesystem::TmpFile::makeSibling( file ) );
+      if ( tmp.path().empty()
+	|| filesystem::hardlinkCopy( file_r, tmp.path() ) != 0
+	|| filesystem::rename( tmp.path(), file ) != 0 )
+      {
+	ERR << "Unable to add " << file_r << " to package store" << endl;
+	return false;
+      }
+      MIL << "Added " << file_r << " to package store (" << checksum_r << ")" << endl;
+      return true;
+    }
+
+    void PackageStore::cleanup() const
+    {
+      if ( ! enabled() || ! _sizeLimit )
+	return;
+
+      std::vector<StoreEntry> entries;
+      ByteCount::SizeType total = 0;
+      // STORE/<type>/<xx>/<checksum>
+      filesystem::dirForEach( _root, [&]( const Pathname & root_r, const char *const type_r )->bool
+      {
+	filesystem::dirForEach( root_r/type_r, [&]( const Pathname & type_r, const char *const xx_r )->bool
+	{
+	  filesystem::dirForEach( type_r/xx_r, [&]( const Pathname & xx_r, const char *const name_r )->bool
+	  {
+	    PathInfo pi( xx_r/name_r );
+	    if ( pi.isFile() )
+	    {
+	      entries.push_back( StoreEntry( pi.path(), pi ) );
+	      total += pi.size();
+	    }
+	    return true;
+	  });
+	  return true;
+	});
+	return true;
+      });
+
+      if ( total <= _sizeLimit )
+	return;
+
+      MIL << *this << ": " << ByteCount( total ) << " in " << entries.size() << " files; cleaning up..." << endl;
+      std::sort( entries.begin(), entries.end() );
+      unsigned removed = 0;
+      for ( const StoreEntry & entry : entries )
+      {
+	if ( total <= _sizeLimit )
+	  break;
+	if ( filesystem::unlink( entry.path ) == 0 )
+	{
+	  total -= entry.size;
+	  ++removed;
+	}
+      }
+      MIL << *this << ": removed " << removed << " files, " << ByteCount( total ) << " left." << endl;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const PackageStore & obj )
+    {
+      if ( ! obj.enabled() )
+	return str << "PackageStore(disabled)";
+      return str << "PackageStore(" << obj.root() << ", " << obj.sizeLimit() << ")";
+    }
+
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,124 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/PackageStore.h
+ *
+*/
+#ifndef ZYPP_REPO_PACKAGESTORE_H
+#define ZYPP_REPO_PACKAGESTORE_H
+
+#include <iosfwd>
+
+#include "zypp/Pathname.h"
+#include "zypp/CheckSum.h"
+#include "zypp/ByteCount.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class PackageStore
+    /// \brief Content addressed package store shared by all repos and roots.
+    ///
+    /// Packages are kept as \c STORE/<type>/<xx>/<checksum>, where \c xx are
+    /// the first two digits of the checksum. The same file published by
+    /// different repos, or needed for different roots on the same host, is
+    /// stored and downloaded just once. Files are handed out via hardlink,
+    /// reflink or copy (\ref filesystem::hardlinkCopy).
+    ///
+    /// The store location is not prefixed by any target root. The files
+    /// mtime is used as LRU stamp: it's updated on each hit, and \ref cleanup
+    /// removes the least recently used files until the store fits into
+    /// its size limit.
+    ///
+    /// \code
+    ///   PackageStore store;	// as configured in zypp.conf
+    ///   if ( ! store.provide( loc.checksum(), dest ) )
+    ///   {
+    ///     // download to dest...
+    ///     store.add( loc.checksum(), dest );
+    ///   }
+    /// \endcode
+    ///////////////////////////////////////////////////////////////////
+    class PackageStore
+    {
+    public:
+      /** Default ctor: the store configured in \c zypp.conf (maybe disabled).
+       * \see \ref ZConfig::download_packageStorePath
+       */
+      PackageStore();
+
+      /** Ctor taking the stores root directory and size limit (0: no limit). */
+      explicit PackageStore( const Pathname & root_r, const ByteCount & sizeLimit_r = ByteCount() );
+
+    public:
+      /** Whether a store location is defined. */
+      bool enabled() const
+      { return ! _root.empty(); }
+
+      /** The stores root directory. */
+      const Pathname & root() const
+      { return _root; }
+
+      /** The stores size limit (0: no limit). */
+      const ByteCount & sizeLimit() const
+      { return _sizeLimit; }
+
+      /** Where a file with \a checksum_r is stored (empty if no store or no checksum). */
+      Pathname location( const CheckSum & checksum_r ) const;
+
+      /** Whether the store contains a file with \a checksum_r. */
+      bool contains( const CheckSum & checksum_r ) const;
+
+      /** Return the stored file with \a checksum_r or an empty \ref Pathname.
+       * The files checksum is verified and broken files are removed. A file
+       * is verified once per process, unless it was modified meanwhile (by
+       * inode, size and ctime). On success the files LRU stamp is updated.
+       * The returned file must not be modified.
+       */
+      Pathname lookup( const CheckSum & checksum_r ) const;
+
+      /** Remove the stored file with \a checksum_r, e.g. if it was rejected
+       * by the signature check, so it will be downloaded again.
+       * \return Whether a file was removed.
+       */
+      bool remove( const CheckSum & checksum_r ) const;
+
+      /** Provide the stored file with \a checksum_r at \a dest_r.
+       * \return Whether the file was found and \a dest_r was created.
+       */
+      bool provide( const CheckSum & checksum_r, const Pathname & dest_r ) const;
+
+      /** Add \a file_r to the store (if not yet present).
+       * The caller is responsible for \a file_r actually having the
+       * checksum \a checksum_r (\ref lookup will check it).
+       * \return Whether the file is present in the store now.
+       */
+      bool add( const CheckSum & checksum_r, const Pathname & file_r ) const;
+
+      /** Remove the least recently used files until the store fits into
+       * its \ref sizeLimit. A no-op if there is no limit.
+       */
+      void cleanup() const;
+
+    private:
+      Pathname  _root;
+      ByteCount _sizeLimit;
+    };
+
+    /** \relates PackageStore Stream output */
+    std::ostream & operator<<( std::ostream & str, const PackageStore & obj );
+
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_REPO_PACKAGESTORE_H
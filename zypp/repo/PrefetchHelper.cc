@@ -0,0 +1,41 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/PrefetchHelper.cc
+ *
+*/
+#include <cstdlib>
+
+#include "zypp/base/Logger.h"
+#include "zypp/repo/PrefetchHelper.h"
+#include "zypp/PathInfo.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  {
+    Pathname prefetchHelper()
+    {
+      const char * env = ::getenv( "ZYPP_PREFETCH_HELPER" );
+      Pathname ret( env && *env ? env : ZYPP_PREFETCH_HELPER );
+      if ( ! PathInfo( ret ).userMayX() )
+      {
+	WAR << "No prefetch helper " << ret << endl;
+	return Pathname();
+      }
+      return ret;
+    }
+
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
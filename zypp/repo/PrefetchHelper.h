@@ -0,0 +1,40 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/PrefetchHelper.h
+ *
+*/
+#ifndef ZYPP_REPO_PREFETCHHELPER_H
+#define ZYPP_REPO_PREFETCHHELPER_H
+
+#include "zypp/Pathname.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  {
+    /** The \c zypp-prefetch helper program, fetching data ahead in a separate process.
+     *
+     * Just forking the application is not safe: a lock held by some other
+     * thread at fork time is never released in the child, and the media
+     * backends, \ref Url and the logger use such locks. So the prefetch runs
+     * in a new process image, started via \ref ExternalProgram.
+     *
+     * \c $ZYPP_PREFETCH_HELPER overrides the installed helper (e.g. in the
+     * testsuite). Returns an empty path if the helper is not executable, so
+     * nothing is prefetched.
+     */
+    Pathname prefetchHelper();
+
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_REPO_PREFETCHHELPER_H
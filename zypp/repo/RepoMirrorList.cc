@@ -15,6 +15,8 @@
 #include <time.h>
 #include "zypp/repo/RepoMirrorList.h"
 #include "zypp/media/MetaLinkParser.h"
+#include "zypp/media/MediaManager.h"
+#include "zypp/media/MirrorScoreboard.h"
 #include "zypp/MediaSetAccess.h"
 #include "zypp/base/LogTools.h"
 #include "zypp/ZConfig.h"
@@ -113,11 +115,13 @@ namespace zypp
 	      murl.setPathName( murl.getPathName().erase(delpos)  );
 	    }
 	    ret.push_back( murl );
-
-	    if ( ret.size() >= 4 )	// why 4?
-	      break;
 	  }
 	}
+
+	// prefer the mirrors which did well before
+	media::MediaManager::mirrorScoreboard().rank( ret );
+	if ( ret.size() > 4 )	// why 4?
+	  ret.resize( 4 );
 	return ret;
       }
 
@@ -21,6 +21,8 @@
 #include "zypp/repo/RepoProvideFile.h"
 #include "zypp/ZYppCallbacks.h"
 #include "zypp/MediaSetAccess.h"
+#include "zypp/media/MediaManager.h"
+#include "zypp/media/MirrorScoreboard.h"
 #include "zypp/ZConfig.h"
 #include "zypp/ZYppFactory.h"
 #include "zypp/repo/SUSEMediaVerifier.h"
@@ -296,12 +298,12 @@ namespace zypp
       // Suppress (interactive) media::MediaChangeReport if we in have multiple basurls (>1)
       media::ScopedDisableMediaChangeReport guard( repo_r.baseUrlsSize() > 1 );
 
-      for ( RepoInfo::urls_const_iterator it = repo_r.baseUrlsBegin();
-            it != repo_r.baseUrlsEnd();
-            /* incremented in the loop */ )
+      // Try the baseurls which did well before first.
+      std::vector<Url> baseUrls( repo_r.baseUrlsBegin(), repo_r.baseUrlsEnd() );
+      media::MediaManager::mirrorScoreboard().rank( baseUrls );
+
+      for ( const Url & url : baseUrls )
       {
-        Url url( *it );
-        ++it;
         try
         {
           MIL << "Providing file of repo '" << repo_r.alias() << "' from " << url << endl;
@@ -82,7 +82,7 @@ bool Downloader::patches_Callback( const OnMediaLocation & loc_r, const string &
 {
   OnMediaLocation loc_with_path(loc_with_path_prefix(loc_r, repoInfo().path()));
   MIL << id_r << " : " << loc_with_path << endl;
-  this->enqueueDigested(loc_with_path,  FileChecker(), search_deltafile(_delta_dir + "repodata", loc_r.filename()));
+  this->enqueueDigested(loc_with_path,  FileChecker(), search_deltafile(_delta_dir / repoInfo().path() / "repodata", loc_r.filename()));
   return true;
 }
 
@@ -159,7 +159,7 @@ bool Downloader::repomd_Callback( const OnMediaLocation & loc_r, const ResourceT
 
   // schedule file for download
   const OnMediaLocation & loc_with_path(loc_with_path_prefix(loc_r, repoInfo().path()));
-  this->enqueueDigested(loc_with_path, FileChecker(), search_deltafile(_delta_dir + "repodata", loc_r.filename()));
+  this->enqueueDigested(loc_with_path, FileChecker(), search_deltafile(_delta_dir / repoInfo().path() / "repodata", loc_r.filename()));
 
   // We got a patches file we need to read, to add patches listed
   // there, so we transfer what we have in the queue, and
@@ -49,6 +49,9 @@ namespace zypp
          * to the user when something fails.
          *
          * \param info Repository information
+         * \param delta_dir Old copy of the repos raw metadata. Files found
+         * there are used for block level delta transfer (zsync or metalink)
+         * if the server supports it.
          */
         Downloader( const RepoInfo &info , const Pathname &delta_dir = Pathname());
 
@@ -34,6 +34,14 @@ namespace zypp
 
     using detail::noSolvableId;
 
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      inline detail::PoolImpl & myPool()
+      { return detail::PoolMember::myPool(); }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
     ///////////////////////////////////////////////////////////////////
     //
     //	CLASS NAME : LookupAttr::Impl
@@ -135,7 +143,11 @@ namespace zypp
           else if ( _repo )
             whichRepo = _repo.id();
 
-          detail::DIWrap dip( whichRepo, _solv.id(), _attr.id(), _strMatcher.searchstring(), _strMatcher.flags().get() );
+          detail::DIWrap dip;
+          if ( _strMatcher.isMultiPattern() ) // libsolv can't, the iterator filters
+            detail::DIWrap( whichRepo, _solv.id(), _attr.id(), _strMatcher ).swap( dip );
+          else
+            detail::DIWrap( whichRepo, _solv.id(), _attr.id(), _strMatcher.searchstring(), _strMatcher.flags().get() ).swap( dip );
           if ( _parent != SolvAttr::noAttr )
             ::dataiterator_prepend_keyname( dip.get(), _parent.id() );
 
@@ -313,9 +325,20 @@ namespace zypp
                              _mstring.empty() ? 0 : _mstring.c_str(), flags_r );
       }
 
+      DIWrap::DIWrap( RepoIdType repoId_r, SolvableIdType solvId_r, IdType attrId_r,
+                      const StrMatcher & filter_r )
+      : _dip( new ::Dataiterator )
+      , _filter( new StrMatcher( filter_r ) )
+      {
+        _filter->compile();
+        ::dataiterator_init( _dip, sat::Pool::instance().get(), repoId_r, solvId_r, attrId_r,
+                             0, filter_r.flags().flagval() );
+      }
+
       DIWrap::DIWrap( const DIWrap & rhs )
         : _dip( 0 )
         , _mstring( rhs._mstring )
+        , _filter( rhs._filter )
       {
         if ( rhs._dip )
         {
@@ -601,9 +624,17 @@ namespace zypp
 
           case REPOKEY_TYPE_DIRSTRARRAY:
 	    // may or may not be stringified depending on SEARCH_FILES flag
-            return( _dip->flags & SEARCH_FILES
-		    ? _dip->kv.str
-		    : ::repodata_dir2str( _dip->data, _dip->kv.id, _dip->kv.str ) );
+            if ( _dip->flags & SEARCH_FILES )
+              return _dip->kv.str;
+            if ( ! myPool().frozen() )
+              return ::repodata_dir2str( _dip->data, _dip->kv.id, _dip->kv.str );
+            {
+              // repodata_dir2str uses the pools temporary string space.
+              static thread_local std::string ret;
+              auto lock( myPool().frozenLock() );
+              ret = ::repodata_dir2str( _dip->data, _dip->kv.id, _dip->kv.str );
+              return ret.c_str();
+            }
             break;
         }
       }
@@ -620,7 +651,7 @@ namespace zypp
           case REPOKEY_TYPE_IDARRAY:
           case REPOKEY_TYPE_CONSTANTID:
             {
-              detail::IdType id = ::repodata_globalize_id( _dip->data, _dip->kv.id, 1 );
+              detail::IdType id = ::repodata_globalize_id( _dip->data, _dip->kv.id, /*create*/! myPool().frozen() );
               return ISRELDEP(id) ? Capability( id ).asString()
                                   : IdString( id ).asString();
             }
@@ -674,7 +705,7 @@ namespace zypp
           case REPOKEY_TYPE_ID:
           case REPOKEY_TYPE_IDARRAY:
           case REPOKEY_TYPE_CONSTANTID:
-            return IdString( ::repodata_globalize_id( _dip->data, _dip->kv.id, 1 ) );
+            return IdString( ::repodata_globalize_id( _dip->data, _dip->kv.id, /*create*/! myPool().frozen() ) );
             break;
         }
       }
@@ -685,6 +716,7 @@ namespace zypp
     {
       if ( _dip )
       {
+        auto lock( myPool().frozenLock() );	// repodata_chk2str
         switch ( solvAttrType() )
         {
           case REPOKEY_TYPE_MD5:
@@ -762,7 +794,7 @@ namespace zypp
 
     detail::IdType LookupAttr::iterator::dereference() const
     {
-      return _dip ? ::repodata_globalize_id( _dip->data, _dip->kv.id, 1 )
+      return _dip ? ::repodata_globalize_id( _dip->data, _dip->kv.id, /*create*/! myPool().frozen() )
                   : detail::noId;
     }
 
@@ -770,7 +802,16 @@ namespace zypp
     {
       if ( _dip )
       {
-	if ( ! ::dataiterator_step( _dip.get() ) )
+	// Matching files or checksums stringifies them in the pools temporary string space.
+	auto lock( _dip->flags & (SEARCH_FILES|SEARCH_CHECKSUMS) ? myPool().frozenLock() : myPool().lookupLock() );
+	bool found = ::dataiterator_step( _dip.get() );
+	if ( const StrMatcher * filter = _dip.filter() )
+	{
+	  // Like libsolv does when matching: values which can't be stringified don't match.
+	  while ( found && ! filter->doMatch( ::repodata_stringify( _dip->pool, _dip->data, _dip->key, &_dip->kv, _dip->flags ) ) )
+	    found = ::dataiterator_step( _dip.get() );
+	}
+	if ( ! found )
 	{
 	  _dip.reset();
 	  base_reference() = 0;
@@ -302,6 +302,11 @@ namespace zypp
           /** \overload to catch \c NULL \a mstring_r. */
           DIWrap( RepoIdType repoId_r, SolvableIdType solvId_r, IdType attrId_r,
                   const char * mstring_r, int flags_r = 0 );
+          /** Initializes to visit all values and pass just those matching \a filter_r.
+           * For matchers libsolv can't evaluate (\ref StrMatcher::isMultiPattern).
+           */
+          DIWrap( RepoIdType repoId_r, SolvableIdType solvId_r, IdType attrId_r,
+                  const StrMatcher & filter_r );
           DIWrap( const DIWrap & rhs );
           ~DIWrap();
         public:
@@ -311,6 +316,7 @@ namespace zypp
             {
               std::swap( _dip, rhs._dip );
               std::swap( _mstring, rhs._mstring );
+              std::swap( _filter, rhs._filter );
             }
           }
           DIWrap & operator=( const DIWrap & rhs )
@@ -330,10 +336,13 @@ namespace zypp
           detail::CDataiterator * operator->() const  { return _dip; }
           detail::CDataiterator * get()        const  { return _dip; }
           const std::string & getstr()   const  { return _mstring; }
+          /** The \ref StrMatcher filtering the values or \c NULL. */
+          const StrMatcher * filter()    const  { return _filter.get(); }
 
 	private:
           detail::CDataiterator * _dip;
           std::string _mstring;
+          shared_ptr<const StrMatcher> _filter;
       };
       /** \relates DIWrap Stream output. */
       std::ostream & operator<<( std::ostream & str, const DIWrap & obj );
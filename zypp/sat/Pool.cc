@@ -11,13 +11,17 @@
 */
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <fcntl.h>
+#include <unistd.h>
 
 extern "C"
 {
 #include <solv/pool.h>
 #include <solv/repo.h>
 #include <solv/solvable.h>
+#include <solv/repodata.h>
+#include <solv/repo_write.h>
 }
 
 #include <iostream>
@@ -27,12 +31,16 @@ extern "C"
 #include "zypp/base/Logger.h"
 #include "zypp/base/Gettext.h"
 #include "zypp/base/Exception.h"
+#include "zypp/base/String.h"
 
 #include "zypp/AutoDispose.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
 
 #include "zypp/sat/detail/PoolImpl.h"
 #include "zypp/sat/Pool.h"
 #include "zypp/sat/LookupAttr.h"
+#include "zypp/sat/Queue.h"
 
 using std::endl;
 
@@ -256,16 +264,52 @@ namespace zypp
 	  << obj.solvablesSize() << "slov}";
     }
 
+    AutoDispose<FILE*> openSolvFile( const Pathname & solvfile_r )
+    {
+      int fd = ::open( solvfile_r.c_str(), O_RDONLY|O_CLOEXEC );
+      if ( fd == -1 )
+	return AutoDispose<FILE*>( (FILE*)nullptr );
+
+      struct stat st;
+      if ( ::fstat( fd, &st ) == 0 && st.st_size > 0 && ! ::getenv( "ZYPP_SOLV_NO_MMAP" ) )
+      {
+	size_t len = st.st_size;
+	// Shared mapping: the pages are the page cache pages, not a private copy.
+	void * addr = ::mmap( nullptr, len, PROT_READ, MAP_SHARED, fd, 0 );
+	if ( addr != MAP_FAILED )
+	{
+	  ::close( fd );	// the mapping stays valid
+	  ::madvise( addr, len, MADV_SEQUENTIAL );
+	  ::madvise( addr, len, MADV_WILLNEED );
+	  FILE * file = ::fmemopen( addr, len, "r" );
+	  if ( file )
+	    return AutoDispose<FILE*>( file, [addr,len]( FILE * file_r ) { ::fclose( file_r ); ::munmap( addr, len ); } );
+	  ::munmap( addr, len );
+	  WAR << "Can't fmemopen " << solvfile_r << ": " << Errno() << endl;
+	  return AutoDispose<FILE*>( ::fopen( solvfile_r.c_str(), "re" ), ::fclose );
+	}
+	DBG << "Can't mmap " << solvfile_r << ": " << Errno() << endl;
+      }
+
+      // Fallback: read the file via stdio.
+      FILE * file = ::fdopen( fd, "re" );
+      if ( ! file )
+      {
+	::close( fd );
+	return AutoDispose<FILE*>( (FILE*)nullptr );
+      }
+      return AutoDispose<FILE*>( file, ::fclose );
+    }
+
     /////////////////////////////////////////////////////////////////
     #undef ZYPP_BASE_LOGGER_LOGGROUP
     #define ZYPP_BASE_LOGGER_LOGGROUP "solvidx"
 
     void updateSolvFileIndex( const Pathname & solvfile_r )
     {
-      AutoDispose<FILE*> solv( ::fopen( solvfile_r.c_str(), "re" ), ::fclose );
+      AutoDispose<FILE*> solv( openSolvFile( solvfile_r ) );
       if ( solv == NULL )
       {
-	solv.resetDispose();
 	ERR << "Can't open solv-file: " << solv << endl;
 	return;
       }
@@ -315,6 +359,115 @@ namespace zypp
       ::pool_free( _pool );
     }
 
+    /////////////////////////////////////////////////////////////////
+    #undef ZYPP_BASE_LOGGER_LOGGROUP
+    #define ZYPP_BASE_LOGGER_LOGGROUP "zypp::satpool"
+
+    namespace
+    {
+      /** Attributes most commands don't need (and which make up most of the file). */
+      bool isHeavyKey( detail::CRepo * repo_r, detail::IdType keyname_r )
+      {
+	if ( keyname_r == SOLVABLE_FILELIST || keyname_r == SOLVABLE_CHANGELOG )
+	  return true;
+	// including the translations ("solvable:description:de")
+	static const char * heavy[] = { "solvable:description", "solvable:eula", "solvable:messageins",
+					"solvable:messagedel", "solvable:authors", "solvable:changelog" };
+	const char * name = ::pool_id2str( repo_r->pool, keyname_r );
+	for ( const char * h : heavy )
+	{
+	  if ( str::hasPrefix( name, h ) )
+	    return true;
+	}
+	return false;
+      }
+
+      int extKeyFilter( detail::CRepo * repo_r, ::Repokey * key_r, void * )
+      {
+	if ( ! isHeavyKey( repo_r, key_r->name ) )
+	  return KEY_STORAGE_DROPPED;
+	return ::repo_write_stdkeyfilter( repo_r, key_r, nullptr );
+      }
+
+      int coreKeyFilter( detail::CRepo * repo_r, ::Repokey * key_r, void * )
+      {
+	if ( isHeavyKey( repo_r, key_r->name ) )
+	  return KEY_STORAGE_DROPPED;
+	return ::repo_write_stdkeyfilter( repo_r, key_r, nullptr );
+      }
+
+      /** Write \a repo_r filtered by \a keyfilter_r into a sibling of \a file_r and rename it. */
+      bool writeSolvFile( detail::CRepo * repo_r, const Pathname & file_r,
+			  int (*keyfilter_r)( detail::CRepo *, ::Repokey *, void * ), ::Queue * keyq_r = nullptr )
+      {
+	filesystem::TmpFile tmp( filesystem::TmpFile::makeSibling( file_r ) );
+	FILE * fp = ::fopen( tmp.path().c_str(), "we" );
+	if ( ! fp )
+	{
+	  ERR << "Can't create " << tmp.path() << endl;
+	  return false;
+	}
+	int ret = ::repo_write_filtered( repo_r, fp, keyfilter_r, nullptr, keyq_r );
+	if ( ::fclose( fp ) != 0 || ret != 0 )
+	{
+	  ERR << "Can't write " << file_r << ": " << ::pool_errstr( repo_r->pool ) << endl;
+	  return false;
+	}
+	::chmod( tmp.path().c_str(), 0644 );
+	return filesystem::rename( tmp.path(), file_r ) == 0;
+      }
+    } // namespace
+
+    bool splitSolvFile( const Pathname & solvfile_r )
+    {
+      AutoDispose<FILE*> solv( openSolvFile( solvfile_r ) );
+      if ( solv == NULL )
+      {
+	ERR << "Can't open solv-file: " << solvfile_r << endl;
+	return false;
+      }
+
+      AutoDispose<detail::CPool*> pool( ::pool_create(), ::pool_free );
+      detail::CRepo * repo = ::repo_create( pool, "" );
+      if ( ::repo_add_solv( repo, solv, 0 ) != 0 )
+      {
+	ERR << "Can't read solv-file: " << ::pool_errstr( pool ) << endl;
+	return false;
+      }
+      solv.reset();
+
+      // The heavy attributes first; the written keys go into the stubs.
+      Pathname extfile( solvfile_r.extend( ".ext" ) );
+      sat::Queue keys;
+      if ( ! writeSolvFile( repo, extfile, &extKeyFilter, keys ) )
+	return false;
+      if ( keys.empty() )
+      {
+	filesystem::unlink( extfile );
+	return false;	// nothing to split off
+      }
+
+      // Same layout as written by libsolvs tools: stubs are created from the
+      // REPOSITORY_EXTERNAL entries when loading the file.
+      ::Repodata * info = ::repo_add_repodata( repo, 0 );
+      detail::IdType handle = ::repodata_new_handle( info );
+      ::repodata_set_idarray( info, handle, REPOSITORY_KEYS, keys );
+      ::repodata_set_str( info, handle, REPOSITORY_LOCATION, extfile.basename().c_str() );
+      // Tie the file to this solv file; verified when loading it.
+      ::repodata_set_num( info, handle, ::pool_str2id( pool, detail::solvExtSizeKey(), /*create*/true ), PathInfo( extfile ).size() );
+      ::repodata_add_flexarray( info, SOLVID_META, REPOSITORY_EXTERNAL, handle );
+      ::repodata_internalize( info );
+
+      if ( ! writeSolvFile( repo, solvfile_r, &coreKeyFilter ) )
+      {
+	filesystem::unlink( extfile );
+	return false;
+      }
+      MIL << "Split solv-file " << solvfile_r << " (" << PathInfo( solvfile_r ).size()
+          << " + " << PathInfo( extfile ).size() << " bytes)" << endl;
+      return true;
+    }
+
     /////////////////////////////////////////////////////////////////
   } // namespace sat
   ///////////////////////////////////////////////////////////////////
@@ -12,9 +12,11 @@
 #ifndef ZYPP_SAT_POOL_H
 #define ZYPP_SAT_POOL_H
 
+#include <cstdio>
 #include <iosfwd>
 
 #include "zypp/Pathname.h"
+#include "zypp/AutoDispose.h"
 
 #include "zypp/sat/detail/PoolMember.h"
 #include "zypp/Repository.h"
@@ -285,9 +287,37 @@ namespace zypp
     inline bool operator!=( const Pool & lhs, const Pool & rhs )
     { return lhs.get() != rhs.get(); }
 
+    /** Open \a solvfile_r for reading by libsolv (\c repo_add_solv).
+     *
+     * The file is mapped read only and read via \c fmemopen, so the data
+     * come straight from the page cache (no \c read calls, and processes
+     * loading the same file share its pages). The kernel is advised to read
+     * ahead sequentially. If the file can't be mapped it is \c fopen'ed.
+     *
+     * \return \c NULL if the file can't be opened.
+     */
+    AutoDispose<FILE*> openSolvFile( const Pathname & solvfile_r );
+
     /** Create solv file content digest for zypper bash completion */
     void updateSolvFileIndex( const Pathname & solvfile_r );
 
+    /** Move the heavy attributes (filelists, descriptions, ...) of a solv file
+     * into a separate \c solvfile_r.ext file.
+     *
+     * \c solvfile_r keeps the dependency data and stubs for the moved
+     * attributes. \ref Repository::addSolv loads them on first access.
+     * On error \c solvfile_r is left unchanged.
+     *
+     * The stubs record the size of the \c .ext file. If it is missing or
+     * has a different size, \ref Repository::addSolv throws (the \ref
+     * RepoManager then rebuilds the cache). If the file was replaced after
+     * loading the solv file (inode, size or mtime changed), the attributes
+     * are not loaded on demand.
+     *
+     * \return Whether the file was split.
+     */
+    bool splitSolvFile( const Pathname & solvfile_r );
+
     /////////////////////////////////////////////////////////////////
   } // namespace sat
   ///////////////////////////////////////////////////////////////////
@@ -0,0 +1,55 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/sat/PoolSnapshot.cc
+ *
+*/
+#include <iostream>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/sat/detail/PoolImpl.h"
+#include "zypp/sat/PoolSnapshot.h"
+#include "zypp/ResPool.h"
+#include "zypp/ResPoolProxy.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////
+  namespace sat
+  { /////////////////////////////////////////////////////////////////
+
+    PoolSnapshot::PoolSnapshot()
+    {
+      if ( ! myPool().frozen() )
+      {
+        // ResPool items, ident index and selectables (this also prepares the pool):
+        ResPool pool( ResPool::instance() );
+        pool.proxy();
+        pool.byIdentBegin( ResPool::ByIdent() );
+      }
+      myPool().freeze();
+    }
+
+    PoolSnapshot::~PoolSnapshot()
+    { myPool().thaw(); }
+
+    bool PoolSnapshot::active()
+    { return myPool().frozen(); }
+
+    std::ostream & operator<<( std::ostream & str, const PoolSnapshot & obj )
+    { return str << "PoolSnapshot(" << ( obj.active() ? "frozen" : "thawed" ) << ")"; }
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace sat
+  ///////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,86 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/sat/PoolSnapshot.h
+ *
+*/
+#ifndef ZYPP_SAT_POOLSNAPSHOT_H
+#define ZYPP_SAT_POOLSNAPSHOT_H
+
+#include <iosfwd>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/sat/detail/PoolMember.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////
+  namespace sat
+  { /////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class PoolSnapshot
+    /// \brief Freeze the \ref Pool (and \ref ResPool) for concurrent read-only queries.
+    ///
+    /// The pool computes a lot on demand (whatprovides, \ref ResPool items
+    /// and indices, attributes split into separate files,...), so using it
+    /// from more than one thread is not safe. While a \ref PoolSnapshot
+    /// exists, all of this is computed in advance and the pool is frozen:
+    /// \ref Solvable attribute lookups, \ref WhatProvides, \ref LookupAttr
+    /// and \ref PoolQuery can be used from many threads concurrently.
+    /// The few libsolv functions which can't (e.g. those using the pools
+    /// temporary string space) are serialized internally.
+    ///
+    /// While frozen:
+    /// \li Modifying the pool (adding or removing repos or solvables,
+    /// changing locales,...) throws.
+    /// \li Strings and relations not already in the pool are not created.
+    /// Their \ref IdString and \ref Capability are \c Null, so they do not
+    /// match anything. So e.g. a \ref WhatProvides for a \ref Capability not
+    /// mentioned in any repo finds nothing, even if a package name matches.
+    /// \li Changing the status of \ref PoolItem is not thread safe.
+    /// \li The zypp logger is not thread safe; the reading threads should
+    /// not log.
+    ///
+    /// Create and destroy the snapshot while no other thread uses the pool.
+    /// Snapshots may be nested.
+    ///
+    /// \code
+    ///   {
+    ///     sat::PoolSnapshot snapshot;		// freeze
+    ///     std::vector<std::function<void()>> queries;
+    ///     ...
+    ///     thread::runTasks( queries );
+    ///   }					// thaw
+    /// \endcode
+    ///////////////////////////////////////////////////////////////////
+    class PoolSnapshot : protected detail::PoolMember, private base::NonCopyable
+    {
+    public:
+      /** Prepare and freeze the pool. This may take a while on a large pool. */
+      PoolSnapshot();
+
+      /** Dtor thaws the pool (unless other snapshots exist). */
+      ~PoolSnapshot();
+
+    public:
+      /** Whether a \ref PoolSnapshot exists (the pool is frozen). */
+      static bool active();
+    };
+
+    /** \relates PoolSnapshot Stream output */
+    std::ostream & operator<<( std::ostream & str, const PoolSnapshot & obj );
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace sat
+  ///////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_SAT_POOLSNAPSHOT_H
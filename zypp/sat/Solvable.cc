@@ -126,6 +126,7 @@ namespace zypp
     std::string Solvable::lookupStrAttribute( const SolvAttr & attr ) const
     {
       NO_SOLVABLE_RETURN( std::string() );
+      auto lock( myPool().lookupLock() );
       const char * s = ::solvable_lookup_str( _solvable, attr.id() );
       return s ? s : std::string();
     }
@@ -134,9 +135,23 @@ namespace zypp
     {
       NO_SOLVABLE_RETURN( std::string() );
       const char * s = 0;
+      // The language lookups use the pools temporary string space.
+      auto lock( myPool().frozenLock() );
       if ( !lang_r )
       {
-        s = ::solvable_lookup_str_poollang( _solvable, attr.id() );
+        if ( ! myPool().frozen() )
+          s = ::solvable_lookup_str_poollang( _solvable, attr.id() );
+        else
+        {
+          // Same as solvable_lookup_str_poollang, but without filling the pools language cache.
+          const detail::CPool * pool( myPool().getPool() );
+          for ( int i = 0; i < pool->nlanguages; ++i )
+          {
+            if ( (s = ::solvable_lookup_str_lang( _solvable, attr.id(), pool->languages[i], 0 )) )
+              return s;
+          }
+          s = ::solvable_lookup_str( _solvable, attr.id() );
+        }
       }
       else
       {
@@ -154,24 +169,28 @@ namespace zypp
     unsigned long long Solvable::lookupNumAttribute( const SolvAttr & attr ) const
     {
       NO_SOLVABLE_RETURN( 0 );
+      auto lock( myPool().lookupLock() );
       return ::solvable_lookup_num( _solvable, attr.id(), 0 );
     }
 
     unsigned long long Solvable::lookupNumAttribute( const SolvAttr & attr, unsigned long long notfound_r ) const
     {
       NO_SOLVABLE_RETURN( notfound_r );
+      auto lock( myPool().lookupLock() );
       return ::solvable_lookup_num( _solvable, attr.id(), notfound_r );
     }
 
     bool Solvable::lookupBoolAttribute( const SolvAttr & attr ) const
     {
       NO_SOLVABLE_RETURN( false );
+      auto lock( myPool().lookupLock() );
       return ::solvable_lookup_bool( _solvable, attr.id() );
     }
 
     detail::IdType Solvable::lookupIdAttribute( const SolvAttr & attr ) const
     {
       NO_SOLVABLE_RETURN( detail::noId );
+      auto lock( myPool().lookupLock() );
       return ::solvable_lookup_id( _solvable, attr.id() );
     }
 
@@ -179,6 +198,7 @@ namespace zypp
     {
       NO_SOLVABLE_RETURN( CheckSum() );
       detail::IdType chksumtype = 0;
+      auto lock( myPool().frozenLock() );	// checksum is converted in the temporary string space
       const char * s = ::solvable_lookup_checksum( _solvable, attr.id(), &chksumtype );
       if ( ! s )
         return CheckSum();
@@ -222,6 +242,7 @@ namespace zypp
       NO_SOLVABLE_RETURN( OnMediaLocation() );
       // medianumber and path
       unsigned medianr;
+      auto lock( myPool().frozenLock() );	// path may be built in the temporary string space
       const char * file = ::solvable_lookup_location( _solvable, &medianr );
       if ( ! file )
         return OnMediaLocation();
@@ -640,6 +661,7 @@ namespace zypp
       NO_SOLVABLE_RETURN( 0U );
       // medianumber and path
       unsigned medianr = 0U;
+      auto lock( myPool().frozenLock() );
       const char * file = ::solvable_lookup_location( _solvable, &medianr );
       if ( ! file )
         medianr = 0U;
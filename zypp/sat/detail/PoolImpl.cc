@@ -10,6 +10,7 @@
  *
 */
 #include <iostream>
+#include <algorithm>
 #include <fstream>
 #include <boost/mpl/int.hpp>
 
@@ -21,6 +22,7 @@
 #include "zypp/base/WatchFile.h"
 #include "zypp/base/Sysconfig.h"
 #include "zypp/base/IOStream.h"
+#include "zypp/AutoDispose.h"
 
 #include "zypp/ZConfig.h"
 
@@ -145,7 +147,7 @@ namespace zypp
           {
             // modalias strings in capability may be hexencoded because rpm does not allow
             // ',', ' ' or other special chars.
-            return target::Modalias::instance().query( str::hexdecode( IdString(rhs).c_str() ) )
+            return target::Modalias::instance().queryEncoded( IdString(rhs) )
                 ? RET_systemProperty
               : RET_unsupported;
           }
@@ -182,6 +184,8 @@ namespace zypp
       //
       PoolImpl::PoolImpl()
       : _pool( ::pool_create() )
+      , _frozen( 0 )
+      , _frozenPaged( false )
       {
         MIL << "Creating sat-pool." << endl;
         if ( ! _pool )
@@ -211,6 +215,9 @@ namespace zypp
         // set namespace callback
         _pool->nscallback = &nsCallback;
         _pool->nscallbackdata = (void*)this;
+
+        // load stub repodata on demand
+        ::pool_setloadcallback( _pool, &_loadSolvStub, (void*)this );
       }
 
       ///////////////////////////////////////////////////////////////////
@@ -225,8 +232,18 @@ namespace zypp
 
      ///////////////////////////////////////////////////////////////////
 
+      void PoolImpl::checkNotFrozen( const char * what_r ) const
+      {
+        if ( _frozen )
+        {
+          ERR << "Pool is frozen: " << (what_r ? what_r : "modification") << endl;
+          ZYPP_THROW( Exception( "Can't modify the pool while a PoolSnapshot is active" ) );
+        }
+      }
+
       void PoolImpl::setDirty( const char * a1, const char * a2, const char * a3 )
       {
+        checkNotFrozen( a1 );
         if ( a1 )
         {
           if      ( a3 ) MIL << a1 << " " << a2 << " " << a3 << endl;
@@ -242,6 +259,7 @@ namespace zypp
 
       void PoolImpl::localeSetDirty( const char * a1, const char * a2, const char * a3 )
       {
+        checkNotFrozen( a1 );
         if ( a1 )
         {
           if      ( a3 ) MIL << a1 << " " << a2 << " " << a3 << endl;
@@ -254,6 +272,7 @@ namespace zypp
 
       void PoolImpl::depSetDirty( const char * a1, const char * a2, const char * a3 )
       {
+        checkNotFrozen( a1 );
         if ( a1 )
         {
           if      ( a3 ) MIL << a1 << " " << a2 << " " << a3 << endl;
@@ -265,6 +284,9 @@ namespace zypp
 
       void PoolImpl::prepare() const
       {
+        if ( _frozen )
+          return;	// prepared in freeze
+
 	// additional /etc/sysconfig/storage check:
 	static WatchFile sysconfigFile( sysconfigStoragePath(), WatchFile::NO_INIT );
 	if ( sysconfigFile.hasChanged() )
@@ -281,6 +303,8 @@ namespace zypp
         if ( ! _pool->whatprovides )
         {
           MIL << "pool_createwhatprovides..." << endl;
+          debug::TraceSpan span( "pool", "prepare" );
+          span.tag( "solvables", _pool->nsolvables );
 
           ::pool_addfileprovides( _pool );
           ::pool_createwhatprovides( _pool );
@@ -292,6 +316,46 @@ namespace zypp
         }
       }
 
+      void PoolImpl::freeze()
+      {
+        if ( _frozen )
+        {
+          ++_frozen;
+          return;
+        }
+        debug::Measure m( "freeze pool" );
+        prepare();
+
+        // Attributes loaded on demand:
+        for ( int i = 1; i < _pool->nrepos; ++i )
+        {
+          if ( _pool->repos[i] )
+            _loadSolvStubs( _pool->repos[i] );
+        }
+        _frozenPaged = ! _pagedRepos.empty();
+
+        // pool_whatprovides computes the providers of a relation on demand
+        // (including namespace callbacks) and appends them to whatprovidesdata.
+        for ( detail::IdType i = 1; i < _pool->nrels; ++i )
+          ::pool_whatprovides( _pool, MAKERELDEP( i ) );
+
+        // Locale and multiversion data computed on demand:
+        getAvailableLocales();
+        trackedLocaleIds();
+        multiversionList();
+        requiredFilesystems();
+
+        _frozen = 1;
+        MIL << "Pool frozen (" << _pool->nsolvables << " solvables, " << _pool->nrels << " relations"
+            << ( _frozenPaged ? ", paged attributes" : "" ) << ")" << endl;
+      }
+
+      void PoolImpl::thaw()
+      {
+        if ( _frozen && ! --_frozen )
+          MIL << "Pool thawed" << endl;
+      }
+
       ///////////////////////////////////////////////////////////////////
 
       CRepo * PoolImpl::_createRepo( const std::string & name_r )
@@ -309,6 +373,9 @@ namespace zypp
 	if ( isSystemRepo( repo_r ) )
 	  _autoinstalled.clear();
         eraseRepoInfo( repo_r );
+        _solvExtFiles.erase( repo_r );
+        _solvFiles.erase( repo_r );
+        _pagedRepos.erase( repo_r );
         ::repo_free( repo_r, /*resusePoolIDs*/false );
 	// If the last repo is removed clear the pool to actually reuse all IDs.
 	// NOTE: the explicit ::repo_free above asserts all solvables are memset(0)!
@@ -319,18 +386,165 @@ namespace zypp
 	}
       }
 
-      int PoolImpl::_addSolv( CRepo * repo_r, FILE * file_r )
+      namespace
+      {
+        inline bool hasSolvStubs( CRepo * repo_r )
+        {
+          for ( int i = 1; i < repo_r->nrepodata; ++i )
+          {
+            if ( ::repo_id2repodata( repo_r, i )->state == REPODATA_STUB )
+              return true;
+          }
+          return false;
+        }
+
+        /** The file stub \a data_r is loaded from, if it has the size recorded by \ref sat::splitSolvFile. */
+        PathInfo solvExtFile( ::Repodata * data_r, const Pathname & dir_r, std::string & error_r )
+        {
+          const char * location = ::repodata_lookup_str( data_r, SOLVID_META, REPOSITORY_LOCATION );
+          IdType sizeKey = ::pool_str2id( data_r->repo->pool, solvExtSizeKey(), /*create*/false );
+          if ( ! location || ! sizeKey )
+          {
+            error_r = "no size recorded for the stub";
+            return PathInfo();
+          }
+
+          PathInfo pi( dir_r / location );
+          if ( ! pi.isFile() || ! pi.userMayR() )
+          {
+            error_r = "can't read " + pi.path().asString();
+            return PathInfo();
+          }
+          if ( pi.size() != ::repodata_lookup_num( data_r, SOLVID_META, sizeKey, ~0ULL ) )
+          {
+            error_r = pi.path().asString() + " has not the recorded size";
+            return PathInfo();
+          }
+          return pi;
+        }
+      } // namespace
+
+      int PoolImpl::_addSolv( CRepo * repo_r, FILE * file_r, const Pathname & path_r )
       {
         setDirty(__FUNCTION__, repo_r->name );
+        debug::TraceSpan span( "pool", "addSolv" );
+        span.tag( "repo", repo_r->name ).tag( "file", path_r );
+        bool wasEmpty = ( repo_r->nsolvables == 0 );
         int ret = ::repo_add_solv( repo_r, file_r, 0 );
+        if ( ret == 0 && ! path_r.empty() )
+        {
+          // Stubs are created from the files REPOSITORY_EXTERNAL entries (if any).
+          // Newer libsolv versions do this already in repo_add_solv.
+          bool haveStubs = hasSolvStubs( repo_r );
+          if ( ! haveStubs )
+          {
+            ::Repodata * data = ::repo_last_repodata( repo_r );
+            haveStubs = data && ::repodata_create_stubs( data ) != data;
+          }
+          if ( haveStubs )
+          {
+            // A missing or stale file would silently lose the attributes.
+            std::vector<PathInfo> extFiles;
+            for ( int i = 1; i < repo_r->nrepodata; ++i )
+            {
+              ::Repodata * data = ::repo_id2repodata( repo_r, i );
+              if ( data->state != REPODATA_STUB )
+                continue;
+              std::string error;
+              PathInfo pi( solvExtFile( data, path_r.dirname(), error ) );
+              if ( pi.path().empty() )
+              {
+                ERR << repo_r->name << ": " << error << endl;
+                ret = ::pool_error( _pool, -1, "%s", error.c_str() );
+                break;
+              }
+              if ( std::find_if( extFiles.begin(), extFiles.end(),
+                                 [&pi]( const PathInfo & f ) { return f.path() == pi.path(); } ) == extFiles.end() )
+                extFiles.push_back( pi );
+            }
+            if ( ret == 0 )
+            {
+              MIL << repo_r->name << ": attributes are loaded on demand from " << path_r.dirname() << endl;
+              _solvExtFiles[repo_r].swap( extFiles );
+            }
+          }
+        }
         if ( ret == 0 )
+        {
+          if ( ::fileno( file_r ) != -1 )
+            _pagedRepos.insert( repo_r );
+
+          if ( wasEmpty && ! path_r.empty() )
+            _solvFiles[repo_r] = PathInfo( path_r );
+          else
+            _solvFiles.erase( repo_r );
+
           _postRepoAdd( repo_r );
+        }
         return ret;
       }
 
+      void PoolImpl::_loadSolvStubs( CRepo * repo_r )
+      {
+        if ( ! hasSolvExt( repo_r ) )
+          return;
+        for ( int i = 1; i < repo_r->nrepodata; ++i )
+        {
+          // A lookup of one of the stubs keys triggers the load callback
+          ::Repodata * data = ::repo_id2repodata( repo_r, i );
+          if ( data->state == REPODATA_STUB && data->nkeys > 1 )
+            ::repo_lookup_type( repo_r, data->start, data->keys[1].name );
+        }
+      }
+
+      int PoolImpl::_loadSolvStub( CPool * pool_r, ::Repodata * data_r, void * cbdata_r )
+      {
+        PoolImpl & self( *static_cast<PoolImpl*>(cbdata_r) );
+        std::map<RepoIdType,std::vector<PathInfo>>::const_iterator it( self._solvExtFiles.find( data_r->repo ) );
+        const char * location = ::repodata_lookup_str( data_r, SOLVID_META, REPOSITORY_LOCATION );
+        if ( it == self._solvExtFiles.end() || ! location )
+          return 0;
+
+        // Must still be the file checked when loading the repo. Caches are replaced
+        // by rename, so a rebuilt one has a different inode. Just don't load it; the
+        // cache is rebuilt by whoever refreshes it (holding the exclusive lock).
+        const PathInfo * orig = nullptr;
+        for ( const PathInfo & pi : it->second )
+        {
+          if ( pi.path().basename() == location )
+            orig = &pi;
+        }
+        PathInfo now( orig ? orig->path() : Pathname() );
+        if ( ! orig || ! now.isFile() || now.ino() != orig->ino() || now.dev() != orig->dev()
+          || now.size() != orig->size() || now.mtime() != orig->mtime() )
+        {
+          ERR << data_r->repo->name << ": attributes not loaded: " << location << " changed since loading the repo" << endl;
+          return 0;
+        }
+        const Pathname & file( now.path() );
+
+        AutoDispose<FILE*> fp( openSolvFile( file ) );
+        if ( fp == NULL )
+        {
+          ERR << data_r->repo->name << ": can't open " << file << endl;
+          return 0;
+        }
+        // Only attributes are added; the dependency data stay valid.
+        if ( ::repo_add_solv( data_r->repo, fp, REPO_USE_LOADING|REPO_EXTEND_SOLVABLES|REPO_LOCALPOOL ) != 0 )
+        {
+          ERR << data_r->repo->name << ": error reading " << file << ": " << ::pool_errstr( pool_r ) << endl;
+          return 0;
+        }
+        if ( ::fileno( fp ) != -1 )
+          self._pagedRepos.insert( data_r->repo );
+        MIL << data_r->repo->name << ": loaded " << file << endl;
+        return 1;
+      }
+
       int PoolImpl::_addHelix( CRepo * repo_r, FILE * file_r )
       {
         setDirty(__FUNCTION__, repo_r->name );
+        _solvFiles.erase( repo_r );
         int ret = ::repo_add_helix( repo_r, file_r, 0 );
         if ( ret == 0 )
           _postRepoAdd( repo_r );
@@ -355,11 +569,19 @@ namespace zypp
 
           detail::IdType blockBegin = 0;
           unsigned       blockSize  = 0;
+          bool           stubsLoaded = false;
           for ( detail::IdType i = repo_r->start; i < repo_r->end; ++i )
           {
               CSolvable * s( _pool->solvables + i );
               if ( s->repo == repo_r && sysids.find( s->arch ) == sysids.end() )
               {
+                // Stubs can only be loaded into a repo without holes,
+                // so load them before removing anything.
+                if ( ! stubsLoaded )
+                {
+                  _loadSolvStubs( repo_r );
+                  stubsLoaded = true;
+                }
                 // Remember an unwanted arch entry:
                 if ( ! blockBegin )
                   blockBegin = i;
@@ -384,6 +606,7 @@ namespace zypp
       detail::SolvableIdType PoolImpl::_addSolvables( CRepo * repo_r, unsigned count_r )
       {
         setDirty(__FUNCTION__, repo_r->name );
+        _solvFiles.erase( repo_r );
         return ::repo_add_solvable_block( repo_r, count_r );
       }
 
@@ -421,6 +644,7 @@ namespace zypp
 
       void PoolImpl::setTextLocale( const Locale & locale_r )
       {
+	checkNotFrozen( "setTextLocale" );
 	std::vector<std::string> fallbacklist;
 	for ( Locale l( locale_r ); l; l = l.fallback() )
 	{
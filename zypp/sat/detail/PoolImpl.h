@@ -18,8 +18,11 @@ extern "C"
 #include <solv/solvable.h>
 #include <solv/poolarch.h>
 #include <solv/repo_solv.h>
+#include <solv/repodata.h>
 }
 #include <iosfwd>
+#include <mutex>
+#include <vector>
 
 #include "zypp/base/Hash.h"
 #include "zypp/base/NonCopyable.h"
@@ -28,6 +31,7 @@ extern "C"
 #include "zypp/sat/detail/PoolMember.h"
 #include "zypp/sat/Queue.h"
 #include "zypp/RepoInfo.h"
+#include "zypp/PathInfo.h"
 #include "zypp/Locale.h"
 #include "zypp/Capability.h"
 #include "zypp/IdString.h"
@@ -43,6 +47,11 @@ namespace zypp
     namespace detail
     { /////////////////////////////////////////////////////////////////
 
+      /** Stub attribute recording the size of the file \ref sat::splitSolvFile
+       * moved the heavy attributes into. Verified when loading the solv file.
+       */
+      inline const char * solvExtSizeKey()	{ return "zypp:solvext:size"; }
+
       ///////////////////////////////////////////////////////////////////
       //
       //	CLASS NAME : PoolImpl
@@ -75,7 +84,46 @@ namespace zypp
            */
           void prepare() const;
 
+        public:
+          /** \name Frozen pool (see \ref sat::PoolSnapshot).
+           * While frozen, the pool must not be modified (throws) and
+           * nothing is computed on demand. Strings and relations not
+           * already in the pool are not created, their \ref IdString
+           * and \ref Capability become \c Null.
+           */
+          //@{
+          /** Prepare the pool, build all data otherwise computed on demand
+           * and freeze it. Nested calls just count.
+           */
+          void freeze();
+
+          /** Undo one \ref freeze. */
+          void thaw();
+
+          /** Whether the pool is frozen. */
+          bool frozen() const
+          { return _frozen; }
+
+          /** Hold while using what is not thread safe even if the pool is
+           * frozen: libsolvs temporary string space (\c pool_tmpjoin,
+           * \c pool_dep2str,...) and what's returned from there, the \ref Arch
+           * table. Does not lock unless the pool is frozen.
+           */
+          std::unique_lock<std::recursive_mutex> frozenLock() const
+          { return _frozen ? std::unique_lock<std::recursive_mutex>( _frozenMutex ) : std::unique_lock<std::recursive_mutex>(); }
+
+          /** Hold while looking up attributes. Does not lock unless the pool
+           * is frozen and some attributes are paged in on demand (solv files
+           * not read via \ref openSolvFile).
+           */
+          std::unique_lock<std::recursive_mutex> lookupLock() const
+          { return _frozen && _frozenPaged ? std::unique_lock<std::recursive_mutex>( _frozenMutex ) : std::unique_lock<std::recursive_mutex>(); }
+          //@}
+
         private:
+          /** Throw if the pool is frozen. */
+          void checkNotFrozen( const char * what_r ) const;
+
           /** Invalidate housekeeping data (e.g. whatprovides) if the
            *  pools content changed.
            */
@@ -133,8 +181,13 @@ namespace zypp
           /** Adding solv file to a repo.
            * Except for \c isSystemRepo_r, solvables of incompatible architecture
            * are filtered out.
+           *
+           * If the files path \a path_r is not empty, attributes moved into
+           * separate files by \ref sat::splitSolvFile are loaded on demand from
+           * its directory. If the repo was empty, the file is remembered as the
+           * repos origin (see \ref solvFile).
           */
-          int _addSolv( CRepo * repo_r, FILE * file_r );
+          int _addSolv( CRepo * repo_r, FILE * file_r, const Pathname & path_r = Pathname() );
 
           /** Adding helix file to a repo.
            * Except for \c isSystemRepo_r, solvables of incompatible architecture
@@ -149,6 +202,35 @@ namespace zypp
           /** Helper postprocessing the repo after adding solv or helix files. */
           void _postRepoAdd( CRepo * repo_r );
 
+          /** Load all not yet loaded stub repodata of \a repo_r. */
+          void _loadSolvStubs( CRepo * repo_r );
+
+          /** libsolv load callback for stub repodata (see \ref sat::splitSolvFile). */
+          static int _loadSolvStub( CPool * pool_r, ::Repodata * data_r, void * cbdata_r );
+
+          /** The solv file \a repo_r was loaded from (as it was when loading it).
+           * Only known if the file was loaded into an empty repo and nothing was
+           * added afterwards, otherwise an empty \ref PathInfo is returned.
+           */
+          PathInfo solvFile( CRepo * repo_r ) const
+          {
+            std::map<RepoIdType,PathInfo>::const_iterator it( _solvFiles.find( repo_r ) );
+            return it == _solvFiles.end() ? PathInfo() : it->second;
+          }
+
+          /** Whether some attributes of \a repo_r are loaded on demand (see \ref sat::splitSolvFile). */
+          bool hasSolvExt( CRepo * repo_r ) const
+          { return _solvExtFiles.find( repo_r ) != _solvExtFiles.end(); }
+
+          /** The files the attributes of \a repo_r are loaded from on demand
+           * (as they were when loading the repo).
+           */
+          std::vector<PathInfo> solvExtFiles( CRepo * repo_r ) const
+          {
+            std::map<RepoIdType,std::vector<PathInfo>>::const_iterator it( _solvExtFiles.find( repo_r ) );
+            return it == _solvExtFiles.end() ? std::vector<PathInfo>() : it->second;
+          }
+
         public:
           /** a \c valid \ref Solvable has a non NULL repo pointer. */
           bool validSolvable( const CSolvable & slv_r ) const
@@ -323,6 +405,12 @@ namespace zypp
           SerialNumberWatcher _watcher;
           /** Additional \ref RepoInfo. */
           std::map<RepoIdType,RepoInfo> _repoinfos;
+          /** Where to load a repos stub repodata from (as it was when loading the repo). */
+          std::map<RepoIdType,std::vector<PathInfo>> _solvExtFiles;
+          /** The solv file a repo was loaded from. */
+          std::map<RepoIdType,PathInfo> _solvFiles;
+          /** Repos read from a file libsolv may page attributes in from (not a shared mapping, see \ref openSolvFile). */
+          std::set<RepoIdType> _pagedRepos;
 
           /**  */
 	  base::SetTracker<LocaleSet> _requestedLocalesTracker;
@@ -339,6 +427,13 @@ namespace zypp
 
 	  /** filesystems mentioned in /etc/sysconfig/storage */
 	  mutable scoped_ptr<std::set<std::string> > _requiredFilesystemsPtr;
+
+          /** Number of active \ref freeze. */
+          unsigned _frozen;
+          /** Whether some attributes of the frozen pool are paged in on demand. */
+          bool _frozenPaged;
+          /** Serializing the non thread safe parts of libsolv while frozen. */
+          mutable std::recursive_mutex _frozenMutex;
       };
       ///////////////////////////////////////////////////////////////////
 
@@ -324,10 +324,23 @@ void Resolver::solverInit()
     _installedSatisfied.clear();
 }
 
+void Resolver::autoSolvTestcase()
+{
+    static const bool enabled = str::strToBool( getenv( "ZYPP_SOLVTESTCASE" ), false );
+    if ( enabled )
+    {
+	Testcase testcase("/var/log/YaST2/autoSolvTestcase");
+	testcase.createSolvTestcase( *this ); // written in background
+    }
+}
+
 bool Resolver::resolvePool()
 {
     solverInit();
-    return _satResolver->resolvePool(_extra_requires, _extra_conflicts, _addWeak, _upgradeRepos );
+    bool ret = _satResolver->resolvePool(_extra_requires, _extra_conflicts, _addWeak, _upgradeRepos );
+    if ( ! ret )
+	autoSolvTestcase();
+    return ret;
 }
 
 bool Resolver::resolveQueue( solver::detail::SolverQueueItemList & queue )
@@ -366,9 +379,15 @@ bool Resolver::resolveQueue( solver::detail::SolverQueueItemList & queue )
     _removed_queue_items.clear();
     _added_queue_items.clear();
 
-    return _satResolver->resolveQueue(queue, _addWeak);
+    bool ret = _satResolver->resolveQueue(queue, _addWeak);
+    if ( ! ret )
+	autoSolvTestcase();
+    return ret;
 }
 
+sat::detail::CSolver * Resolver::satSolver() const
+{ return _satResolver->satSolver(); }
+
 sat::Transaction Resolver::getTransaction()
 {
   // FIXME: That's an ugly way of pushing autoInstalled into the transaction.
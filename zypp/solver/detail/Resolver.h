@@ -117,6 +117,8 @@ class Resolver : private base::NonCopyable
     bool checkUnmaintainedItems ();
 
     void solverInit();
+    // write a libsolv testcase of a failed solver run (ZYPP_SOLVTESTCASE)
+    void autoSolvTestcase();
 
   public:
 
@@ -212,6 +214,9 @@ class Resolver : private base::NonCopyable
     // Return the Transaction computed by the last solver run.
     sat::Transaction getTransaction();
 
+    // Return the libsolv solver of the last run (NULL if none).
+    sat::detail::CSolver * satSolver() const;
+
     // reset all SOLVER transaction in pool
     void undo();
 
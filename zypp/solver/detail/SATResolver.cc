@@ -32,6 +32,7 @@ extern "C"
 #define ZYPP_USE_RESOLVER_INTERNALS
 
 #include "zypp/base/String.h"
+#include "zypp/base/Measure.h"
 #include "zypp/Product.h"
 #include "zypp/Capability.h"
 #include "zypp/ResStatus.h"
@@ -420,7 +421,10 @@ SATResolver::solving(const CapabilitySet & requires_caps,
     // Solve !
     MIL << "Starting solving...." << endl;
     MIL << *this;
-    solver_solve( _satSolver, &(_jobQueue) );
+    {
+      debug::TraceSpan span( "solver", "solver_solve" );
+      solver_solve( _satSolver, &(_jobQueue) );
+    }
     MIL << "....Solver end" << endl;
 
     // copying solution back to zypp pool
@@ -847,7 +851,10 @@ void SATResolver::doUpdate()
     // Solve !
     MIL << "Starting solving for update...." << endl;
     MIL << *this;
-    solver_solve( _satSolver, &(_jobQueue) );
+    {
+      debug::TraceSpan span( "solver", "solver_solve" );
+      solver_solve( _satSolver, &(_jobQueue) );
+    }
     MIL << "....Solver end" << endl;
 
     // copying solution back to zypp pool
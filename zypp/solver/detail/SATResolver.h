@@ -220,6 +220,9 @@ class SATResolver : public base::ReferenceCounted, private base::NonCopyable, pr
 
     sat::StringQueue autoInstalled() const;
     sat::StringQueue userInstalled() const;
+
+    /** The libsolv solver of the last run (NULL if none). */
+    sat::detail::CSolver * satSolver() const { return _satSolver; }
 };
 
 ///////////////////////////////////////////////////////////////////
@@ -9,10 +9,18 @@
 /** \file       zypp/solver/detail/Testcase.cc
  *
 */
+extern "C"
+{
+#include <solv/solver.h>
+#include <solv/repo_write.h>
+#include <solv/testcase.h>
+}
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <streambuf>
+#include <thread>
+#include <mutex>
 
 #define ZYPP_USE_RESOLVER_INTERNALS
 
@@ -24,6 +32,7 @@
 #include "zypp/base/PtrTypes.h"
 #include "zypp/base/NonCopyable.h"
 #include "zypp/base/ReferenceCounted.h"
+#include "zypp/AutoDispose.h"
 
 #include "zypp/parser/xml/XmlEscape.h"
 
@@ -472,6 +481,235 @@ void HelixControl::addUpgradeRepos( const std::set<Repository> & upgradeRepos_r
 
 //---------------------------------------------------------------------------
 
+namespace
+{
+  /** Create \a dumpPath_r or remove old stuff if \a clean_r. */
+  bool prepareDumpPath( const std::string & dumpPath_r, bool clean_r )
+  {
+    PathInfo path (dumpPath_r);
+
+    if ( !path.isExist() ) {
+	if (zypp::filesystem::assert_dir (dumpPath_r)!=0) {
+	    ERR << "Cannot create directory " << dumpPath_r << endl;
+	    return false;
+	}
+    } else {
+	if (!path.isDir()) {
+	    ERR << dumpPath_r << " is not a directory." << endl;
+	    return false;
+	}
+	if (clean_r)
+	    zypp::filesystem::clean_dir (dumpPath_r);
+    }
+    return true;
+  }
+
+  /** A file of a solv testcase to write. */
+  struct SolvTestcaseFile
+  {
+    SolvTestcaseFile( const Pathname & path_r, std::string data_r )
+    : path( path_r ), data( std::move(data_r) )
+    {}
+    Pathname    path;
+    std::string data;
+  };
+
+  ///////////////////////////////////////////////////////////////////
+  /// \brief Write solv testcase files, maybe in a background thread.
+  ///
+  /// One testcase is written at a time. The writer thread must not log
+  /// (the logger is not thread safe), errors are logged by \ref wait.
+  ///////////////////////////////////////////////////////////////////
+  class SolvTestcaseWriter
+  {
+  public:
+    static SolvTestcaseWriter & instance()
+    {
+      static SolvTestcaseWriter _instance;
+      return _instance;
+    }
+
+    ~SolvTestcaseWriter()
+    { wait(); }
+
+    /** Wait for the running writer; return whether the last testcase was written. */
+    bool wait()
+    {
+      std::lock_guard<std::mutex> lock( _mutex );
+      join();
+      return _ok;
+    }
+
+    void write( std::vector<SolvTestcaseFile> files_r, bool async_r )
+    {
+      std::lock_guard<std::mutex> lock( _mutex );
+      join();
+      if ( async_r )
+	_thread = std::thread( &SolvTestcaseWriter::doWrite, this, std::move(files_r) );
+      else
+      {
+	doWrite( std::move(files_r) );
+	join();
+      }
+    }
+
+  private:
+    void join()
+    {
+      if ( _thread.joinable() )
+	_thread.join();
+      if ( ! _error.empty() )
+      {
+	ERR << _error << endl;
+	_error.clear();
+      }
+    }
+
+    void doWrite( std::vector<SolvTestcaseFile> files_r )
+    {
+      _ok = true;
+      for ( const SolvTestcaseFile & file : files_r )
+      {
+	std::ofstream out( file.path.c_str(), std::ios_base::out|std::ios_base::binary|std::ios_base::trunc );
+	out.write( file.data.data(), file.data.size() );
+	out.close();
+	if ( ! out )
+	{
+	  _error = "Can't write testcase file " + file.path.asString();
+	  _ok = false;
+	  return;
+	}
+      }
+    }
+
+  private:
+    std::mutex  _mutex;
+    std::thread _thread;
+    std::string _error;
+    bool        _ok = true;
+  };
+
+  /** Whether \a orig_r is unchanged. */
+  bool unchanged( const PathInfo & orig_r )
+  {
+    if ( orig_r.path().empty() )
+      return false;
+    PathInfo now( orig_r.path() );
+    return now.isFile() && now.ino() == orig_r.ino() && now.dev() == orig_r.dev()
+        && now.size() == orig_r.size() && now.mtime() == orig_r.mtime();
+  }
+
+  /** Hardlink the unchanged solv file \a repo_r was loaded from into \a dumpPath_r.
+   * If attributes are loaded on demand from other files, the files are linked
+   * together into a subdirectory, as the stubs refer to them by name.
+   * \a file_r is set to the solv files name relative to \a dumpPath_r.
+   */
+  bool linkSolvFile( ::Repo * repo_r, const Pathname & dumpPath_r, std::string & file_r )
+  {
+    sat::detail::PoolImpl & satpool( sat::detail::PoolMember::myPool() );
+    PathInfo orig( satpool.solvFile( repo_r ) );
+    if ( ! unchanged( orig ) )
+      return false;	// cache was rebuilt meanwhile
+
+    if ( ! satpool.hasSolvExt( repo_r ) )
+      return filesystem::hardlink( orig.path(), dumpPath_r / file_r ) == 0;
+
+    const std::vector<PathInfo> & extFiles( satpool.solvExtFiles( repo_r ) );
+    for ( const PathInfo & ext : extFiles )
+    {
+      if ( ! unchanged( ext ) )
+	return false;
+    }
+    Pathname dir( str::numstring( repo_r->repoid ) );
+    if ( filesystem::assert_dir( dumpPath_r / dir ) != 0 )
+      return false;
+    for ( const PathInfo & ext : extFiles )
+    {
+      if ( filesystem::hardlink( ext.path(), dumpPath_r / dir / ext.path().basename() ) != 0 )
+      {
+	filesystem::recursive_rmdir( dumpPath_r / dir );
+	return false;
+      }
+    }
+    if ( filesystem::hardlink( orig.path(), dumpPath_r / dir / orig.path().basename() ) != 0 )
+    {
+      filesystem::recursive_rmdir( dumpPath_r / dir );
+      return false;
+    }
+    file_r = ( dir / orig.path().basename() ).asString();
+    return true;
+  }
+
+  /** Repo name as used in libsolv testcases (and \c testcase_job2str). */
+  std::string testcaseRepoName( ::Repo * repo_r )
+  {
+    if ( ! repo_r->name )
+      return str::form( "#%d", repo_r->repoid );
+    std::string ret( repo_r->name );
+    for ( char & ch : ret )
+    {
+      if ( ch == ' ' || ch == '\t' )
+	ch = '_';
+    }
+    return ret;
+  }
+
+  /** Testcase \c solverflags line for the flags we set (those differing from libsolvs defaults). */
+  std::string testcaseSolverFlags( sat::detail::CSolver * solver_r )
+  {
+    static const std::pair<int,const char *> flags[] = {
+      { SOLVER_FLAG_ALLOW_DOWNGRADE,		"allowdowngrade" },
+      { SOLVER_FLAG_ALLOW_NAMECHANGE,		"allownamechange" },
+      { SOLVER_FLAG_ALLOW_ARCHCHANGE,		"allowarchchange" },
+      { SOLVER_FLAG_ALLOW_VENDORCHANGE,		"allowvendorchange" },
+      { SOLVER_FLAG_ALLOW_UNINSTALL,		"allowuninstall" },
+      { SOLVER_FLAG_NO_UPDATEPROVIDE,		"noupdateprovide" },
+      { SOLVER_FLAG_SPLITPROVIDES,		"splitprovides" },
+      { SOLVER_FLAG_IGNORE_RECOMMENDED,		"ignorerecommended" },
+      { SOLVER_FLAG_ADD_ALREADY_RECOMMENDED,	"addalreadyrecommended" },
+      { SOLVER_FLAG_DUP_ALLOW_DOWNGRADE,	"dupallowdowngrade" },
+      { SOLVER_FLAG_DUP_ALLOW_NAMECHANGE,	"dupallownamechange" },
+      { SOLVER_FLAG_DUP_ALLOW_ARCHCHANGE,	"dupallowarchchange" },
+      { SOLVER_FLAG_DUP_ALLOW_VENDORCHANGE,	"dupallowvendorchange" },
+    };
+    AutoDispose<sat::detail::CSolver*> defaults( ::solver_create( solver_r->pool ), ::solver_free );
+    std::string ret;
+    for ( const auto & flag : flags )
+    {
+      int val = ::solver_get_flag( solver_r, flag.first );
+      if ( val == ::solver_get_flag( defaults, flag.first ) )
+	continue;
+      ret += ret.empty() ? "solverflags " : " ";
+      if ( ! val )
+	ret += "!";
+      ret += flag.second;
+    }
+    if ( ! ret.empty() )
+      ret += "\n";
+    return ret;
+  }
+
+  /** Serialize \a repo_r into solv format.
+   * Attributes not yet loaded on demand are not loaded, but omitted.
+   */
+  bool writeSolv( ::Repo * repo_r, std::string & data_r )
+  {
+    char * buf = 0;
+    size_t size = 0;
+    FILE * fp = ::open_memstream( &buf, &size );
+    if ( ! fp )
+      return false;
+    int ret = ::repo_write( repo_r, fp );
+    ::fclose( fp );
+    if ( ret == 0 )
+      data_r.assign( buf, size );
+    ::free( buf );
+    return ret == 0;
+  }
+} // namespace
+
+//---------------------------------------------------------------------------
+
 Testcase::Testcase()
     :dumpPath("/var/log/YaST2/solverTestcase")
 {}
@@ -485,22 +723,9 @@ Testcase::~Testcase()
 
 bool Testcase::createTestcase(Resolver & resolver, bool dumpPool, bool runSolver)
 {
-    PathInfo path (dumpPath);
-
-    if ( !path.isExist() ) {
-	if (zypp::filesystem::assert_dir (dumpPath)!=0) {
-	    ERR << "Cannot create directory " << dumpPath << endl;
-	    return false;
-	}
-    } else {
-	if (!path.isDir()) {
-	    ERR << dumpPath << " is not a directory." << endl;
-	    return false;
-	}
-	// remove old stuff if pool will be dump
-	if (dumpPool)
-	    zypp::filesystem::clean_dir (dumpPath);
-    }
+    // remove old stuff if pool will be dump
+    if ( !prepareDumpPath( dumpPath, dumpPool ) )
+	return false;
 
     if (runSolver) {
         zypp::base::LogControl::TmpLineWriter tempRedirect;
@@ -609,6 +834,73 @@ bool Testcase::createTestcase(Resolver & resolver, bool dumpPool, bool runSolver
     return true;
 }
 
+bool Testcase::createSolvTestcase( Resolver & resolver, bool async )
+{
+    sat::detail::CSolver * solver = resolver.satSolver();
+    if ( !solver ) {
+	ERR << "No solver run to create a testcase for." << endl;
+	return false;
+    }
+
+    // don't clean up a testcase still being written
+    SolvTestcaseWriter::instance().wait();
+    if ( !prepareDumpPath( dumpPath, true ) )
+	return false;
+
+    ::Pool * pool = solver->pool;
+    std::vector<SolvTestcaseFile> files;
+    std::string control;
+    unsigned linked = 0;
+
+    int i;
+    ::Repo * repo;
+    FOR_REPOS( i, repo )
+    {
+	std::string file( str::numstring( repo->repoid ) + ".solv" );
+	Pathname dest( Pathname(dumpPath) / file );
+	if ( linkSolvFile( repo, dumpPath, file ) ) {
+	    ++linked;
+	} else {
+	    std::string data;
+	    if ( !writeSolv( repo, data ) ) {
+		ERR << "Cannot write repo " << repo->name << ": " << ::pool_errstr( pool ) << endl;
+		return false;
+	    }
+	    files.push_back( SolvTestcaseFile( dest, std::move(data) ) );
+	}
+	control += str::form( "repo %s %d.%d solv %s\n", testcaseRepoName( repo ).c_str(),
+			      repo->priority, repo->subpriority, file.c_str() );
+    }
+
+    control += "system " + ZConfig::instance().systemArchitecture().asString() + " rpm";
+    if ( pool->installed )
+	control += " " + testcaseRepoName( pool->installed );
+    control += "\n";
+
+    control += testcaseSolverFlags( solver );
+
+    for ( int j = 0; j + 1 < solver->job.count; j += 2 )
+	control += std::string("job ") + ::testcase_job2str( pool, solver->job.elements[j], solver->job.elements[j+1] ) + "\n";
+
+    char * result = ::testcase_solverresult( solver, TESTCASE_RESULT_TRANSACTION|TESTCASE_RESULT_PROBLEMS );
+    if ( result ) {
+	files.push_back( SolvTestcaseFile( Pathname(dumpPath) / "solver.result", result ) );
+	::solv_free( result );
+	control += "result transaction,problems solver.result\n";
+    }
+
+    // the control file last, so it's complete only if everything else is
+    files.push_back( SolvTestcaseFile( Pathname(dumpPath) / "testcase.t", std::move(control) ) );
+
+    MIL << "Writing solv testcase to " << dumpPath << " (" << linked << " repos linked, "
+	<< files.size() << " files to write" << (async ? " in background)" : ")") << endl;
+    SolvTestcaseWriter::instance().write( std::move(files), async );
+    return async || SolvTestcaseWriter::instance().wait();
+}
+
+bool Testcase::waitSolvTestcase()
+{ return SolvTestcaseWriter::instance().wait(); }
+
 
       ///////////////////////////////////////////////////////////////////
     };// namespace detail
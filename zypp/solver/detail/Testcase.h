@@ -47,6 +47,28 @@ namespace zypp
 	  ~Testcase();
 
 	  bool createTestcase( Resolver & resolver, bool dumpPool = true, bool runSolver = true );
+
+	  /**
+	   * Write a libsolv testcase of the resolvers last solver run.
+	   *
+	   * Instead of helix XML, the repos are written as binary solv files
+	   * (repos loaded from an unchanged solv file are just hardlinked, together
+	   * with the files attributes are loaded from on demand) and
+	   * the system, solver flags and jobs go into a libsolv \c testcase.t
+	   * file. Use libsolvs \c testsolv to replay it.
+	   *
+	   * Only collecting the data is done in the calling thread. If \a async
+	   * is \c true, the files are written by a background thread. Testcases
+	   * are written one after the other (see \ref waitSolvTestcase).
+	   *
+	   * \note Namespace dependencies (modalias, locales) are not captured.
+	   */
+	  bool createSolvTestcase( Resolver & resolver, bool async = false );
+
+	  /** Wait until a testcase written in background is complete.
+	   * \return Whether writing the last testcase succeeded.
+	   */
+	  static bool waitSolvTestcase();
       };
 
       ///////////////////////////////////////////////////////////////////
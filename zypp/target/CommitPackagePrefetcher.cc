@@ -0,0 +1,341 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/CommitPackagePrefetcher.cc
+ *
+*/
+extern "C"
+{
+#include <signal.h>
+#include <unistd.h>
+}
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <vector>
+
+#include "zypp/base/Easy.h"
+#include "zypp/base/LogTools.h"
+#include "zypp/base/IOStream.h"
+#include "zypp/base/String.h"
+#include "zypp/target/CommitPackagePrefetcher.h"
+#include "zypp/target/rpm/RpmDb.h"
+#include "zypp/repo/PackageProvider.h"
+#include "zypp/repo/PrefetchHelper.h"
+#include "zypp/repo/RepoProvideFile.h"
+#include "zypp/ExternalProgram.h"
+#include "zypp/Package.h"
+#include "zypp/PathInfo.h"
+#include "zypp/PoolItem.h"
+#include "zypp/Target.h"
+#include "zypp/TmpPath.h"
+#include "zypp/ZConfig.h"
+#include "zypp/ZYppFactory.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  { /////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** Time (ms) granted to a cancelled helper to stop before it is killed. */
+      const unsigned cancelTimeout = 5000;
+
+      typedef std::set<sat::Solvable::IdType> SolvableIds;
+
+      /** The packages in \a transaction_r worth to be prefetched. */
+      std::vector<PoolItem> packagesToPrefetch( const sat::Transaction & transaction_r )
+      {
+	std::vector<PoolItem> ret;
+	for_( it, transaction_r.begin(), transaction_r.end() )
+	{
+	  switch ( it->stepType() )
+	  {
+	    case sat::Transaction::TRANSACTION_INSTALL:
+	    case sat::Transaction::TRANSACTION_MULTIINSTALL:
+	      break;
+
+	    default:
+	      continue;
+	      break;
+	  }
+
+	  PoolItem pi( it->satSolvable() );
+	  if ( ! pi || ! pi->isKind<Package>() )
+	    continue;
+	  // Don't touch local or removable media (e.g. ask for a DVD).
+	  const RepoInfo & info( pi->repoInfo() );
+	  if ( info.baseUrlsEmpty() || ! info.baseUrlsBegin()->schemeIsDownloading() )
+	    continue;
+	  ret.push_back( pi );
+	}
+	return ret;
+      }
+
+      SolvableIds idsOf( const std::vector<PoolItem> & packages_r )
+      {
+	SolvableIds ret;
+	for ( const PoolItem & pi : packages_r )
+	  ret.insert( pi.satSolvable().id() );
+	return ret;
+      }
+
+      /** Where the helper \a pid_r downloads packages of \a info_r to.
+       * Next to the package cache, so checked packages can be moved there.
+       */
+      Pathname stagingDir( const RepoInfo & info_r, pid_t pid_r )
+      { return info_r.packagesPath() / str::form( ".prefetch.%d", int(pid_r) ); }
+
+      /** Write the helpers job for \a packages_r to \a jobDir_r (see \c zypp-prefetch). */
+      bool writeJob( const std::vector<PoolItem> & packages_r, const Pathname & jobDir_r )
+      {
+	std::ofstream repos( (jobDir_r / "repos.repo").c_str() );
+	std::ofstream job( (jobDir_r / "packages").c_str() );
+	job << "repomanagerroot " << ZConfig::instance().repoManagerRoot() << endl;
+
+	std::set<Repository::IdType> written;
+	for ( const PoolItem & pi : packages_r )
+	{
+	  const RepoInfo & info( pi->repoInfo() );
+	  if ( written.insert( pi.repository().id() ).second )
+	  {
+	    info.dumpAsIniOn( repos ) << endl;
+	    job << "packagespath " << info.alias() << " " << info.packagesPath() << endl;
+	  }
+
+	  const OnMediaLocation & loc( pi->asKind<Package>()->location() );
+	  job << "package " << pi.satSolvable().id() << " " << info.alias()
+	      << " " << loc.medianr()
+	      << " " << ByteCount::SizeType( loc.downloadSize() );
+	  if ( loc.checksum().empty() )
+	    job << " - -";
+	  else
+	    job << " " << loc.checksum().type() << " " << loc.checksum().checksum();
+	  job << " " << loc.filename() << endl;
+	}
+	repos.close();
+	job.close();
+	return repos && job;
+      }
+
+      /** Whether the downloaded \a path_r passes the signature check \ref repo::PackageProvider would do. */
+      bool signatureOk( const Package::constPtr & package_r, const Pathname & path_r )
+      {
+	const RepoInfo & info( package_r->repoInfo() );
+	if ( ! info.pkgGpgCheck() )
+	  return true;
+
+	Target_Ptr target( getZYpp()->getTarget() );
+	if ( ! target )
+	  return false;
+
+	rpm::RpmDb::CheckPackageDetail detail;
+	rpm::RpmDb::CheckPackageResult res = target->rpmDb().checkPackageSignature( path_r, detail );
+	if ( res == rpm::RpmDb::CHK_NOSIG && ! info.pkgGpgCheckIsMandatory() )
+	  res = rpm::RpmDb::CHK_OK;
+	if ( res != rpm::RpmDb::CHK_OK )
+	  WAR << "Drop prefetched " << package_r << ": " << res << endl;
+	return res == rpm::RpmDb::CHK_OK;
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class CommitPackagePrefetcher::Impl
+    /// \brief CommitPackagePrefetcher implementation.
+    ///
+    /// The helper appends a line <tt>"<solvable id> <path>"</tt> to the
+    /// \c _record file for each package it downloaded into a staging dir.
+    ///////////////////////////////////////////////////////////////////
+    class CommitPackagePrefetcher::Impl
+    {
+    public:
+      Impl()
+      : _started( false )
+      {}
+
+      /** Whether the helper is still running (reaps it otherwise). */
+      bool running() const
+      {
+	if ( ! _prog )
+	  return false;
+	if ( _prog->running() )
+	  return true;
+	MIL << "Package prefetch finished (" << _prog->close() << ")" << endl;
+	_prog.reset();
+	return false;
+      }
+
+      void cancel()
+      {
+	if ( ! running() )
+	  return;
+
+	MIL << "Cancel package prefetch [" << _prog->getpid() << "]" << endl;
+	::kill( _prog->getpid(), SIGTERM );
+	for ( unsigned waited = 0; waited < cancelTimeout && running(); waited += 50 )
+	  ::usleep( 50 * 1000 );
+	if ( _prog )
+	{
+	  WAR << "Kill package prefetch [" << _prog->getpid() << "]" << endl;
+	  _prog->kill();
+	  _prog.reset();
+	}
+      }
+
+      /** Forget about the downloads (the helper must not be running). */
+      void clear()
+      {
+	for ( const Pathname & dir : _stagingDirs )
+	  filesystem::recursive_rmdir( dir );
+	_stagingDirs.clear();
+	_jobDir.reset();
+	_record.reset();
+	_ids.clear();
+	_started = false;
+      }
+
+      /** Move the downloads needed by \a keep_r into the package cache,
+       * if they pass the signature check (the helper must not be running).
+       */
+      void adopt( const SolvableIds & keep_r )
+      {
+	if ( ! _record )
+	  return;
+
+	unsigned adopted = 0;
+	std::ifstream in( _record->path().c_str() );
+	for ( iostr::EachLine line( in ); line; line.next() )
+	{
+	  std::string path( *line );
+	  sat::Solvable::IdType id = str::strtonum<sat::Solvable::IdType>( str::stripFirstWord( path ) );
+	  if ( ! keep_r.count( id ) || path.empty() || ! PathInfo( path ).isFile() )
+	    continue;
+
+	  Package::constPtr package( PoolItem( sat::Solvable( id ) )->asKind<Package>() );
+	  if ( ! package || ! signatureOk( package, path ) )
+	    continue;
+
+	  const RepoInfo & info( package->repoInfo() );
+	  Pathname cached( info.packagesPath() / info.path() / package->location().filename() );
+	  if ( filesystem::assert_dir( cached.dirname() ) == 0 && filesystem::rename( path, cached ) == 0 )
+	    ++adopted;
+	}
+	MIL << "Adopted " << adopted << " prefetched packages" << endl;
+      }
+
+    public:
+      mutable scoped_ptr<ExternalProgram>  _prog;	//!< the running helper
+      std::set<Pathname>                   _stagingDirs;
+      bool                                 _started;	//!< whether _ids were prefetched
+      SolvableIds                          _ids;
+      scoped_ptr<filesystem::TmpDir>       _jobDir;	//!< the helpers input
+      scoped_ptr<filesystem::TmpFile>      _record;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    CommitPackagePrefetcher::CommitPackagePrefetcher()
+    : _pimpl( new Impl )
+    {}
+
+    CommitPackagePrefetcher::~CommitPackagePrefetcher()
+    {
+      _pimpl->cancel();
+      _pimpl->clear();
+    }
+
+    bool CommitPackagePrefetcher::start( const sat::Transaction & transaction_r )
+    {
+      std::vector<PoolItem> packages( packagesToPrefetch( transaction_r ) );
+      SolvableIds ids( idsOf( packages ) );
+      if ( _pimpl->_started && ids == _pimpl->_ids )
+	return false;	// the same solution
+
+      _pimpl->cancel();
+      _pimpl->clear();
+
+      // Packages already in the cache are left to the commit.
+      {
+	repo::RepoMediaAccess access;
+	packages.erase( std::remove_if( packages.begin(), packages.end(), [&access]( const PoolItem & pi_r ) {
+	  return repo::PackageProvider( access, pi_r ).isCached();
+	} ), packages.end() );
+      }
+      if ( packages.empty() )
+	return false;
+
+      Pathname helper( repo::prefetchHelper() );
+      if ( helper.empty() )
+	return false;
+
+      _pimpl->_jobDir.reset( new filesystem::TmpDir( myTmpDir(), "prefetch." ) );
+      _pimpl->_record.reset( new filesystem::TmpFile( myTmpDir(), "prefetch." ) );
+      if ( ! writeJob( packages, _pimpl->_jobDir->path() ) )
+      {
+	WAR << "Can't write package prefetch job " << _pimpl->_jobDir->path() << endl;
+	_pimpl->clear();
+	return false;
+      }
+
+      ExternalProgram::Arguments cmd;
+      cmd.push_back( helper.asString() );
+      cmd.push_back( "packages" );
+      cmd.push_back( _pimpl->_jobDir->path().asString() );
+      cmd.push_back( _pimpl->_record->path().asString() );
+      _pimpl->_prog.reset( new ExternalProgram( cmd, ExternalProgram::Discard_Stderr ) );
+      pid_t pid = _pimpl->_prog->getpid();
+      if ( pid <= 0 )
+      {
+	WAR << "Can't start package prefetch" << endl;
+	_pimpl->_prog.reset();
+	_pimpl->clear();
+	return false;
+      }
+
+      for ( const PoolItem & pi : packages )
+	_pimpl->_stagingDirs.insert( stagingDir( pi->repoInfo(), pid ) );
+      _pimpl->_ids.swap( ids );
+      _pimpl->_started = true;
+      MIL << "Package prefetch [" << pid << "] started for " << packages.size() << " packages" << endl;
+      return true;
+    }
+
+    void CommitPackagePrefetcher::cancel()
+    { _pimpl->cancel(); }
+
+    bool CommitPackagePrefetcher::running() const
+    { return _pimpl->running(); }
+
+    void CommitPackagePrefetcher::commitBegins( const sat::Transaction & transaction_r )
+    {
+      _pimpl->cancel();
+      _pimpl->adopt( idsOf( packagesToPrefetch( transaction_r ) ) );
+      _pimpl->clear();
+    }
+
+    std::ostream & operator<<( std::ostream & str, const CommitPackagePrefetcher & obj )
+    {
+      str << "CommitPackagePrefetcher(" << obj._pimpl->_ids.size() << " packages";
+      if ( obj.running() )
+	str << ", running [" << obj._pimpl->_prog->getpid() << "]";
+      return str << ")";
+    }
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,94 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/CommitPackagePrefetcher.h
+ *
+*/
+#ifndef ZYPP_TARGET_COMMITPACKAGEPREFETCHER_H
+#define ZYPP_TARGET_COMMITPACKAGEPREFETCHER_H
+
+#include <iosfwd>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/base/PtrTypes.h"
+#include "zypp/sat/Transaction.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  { /////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class CommitPackagePrefetcher
+    /// \brief Download the packages of a transaction into the package cache
+    /// while the application waits for the user to confirm the commit.
+    ///
+    /// \ref start runs the \ref repo::prefetchHelper at the lowest CPU
+    /// priority, downloading the packages to install from downloading repos.
+    /// Packages already in the cache are skipped. The helper is not
+    /// interactive, so any problem just skips the package; the commit will
+    /// download it again. A separate process is used because neither the
+    /// media backends nor the logger are thread safe.
+    ///
+    /// The helper downloads into a private staging dir next to the package
+    /// cache and checks the checksums. \ref commitBegins checks the
+    /// signatures of the packages needed by the commit and moves them into
+    /// the cache, where the \ref CommitPackageCache finds them. All other
+    /// downloads are removed with the staging dir, as they are if the
+    /// solution changes (\ref start with different packages) or no commit
+    /// happens (dtor).
+    ///////////////////////////////////////////////////////////////////
+    class CommitPackagePrefetcher : private base::NonCopyable
+    {
+      friend std::ostream & operator<<( std::ostream & str, const CommitPackagePrefetcher & obj );
+
+    public:
+      CommitPackagePrefetcher();
+
+      /** Dtor cancels a running prefetch and removes unused downloads. */
+      ~CommitPackagePrefetcher();
+
+    public:
+      /** Start prefetching the packages to install in \a transaction_r.
+       * Nothing is done if they are the same as in the running (or finished)
+       * prefetch. Otherwise a running prefetch is cancelled first.
+       * \return Whether a prefetch was started.
+       */
+      bool start( const sat::Transaction & transaction_r );
+
+      /** Stop a running prefetch (downloads in progress are aborted). */
+      void cancel();
+
+      /** Whether a prefetch is running. */
+      bool running() const;
+
+      /** To be called before \a transaction_r is committed.
+       * Stops a running prefetch. The downloads needed by \a transaction_r
+       * are moved into the package cache if they pass the signature check,
+       * all others are removed.
+       */
+      void commitBegins( const sat::Transaction & transaction_r );
+
+    public:
+      class Impl;
+    private:
+      RW_pointer<Impl> _pimpl;
+    };
+
+    /** \relates CommitPackagePrefetcher Stream output */
+    std::ostream & operator<<( std::ostream & str, const CommitPackagePrefetcher & obj );
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_TARGET_COMMITPACKAGEPREFETCHER_H
@@ -0,0 +1,308 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/RpmHeaderPrefetcher.cc
+ *
+*/
+extern "C"
+{
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdint.h>
+}
+#include <cerrno>
+#include <functional>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/thread/RunTasks.h"
+#include "zypp/target/RpmHeaderPrefetcher.h"
+#include "zypp/AutoDispose.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  { /////////////////////////////////////////////////////////////////
+
+    typedef RpmHeaderPrefetcher::Blob Blob;
+
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      inline uint32_t be32( const unsigned char * p )
+      { return ( uint32_t(p[0]) << 24 ) | ( uint32_t(p[1]) << 16 ) | ( uint32_t(p[2]) << 8 ) | uint32_t(p[3]); }
+
+      inline bool preadAll( int fd_r, void * buf_r, size_t len_r, off_t off_r )
+      {
+	while ( len_r )
+	{
+	  ssize_t cnt = ::pread( fd_r, buf_r, len_r, off_r );
+	  if ( cnt < 0 && errno == EINTR )
+	    continue;
+	  if ( cnt <= 0 )
+	    return false;
+	  buf_r = static_cast<char*>(buf_r) + cnt;
+	  len_r -= cnt;
+	  off_r += cnt;
+	}
+	return true;
+      }
+
+      ///////////////////////////////////////////////////////////////////
+      /// \brief Header blobs of recently checked packages (by checksum).
+      ///
+      /// A retried or repeated commit in the same process does not read
+      /// the package files again. Used in the main thread only.
+      ///////////////////////////////////////////////////////////////////
+      struct RpmHeaderBlobCache
+      {
+	static const size_t maxBytes = 128 * 1024 * 1024;
+
+	Blob lookup( const std::string & key_r ) const
+	{
+	  if ( key_r.empty() )
+	    return Blob();
+	  auto it( _blobs.find( key_r ) );
+	  return it == _blobs.end() ? Blob() : it->second;
+	}
+
+	void remember( const std::string & key_r, const Blob & blob_r )
+	{
+	  if ( key_r.empty() || ! blob_r || blob_r->size() > maxBytes / 4 )
+	    return;
+	  if ( _bytes + blob_r->size() > maxBytes )
+	  {
+	    _blobs.clear();
+	    _bytes = 0;
+	  }
+	  Blob & blob( _blobs[key_r] );
+	  if ( blob )
+	    _bytes -= blob->size();
+	  blob = blob_r;
+	  _bytes += blob->size();
+	}
+
+	static RpmHeaderBlobCache & instance()
+	{
+	  static RpmHeaderBlobCache _instance;
+	  return _instance;
+	}
+
+      private:
+	std::unordered_map<std::string,Blob> _blobs;
+	size_t _bytes = 0;
+      };
+
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class RpmHeaderPrefetcher::Impl
+    /// \brief RpmHeaderPrefetcher implementation.
+    ///////////////////////////////////////////////////////////////////
+    class RpmHeaderPrefetcher::Impl : private base::NonCopyable
+    {
+      /** A file to read. */
+      struct Entry
+      {
+	IdType      id;
+	Pathname    file;
+	std::string key;
+      };
+
+    public:
+      Impl( unsigned windowSize_r )
+      : _windowSize( windowSize_r ? windowSize_r : 1 )
+      {}
+
+      ~Impl()
+      {
+	if ( ! _queue.empty() )
+	  MIL << "Prefetched " << _read << " package headers (" << _cached << " cached, " << _failed << " failed, "
+	      << ( _queue.size() - _next ) << " not needed)" << endl;
+      }
+
+    public:
+      void add( IdType id_r, const Pathname & file_r, const std::string & cacheKey_r )
+      {
+	_pos[id_r] = _queue.size();
+	_queue.push_back( Entry { id_r, file_r, cacheKey_r } );
+      }
+
+      Blob take( IdType id_r )
+      {
+	auto pit( _pos.find( id_r ) );
+	if ( pit == _pos.end() )
+	  return Blob();
+
+	auto wit( _window.find( id_r ) );
+	if ( wit == _window.end() )
+	{
+	  if ( pit->second < _next )
+	    return Blob();	// taken, failed or skipped
+
+	  // consumer skipped ahead: restart the window at id_r
+	  _window.clear();
+	  _windowBytes = 0;
+	  _next = pit->second;
+	  fill();
+	  wit = _window.find( id_r );
+	  if ( wit == _window.end() )
+	    return Blob();
+	}
+
+	Blob ret( wit->second );
+	_windowBytes -= ret->size();
+	_window.erase( wit );
+	if ( _window.size() <= _windowSize / 2 )
+	  fill();
+	return ret;
+      }
+
+      unsigned windowSize() const
+      { return _windowSize; }
+
+      unsigned prefetched() const
+      { return _window.size(); }
+
+    private:
+      /** Refill the window with the next files (cache first, then read in parallel). */
+      void fill()
+      {
+	RpmHeaderBlobCache & cache( RpmHeaderBlobCache::instance() );
+	std::vector<const Entry *> toRead;
+	while ( _next < _queue.size() && _window.size() + toRead.size() < _windowSize && _windowBytes < maxWindowBytes )
+	{
+	  const Entry & entry( _queue[_next++] );
+	  Blob blob( cache.lookup( entry.key ) );
+	  if ( blob )
+	  {
+	    _window[entry.id] = blob;
+	    _windowBytes += blob->size();
+	    ++_cached;
+	  }
+	  else
+	    toRead.push_back( &entry );
+	}
+	if ( toRead.empty() )
+	  return;
+
+	std::vector<Blob> blobs( toRead.size() );
+	std::vector<std::function<void()> > tasks;
+	for ( unsigned i = 0; i < toRead.size(); ++i )
+	{
+	  tasks.push_back( [&toRead,&blobs,i]()
+	  { blobs[i] = readBlob( toRead[i]->file ); } );
+	}
+	thread::runTasks( tasks );
+
+	for ( unsigned i = 0; i < blobs.size(); ++i )
+	{
+	  if ( ! blobs[i] )
+	  {
+	    ++_failed;	// looked up from file later
+	    continue;
+	  }
+	  _window[toRead[i]->id] = blobs[i];
+	  _windowBytes += blobs[i]->size();
+	  cache.remember( toRead[i]->key, blobs[i] );
+	  ++_read;
+	}
+      }
+
+    private:
+      unsigned _windowSize;
+      std::vector<Entry> _queue;
+      std::unordered_map<IdType,size_t> _pos;
+      size_t _next = 0;		///< first entry not yet fetched
+      std::unordered_map<IdType,Blob> _window;
+      size_t _windowBytes = 0;
+      unsigned _read = 0;
+      unsigned _cached = 0;
+      unsigned _failed = 0;
+    };
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	CLASS NAME : RpmHeaderPrefetcher
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    RpmHeaderPrefetcher::RpmHeaderPrefetcher( unsigned windowSize_r )
+    : _pimpl( new Impl( windowSize_r ) )
+    {}
+
+    RpmHeaderPrefetcher::~RpmHeaderPrefetcher()
+    {}
+
+    void RpmHeaderPrefetcher::add( IdType id_r, const Pathname & file_r, const std::string & cacheKey_r )
+    { _pimpl->add( id_r, file_r, cacheKey_r ); }
+
+    RpmHeaderPrefetcher::Blob RpmHeaderPrefetcher::take( IdType id_r )
+    { return _pimpl->take( id_r ); }
+
+    unsigned RpmHeaderPrefetcher::windowSize() const
+    { return _pimpl->windowSize(); }
+
+    unsigned RpmHeaderPrefetcher::prefetched() const
+    { return _pimpl->prefetched(); }
+
+    RpmHeaderPrefetcher::Blob RpmHeaderPrefetcher::readBlob( const Pathname & file_r )
+    {
+      // Runs in worker threads, so it must not log.
+      static const size_t leadSize = 96;
+      static const uint32_t maxIl = 0x10000;
+      static const uint32_t maxDl = 256 * 1024 * 1024;
+
+      int fd = ::open( file_r.c_str(), O_RDONLY|O_CLOEXEC );
+      if ( fd == -1 )
+	return Blob();
+      AutoDispose<int> guard( fd, ::close );
+
+      unsigned char intro[16];
+      if ( ! preadAll( fd, intro, 4, 0 ) || be32( intro ) != 0xedabeedb )
+	return Blob();
+
+      // signature header: 16 byte intro, index, data, padded to 8
+      size_t size = leadSize;
+      if ( ! preadAll( fd, intro, 16, size ) || be32( intro ) != 0x8eade801 )
+	return Blob();
+      uint32_t il = be32( intro + 8 );
+      uint32_t dl = be32( intro + 12 );
+      if ( il > maxIl || dl > maxDl )
+	return Blob();
+      size += 16 + ( ( 16 * il + dl + 7 ) & ~7 );
+
+      // header: 16 byte intro, index, data
+      if ( ! preadAll( fd, intro, 16, size ) || be32( intro ) != 0x8eade801 )
+	return Blob();
+      il = be32( intro + 8 );
+      dl = be32( intro + 12 );
+      if ( il > maxIl || dl > maxDl )
+	return Blob();
+      size += 16 + 16 * il + dl;
+
+      std::string * ret = new std::string( size, '\0' );
+      Blob blob( ret );
+      if ( ! preadAll( fd, &(*ret)[0], size, 0 ) )
+	return Blob();
+      return blob;
+    }
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,112 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/RpmHeaderPrefetcher.h
+ *
+*/
+#ifndef ZYPP_TARGET_RPMHEADERPREFETCHER_H
+#define ZYPP_TARGET_RPMHEADERPREFETCHER_H
+
+#include <string>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/base/PtrTypes.h"
+#include "zypp/sat/detail/PoolMember.h"
+#include "zypp/Pathname.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  { /////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class RpmHeaderPrefetcher
+    /// \brief Read the headers of rpm files in parallel, a bounded window
+    /// ahead of the consumer.
+    ///
+    /// The files are \ref add ed in the order they are expected to be
+    /// used. \ref take hands out a files header blob (the lead, signature
+    /// and header, without the payload) and drops it from the window. As
+    /// the window drains, the next files are read in parallel. At most
+    /// \ref windowSize blobs (and about \ref maxWindowBytes) are held.
+    ///
+    /// Blobs of files added with a cache key (the package checksum) are
+    /// also kept in a process wide cache limited to 128 MiB, so a retried
+    /// commit does not read the same files again.
+    ///
+    /// \code
+    /// RpmHeaderPrefetcher prefetcher;
+    /// for ( ... )
+    ///   prefetcher.add( id, localfile, checksumkey );
+    /// ...
+    /// RpmHeaderPrefetcher::Blob blob( prefetcher.take( id ) );
+    /// if ( ! blob )
+    ///   ; // read the file yourself
+    /// \endcode
+    ///////////////////////////////////////////////////////////////////
+    class RpmHeaderPrefetcher : private base::NonCopyable
+    {
+    public:
+      typedef sat::detail::IdType IdType;
+
+      /** The bytes of an rpm file up to the end of its header. */
+      typedef shared_ptr<const std::string> Blob;
+
+      /** Default max. number of blobs held. */
+      static const unsigned defaultWindowSize = 64;
+
+      /** Further files are not read ahead while the window holds that many bytes. */
+      static const size_t maxWindowBytes = 32 * 1024 * 1024;
+
+    public:
+      explicit RpmHeaderPrefetcher( unsigned windowSize_r = defaultWindowSize );
+
+      /** Dtor logs some statistics. */
+      ~RpmHeaderPrefetcher();
+
+    public:
+      /** Append \a file_r to the files to read.
+       * \a cacheKey_r (e.g. \c "sha256:...") identifies the files content in
+       * the process wide cache. If empty, the cache is not used.
+       */
+      void add( IdType id_r, const Pathname & file_r, const std::string & cacheKey_r = std::string() );
+
+      /** Hand out the blob of \a id_r and drop it from the window.
+       * An empty blob is returned if \a id_r was not \ref add ed, was
+       * already taken or could not be read. If the consumer skips ahead,
+       * the window restarts at \a id_r and the files in between are dropped.
+       */
+      Blob take( IdType id_r );
+
+      /** Max. number of blobs held. */
+      unsigned windowSize() const;
+
+      /** Number of blobs currently held. */
+      unsigned prefetched() const;
+
+    public:
+      /** Read the header blob of \a file_r (empty if it's not an rpm).
+       * Safe to be called from worker threads.
+       */
+      static Blob readBlob( const Pathname & file_r );
+
+    public:
+      class Impl;
+    private:
+      RW_pointer<Impl> _pimpl;
+    };
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_TARGET_RPMHEADERPREFETCHER_H
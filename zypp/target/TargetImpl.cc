@@ -49,6 +49,7 @@
 
 #include "zypp/parser/ProductFileReader.h"
 #include "zypp/repo/SrcPackageProvider.h"
+#include "zypp/repo/PackageStore.h"
 
 #include "zypp/sat/Pool.h"
 #include "zypp/sat/detail/PoolImpl.h"
@@ -1315,6 +1316,8 @@ namespace zypp
 	    DBG << "dryRun/downloadOnly: Not installing/deleting anything." << endl;
 	  }
 	}
+	// packages were added to the shared package store; keep it in size
+	repo::PackageStore().cleanup();
       }
       else
       {
@@ -33,6 +33,7 @@ extern "C"
 
 #include "zypp/target/TargetImpl.h"
 #include "zypp/target/CommitPackageCache.h"
+#include "zypp/target/RpmHeaderPrefetcher.h"
 
 #include "zypp/ZYppCallbacks.h"
 
@@ -79,6 +80,27 @@ namespace zypp
 	const sat::Queue & noFilelist() const
 	{ return _noFilelist; }
 
+	/** Queue the (cached) packages to install for reading their headers ahead.
+	 * They are read in parallel, a bounded window ahead of the 1st visits
+	 * (in \a todo_r order). Each blob is dropped after its 1st visit, later
+	 * visits read the file.
+	 */
+	void prefetch( const sat::Queue & todo_r, int newpkgs_r )
+	{
+	  for ( int i = 0; i < newpkgs_r && i < int(todo_r.size()); ++i )
+	  {
+	    sat::detail::IdType id = todo_r[i];
+	    Package::Ptr pkg( make<Package>( sat::Solvable( id ) ) );
+	    if ( ! pkg || pkg->isSystem() )
+	      continue;
+	    Pathname localfile( pkg->cachedLocation() );
+	    if ( localfile.empty() )
+	      continue;
+	    CheckSum checksum( pkg->checksum() );
+	    _prefetcher.add( id, localfile, checksum.empty() ? std::string() : checksum.type()+":"+checksum.checksum() );
+	  }
+	}
+
 	static void * invoke( sat::detail::CPool * pool_r, sat::detail::IdType id_r, void * cbdata_r )
 	{ return (*reinterpret_cast<FileConflictsCB*>(cbdata_r))( pool_r, id_r ); }
 
@@ -104,6 +126,14 @@ namespace zypp
 	    Pathname localfile( pkg->cachedLocation() );
 	    if ( localfile.empty() )
 	      return nullptr;
+	    RpmHeaderPrefetcher::Blob blob( _prefetcher.take( id_r ) );
+	    if ( blob )
+	    {
+	      AutoDispose<FILE*> fp( ::fmemopen( const_cast<char*>( blob->data() ), blob->size(), "r" ), ::fclose );
+	      if ( fp )
+		return ::rpm_byfp( _state, fp, localfile.c_str() );
+	      fp.resetDispose();
+	    }
 	    AutoDispose<FILE*> fp( ::fopen( localfile.c_str(), "re" ), ::fclose );
 	    return ::rpm_byfp( _state, fp, localfile.c_str() );
 	  }
@@ -114,6 +144,7 @@ namespace zypp
 	AutoDispose<void*> _state;
 	std::unordered_set<sat::detail::IdType> _visited;
 	sat::Queue _noFilelist;
+	RpmHeaderPrefetcher _prefetcher;
       };
 
     } // namespace
@@ -135,6 +166,7 @@ namespace zypp
 	  ZYPP_THROW( AbortRequestException() );
 
 	FileConflictsCB cb( sat::Pool::instance().get(), progress );
+	cb.prefetch( todo, newpkgs );
 	// lambda receives progress trigger and translates into report
 	auto sendProgress = [&]( const ProgressData & progress_r )->bool {
 	  if ( ! report->progress( progress_r, cb.noFilelist() ) )
@@ -12,11 +12,17 @@
 extern "C"
 {
 #include <fnmatch.h>
+#include <unistd.h>
 }
 
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <cstring>
 
 #undef ZYPP_BASE_LOGGER_LOGGROUP
 #define ZYPP_BASE_LOGGER_LOGGROUP "MODALIAS"
@@ -24,6 +30,7 @@ extern "C"
 #include "zypp/base/LogTools.h"
 #include "zypp/base/IOStream.h"
 #include "zypp/base/InputStream.h"
+#include "zypp/base/String.h"
 #include "zypp/AutoDispose.h"
 #include "zypp/PathInfo.h"
 
@@ -86,6 +93,111 @@ namespace zypp
 	  }
 	}
       }
+
+      /** Where the scanned modaliases of \c /sys are kept across processes. */
+      inline Pathname cacheFile()
+      {
+	const char * file = getenv("ZYPP_MODALIAS_CACHE");
+	return file ? file : "/var/run/zypp-modalias.cache";
+      }
+
+      /** Sorted names in \a dir_r (readdir order may differ). */
+      std::vector<std::string> sortedDirEntries( const Pathname & dir_r )
+      {
+	std::vector<std::string> ret;
+	AutoDispose<DIR *> dir( ::opendir( dir_r.c_str() ), ::closedir );
+	if ( dir )
+	{
+	  struct dirent * dirent = NULL;
+	  while ( (dirent = ::readdir(dir)) != NULL )
+	  {
+	    if ( dirent->d_name[0] != '.' )
+	      ret.push_back( dirent->d_name );
+	  }
+	  std::sort( ret.begin(), ret.end() );
+	}
+	return ret;
+      }
+
+      /** Cheap fingerprint of the devices in \c /sys (empty if unavailable).
+       * Hashes the boot id, the device names in \c /sys/bus/\<bus\>/devices
+       * and \c /sys/class/\<class\> and each devices \c modalias, so rebooting,
+       * adding/removing a device or replacing it by one getting the same name
+       * changes it. This reads a few directories and one small file per device
+       * instead of the whole tree.
+       */
+      std::string sysDevicesFingerprint()
+      {
+	std::string bootId;
+	{
+	  std::ifstream str( "/proc/sys/kernel/random/boot_id" );
+	  bootId = iostr::getline( str );
+	}
+	if ( bootId.empty() )
+	  return std::string();
+
+	std::hash<std::string> hasher;
+	size_t hash = hasher( bootId );
+	unsigned devices = 0;
+	auto add = [&]( const Pathname & topdir_r, const char * subdir_r )
+	{
+	  for ( const std::string & group : sortedDirEntries( topdir_r ) )
+	  {
+	    hash = hash * 31 + hasher( group );
+	    Pathname groupdir( topdir_r / group / subdir_r );
+	    for ( const std::string & device : sortedDirEntries( groupdir ) )
+	    {
+	      hash = hash * 31 + hasher( device );
+	      std::ifstream str( ( groupdir / device / "modalias" ).c_str() );
+	      if ( str )
+		hash = hash * 31 + hasher( iostr::getline( str ) );
+	      ++devices;
+	    }
+	  }
+	};
+	add( "/sys/bus", "devices" );
+	add( "/sys/class", "" );
+	if ( ! devices )
+	  return std::string();
+
+	return str::form( "%s %zx %u", bootId.c_str(), hash, devices );
+      }
+
+      /** Read the cached modaliases if the cache matches \a fingerprint_r. */
+      bool readCache( const std::string & fingerprint_r, Modalias::ModaliasList & arg )
+      {
+	std::ifstream str( cacheFile().c_str() );
+	if ( ! str || iostr::getline( str ) != "# " + fingerprint_r )
+	  return false;
+	for ( iostr::EachLine line( str ); line; line.next() )
+	{
+	  if ( ! line->empty() )
+	    arg.push_back( *line );
+	}
+	return true;
+      }
+
+      /** Replace the cache (if permitted). */
+      void writeCache( const std::string & fingerprint_r, const Modalias::ModaliasList & list_r )
+      {
+	Pathname file( cacheFile() );
+	Pathname tmp( file.extend( str::form( ".%d", ::getpid() ) ) );
+	{
+	  std::ofstream str( tmp.c_str() );
+	  if ( ! str )
+	    return;	// e.g. not root
+	  str << "# " << fingerprint_r << endl;
+	  for ( const std::string & line : list_r )
+	    str << line << endl;
+	  if ( ! str )
+	  {
+	    filesystem::unlink( tmp );
+	    return;
+	  }
+	}
+	if ( filesystem::rename( tmp, file ) != 0 )
+	  filesystem::unlink( tmp );
+      }
     } // namespace
     ///////////////////////////////////////////////////////////////////
 
@@ -123,6 +235,18 @@ namespace zypp
 	{
 	  dir = "/sys";
 	  DBG << "Using /sys directory." << endl;
+	  std::string fingerprint( sysDevicesFingerprint() );
+	  if ( ! fingerprint.empty() )
+	  {
+	    if ( readCache( fingerprint, _modaliases ) )
+	    {
+	      DBG << "Using cached modaliases: " << cacheFile() << endl;
+	      return;
+	    }
+	    foreach_file_recursive( dir, _modaliases );
+	    writeCache( fingerprint, _modaliases );
+	    return;
+	  }
 	}
 
 	foreach_file_recursive( dir, _modaliases );
@@ -148,13 +272,63 @@ namespace zypp
        */
       bool query( const char * cap_r ) const
       {
-	if ( cap_r && *cap_r )
+	if ( ! ( cap_r && *cap_r ) )
+	  return false;
+
+	std::lock_guard<std::mutex> guard( _mutex );
+	return match( cap_r );
+      }
+
+      /** Memoized \ref query for the (maybe hexencoded) argument of a \c modalias() dependency. */
+      bool queryEncoded( IdString cap_r ) const
+      {
+	if ( cap_r.empty() )
+	  return false;
+
+	std::lock_guard<std::mutex> guard( _mutex );
+	auto it( _queryCache.find( cap_r.id() ) );
+	if ( it != _queryCache.end() )
+	  return it->second;
+	// modalias strings in capability may be hexencoded because rpm does not allow
+	// ',', ' ' or other special chars.
+	return( _queryCache[cap_r.id()] = match( str::hexdecode( cap_r.c_str() ).c_str() ) );
+      }
+
+      void setModaliases( ModaliasList newlist_r )
+      {
+	std::lock_guard<std::mutex> guard( _mutex );
+	_modaliases.swap( newlist_r );
+	_sorted.clear();
+	_queryCache.clear();
+      }
+
+    private:
+      /** Match \a cap_r against the modaliases.
+       *
+       * The modaliases are kept sorted, which groups them by bus (the
+       * part before the ':') and vendor/device ids. Only the range of
+       * modaliases starting with the patterns literal prefix (the part
+       * before the first wildcard) is passed to \c fnmatch. Patterns
+       * in packages usually have a literal \c "bus:vVENDORdDEVICE" prefix.
+       *
+       * Expects \c _mutex to be locked.
+       */
+      bool match( const char * cap_r ) const
+      {
+	if ( _sorted.empty() && ! _modaliases.empty() )
 	{
-	  for_( it, _modaliases.begin(), _modaliases.end() )
-	  {
-	    if ( fnmatch( cap_r, (*it).c_str(), 0 ) == 0 )
-	      return true;
-	  }
+	  _sorted = _modaliases;
+	  std::sort( _sorted.begin(), _sorted.end() );
+	  _sorted.erase( std::unique( _sorted.begin(), _sorted.end() ), _sorted.end() );
+	}
+
+	std::string prefix( cap_r, ::strcspn( cap_r, "*?[\\" ) );
+	for ( auto it = std::lower_bound( _sorted.begin(), _sorted.end(), prefix ); it != _sorted.end(); ++it )
+	{
+	  if ( ! str::hasPrefix( *it, prefix ) )
+	    break;	// beyond the range
+	  if ( fnmatch( cap_r, it->c_str(), 0 ) == 0 )
+	    return true;
 	}
 	return false;
       }
@@ -162,6 +336,11 @@ namespace zypp
     public:
       ModaliasList _modaliases;
 
+    private:
+      mutable std::mutex _mutex;
+      mutable ModaliasList _sorted;	//!< sorted unique \c _modaliases (lazy)
+      mutable std::unordered_map<IdString::IdType, bool> _queryCache;
+
     public:
       /** Offer default Impl. */
       static shared_ptr<Impl> nullimpl()
@@ -207,8 +386,11 @@ namespace zypp
     const Modalias::ModaliasList & Modalias::modaliasList() const
     { return _pimpl->_modaliases; }
 
+    bool Modalias::queryEncoded( IdString cap_r ) const
+    { return _pimpl->queryEncoded( cap_r ); }
+
     void Modalias::modaliasList( ModaliasList newlist_r )
-    { _pimpl->_modaliases.swap( newlist_r ); }
+    { _pimpl->setModaliases( std::move(newlist_r) ); }
 
     std::ostream & operator<<( std::ostream & str, const Modalias & obj )
     { return str << *obj._pimpl; }
@@ -74,6 +74,14 @@ namespace zypp
         bool query( const std::string & cap_r ) const
         { return query( cap_r.c_str() ); }
 
+        /** Memoized \ref query for the argument of a \c modalias() dependency
+         * as passed by the solvers namespace callback. It may be hexencoded
+         * (\ref str::hexdecode), as rpm does not allow some special chars.
+         * The result is remembered per \ref IdString until the
+         * \ref modaliasList changes.
+         */
+        bool queryEncoded( IdString cap_r ) const;
+
         /** List of modaliases found on system */
         const ModaliasList & modaliasList() const;
 
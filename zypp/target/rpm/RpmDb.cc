@@ -31,6 +31,7 @@ extern "C"
 
 #include "zypp/base/Logger.h"
 #include "zypp/base/String.h"
+#include "zypp/base/Measure.h"
 #include "zypp/base/Gettext.h"
 #include "zypp/base/LocaleGuard.h"
 
@@ -1943,6 +1944,8 @@ void RpmDb::processConfigFiles(const std::string& line, const std::string& name,
 //
 void RpmDb::installPackage( const Pathname & filename, RpmInstFlags flags )
 {
+  debug::TraceSpan span( "rpm", "install" );
+  span.tag( "package", filename.basename() );
   callback::SendReport<RpmInstallReport> report;
 
   report->start(filename);
@@ -2130,6 +2133,8 @@ void RpmDb::removePackage( Package::constPtr package, RpmInstFlags flags )
 //
 void RpmDb::removePackage( const std::string & name_r, RpmInstFlags flags )
 {
+  debug::TraceSpan span( "rpm", "remove" );
+  span.tag( "package", name_r );
   callback::SendReport<RpmRemoveReport> report;
 
   report->start( name_r );
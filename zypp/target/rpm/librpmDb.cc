@@ -11,9 +11,12 @@
 */
 #include "librpm.h"
 
+#include <cstdlib>
 #include <iostream>
 
 #include "zypp/base/Logger.h"
+#include "zypp/base/String.h"
+#include "zypp/thread/RunTasks.h"
 #include "zypp/PathInfo.h"
 #include "zypp/target/rpm/librpmDb.h"
 #include "zypp/target/rpm/RpmHeader.h"
@@ -927,6 +930,214 @@ bool librpmDb::db_const_iterator::findPackage( const Package::constPtr & which_r
   return findPackage( which_r->name(), which_r->edition() );
 }
 
+///////////////////////////////////////////////////////////////////
+//
+//	CLASS NAME : librpmDb::db_scanner
+//
+///////////////////////////////////////////////////////////////////
+
+namespace
+{
+  /** Database entries retrieved by one task. */
+  const unsigned scanChunkSize = 64;
+
+  /** Tasks per thread in a batch (a batch is read before it's processed). */
+  const unsigned scanChunksPerThread = 4;
+
+  /** A database entry handed to a worker. */
+  struct ScanEntry
+  {
+    unsigned hdrNum;
+#ifndef _RPM_5
+    void *   blob;	// private copy of the header
+    unsigned size;
+#else
+    Header   h;
+#endif
+  };
+
+  /** Append the values of \a tag_r in \a h_r to \a values_r. */
+  void scanTag( Header h_r, int tag_r, std::vector<std::string> & values_r )
+  {
+#ifndef _RPM_5
+    ::rpmtd td = ::rpmtdNew();
+    if ( ::headerGet( h_r, rpmTag(tag_r), td, HEADERGET_MINMEM ) )
+    {
+      values_r.reserve( ::rpmtdCount( td ) );
+      while ( ::rpmtdNext( td ) >= 0 )
+      {
+        char * val = ::rpmtdFormat( td, RPMTD_FORMAT_STRING, NULL );
+        values_r.push_back( val ? val : "" );
+        ::free( val );
+      }
+      ::rpmtdFreeData( td );
+    }
+    ::rpmtdFree( td );
+#else
+    rpmTagType type = RPM_NULL_TYPE;
+    rpm_count_t cnt = 0;
+    void * val = 0;
+    if ( ! ::headerGetEntry( h_r, rpmTag(tag_r), hTYP_t(&type), &val, &cnt ) || ! val )
+      return;
+    switch ( type )
+    {
+      case RPM_STRING_TYPE:
+        values_r.push_back( (char*)val );
+        break;
+      case RPM_STRING_ARRAY_TYPE:
+      case RPM_I18NSTRING_TYPE:
+        values_r.assign( (char**)val, ((char**)val)+cnt );
+        break;
+      case RPM_INT8_TYPE:
+        for ( rpm_count_t i = 0; i < cnt; ++i )
+          values_r.push_back( str::numstring( ((int8_t*)val)[i] ) );
+        break;
+      case RPM_INT16_TYPE:
+        for ( rpm_count_t i = 0; i < cnt; ++i )
+          values_r.push_back( str::numstring( ((int16_t*)val)[i] ) );
+        break;
+      case RPM_INT32_TYPE:
+        for ( rpm_count_t i = 0; i < cnt; ++i )
+          values_r.push_back( str::numstring( ((int32_t*)val)[i] ) );
+        break;
+      default:
+        break;
+    }
+    if ( type == RPM_STRING_ARRAY_TYPE || type == RPM_I18NSTRING_TYPE )
+      ::free( val );
+#endif
+  }
+
+  /** Retrieve the tags of \a entry_r into \a record_r (runs in a worker thread). */
+  void scanEntry( ScanEntry & entry_r, const std::vector<int> & tags_r, librpmDb::db_scanner::Record & record_r )
+  {
+    record_r.hdrNum = entry_r.hdrNum;
+    record_r.values.resize( tags_r.size() );
+#ifndef _RPM_5
+    // Each worker owns its header, so no refcounts are shared across threads.
+    Header h = ::headerImport( entry_r.blob, entry_r.size, HEADERIMPORT_COPY );
+    ::free( entry_r.blob );
+    entry_r.blob = 0;
+#else
+    Header h = entry_r.h;
+    entry_r.h = 0;
+#endif
+    if ( ! h )
+      return;
+    for ( unsigned i = 0; i < tags_r.size(); ++i )
+      scanTag( h, tags_r[i], record_r.values[i] );
+    ::headerFree( h );
+  }
+} // namespace
+
+librpmDb::db_scanner::db_scanner( const std::vector<int> & tags_r, librpmDb::constPtr dbptr_r )
+  : _tags( tags_r )
+  , _dbptr( dbptr_r )
+  , _threadCount( thread::defaultThreadCount() )
+{}
+
+librpmDb::db_scanner::~db_scanner()
+{}
+
+unsigned librpmDb::db_scanner::scan( const RecordConsumer & consumer_r )
+{
+  _dberr.reset();
+  librpmDb::constPtr dbptr( _dbptr );
+  if ( ! dbptr )
+  {
+    try
+    {
+      librpmDb::dbAccess( dbptr );
+    }
+    catch ( const RpmException & excpt_r )
+    {
+      ZYPP_CAUGHT( excpt_r );
+      _dberr.reset( new RpmException( excpt_r ) );
+    }
+    if ( ! dbptr )
+    {
+      WAR << "No database access: " << _dberr << endl;
+      return 0;
+    }
+  }
+
+  rpmdbMatchIterator mi = ::rpmtsInitIterator( dbptr->_d._ts, rpmTag(RPMDBI_PACKAGES), NULL, 0 );
+  if ( ! mi )
+    return 0;
+
+#ifndef _RPM_5
+  unsigned threadCount = _threadCount ? _threadCount : 1;
+#else
+  unsigned threadCount = 1;	// headerLink/headerFree are not thread safe
+#endif
+  const unsigned batchSize = threadCount * scanChunksPerThread * scanChunkSize;
+
+  unsigned ret = 0;
+  bool done = false;
+  std::vector<ScanEntry> batch;
+  std::vector<Record> records;
+  while ( ! done )
+  {
+    // Read the next range of entries (sequential database access).
+    batch.clear();
+    while ( batch.size() < batchSize )
+    {
+      Header h = ::rpmdbNextIterator( mi );
+      if ( ! h )
+      {
+        done = true;
+        break;
+      }
+      ScanEntry entry;
+      entry.hdrNum = ::rpmdbGetIteratorOffset( mi );
+#ifndef _RPM_5
+      entry.blob = ::headerExport( h, &entry.size );
+      if ( ! entry.blob )
+        continue;
+#else
+      entry.h = ::headerLink( h );
+#endif
+      batch.push_back( entry );
+    }
+    if ( batch.empty() )
+      break;
+
+    // Retrieve the tags in chunks of consecutive entries.
+    records.clear();
+    records.resize( batch.size() );
+    std::vector<function<void()> > tasks;
+    for ( unsigned begin = 0; begin < batch.size(); begin += scanChunkSize )
+    {
+      unsigned end = std::min( begin + scanChunkSize, unsigned(batch.size()) );
+      tasks.push_back( [this,&batch,&records,begin,end]()
+      {
+        for ( unsigned i = begin; i < end; ++i )
+          scanEntry( batch[i], _tags, records[i] );
+      } );
+    }
+    thread::runTasks( tasks, threadCount );
+
+    for ( const Record & record : records )
+    {
+      ++ret;
+      if ( ! consumer_r( record ) )
+      {
+        done = true;
+        break;
+      }
+    }
+  }
+  ::rpmdbFreeIterator( mi );
+
+  if ( dbptr->error() )
+  {
+    _dberr = dbptr->error();
+    WAR << "Lost database access: " << _dberr << endl;
+  }
+  DBG << "Scanned " << ret << " headers (" << _tags.size() << " tags, " << threadCount << " threads)" << endl;
+  return ret;
+}
+
 } // namespace rpm
 } // namespace target
 } // namespace zypp
@@ -13,8 +13,11 @@
 #define librpmDb_h
 
 #include <iosfwd>
+#include <string>
+#include <vector>
 
 #include "zypp/base/ReferenceCounted.h"
+#include "zypp/base/Function.h"
 #include "zypp/base/NonCopyable.h"
 #include "zypp/base/PtrTypes.h"
 #include "zypp/PathInfo.h"
@@ -235,6 +238,11 @@ public:
    **/
   class db_const_iterator;
 
+  /**
+   * Subclass to bulk read selected tags of all database entries.
+   **/
+  class db_scanner;
+
 private:
   ///////////////////////////////////////////////////////////////////
   //
@@ -618,6 +626,88 @@ public:
   bool findPackage( const Package::constPtr & which_r );
 };
 
+///////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////
+//
+//	CLASS NAME : librpmDb::db_scanner
+/**
+ * @short Bulk read selected tags of all database entries.
+ *
+ * Unlike @ref db_const_iterator no @ref RpmHeader is created. Only
+ * the requested tags are retrieved, and their values are passed to a
+ * callback as a compact @ref Record. Each value is formatted as string
+ * (like <tt>rpm -q --qf '[%{TAG}\n]'</tt>).
+ *
+ * The database is read sequentially in batches (ranges of database
+ * entries). Retrieving the tags of a batch is split across worker
+ * threads (see @ref thread::runTasks). The records are passed to the
+ * callback in the calling thread, in database order, batch by batch.
+ *
+ * \code
+ * librpmDb::db_scanner scanner( { RPMTAG_NAME, RPMTAG_BASENAMES, RPMTAG_FILEDIGESTS } );
+ * scanner.scan( []( const librpmDb::db_scanner::Record & rec_r )->bool {
+ *   // rec_r.values[0][0] is the name, rec_r.values[1] the files...
+ *   return true; // continue
+ * } );
+ * \endcode
+ **/
+class librpmDb::db_scanner : private base::NonCopyable
+{
+public:
+  /**
+   * The values of the requested tags of one database entry.
+   **/
+  struct Record
+  {
+    /** The headers index in database. */
+    unsigned hdrNum;
+    /** Per requested tag (in order) its values (empty if the tag is missing). */
+    std::vector<std::vector<std::string> > values;
+  };
+
+  /**
+   * Called for each @ref Record, return \c false to stop the scan.
+   **/
+  typedef function<bool( const Record & )> RecordConsumer;
+
+public:
+  /**
+   * Constructor taking the rpm tags to retrieve.
+   * The default form accesses librpmDb's default database.
+   **/
+  db_scanner( const std::vector<int> & tags_r, librpmDb::constPtr dbptr_r = 0 );
+
+  ~db_scanner();
+
+  /**
+   * Number of worker threads to use (default: number of CPUs).
+   **/
+  unsigned threadCount() const
+  { return _threadCount; }
+
+  void setThreadCount( unsigned threadCount_r )
+  { _threadCount = threadCount_r; }
+
+  /**
+   * Pass the @ref Record of each database entry to \a consumer_r.
+   * Returns the number of records passed.
+   **/
+  unsigned scan( const RecordConsumer & consumer_r );
+
+  /**
+   * Return any database error of the last @ref scan.
+   **/
+  shared_ptr<RpmException> dbError() const
+  { return _dberr; }
+
+private:
+  std::vector<int>         _tags;
+  librpmDb::constPtr       _dbptr;
+  unsigned                 _threadCount;
+  shared_ptr<RpmException> _dberr;
+};
+
 ///////////////////////////////////////////////////////////////////
 } //namespace rpm
 } //namespace target
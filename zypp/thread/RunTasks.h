@@ -0,0 +1,103 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/thread/RunTasks.h
+ *
+*/
+#ifndef   ZYPP_THREAD_RUNTASKS_H
+#define   ZYPP_THREAD_RUNTASKS_H
+
+#include <vector>
+#include <atomic>
+#include <exception>
+#include <boost/thread.hpp>
+
+//////////////////////////////////////////////////////////////////////
+namespace zypp
+{ ////////////////////////////////////////////////////////////////////
+  ////////////////////////////////////////////////////////////////////
+  namespace thread
+  { //////////////////////////////////////////////////////////////////
+
+    /** Number of worker threads to use if not told otherwise (at least 1). */
+    inline unsigned defaultThreadCount()
+    {
+      unsigned ret = boost::thread::hardware_concurrency();
+      return ret ? ret : 1;
+    }
+
+    /** Run a number of independent tasks using up to \c threadCount_r threads.
+     *
+     * Tasks are handed out in order to the next idle worker, so uneven
+     * task sizes balance themselves. The call returns after all tasks are
+     * done. If a task throws, the remaining tasks are still run and the
+     * first exception caught is rethrown afterwards.
+     *
+     * With \c threadCount_r <= 1 (or a single task) the tasks are run
+     * in the calling thread.
+     *
+     * \note The zypp logger is not thread safe. Tasks must not log,
+     * but should store their results and let the caller log them.
+     *
+     * \code
+     * std::vector<std::function<void()>> tasks;
+     * std::vector<unsigned> results( 100 );
+     * for ( unsigned i = 0; i < 100; ++i )
+     *   tasks.push_back( [i,&results]() { results[i] = i*i; } );
+     * thread::runTasks( tasks );
+     * \endcode
+     */
+    template <class TFunction>
+    void runTasks( const std::vector<TFunction> & tasks_r, unsigned threadCount_r = defaultThreadCount() )
+    {
+      if ( threadCount_r > tasks_r.size() )
+        threadCount_r = tasks_r.size();
+
+      if ( threadCount_r <= 1 )
+      {
+        for ( const TFunction & task : tasks_r )
+          task();
+        return;
+      }
+
+      std::atomic<size_t> next( 0 );
+      std::vector<std::exception_ptr> errors( threadCount_r );
+      boost::thread_group group;
+      for ( unsigned t = 0; t < threadCount_r; ++t )
+      {
+        group.create_thread( [&tasks_r, &next, &errors, t]()
+        {
+          for ( size_t i = next++; i < tasks_r.size(); i = next++ )
+          {
+            try
+            { tasks_r[i](); }
+            catch ( ... )
+            {
+              if ( ! errors[t] )
+                errors[t] = std::current_exception();
+            }
+          }
+        });
+      }
+      group.join_all();
+
+      for ( const std::exception_ptr & error : errors )
+      {
+        if ( error )
+          std::rethrow_exception( error );
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////
+  } // namespace thread
+  ////////////////////////////////////////////////////////////////////
+  ////////////////////////////////////////////////////////////////////
+} // namespace zypp
+//////////////////////////////////////////////////////////////////////
+
+#endif // ZYPP_THREAD_RUNTASKS_H
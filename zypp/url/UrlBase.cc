@@ -14,8 +14,11 @@
 #include "zypp/base/Gettext.h"
 #include "zypp/base/Regex.h"
 
+#include "zypp/TriBool.h"
+
 #include <stdexcept>
 #include <climits>
+#include <cstring>
 #include <errno.h>
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -45,6 +48,17 @@
 #define RX_VALID_HOSTIPV6  \
         "^\\[[:a-fA-F0-9]+(:[0-9]{1,3}(\\.[0-9]{1,3}){3})?\\]$"
 
+// ---------------------------------------------------------------
+/*
+** The default component patterns; see UrlBase::configure().
+*/
+#define RX_USERNAME   "^([" a_zA_Z "0-9!$&'\\(\\)*+=,;~\\._-]|%[a-fA-F0-9]{2})+$"
+#define RX_PASSWORD   "^([" a_zA_Z "0-9!$&'\\(\\)*+=,:;~\\._-]|%[a-fA-F0-9]{2})+$"
+#define RX_PATHNAME   "^([" a_zA_Z "0-9!$&'\\(\\){}*+=,:@/~\\._-]|%[a-fA-F0-9]{2})+$"
+#define RX_PATHPARAMS "^([" a_zA_Z "0-9!$&'\\(\\){}*+=,:;@/~\\._-]|%[a-fA-F0-9]{2})+$"
+#define RX_QUERYSTR   "^([" a_zA_Z "0-9!$&'\\(\\){}*+=,:;@/?~\\._-]|%[a-fA-F0-9]{2})+$"
+#define RX_FRAGMENT   RX_QUERYSTR
+
 
 //////////////////////////////////////////////////////////////////////
 namespace zypp
@@ -141,6 +155,96 @@ namespace zypp
     namespace // anonymous
     {
 
+      // -------------------------------------------------------------
+      // Plain ASCII char classes (locale independent, unlike the
+      // regex ones; see a_zA_Z above).
+      inline bool isAsciiAlpha(char c)
+      { return ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ); }
+
+      inline bool isAsciiDigit(char c)
+      { return c >= '0' && c <= '9'; }
+
+      inline bool isAsciiAlnum(char c)
+      { return isAsciiAlpha(c) || isAsciiDigit(c); }
+
+      inline bool isAsciiXDigit(char c)
+      { return isAsciiDigit(c) || ( c >= 'a' && c <= 'f' ) || ( c >= 'A' && c <= 'F' ); }
+
+      // -------------------------------------------------------------
+      /*
+      ** If regx is one of the default component patterns, return
+      ** the chars it accepts besides alnum and %-escapes. NULL
+      ** for any other (custom) pattern.
+      */
+      const char *
+      builtinSafeChars(const std::string &regx)
+      {
+        static const struct { const char *rx; const char *safe; } builtin[] = {
+          { RX_USERNAME,   "!$&'()*+=,;~._-" },
+          { RX_PASSWORD,   "!$&'()*+=,:;~._-" },
+          { RX_PATHNAME,   "!$&'(){}*+=,:@/~._-" },
+          { RX_PATHPARAMS, "!$&'(){}*+=,:;@/~._-" },
+          { RX_QUERYSTR,   "!$&'(){}*+=,:;@/?~._-" },
+        };
+        for( const auto & b : builtin )
+        {
+          if( regx == b.rx )
+            return b.safe;
+        }
+        return NULL;
+      }
+
+      // -------------------------------------------------------------
+      /*
+      ** Same as matching ^([<alnum><safe>]|%[a-fA-F0-9]{2})+$
+      ** (regex_match stops at a NUL char as well).
+      */
+      bool
+      matchEncoded(const std::string &data, const char *safe)
+      {
+        const char *p = data.c_str();
+        if( !*p )
+          return false;
+        for( ; *p; ++p )
+        {
+          if( *p == '%' )
+          {
+            if( !isAsciiXDigit(p[1]) || !isAsciiXDigit(p[2]) )
+              return false;
+            p += 2;
+          }
+          else if( !isAsciiAlnum(*p) && !::strchr(safe, *p) )
+          {
+            return false;
+          }
+        }
+        return true;
+      }
+
+      // -------------------------------------------------------------
+      /*
+      ** Same as matching RX_VALID_HOSTNAME, as long as there are
+      ** no non-ASCII chars (indeterminate is returned then, as
+      ** [:alnum:] depends on the locale).
+      */
+      TriBool
+      matchHostname(const char *p)
+      {
+        bool segment = false;   // inside a segment
+        for( ; *p; ++p )
+        {
+          if( isAsciiAlnum(*p) || *p == '$' || *p == '{' || *p == '}' || *p == '_' )
+            segment = true;
+          else if( (unsigned char)*p >= 0x80 )
+            return indeterminate;
+          else if( segment && ( *p == '.' || *p == '-' ) )
+            segment = false;
+          else
+            return false;
+        }
+        return segment;
+      }
+
 			// -------------------------------------------------------------
       inline void
       checkUrlData(const std::string &data,
@@ -157,7 +261,11 @@ namespace zypp
         else
         {
           bool valid = false;
-          try
+          if( const char *safe = builtinSafeChars(regx) )
+          {
+            valid = matchEncoded(data, safe);
+          }
+          else try
           {
             str::regex rex(regx);
             valid = str::regex_match(data, rex);
@@ -277,14 +385,14 @@ namespace zypp
       // n=no  (don't encode 2. slash if authority present)
       config("path_encode_slash2", "n");
 
-      config("rx_username",     "^([" a_zA_Z "0-9!$&'\\(\\)*+=,;~\\._-]|%[a-fA-F0-9]{2})+$");
-      config("rx_password",     "^([" a_zA_Z "0-9!$&'\\(\\)*+=,:;~\\._-]|%[a-fA-F0-9]{2})+$");
+      config("rx_username",     RX_USERNAME);
+      config("rx_password",     RX_PASSWORD);
 
-      config("rx_pathname",     "^([" a_zA_Z "0-9!$&'\\(\\){}*+=,:@/~\\._-]|%[a-fA-F0-9]{2})+$");
-      config("rx_pathparams",   "^([" a_zA_Z "0-9!$&'\\(\\){}*+=,:;@/~\\._-]|%[a-fA-F0-9]{2})+$");
+      config("rx_pathname",     RX_PATHNAME);
+      config("rx_pathparams",   RX_PATHPARAMS);
 
-      config("rx_querystr",     "^([" a_zA_Z "0-9!$&'\\(\\){}*+=,:;@/?~\\._-]|%[a-fA-F0-9]{2})+$");
-      config("rx_fragment",     "^([" a_zA_Z "0-9!$&'\\(\\){}*+=,:;@/?~\\._-]|%[a-fA-F0-9]{2})+$");
+      config("rx_querystr",     RX_QUERYSTR);
+      config("rx_fragment",     RX_FRAGMENT);
     }
 
 
@@ -373,14 +481,13 @@ namespace zypp
     bool
     UrlBase::isValidScheme(const std::string &scheme) const
     {
-      bool valid = false;
-      try
+      // RX_VALID_SCHEME
+      const char *p = scheme.c_str();
+      bool valid = isAsciiAlpha(*p);
+      while( valid && *++p )
       {
-        str::regex rex(RX_VALID_SCHEME);
-        valid = str::regex_match(scheme, rex);
+        valid = isAsciiAlnum(*p) || *p == '.' || *p == '+' || *p == '-';
       }
-      catch( ... )
-      {}
 
       if(valid)
       {
@@ -1025,6 +1132,13 @@ namespace zypp
 
         if( isValidHost(host))
         {
+          // nothing to decode, lowercase or encode
+          if( host.find_first_not_of("abcdefghijklmnopqrstuvwxyz0123456789.-_") == std::string::npos)
+          {
+            m_data->host = host;
+            return;
+          }
+
           std::string temp;
 
           // always decode in case isValidHost()
@@ -1324,28 +1438,43 @@ namespace zypp
     bool
     UrlBase::isValidHost(const std::string &host) const
     {
-      try
+      if( !host.empty() && host[0] == '[')
       {
-        str::regex regx(RX_VALID_HOSTIPV6);
-        if( str::regex_match(host, regx))
-        {
-          struct in6_addr ip;
-          std::string temp( host.substr(1, host.size()-2));
+        // RX_VALID_HOSTIPV6; anything inet_pton accepts
+        // within the brackets matches it as well.
+        if( host.size() < 3 || host[host.size()-1] != ']' ||
+            host.find_first_not_of(":.0123456789abcdefABCDEF", 1) != host.size()-1)
+          return false;
+
+        struct in6_addr ip;
+        std::string temp( host.substr(1, host.size()-2));
+
+        return inet_pton(AF_INET6, temp.c_str(), &ip) > 0;
+      }
 
-          return inet_pton(AF_INET6, temp.c_str(), &ip) > 0;
+      // matches also IPv4 dotted-decimal adresses...
+      std::string temp;
+      const char *name = host.c_str();
+      if( host.find('%') != std::string::npos)
+      {
+        temp = zypp::url::decode(host);
+        name = temp.c_str();
+      }
+
+      TriBool valid( matchHostname(name));
+      if( indeterminate(valid))
+      {
+        try
+        {
+          str::regex regx(RX_VALID_HOSTNAME);
+          valid = str::regex_match(name, regx);
         }
-        else
+        catch( ... )
         {
-          // matches also IPv4 dotted-decimal adresses...
-          std::string temp( zypp::url::decode(host));
-          str::regex  regx(RX_VALID_HOSTNAME);
-          return str::regex_match(temp, regx);
+          valid = false;
         }
       }
-      catch( ... )
-      {}
-
-      return false;
+      return bool(valid);
     }
 
 
@@ -1353,18 +1482,18 @@ namespace zypp
     bool
     UrlBase::isValidPort(const std::string &port) const
     {
-      try
+      // RX_VALID_PORT
+      const char *p = port.c_str();
+      long pnum = 0;
+      for( ; isAsciiDigit(*p); ++p )
       {
-        str::regex regx(RX_VALID_PORT);
-        if( str::regex_match(port, regx))
-        {
-          long pnum = str::strtonum<long>(port);
-          return ( pnum >= 1 && pnum <= USHRT_MAX);
-        }
+        if( p - port.c_str() == 5 )
+          return false;
+        pnum = pnum * 10 + ( *p - '0' );
       }
-      catch( ... )
-      {}
-      return false;
+      if( *p || p == port.c_str() )
+        return false;
+      return ( pnum >= 1 && pnum <= USHRT_MAX);
     }
 
 
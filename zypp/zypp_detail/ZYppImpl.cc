@@ -18,6 +18,7 @@
 #include "zypp/zypp_detail/ZYppImpl.h"
 #include "zypp/target/TargetImpl.h"
 #include "zypp/ZYpp.h"
+#include "zypp/ZYppFactory.h"
 #include "zypp/DiskUsageCounter.h"
 #include "zypp/ZConfig.h"
 #include "zypp/sat/Pool.h"
@@ -153,11 +154,15 @@ namespace zypp
       {
         ZYPP_THROW( Exception("ZYPP_TESTSUITE_FAKE_ARCH set. Commit not allowed and disabled.") );
       }
+      ZYppFactory::instance().assertWritable( "Commit" );
 
       MIL << "Attempt to commit (" << policy_r << ")" << endl;
       if (! _target)
 	ZYPP_THROW( Exception("Target not initialized.") );
 
+      if ( _prefetcher )
+        _prefetcher->commitBegins( _resolver->getTransaction() );
+
       ZYppCommitResult res = _target->_pimpl->commit( pool(), policy_r );
 
       if (! policy_r.dryRun() )
@@ -180,6 +185,24 @@ namespace zypp
       return res;
     }
 
+    void ZYppImpl::prefetchPackages()
+    {
+      if ( ! _target )
+      {
+        WAR << "Target not initialized: no package prefetch." << endl;
+        return;
+      }
+      if ( ! _prefetcher )
+        _prefetcher.reset( new target::CommitPackagePrefetcher );
+      _prefetcher->start( _resolver->getTransaction() );
+    }
+
+    void ZYppImpl::cancelPackagePrefetch()
+    {
+      if ( _prefetcher )
+        _prefetcher->cancel();
+    }
+
     void ZYppImpl::installSrcPackage( const SrcPackage_constPtr & srcPackage_r )
     {
       if (! _target)
@@ -22,6 +22,7 @@
 #include "zypp/ResTraits.h"
 #include "zypp/DiskUsageCounter.h"
 #include "zypp/ManagedFile.h"
+#include "zypp/target/CommitPackagePrefetcher.h"
 
 using namespace zypp::filesystem;
 
@@ -90,6 +91,12 @@ namespace zypp
       /** Commit changes and transactions. */
       ZYppCommitResult commit( const ZYppCommitPolicy & policy_r );
 
+      /** Start downloading the packages of the current solution in the background. */
+      void prefetchPackages();
+
+      /** Stop downloading packages in the background. */
+      void cancelPackagePrefetch();
+
       /** Install a source package on the Target. */
       void installSrcPackage( const SrcPackage_constPtr & srcPackage_r );
 
@@ -122,6 +129,8 @@ namespace zypp
       Pathname _home_path;
       /** defined mount points, used for disk usage counting */
       shared_ptr<DiskUsageCounter> _disk_usage;
+      /** background download of the packages to commit */
+      scoped_ptr<target::CommitPackagePrefetcher> _prefetcher;
     };
     ///////////////////////////////////////////////////////////////////
 